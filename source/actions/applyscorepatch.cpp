@@ -0,0 +1,47 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "applyscorepatch.h"
+
+#include <app/caret.h>
+#include <score/score.h>
+
+ApplyScorePatch::ApplyScorePatch(Score &score,
+                                 const ScoreUtils::ScorePatch &patch,
+                                 Caret &caret, const QString &text)
+    : QUndoCommand(text), myScore(score), myPatch(patch), myCaret(caret)
+{
+}
+
+void ApplyScorePatch::redo()
+{
+    myInversePatch = ScoreUtils::applyPatch(myScore, myPatch);
+    updateCaret();
+}
+
+void ApplyScorePatch::undo()
+{
+    ScoreUtils::applyPatch(myScore, myInversePatch);
+    myInversePatch = ScoreUtils::ScorePatch();
+    updateCaret();
+}
+
+void ApplyScorePatch::updateCaret()
+{
+    const ScoreLocation &location = myCaret.getLocation();
+    myCaret.moveToSystem(location.getSystemIndex(), true);
+    myCaret.moveToStaff(location.getStaffIndex());
+}
@@ -0,0 +1,47 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ACTIONS_APPLYSCOREPATCH_H
+#define ACTIONS_APPLYSCOREPATCH_H
+
+#include <QUndoCommand>
+#include <score/utils/scorediff.h>
+
+class Caret;
+class Score;
+
+/// Applies the changes from a diff or merge. Only the systems that are
+/// replaced are stored for undoing.
+class ApplyScorePatch : public QUndoCommand
+{
+public:
+    ApplyScorePatch(Score &score, const ScoreUtils::ScorePatch &patch,
+                    Caret &caret, const QString &text);
+
+    virtual void redo() override;
+    virtual void undo() override;
+
+private:
+    /// Ensures that the caret is still in a valid system and staff.
+    void updateCaret();
+
+    Score &myScore;
+    const ScoreUtils::ScorePatch myPatch;
+    Caret &myCaret;
+    ScoreUtils::ScorePatch myInversePatch;
+};
+
+#endif
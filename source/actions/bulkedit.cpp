@@ -0,0 +1,411 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bulkedit.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <QtConcurrentMap>
+#include <score/score.h>
+#include <score/scorelocation.h>
+#include <set>
+
+/// Moves each note to the fret (and, if necessary, the string) that produces
+/// its new pitch. Trills and tapped harmonics are shifted along with the note.
+/// Notes that cannot be placed are left unchanged.
+/// @returns False if the position contains a natural harmonic whose pitch
+/// would need to change, since it can't simply be moved to another fret.
+/// @param oldTuning The tuning that the notes were entered for, or null if it
+/// is unknown (in which case notes can't be moved to another string).
+/// @param newTuning The tuning that the notes should be played with.
+static bool refretNotes(Position &pos, int stringCount,
+                        const Tuning *oldTuning, const Tuning *newTuning,
+                        int semitones)
+{
+    if (oldTuning && newTuning)
+    {
+        stringCount = std::min({ stringCount, oldTuning->getStringCount(),
+                                 newTuning->getStringCount() });
+    }
+
+    const std::vector<Note> originalNotes(pos.getNotes().begin(),
+                                          pos.getNotes().end());
+
+    // Strings that are occupied, either by a note that was placed or by a
+    // note that hasn't been placed yet (so that a note which can't be moved
+    // can always stay on its original string).
+    std::set<int> usedStrings;
+    for (const Note &note : originalNotes)
+        usedStrings.insert(note.getString());
+
+    auto findFret = [&](const Note &note, int string) {
+        if (!oldTuning || !newTuning)
+            return note.getFretNumber() + semitones;
+
+        const int pitch = oldTuning->getNote(note.getString(), false) +
+                          note.getFretNumber() + semitones;
+        return pitch - newTuning->getNote(string, false);
+    };
+
+    auto inRange = [](int fret) {
+        return fret >= Note::MIN_FRET_NUMBER && fret <= Note::MAX_FRET_NUMBER;
+    };
+
+    // Moves the note to the given string and fret, along with its trill and
+    // tapped harmonic. Returns false if any of them would be out of range.
+    auto moveNote = [&](const Note &note, int string, int fret,
+                        std::vector<Note> &notes) {
+        const int shift = fret - note.getFretNumber();
+        if (!inRange(fret) ||
+            (note.hasTrill() && !inRange(note.getTrilledFret() + shift)) ||
+            (note.hasTappedHarmonic() &&
+             !inRange(note.getTappedHarmonicFret() + shift)))
+        {
+            return false;
+        }
+
+        notes.push_back(note);
+        Note &newNote = notes.back();
+        newNote.setString(string);
+        newNote.setFretNumber(fret);
+        if (note.hasTrill())
+            newNote.setTrilledFret(note.getTrilledFret() + shift);
+        if (note.hasTappedHarmonic())
+            newNote.setTappedHarmonicFret(note.getTappedHarmonicFret() + shift);
+        return true;
+    };
+
+    // The pitch of a natural harmonic depends on the fret in a different
+    // way, so it can only be left alone if its string's pitch is unchanged.
+    for (const Note &note : originalNotes)
+    {
+        if (note.hasProperty(Note::NaturalHarmonic) &&
+            note.getString() < stringCount &&
+            findFret(note, note.getString()) != note.getFretNumber())
+        {
+            return false;
+        }
+    }
+
+    std::vector<Note> newNotes;
+    std::vector<const Note *> unplacedNotes;
+
+    // First, keep as many notes as possible on their current string.
+    for (const Note &note : originalNotes)
+    {
+        if (note.hasProperty(Note::NaturalHarmonic) ||
+            note.getString() >= stringCount)
+        {
+            newNotes.push_back(note);
+            continue;
+        }
+
+        if (!moveNote(note, note.getString(), findFret(note, note.getString()),
+                      newNotes))
+        {
+            unplacedNotes.push_back(&note);
+        }
+    }
+
+    // Then, try to move the remaining notes to the nearest free string.
+    for (const Note *note : unplacedNotes)
+    {
+        bool placed = false;
+        if (oldTuning && newTuning)
+        {
+            for (int offset = 1; offset < stringCount && !placed; ++offset)
+            {
+                for (int direction : { -1, 1 })
+                {
+                    const int string = note->getString() + direction * offset;
+                    if (string < 0 || string >= stringCount ||
+                        usedStrings.count(string))
+                    {
+                        continue;
+                    }
+
+                    if (moveNote(*note, string, findFret(*note, string),
+                                 newNotes))
+                    {
+                        usedStrings.insert(string);
+                        placed = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (!placed)
+            newNotes.push_back(*note);
+    }
+
+    for (const Note &note : originalNotes)
+        pos.removeNote(note);
+    for (const Note &note : newNotes)
+        pos.insertNote(note);
+
+    return true;
+}
+
+BulkEdit::BulkEdit(Score &score, const Edit &edit, const QString &text)
+    : QUndoCommand(text), myScore(score)
+{
+    Range range;
+    range.myFirstSystem = 0;
+    range.myLastSystem = static_cast<int>(score.getSystems().size()) - 1;
+    range.myStaff = -1;
+    range.myVoice = -1;
+    range.myLeft = 0;
+    range.myRight = std::numeric_limits<int>::max();
+
+    computeChanges(range, edit);
+}
+
+BulkEdit::BulkEdit(const ScoreLocation &location, const Edit &edit,
+                   const QString &text)
+    : QUndoCommand(text), myScore(const_cast<Score &>(location.getScore()))
+{
+    Range range;
+    range.myFirstSystem = range.myLastSystem = location.getSystemIndex();
+    range.myStaff = location.getStaffIndex();
+    range.myVoice = location.getVoiceIndex();
+    range.myLeft = std::min(location.getPositionIndex(),
+                            location.getSelectionStart());
+    range.myRight = std::max(location.getPositionIndex(),
+                             location.getSelectionStart());
+
+    computeChanges(range, edit);
+}
+
+int BulkEdit::getChangeCount() const
+{
+    return static_cast<int>(myChanges.size());
+}
+
+const std::vector<BulkEdit::BlockedPosition> &
+BulkEdit::getBlockedPositions() const
+{
+    return myBlockedPositions;
+}
+
+int BulkEdit::getFirstSystem() const
+{
+    return myChanges.empty() ? -1 : myChanges.front().mySystem;
+}
+
+int BulkEdit::getLastSystem() const
+{
+    return myChanges.empty() ? -1 : myChanges.back().mySystem;
+}
+
+void BulkEdit::redo()
+{
+    applyChanges(false);
+}
+
+void BulkEdit::undo()
+{
+    applyChanges(true);
+}
+
+void BulkEdit::computeChanges(const Range &range, const Edit &edit)
+{
+    const int numSystems = range.myLastSystem - range.myFirstSystem + 1;
+    if (numSystems <= 0)
+        return;
+
+    std::vector<int> systems(numSystems);
+    std::iota(systems.begin(), systems.end(), range.myFirstSystem);
+    std::vector<std::vector<Change>> systemChanges(numSystems);
+    std::vector<std::vector<BlockedPosition>> systemBlocked(numSystems);
+    const Score &score = myScore;
+
+    // Each system only reads from the score and writes to its own list of
+    // changes, so they can be processed in parallel.
+    QtConcurrent::blockingMap(systems, [&](int systemIndex) {
+        const int i = systemIndex - range.myFirstSystem;
+        computeSystemChanges(score, systemIndex, range, edit,
+                             systemChanges[i], systemBlocked[i]);
+    });
+
+    for (const std::vector<Change> &changes : systemChanges)
+        myChanges.insert(myChanges.end(), changes.begin(), changes.end());
+    for (const std::vector<BlockedPosition> &blocked : systemBlocked)
+    {
+        myBlockedPositions.insert(myBlockedPositions.end(), blocked.begin(),
+                                  blocked.end());
+    }
+}
+
+void BulkEdit::computeSystemChanges(const Score &score, int systemIndex,
+                                    const Range &range, const Edit &edit,
+                                    std::vector<Change> &changes,
+                                    std::vector<BlockedPosition> &blocked)
+{
+    const System &system = score.getSystems()[systemIndex];
+
+    // Find the players at the start of the system.
+    const PlayerChange *initialPlayers =
+        ScoreUtils::getCurrentPlayers(score, systemIndex, -1);
+
+    Context context;
+    context.mySystem = systemIndex;
+
+    const int numStaves = static_cast<int>(system.getStaves().size());
+    for (int staffIndex = 0; staffIndex < numStaves; ++staffIndex)
+    {
+        if (range.myStaff >= 0 && range.myStaff != staffIndex)
+            continue;
+
+        const Staff &staff = system.getStaves()[staffIndex];
+        context.myStaff = staffIndex;
+        context.myStringCount = staff.getStringCount();
+
+        for (int voiceIndex = 0; voiceIndex < Staff::NUM_VOICES; ++voiceIndex)
+        {
+            if (range.myVoice >= 0 && range.myVoice != voiceIndex)
+                continue;
+
+            context.myVoice = voiceIndex;
+            auto positions = staff.getVoices()[voiceIndex].getPositions();
+            const int numPositions = static_cast<int>(positions.size());
+
+            for (int i = 0; i < numPositions; ++i)
+            {
+                const Position &pos = positions[i];
+                if (pos.getPosition() < range.myLeft ||
+                    pos.getPosition() > range.myRight)
+                {
+                    continue;
+                }
+
+                const PlayerChange *players = initialPlayers;
+                for (const PlayerChange &change : system.getPlayerChanges())
+                {
+                    if (change.getPosition() <= pos.getPosition())
+                        players = &change;
+                }
+
+                context.myPlayer = -1;
+                context.myTuning = nullptr;
+                if (players)
+                {
+                    auto activePlayers = players->getActivePlayers(staffIndex);
+                    if (!activePlayers.empty())
+                    {
+                        context.myPlayer =
+                            activePlayers.front().getPlayerNumber();
+                        context.myTuning =
+                            &score.getPlayers()[context.myPlayer].getTuning();
+                    }
+                }
+
+                Position newPos(pos);
+                if (!edit(context, newPos))
+                {
+                    BlockedPosition blockedPos;
+                    blockedPos.mySystem = systemIndex;
+                    blockedPos.myStaff = staffIndex;
+                    blockedPos.myPosition = pos.getPosition();
+                    blocked.push_back(blockedPos);
+                    continue;
+                }
+                Q_ASSERT(newPos.getPosition() == pos.getPosition());
+
+                if (!(newPos == pos))
+                {
+                    Change change;
+                    change.mySystem = systemIndex;
+                    change.myStaff = staffIndex;
+                    change.myVoice = voiceIndex;
+                    change.myIndex = i;
+                    change.myOriginalPosition = pos;
+                    change.myNewPosition = newPos;
+                    changes.push_back(change);
+                }
+            }
+        }
+    }
+}
+
+void BulkEdit::applyChanges(bool undo)
+{
+    for (const Change &change : myChanges)
+    {
+        Position &pos = myScore.getSystems()[change.mySystem]
+                            .getStaves()[change.myStaff]
+                            .getVoices()[change.myVoice]
+                            .getPositions()[change.myIndex];
+        pos = undo ? change.myOriginalPosition : change.myNewPosition;
+    }
+}
+
+BulkEdit::Edit BulkEdit::transpose(int semitones)
+{
+    return [=](const Context &context, Position &pos) {
+        return refretNotes(pos, context.myStringCount, context.myTuning,
+                           context.myTuning, semitones);
+    };
+}
+
+BulkEdit::Edit BulkEdit::retune(int player, const Tuning &newTuning)
+{
+    return [=](const Context &context, Position &pos) {
+        if (context.myPlayer != player)
+            return true;
+
+        return refretNotes(pos, context.myStringCount, context.myTuning,
+                           &newTuning, 0);
+    };
+}
+
+BulkEdit::Edit BulkEdit::scaleDurations(double factor)
+{
+    return [=](const Context &, Position &pos) {
+        // The duration types are the denominators of the note values.
+        const double duration = pos.getDurationType() / factor;
+        const int newDuration = static_cast<int>(duration);
+
+        if (duration == newDuration && newDuration >= Position::WholeNote &&
+            newDuration <= Position::SixtyFourthNote)
+        {
+            pos.setDurationType(
+                static_cast<Position::DurationType>(newDuration));
+        }
+
+        return true;
+    };
+}
+
+BulkEdit::Edit BulkEdit::clearProperties(
+    const std::vector<Position::SimpleProperty> &positionProperties,
+    const std::vector<Note::SimpleProperty> &noteProperties)
+{
+    return [=](const Context &, Position &pos) {
+        for (Position::SimpleProperty property : positionProperties)
+            pos.setProperty(property, false);
+
+        for (Note &note : pos.getNotes())
+        {
+            for (Note::SimpleProperty property : noteProperties)
+                note.setProperty(property, false);
+        }
+
+        return true;
+    };
+}
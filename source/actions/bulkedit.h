@@ -0,0 +1,143 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ACTIONS_BULKEDIT_H
+#define ACTIONS_BULKEDIT_H
+
+#include <functional>
+#include <QUndoCommand>
+#include <score/note.h>
+#include <score/position.h>
+#include <vector>
+
+class Score;
+class ScoreLocation;
+class Tuning;
+
+/// Applies an edit to every position in the score or in the selection, as a
+/// single undo command. The edits are computed for each system in parallel,
+/// and only the positions that were modified are stored.
+class BulkEdit : public QUndoCommand
+{
+public:
+    /// Describes where a position is in the score.
+    struct Context
+    {
+        int mySystem;
+        int myStaff;
+        int myVoice;
+        int myStringCount;
+        /// The index of the staff's (first) active player, or -1 if the staff
+        /// has no players at the position.
+        int myPlayer;
+        /// The tuning of the active player, or null if there is no player.
+        const Tuning *myTuning;
+    };
+
+    /// Modifies a copy of a position. Positions that are left unchanged are
+    /// not recorded. The edit must not change the location of the position,
+    /// and may be called from several threads at once.
+    /// Returns false if the position cannot be edited, in which case it is
+    /// left unchanged and reported by getBlockedPositions().
+    typedef std::function<bool(const Context &, Position &)> Edit;
+
+    /// The location of a position that could not be edited.
+    struct BlockedPosition
+    {
+        int mySystem;
+        int myStaff;
+        int myPosition;
+    };
+
+    /// Edits every position in the score.
+    BulkEdit(Score &score, const Edit &edit, const QString &text);
+    /// Edits the selected positions.
+    BulkEdit(const ScoreLocation &location, const Edit &edit,
+             const QString &text);
+
+    /// Returns the number of positions that are modified.
+    int getChangeCount() const;
+    /// Returns the positions that could not be edited.
+    const std::vector<BlockedPosition> &getBlockedPositions() const;
+    /// Returns the first system that is modified, or -1 if there are no
+    /// changes.
+    int getFirstSystem() const;
+    /// Returns the last system that is modified, or -1 if there are no
+    /// changes.
+    int getLastSystem() const;
+
+    virtual void redo() override;
+    virtual void undo() override;
+
+    /// Transposes each note by the given number of semitones, along with
+    /// any trills or tapped harmonics. Notes that would be out of range are
+    /// moved to another string if possible, and are otherwise left unchanged.
+    /// Positions with natural harmonics cannot be transposed.
+    static Edit transpose(int semitones);
+
+    /// Refrets the notes played by the given player for a new tuning, so
+    /// that they keep the same pitch. Positions with natural harmonics cannot
+    /// be refretted unless their string's pitch is unchanged.
+    static Edit retune(int player, const Tuning &newTuning);
+
+    /// Multiplies each duration by the given power of two (e.g. 2 to double
+    /// the durations, or 0.5 to halve them). Durations that would be out of
+    /// range are left unchanged.
+    static Edit scaleDurations(double factor);
+
+    /// Removes the given properties from each position and note.
+    static Edit clearProperties(
+        const std::vector<Position::SimpleProperty> &positionProperties,
+        const std::vector<Note::SimpleProperty> &noteProperties);
+
+private:
+    struct Change
+    {
+        int mySystem;
+        int myStaff;
+        int myVoice;
+        /// The index of the position in the voice.
+        int myIndex;
+        Position myOriginalPosition;
+        Position myNewPosition;
+    };
+
+    /// Restricts the edit to part of the score (e.g. the selection).
+    struct Range
+    {
+        int myFirstSystem;
+        int myLastSystem;
+        /// The staff and voice to edit, or -1 for all staves and voices.
+        int myStaff;
+        int myVoice;
+        int myLeft;
+        int myRight;
+    };
+
+    void computeChanges(const Range &range, const Edit &edit);
+    static void computeSystemChanges(const Score &score, int systemIndex,
+                                     const Range &range, const Edit &edit,
+                                     std::vector<Change> &changes,
+                                     std::vector<BlockedPosition> &blocked);
+    void applyChanges(bool undo);
+
+    Score &myScore;
+    std::vector<Change> myChanges;
+    std::vector<BlockedPosition> myBlockedPositions;
+};
+
+#endif
@@ -20,6 +20,15 @@
 #include <score/barline.h>
 #include <score/score.h>
 
+/// Compares two key signatures, ignoring properties such as visibility that
+/// are specific to each bar.
+static bool isSameKey(const KeySignature &key1, const KeySignature &key2)
+{
+    return key1.getKeyType() == key2.getKeyType() &&
+           key1.getNumAccidentals() == key2.getNumAccidentals() &&
+           key1.usesSharps() == key2.usesSharps();
+}
+
 EditKeySignature::EditKeySignature(const ScoreLocation &location,
                                    const KeySignature &newKey)
     : QUndoCommand(QObject::tr("Edit Key Signature")),
@@ -58,9 +67,7 @@ void EditKeySignature::updateFollowingKeySignatures(const KeySignature &oldKey,
             }
 
             const KeySignature &currentKey = bar.getKeySignature();
-            if (currentKey.getKeyType() == oldKey.getKeyType() &&
-                currentKey.getNumAccidentals() == oldKey.getNumAccidentals() &&
-                currentKey.usesSharps() == oldKey.usesSharps())
+            if (isSameKey(currentKey, oldKey))
             {
                 KeySignature key;
                 key.setVisible(bar.getKeySignature().isVisible());
@@ -77,3 +84,35 @@ void EditKeySignature::updateFollowingKeySignatures(const KeySignature &oldKey,
         }
     }
 }
+
+int EditKeySignature::getLastAffectedSystem() const
+{
+    const Score &score = myLocation.getScore();
+    const int startSystem = myLocation.getSystemIndex();
+
+    // Redoing updates the following bars that match the old signature, and
+    // undoing updates the bars that match the new signature.
+    int lastSystem = startSystem;
+    for (int i = startSystem; i < score.getSystems().size(); ++i)
+    {
+        for (const Barline &bar : score.getSystems()[i].getBarlines())
+        {
+            if (i == startSystem &&
+                bar.getPosition() <= myLocation.getPositionIndex())
+            {
+                continue;
+            }
+
+            const KeySignature &currentKey = bar.getKeySignature();
+            if (!isSameKey(currentKey, myOldKey) &&
+                !isSameKey(currentKey, myNewKey))
+            {
+                return lastSystem;
+            }
+
+            lastSystem = i;
+        }
+    }
+
+    return lastSystem;
+}
@@ -30,6 +30,10 @@ public:
     virtual void redo() override;
     virtual void undo() override;
 
+    /// Returns the index of the last system whose key signatures can be modified
+    /// by this command.
+    int getLastAffectedSystem() const;
+
 private:
     /// Updates all of the key signatures following myLocation until a different
     /// key signature is reached.
@@ -20,6 +20,15 @@
 #include <score/barline.h>
 #include <score/score.h>
 
+/// Compares two time signatures, ignoring properties such as visibility that
+/// are specific to each bar.
+static bool isSameMeter(const TimeSignature &time1, const TimeSignature &time2)
+{
+    return time1.getMeterType() == time2.getMeterType() &&
+           time1.getBeatsPerMeasure() == time2.getBeatsPerMeasure() &&
+           time1.getBeatValue() == time2.getBeatValue();
+}
+
 EditTimeSignature::EditTimeSignature(const ScoreLocation &location,
                                      const TimeSignature& newTimeSig)
     : QUndoCommand(QObject::tr("Edit Time Signature")),
@@ -58,9 +67,7 @@ void EditTimeSignature::updateFollowingTimeSignatures(
             }
 
             const TimeSignature &currentTime = bar.getTimeSignature();
-            if (currentTime.getMeterType() == oldTime.getMeterType() &&
-                currentTime.getBeatsPerMeasure() == oldTime.getBeatsPerMeasure() &&
-                currentTime.getBeatValue() == oldTime.getBeatValue())
+            if (isSameMeter(currentTime, oldTime))
             {
                 TimeSignature time(newTime);
                 time.setVisible(currentTime.isVisible());
@@ -71,3 +78,35 @@ void EditTimeSignature::updateFollowingTimeSignatures(
         }
     }
 }
+
+int EditTimeSignature::getLastAffectedSystem() const
+{
+    const Score &score = myLocation.getScore();
+    const int startSystem = myLocation.getSystemIndex();
+
+    // Redoing updates the following bars that match the old signature, and
+    // undoing updates the bars that match the new signature.
+    int lastSystem = startSystem;
+    for (int i = startSystem; i < score.getSystems().size(); ++i)
+    {
+        for (const Barline &bar : score.getSystems()[i].getBarlines())
+        {
+            if (i == startSystem &&
+                bar.getPosition() <= myLocation.getPositionIndex())
+            {
+                continue;
+            }
+
+            const TimeSignature &currentTime = bar.getTimeSignature();
+            if (!isSameMeter(currentTime, myOldTime) &&
+                !isSameMeter(currentTime, myNewTime))
+            {
+                return lastSystem;
+            }
+
+            lastSystem = i;
+        }
+    }
+
+    return lastSystem;
+}
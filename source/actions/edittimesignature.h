@@ -31,6 +31,10 @@ public:
     virtual void redo() override;
     virtual void undo() override;
 
+    /// Returns the index of the last system whose time signatures can be modified
+    /// by this command.
+    int getLastAffectedSystem() const;
+
 private:
     /// Updates all of the time signatures following myLocation until a
     /// different time signature is reached.
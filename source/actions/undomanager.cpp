@@ -17,6 +17,8 @@
 
 #include "undomanager.h"
 
+#include <util/tracing.h>
+
 UndoManager::UndoManager(QObject *parent) :
     QUndoGroup(parent)
 {
@@ -42,51 +44,68 @@ void UndoManager::removeStack(int index)
     undoStacks.erase(undoStacks.begin() + index);
 }
 
+/// Returns the number of commands, including the command itself.
+static int countCommands(const QUndoCommand &cmd)
+{
+    int count = 1;
+    for (int i = 0; i < cmd.childCount(); ++i)
+        count += countCommands(*cmd.child(i));
+
+    return count;
+}
+
+int UndoManager::getCommandCount(int index) const
+{
+    const QUndoStack &stack = undoStacks.at(index);
+
+    int count = 0;
+    for (int i = 0; i < stack.count(); ++i)
+        count += countCommands(*stack.command(i));
+
+    return count;
+}
+
 void UndoManager::push(QUndoCommand *cmd)
 {
+    PTE_TRACE_SCOPE("UndoManager::push");
     activeStack()->push(cmd);
 }
 
 void UndoManager::push(QUndoCommand *cmd, int affectedSystem)
 {
-    beginMacro(cmd->actionText());
-
-    auto onUndo = new SignalOnUndo();
-    if (affectedSystem >= 0)
-    {
-        connect(onUndo, &SignalOnUndo::triggered, [=]() {
-            onSystemChanged(affectedSystem);
-        });
-    }
-    else
-    {
-        connect(onUndo, &SignalOnUndo::triggered, this,
-                &UndoManager::fullRedrawNeeded);
-    }
+    push(cmd, affectedSystem, affectedSystem);
+}
 
-    push(onUndo);
+void UndoManager::push(QUndoCommand *cmd, int firstSystem, int lastSystem)
+{
+    beginMacro(cmd->actionText(), firstSystem, lastSystem);
     push(cmd);
+    endMacro(firstSystem, lastSystem);
+}
 
-    auto onRedo = new SignalOnRedo();
-    if (affectedSystem >= 0)
+template <typename SignalCommand>
+SignalCommand *UndoManager::createRedrawCommand(int firstSystem,
+                                                int lastSystem)
+{
+    auto command = new SignalCommand();
+    if (firstSystem >= 0)
     {
-        connect(onRedo, &SignalOnRedo::triggered, [=]() {
-            onSystemChanged(affectedSystem);
+        connect(command, &SignalCommand::triggered, [=]() {
+            onSystemsChanged(firstSystem, lastSystem);
         });
     }
     else
     {
-        connect(onRedo, &SignalOnRedo::triggered, this,
+        connect(command, &SignalCommand::triggered, this,
                 &UndoManager::fullRedrawNeeded);
     }
 
-    push(onRedo);
-    endMacro();
+    return command;
 }
 
-void UndoManager::onSystemChanged(int affectedSystem)
+void UndoManager::onSystemsChanged(int firstSystem, int lastSystem)
 {
-    emit redrawNeeded(affectedSystem);
+    emit redrawNeeded(firstSystem, lastSystem);
 }
 
 void UndoManager::beginMacro(const QString &text)
@@ -99,6 +118,19 @@ void UndoManager::endMacro()
     activeStack()->endMacro();
 }
 
+void UndoManager::beginMacro(const QString &text, int firstSystem,
+                             int lastSystem)
+{
+    beginMacro(text);
+    push(createRedrawCommand<SignalOnUndo>(firstSystem, lastSystem));
+}
+
+void UndoManager::endMacro(int firstSystem, int lastSystem)
+{
+    push(createRedrawCommand<SignalOnRedo>(firstSystem, lastSystem));
+    endMacro();
+}
+
 void SignalOnRedo::redo()
 {
     emit triggered();
@@ -36,25 +36,45 @@ public:
     void setActiveStackIndex(int index);
     void removeStack(int index);
 
+    /// Returns the number of commands in the document's undo stack, including
+    /// the commands nested inside of macros.
+    int getCommandCount(int index) const;
+
     /// Pushes an undo command onto the active stack.
     /// @param affectedSystem Index of the system that is modified by this action.
     /// Use -1 for actions that affect all systems.
     void push(QUndoCommand *cmd, int affectedSystem);
 
+    /// Pushes an undo command that modifies a range of systems (e.g. changing
+    /// a key signature also updates the following bars).
+    void push(QUndoCommand *cmd, int firstSystem, int lastSystem);
+
+    /// Pushes an undo command without redrawing any systems. This is for
+    /// commands inside a macro that was started with a range of systems.
+    void push(QUndoCommand *cmd);
+
     void beginMacro(const QString &text);
     void endMacro();
 
+    /// Begins a macro that redraws the given systems once when it is undone or
+    /// redone, rather than after each of its commands.
+    void beginMacro(const QString &text, int firstSystem, int lastSystem);
+    /// Ends a macro that was started with a range of systems. The same range
+    /// must be provided.
+    void endMacro(int firstSystem, int lastSystem);
+
     static const int AFFECTS_ALL_SYSTEMS = -1;
 
 signals:
     void fullRedrawNeeded();
-    void redrawNeeded(int);
+    void redrawNeeded(int firstSystem, int lastSystem);
 
 private:
-    /// Pushes the QUndoCommand onto the active stack.
-    void push(QUndoCommand *cmd);
+    /// Creates a command that redraws the systems when it is undone or redone.
+    template <typename SignalCommand>
+    SignalCommand *createRedrawCommand(int firstSystem, int lastSystem);
 
-    void onSystemChanged(int affectedSystem);
+    void onSystemsChanged(int firstSystem, int lastSystem);
 
     boost::ptr_vector<QUndoStack> undoStacks;
 };
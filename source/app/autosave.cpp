@@ -0,0 +1,259 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "autosave.h"
+
+#include <app/documentmanager.h>
+#include <app/settings.h>
+#include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <memory>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QtConcurrentRun>
+#include <score/serialization.h>
+#include <sstream>
+#include <util/tracing.h>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<QString, std::shared_ptr<const Score>>>
+    SnapshotList;
+
+/// Writes the snapshots in the same format as the Power Tab exporter. The
+/// data is committed atomically, so a crash while writing never leaves a
+/// truncated recovery file.
+static void writeSnapshots(const SnapshotList &snapshots)
+{
+    for (auto &snapshot : snapshots)
+    {
+        try
+        {
+            std::ostringstream output;
+            {
+                boost::iostreams::filtering_ostreambuf out;
+                out.push(boost::iostreams::gzip_compressor());
+                out.push(output);
+
+                std::ostream compressed_output(&out);
+                ScoreUtils::save(compressed_output, "score", *snapshot.second);
+            }
+
+            const std::string data = output.str();
+            QSaveFile file(snapshot.first);
+            if (!file.open(QIODevice::WriteOnly) ||
+                file.write(data.data(), data.size()) !=
+                    static_cast<qint64>(data.size()) ||
+                !file.commit())
+            {
+                throw std::runtime_error("Could not write recovery file");
+            }
+        }
+        catch (const std::exception &e)
+        {
+            qDebug() << "Error writing recovery file" << snapshot.first;
+            qDebug() << "Exception: " << e.what();
+        }
+    }
+}
+
+AutoSave::AutoSave(QObject *parent)
+    : QObject(parent),
+      mySession(QString("%1_%2")
+                    .arg(QCoreApplication::applicationPid())
+                    .arg(QDateTime::currentMSecsSinceEpoch())),
+      myNextId(0)
+{
+    if (!QDir().mkpath(recoveryDirectory()))
+        qDebug() << "Could not create recovery directory.";
+
+    // Hold a lock for as long as the session is running, so that other
+    // instances of the program don't treat its snapshots as abandoned.
+    myLockFile.reset(new QLockFile(lockFilePath(mySession)));
+    myLockFile->setStaleLockTime(0);
+    if (!myLockFile->tryLock())
+        qDebug() << "Could not lock the recovery session.";
+
+    QSettings settings;
+    const int interval = settings.value(
+        Settings::APP_AUTOSAVE_INTERVAL,
+        Settings::APP_AUTOSAVE_INTERVAL_DEFAULT).toInt();
+
+    // An interval of zero disables autosave.
+    if (interval > 0)
+    {
+        connect(&myTimer, SIGNAL(timeout()), this, SLOT(takeSnapshots()));
+        myTimer.start(interval * 1000);
+    }
+}
+
+AutoSave::~AutoSave()
+{
+    myPendingWrite.waitForFinished();
+
+    for (auto &doc : myDocuments)
+    {
+        if (!doc.second.myIsRestored)
+            QFile::remove(doc.second.myPath);
+    }
+}
+
+AutoSave::Entry &AutoSave::getEntry(const Document &doc)
+{
+    auto it = myDocuments.find(&doc);
+    if (it == myDocuments.end())
+    {
+        Entry entry;
+        entry.myPath = nextSnapshotPath();
+        entry.myIsModified = false;
+        entry.myIsRestored = false;
+        it = myDocuments.insert(std::make_pair(&doc, entry)).first;
+    }
+
+    return it->second;
+}
+
+void AutoSave::markModified(const Document &doc)
+{
+    getEntry(doc).myIsModified = true;
+}
+
+void AutoSave::markModified(const Document &doc, int firstSystem,
+                            int lastSystem)
+{
+    Entry &entry = getEntry(doc);
+    entry.myIsModified = true;
+
+    if (firstSystem < 0)
+        entry.myCache.invalidate();
+    else
+        entry.myCache.markModified(firstSystem, lastSystem);
+}
+
+void AutoSave::removeDocument(const Document &doc)
+{
+    auto it = myDocuments.find(&doc);
+    if (it == myDocuments.end())
+        return;
+
+    // Make sure that a pending write doesn't recreate the file.
+    myPendingWrite.waitForFinished();
+
+    QFile::remove(it->second.myPath);
+    myDocuments.erase(it);
+}
+
+QStringList AutoSave::findRecoveryFiles() const
+{
+    QStringList files;
+    QDir dir(recoveryDirectory());
+    for (const QString &file : dir.entryList(QStringList("*.pt2"), QDir::Files,
+                                             QDir::Time))
+    {
+        // The snapshots are named "<session>-<id>.pt2".
+        const QString session = file.section('-', 0, 0);
+        if (session == mySession)
+            continue;
+
+        // If the session's lock can be acquired, the session is no longer
+        // running. The lock file is only treated as stale if its process has
+        // exited.
+        QLockFile lock(lockFilePath(session));
+        lock.setStaleLockTime(0);
+        if (lock.tryLock())
+        {
+            lock.unlock();
+            files.append(dir.filePath(file));
+        }
+    }
+
+    return files;
+}
+
+void AutoSave::restoreDocument(const Document &doc,
+                               const QString &recoveryFile)
+{
+    // Move the snapshot into this session, so that other instances of the
+    // program don't try to recover it as well.
+    Entry entry;
+    entry.myPath = nextSnapshotPath();
+    if (!QFile::rename(recoveryFile, entry.myPath))
+        entry.myPath = recoveryFile;
+
+    // The snapshot already matches the document.
+    entry.myIsModified = false;
+    entry.myIsRestored = true;
+    myDocuments[&doc] = entry;
+}
+
+void AutoSave::takeSnapshots()
+{
+    // If the previous snapshots are still being written, try again at the
+    // next interval rather than queueing up more work.
+    if (myPendingWrite.isRunning())
+        return;
+
+    PTE_TRACE_SCOPE("AutoSave::takeSnapshots");
+
+    // Only the copy is done on this thread - serializing, compressing and
+    // writing the data happens in the background. The systems that weren't
+    // edited since the previous snapshot are reused.
+    SnapshotList snapshots;
+    for (auto &doc : myDocuments)
+    {
+        if (!doc.second.myIsModified)
+            continue;
+
+        snapshots.push_back(std::make_pair(
+            doc.second.myPath,
+            doc.second.myCache.getSnapshot(doc.first->getScore())));
+
+        doc.second.myIsModified = false;
+    }
+
+    if (snapshots.empty())
+        return;
+
+    PTE_TRACE_COUNTER("AutoSave::snapshots", snapshots.size());
+
+    myPendingWrite = QtConcurrent::run([=]() { writeSnapshots(snapshots); });
+}
+
+QString AutoSave::recoveryDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::DataLocation) +
+           "/recovery";
+}
+
+QString AutoSave::lockFilePath(const QString &session)
+{
+    return QString("%1/%2.lock").arg(recoveryDirectory()).arg(session);
+}
+
+QString AutoSave::nextSnapshotPath()
+{
+    return QString("%1/%2-%3.pt2")
+        .arg(recoveryDirectory())
+        .arg(mySession)
+        .arg(myNextId++);
+}
@@ -0,0 +1,100 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef APP_AUTOSAVE_H
+#define APP_AUTOSAVE_H
+
+#include <app/playbackscorecache.h>
+#include <map>
+#include <memory>
+#include <QFuture>
+#include <QStringList>
+#include <QTimer>
+
+class Document;
+class QLockFile;
+
+/// Periodically writes snapshots of modified documents to a recovery
+/// directory, so that they can be restored after a crash.
+class AutoSave : public QObject
+{
+    Q_OBJECT
+
+public:
+    AutoSave(QObject *parent = nullptr);
+    /// Removes this session's snapshots, since the program exited normally.
+    /// Snapshots of restored documents that were never saved are kept.
+    ~AutoSave();
+
+    /// Marks the document as modified, so that a snapshot is written at the
+    /// next interval.
+    void markModified(const Document &doc);
+
+    /// Records that a range of systems in the document was edited, so that
+    /// only those systems are copied for the next snapshot. Use -1 for edits
+    /// that may affect all systems.
+    void markModified(const Document &doc, int firstSystem, int lastSystem);
+
+    /// Removes the document's snapshot (e.g. after it is saved or closed).
+    void removeDocument(const Document &doc);
+
+    /// Returns any snapshots left behind by a previous session that did not
+    /// exit cleanly. Snapshots from sessions that are still running are
+    /// skipped.
+    QStringList findRecoveryFiles() const;
+
+    /// Takes ownership of a snapshot from a previous session, after it was
+    /// restored into the given document. The file is kept until the document
+    /// is saved or closed.
+    void restoreDocument(const Document &doc, const QString &recoveryFile);
+
+private slots:
+    /// Copies each modified document and writes it to disk in a separate
+    /// thread.
+    void takeSnapshots();
+
+private:
+    struct Entry
+    {
+        QString myPath;
+        bool myIsModified;
+        /// Whether the snapshot should be kept when the program exits.
+        bool myIsRestored;
+        /// Reuses the unmodified systems from the previous snapshot.
+        PlaybackScoreCache myCache;
+    };
+
+    /// Returns the document's entry, creating one if necessary.
+    Entry &getEntry(const Document &doc);
+
+    static QString recoveryDirectory();
+    /// Returns the path of the lock file that is held while the session is
+    /// running.
+    static QString lockFilePath(const QString &session);
+    /// Returns a new path for one of this session's snapshots.
+    QString nextSnapshotPath();
+
+    QTimer myTimer;
+    std::map<const Document *, Entry> myDocuments;
+    QFuture<void> myPendingWrite;
+    /// Uniquely identifies this session's snapshots.
+    const QString mySession;
+    std::unique_ptr<QLockFile> myLockFile;
+    int myNextId;
+};
+
+#endif
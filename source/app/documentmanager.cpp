@@ -21,6 +21,10 @@
 #include <QString>
 
 #include <app/settings.h>
+#include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <score/serialization.h>
+#include <sstream>
 
 DocumentManager::DocumentManager()
 {
@@ -119,7 +123,7 @@ int DocumentManager::getCurrentDocumentIndex() const
 }
 
 Document::Document()
-    : myCaret(myScore)
+    : myIsModified(false), myCaret(myScore)
 {
 }
 
@@ -138,22 +142,89 @@ void Document::setFilename(const std::string &filename)
     myFilename = filename;
 }
 
+bool Document::isModified() const
+{
+    return myIsModified;
+}
+
+void Document::setModified(bool modified)
+{
+    myIsModified = modified;
+}
+
 const Score &Document::getScore() const
 {
+    wake();
     return myScore;
 }
 
 Score &Document::getScore()
 {
+    wake();
     return myScore;
 }
 
 const Caret &Document::getCaret() const
 {
+    wake();
     return myCaret;
 }
 
 Caret &Document::getCaret()
 {
+    wake();
     return myCaret;
 }
+
+void Document::hibernate()
+{
+    if (myHibernatedScore)
+        return;
+
+    std::ostringstream output;
+    {
+        boost::iostreams::filtering_ostreambuf out;
+        out.push(boost::iostreams::gzip_compressor());
+        out.push(output);
+
+        std::ostream compressed_output(&out);
+        ScoreUtils::save(compressed_output, "score", myScore);
+    }
+
+    myHibernatedScore = output.str();
+
+    // The score object must stay alive, since the caret and the undo stack
+    // refer to it, so just remove its contents.
+    while (!myScore.getSystems().empty())
+        myScore.removeSystem(myScore.getSystems().size() - 1);
+    while (!myScore.getPlayers().empty())
+        myScore.removePlayer(myScore.getPlayers().size() - 1);
+    while (!myScore.getInstruments().empty())
+        myScore.removeInstrument(myScore.getInstruments().size() - 1);
+}
+
+bool Document::isHibernating() const
+{
+    return myHibernatedScore;
+}
+
+size_t Document::getHibernatedSize() const
+{
+    return myHibernatedScore ? myHibernatedScore->size() : 0;
+}
+
+void Document::wake() const
+{
+    if (!myHibernatedScore)
+        return;
+
+    std::istringstream input(*myHibernatedScore);
+    boost::iostreams::filtering_istreambuf in;
+    in.push(boost::iostreams::gzip_decompressor());
+    in.push(input);
+
+    std::istream compressed_input(&in);
+    ScoreUtils::load(compressed_input, "score", myScore);
+
+    myHibernatedScore.reset();
+}
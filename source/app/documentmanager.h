@@ -34,15 +34,33 @@ public:
     const std::string &getFilename() const;
     void setFilename(const std::string &filename);
 
+    /// Returns whether the document has unsaved changes that are not tracked
+    /// by its undo stack (e.g. after being restored from a recovery file).
+    bool isModified() const;
+    void setModified(bool modified);
+
     const Score &getScore() const;
     Score &getScore();
 
     const Caret &getCaret() const;
     Caret &getCaret();
 
+    /// Compresses the score to reduce memory usage while the document is not
+    /// being viewed. The score is restored the next time it is accessed.
+    void hibernate();
+    bool isHibernating() const;
+    /// Returns the size of the compressed score while hibernating.
+    size_t getHibernatedSize() const;
+
 private:
+    /// Restores the score if the document is hibernating.
+    void wake() const;
+
     boost::optional<std::string> myFilename;
-    Score myScore;
+    bool myIsModified;
+    mutable Score myScore;
+    /// The compressed score, while the document is hibernating.
+    mutable boost::optional<std::string> myHibernatedScore;
     Caret myCaret;
 };
 
@@ -0,0 +1,136 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "playbackscorecache.h"
+
+#include <algorithm>
+#include <score/score.h>
+#include <util/tracing.h>
+
+PlaybackScoreCache::PlaybackScoreCache() : mySource(nullptr)
+{
+}
+
+void PlaybackScoreCache::markModified(int firstSystem, int lastSystem)
+{
+    for (Entry &entry : myEntries)
+    {
+        if (entry.myFirstModified < 0)
+        {
+            entry.myFirstModified = firstSystem;
+            entry.myLastModified = lastSystem;
+        }
+        else
+        {
+            entry.myFirstModified =
+                std::min(entry.myFirstModified, firstSystem);
+            entry.myLastModified = std::max(entry.myLastModified, lastSystem);
+        }
+    }
+}
+
+void PlaybackScoreCache::invalidate()
+{
+    for (Entry &entry : myEntries)
+        entry.myIsAllModified = true;
+}
+
+std::shared_ptr<const Score> PlaybackScoreCache::getSnapshot(
+    const Score &score)
+{
+    PTE_TRACE_SCOPE("PlaybackScoreCache::getSnapshot");
+
+    if (mySource != &score)
+    {
+        mySource = &score;
+        invalidate();
+    }
+
+    // Find a snapshot that has been released by the playback thread.
+    auto entry = std::find_if(myEntries.begin(), myEntries.end(),
+                              [](const Entry &entry) {
+        return !entry.myIsInUse->load(std::memory_order_acquire);
+    });
+
+    if (entry == myEntries.end())
+    {
+        Entry newEntry;
+        newEntry.myIsInUse = std::make_shared<std::atomic<bool>>(false);
+        newEntry.myIsAllModified = true;
+        newEntry.myFirstModified = newEntry.myLastModified = -1;
+        myEntries.push_back(newEntry);
+        entry = myEntries.end() - 1;
+    }
+
+    updateEntry(*entry, score);
+    entry->myIsInUse->store(true, std::memory_order_relaxed);
+
+    // Rather than deleting the score, the returned pointer's deleter hands the
+    // snapshot back to the cache. It also keeps the score alive in case the
+    // cache is destroyed first.
+    std::shared_ptr<Score> snapshot = entry->myScore;
+    std::shared_ptr<std::atomic<bool>> isInUse = entry->myIsInUse;
+    return std::shared_ptr<const Score>(
+        snapshot.get(), [snapshot, isInUse](const Score *) {
+            isInUse->store(false, std::memory_order_release);
+        });
+}
+
+void PlaybackScoreCache::updateEntry(Entry &entry, const Score &score)
+{
+    const int systemCount = static_cast<int>(score.getSystems().size());
+
+    if (entry.myIsAllModified || !entry.myScore ||
+        static_cast<int>(entry.myScore->getSystems().size()) != systemCount)
+    {
+        entry.myScore = std::make_shared<Score>();
+        ScoreUtils::copy(score, *entry.myScore);
+    }
+    else
+    {
+        Score &copy = *entry.myScore;
+
+        // Only the modified systems need to be copied.
+        if (entry.myFirstModified >= 0)
+        {
+            const int last = std::min(entry.myLastModified, systemCount - 1);
+            for (int i = entry.myFirstModified; i <= last; ++i)
+                copy.getSystems()[i] = score.getSystems()[i];
+        }
+
+        // The score information, players, and instruments are small and can
+        // be edited without redrawing any systems, so they are always copied.
+        copy.setScoreInfo(score.getScoreInfo());
+        copy.setLineSpacing(score.getLineSpacing());
+
+        while (!copy.getPlayers().empty())
+            copy.removePlayer(static_cast<int>(copy.getPlayers().size()) - 1);
+        for (const Player &player : score.getPlayers())
+            copy.insertPlayer(player);
+
+        while (!copy.getInstruments().empty())
+        {
+            copy.removeInstrument(
+                static_cast<int>(copy.getInstruments().size()) - 1);
+        }
+        for (const Instrument &instrument : score.getInstruments())
+            copy.insertInstrument(instrument);
+    }
+
+    entry.myIsAllModified = false;
+    entry.myFirstModified = entry.myLastModified = -1;
+}
@@ -0,0 +1,71 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef APP_PLAYBACKSCORECACHE_H
+#define APP_PLAYBACKSCORECACHE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class Score;
+
+/// Provides read-only snapshots of a score for the playback thread (and for
+/// autosave). Rather than copying the entire score after every edit, the
+/// systems that were not modified since the last snapshot are reused from an
+/// earlier copy.
+class PlaybackScoreCache
+{
+public:
+    PlaybackScoreCache();
+
+    /// Records that the given range of systems was modified.
+    void markModified(int firstSystem, int lastSystem);
+
+    /// Records that the entire score may have been modified, or that a
+    /// different score is now being edited.
+    void invalidate();
+
+    /// Returns an up to date snapshot of the score. The snapshot is not reused
+    /// until every copy of the returned pointer has been released, which may
+    /// happen on another thread.
+    std::shared_ptr<const Score> getSnapshot(const Score &score);
+
+private:
+    /// A copy of the score, along with the systems that were modified after
+    /// it was last updated.
+    struct Entry
+    {
+        std::shared_ptr<Score> myScore;
+        /// Set while the snapshot is handed out, and cleared when the last
+        /// copy of the returned pointer is released.
+        std::shared_ptr<std::atomic<bool>> myIsInUse;
+        bool myIsAllModified;
+        int myFirstModified;
+        int myLastModified;
+    };
+
+    void updateEntry(Entry &entry, const Score &score);
+
+    /// A snapshot cannot be updated while the playback thread is still using
+    /// it, so a few copies are kept around.
+    std::vector<Entry> myEntries;
+    /// The score that the snapshots were copied from.
+    const Score *mySource;
+};
+
+#endif
@@ -37,6 +37,8 @@
 #include <actions/addsystem.h>
 #include <actions/addtempomarker.h>
 #include <actions/adjustlinespacing.h>
+#include <actions/applyscorepatch.h>
+#include <actions/bulkedit.h>
 #include <actions/editbarline.h>
 #include <actions/editclef.h>
 #include <actions/editfileinformation.h>
@@ -67,6 +69,9 @@
 #include <actions/shiftpositions.h>
 #include <actions/undomanager.h>
 
+#include <algorithm>
+
+#include <app/autosave.h>
 #include <app/caret.h>
 #include <app/clipboard.h>
 #include <app/command.h>
@@ -77,12 +82,12 @@
 #include <app/recentfiles.h>
 #include <app/scorearea.h>
 #include <app/settings.h>
+#include <app/tablibrary.h>
 #include <app/tuningdictionary.h>
 
+#include <audio/barindex.h>
 #include <audio/midiplayer.h>
-
-#include <boost/lexical_cast.hpp>
-#include <boost/timer.hpp>
+#include <audio/playbacksettings.h>
 
 #include <dialogs/alterationofpacedialog.h>
 #include <dialogs/alternateendingdialog.h>
@@ -103,30 +108,45 @@
 #include <dialogs/preferencesdialog.h>
 #include <dialogs/rehearsalsigndialog.h>
 #include <dialogs/staffdialog.h>
+#include <dialogs/tablibrarydialog.h>
 #include <dialogs/tappedharmonicdialog.h>
 #include <dialogs/tempomarkerdialog.h>
 #include <dialogs/timesignaturedialog.h>
 #include <dialogs/trilldialog.h>
+#include <dialogs/tuningdialog.h>
 #include <dialogs/tuningdictionarydialog.h>
 
 #include <formats/fileformatmanager.h>
 
+#include <fstream>
+#include <sstream>
+
 #include <QCoreApplication>
-#include <QDebug>
+#include <QDialog>
+#include <QDialogButtonBox>
 #include <QDockWidget>
 #include <QFileDialog>
 #include <QFontDatabase>
+#include <QInputDialog>
 #include <QKeyEvent>
 #include <QMenuBar>
 #include <QMessageBox>
+#include <QPlainTextEdit>
+#include <QPushButton>
 #include <QScrollArea>
 #include <QSettings>
 #include <QTabBar>
+#include <QTimer>
 #include <QVBoxLayout>
 
+#include <score/score.h>
 #include <score/utils.h>
+#include <score/utils/memoryusage.h>
+#include <score/utils/scorediff.h>
 #include <score/voiceutils.h>
 
+#include <util/tracing.h>
+
 #include <widgets/instruments/instrumentpanel.h>
 #include <widgets/mixer/mixer.h>
 #include <widgets/playback/playbackwidget.h>
@@ -137,6 +157,7 @@ PowerTabEditor::PowerTabEditor()
       myFileFormatManager(new FileFormatManager()),
       myUndoManager(new UndoManager()),
       myTuningDictionary(new TuningDictionary()),
+      myAutoSave(new AutoSave()),
       mySettingsPubSub(std::make_shared<SettingsPubSub>()),
       myIsPlaying(false),
       myPreviousDirectory(
@@ -160,12 +181,62 @@ PowerTabEditor::PowerTabEditor()
     // Load the tab note font.
     QFontDatabase::addApplicationFont(":fonts/LiberationSans-Regular.ttf");
 
-    connect(myUndoManager.get(), SIGNAL(redrawNeeded(int)), this,
-            SLOT(redrawSystem(int)));
+    connect(myUndoManager.get(), SIGNAL(redrawNeeded(int, int)), this,
+            SLOT(redrawSystems(int, int)));
     connect(myUndoManager.get(), SIGNAL(fullRedrawNeeded()), this,
             SLOT(redrawScore()));
+    // Only the edited systems need to be indexed again or copied for
+    // playback and autosave.
+    connect(myUndoManager.get(), &UndoManager::redrawNeeded,
+            [=](int firstSystem, int lastSystem) {
+        myPlaybackScoreCache.markModified(firstSystem, lastSystem);
+        myAutoSave->markModified(myDocumentManager->getCurrentDocument(),
+                                 firstSystem, lastSystem);
+
+        if (myBarIndex)
+        {
+            myBarIndex->updateSystems(
+                myDocumentManager->getCurrentDocument().getScore(),
+                firstSystem, lastSystem);
+        }
+
+        if (myPhraseIndex)
+        {
+            myPhraseIndex->updateSystems(
+                myDocumentManager->getCurrentDocument().getScore(),
+                firstSystem, lastSystem);
+        }
+    });
+    connect(myUndoManager.get(), &UndoManager::fullRedrawNeeded, [=]() {
+        myBarIndex.reset();
+        myPhraseIndex.reset();
+        myPlaybackScoreCache.invalidate();
+        myAutoSave->markModified(myDocumentManager->getCurrentDocument(),
+                                 UndoManager::AFFECTS_ALL_SYSTEMS,
+                                 UndoManager::AFFECTS_ALL_SYSTEMS);
+    });
     connect(myUndoManager.get(), SIGNAL(cleanChanged(bool)), this,
             SLOT(updateModified(bool)));
+    // Any edit, undo, or redo requires a new snapshot of the document.
+    connect(myUndoManager.get(), &QUndoGroup::indexChanged, [=]() {
+        if (myDocumentManager->hasOpenDocuments())
+        {
+            myAutoSave->markModified(
+                myDocumentManager->getCurrentDocument());
+            updateLocationLabel();
+        }
+
+        // Send the edited score to the MIDI player.
+        if (myMidiPlayer)
+            myMidiPlayer->updateScore(copyScoreForPlayback());
+    });
+
+    // Publish a new snapshot of the settings to the playback thread whenever
+    // the preferences are changed.
+    mySettingsPubSub->subscribe([=](const std::string &) {
+        if (myMidiPlayer)
+            myMidiPlayer->updateSettings(std::make_shared<PlaybackSettings>());
+    });
 
     myTuningDictionary->loadInBackground();
 
@@ -189,6 +260,19 @@ PowerTabEditor::PowerTabEditor()
     setMinimumSize(800, 600);
     setWindowState(Qt::WindowMaximized);
     setWindowTitle(getApplicationName());
+
+    // Periodically check for tabs that can be hibernated.
+    if (settings.value(Settings::APP_HIBERNATE_TIMEOUT,
+                       Settings::APP_HIBERNATE_TIMEOUT_DEFAULT).toInt() > 0)
+    {
+        auto hibernateTimer = new QTimer(this);
+        connect(hibernateTimer, SIGNAL(timeout()), this,
+                SLOT(hibernateInactiveTabs()));
+        hibernateTimer->start(60 * 1000);
+    }
+
+    // Check for recovered documents once the event loop has started.
+    QTimer::singleShot(0, this, SLOT(restoreRecoveredDocuments()));
 }
 
 PowerTabEditor::~PowerTabEditor()
@@ -219,8 +303,7 @@ void PowerTabEditor::openFile(QString filename)
     if (filename.isEmpty())
         return;
 
-    boost::timer timer;
-    qDebug() << "Opening file: " << filename;
+    PTE_TRACE_SCOPE("PowerTabEditor::openFile");
 
     QFileInfo fileInfo(filename);
     boost::optional<FileFormat> format = myFileFormatManager->findFormat(
@@ -237,7 +320,9 @@ void PowerTabEditor::openFile(QString filename)
     if (myFileFormatManager->importFile(doc.getScore(), filename.toStdString(),
                                         *format, this))
     {
-        qDebug() << "File loaded in" << timer.elapsed() << "seconds";
+        // Release the memory left over from growing the vectors while
+        // importing.
+        ScoreUtils::compact(doc.getScore());
 
         doc.setFilename(filename.toStdString());
         setPreviousDirectory(filename);
@@ -254,9 +339,28 @@ void PowerTabEditor::openFile(QString filename)
 void PowerTabEditor::switchTab(int index)
 {
     myDocumentManager->setCurrentDocumentIndex(index);
+    myBarIndex.reset();
+    myPhraseIndex.reset();
+    myPlaybackScoreCache.invalidate();
+    myPhrase.clear();
+
+    for (int i = 0; i < myTabWidget->count(); ++i)
+    {
+        auto scoreArea = static_cast<ScoreArea *>(myTabWidget->widget(i));
+        scoreArea->setActive(i == index);
+    }
 
     if (index != -1)
     {
+        // Restore the tab if it was hibernated.
+        ScoreArea *scoreArea = getScoreArea();
+        if (scoreArea->isHibernating())
+        {
+            PTE_TRACE_SCOPE("PowerTabEditor::restoreTab");
+            scoreArea->renderDocument(myDocumentManager->getCurrentDocument(),
+                                      Staff::GuitarView);
+        }
+
         const Score &score = myDocumentManager->getCurrentDocument().getScore();
         myMixer->reset(score);
         myInstrumentPanel->reset(score);
@@ -273,10 +377,39 @@ void PowerTabEditor::switchTab(int index)
     updateWindowTitle();
 }
 
+void PowerTabEditor::hibernateInactiveTabs()
+{
+    QSettings settings;
+    const int timeout =
+        settings.value(Settings::APP_HIBERNATE_TIMEOUT,
+                       Settings::APP_HIBERNATE_TIMEOUT_DEFAULT).toInt();
+    const bool compress =
+        settings.value(Settings::APP_HIBERNATE_COMPRESS,
+                       Settings::APP_HIBERNATE_COMPRESS_DEFAULT).toBool();
+    if (timeout <= 0)
+        return;
+
+    for (int i = 0; i < myTabWidget->count(); ++i)
+    {
+        auto scoreArea = static_cast<ScoreArea *>(myTabWidget->widget(i));
+        if (scoreArea->isHibernating() ||
+            scoreArea->getInactiveTime() < timeout * 1000)
+        {
+            continue;
+        }
+
+        PTE_TRACE_SCOPE("PowerTabEditor::hibernateTab");
+        scoreArea->hibernate();
+        if (compress)
+            myDocumentManager->getDocument(i).hibernate();
+    }
+}
+
 bool PowerTabEditor::closeTab(int index)
 {
     // Prompt to save modified documents.
-    if (isWindowModified())
+    if (isWindowModified() ||
+        myDocumentManager->getDocument(index).isModified())
     {
         QMessageBox msg(this);
         msg.setWindowTitle(tr("Close Document"));
@@ -299,6 +432,7 @@ bool PowerTabEditor::closeTab(int index)
     if (myDocumentManager->getDocument(index).getCaret().isInPlaybackMode())
         startStopPlayback();
 
+    myAutoSave->removeDocument(myDocumentManager->getDocument(index));
     myUndoManager->removeStack(index);
     myDocumentManager->removeDocument(index);
     delete myTabWidget->widget(index);
@@ -353,6 +487,9 @@ bool PowerTabEditor::saveFileAs()
         if (myFileFormatManager->exportFile(doc.getScore(), newPath, *format))
         {
             doc.setFilename(newPath);
+            doc.setModified(false);
+            myAutoSave->removeDocument(doc);
+            updateModified(myUndoManager->isClean());
 
             // Update window title and tab bar.
             updateWindowTitle();
@@ -370,9 +507,261 @@ bool PowerTabEditor::saveFileAs()
     return false;
 }
 
+void PowerTabEditor::exportTrace()
+{
+    const QString path = QFileDialog::getSaveFileName(
+        this, tr("Export Performance Trace"), myPreviousDirectory,
+        tr("Chrome Trace Files (*.json)"));
+    if (path.isEmpty())
+        return;
+
+    std::ofstream output(path.toStdString());
+    Tracing::exportJson(output);
+
+    if (!output)
+    {
+        QMessageBox::warning(this, tr("Error Exporting Trace"),
+                             tr("The trace file could not be written."));
+    }
+}
+
+void PowerTabEditor::showMemoryReport()
+{
+    std::ostringstream report;
+
+    for (int i = 0; i < myTabWidget->count(); ++i)
+    {
+        const Document &doc = myDocumentManager->getDocument(i);
+        auto scoreArea = static_cast<const ScoreArea *>(myTabWidget->widget(i));
+
+        report << myTabWidget->tabText(i).toStdString() << "\n\n";
+
+        // Avoid waking up the document just to measure it.
+        if (doc.isHibernating())
+        {
+            report << "Hibernating, compressed to " << doc.getHibernatedSize()
+                   << " bytes\n";
+        }
+        else
+        {
+            const ScoreUtils::MemoryUsage usage =
+                ScoreUtils::getMemoryUsage(doc.getScore());
+            ScoreUtils::printMemoryUsage(report, usage);
+            report << "After compaction: "
+                   << usage.getTotalBytes() - usage.getTotalSlackBytes()
+                   << " bytes\n";
+        }
+
+        report << "Undo commands: " << myUndoManager->getCommandCount(i)
+               << "\n";
+        report << "Scene items: " << scoreArea->getItemCount()
+               << ", text batches: " << scoreArea->getGlyphMemoryUsage()
+               << " bytes\n\n";
+    }
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Memory Report"));
+
+    auto text = new QPlainTextEdit(QString::fromStdString(report.str()));
+    text->setReadOnly(true);
+    text->setLineWrapMode(QPlainTextEdit::NoWrap);
+    text->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    auto buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    connect(buttons, SIGNAL(rejected()), &dialog, SLOT(reject()));
+
+    auto layout = new QVBoxLayout(&dialog);
+    layout->addWidget(text);
+    layout->addWidget(buttons);
+
+    dialog.resize(600, 500);
+    dialog.exec();
+}
+
+void PowerTabEditor::compareWithFile()
+{
+    Score otherScore;
+    if (!importScore(tr("Compare With"), otherScore))
+        return;
+
+    Score &score = getLocation().getScore();
+    const ScoreUtils::ScorePatch patch = ScoreUtils::diff(score, otherScore);
+
+    std::ostringstream report;
+    ScoreUtils::printPatch(report, score, patch);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Compare With"));
+
+    auto text = new QPlainTextEdit(QString::fromStdString(report.str()));
+    text->setReadOnly(true);
+    text->setLineWrapMode(QPlainTextEdit::NoWrap);
+    text->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    auto buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    QPushButton *applyButton =
+        buttons->addButton(tr("Apply Changes"), QDialogButtonBox::AcceptRole);
+    applyButton->setEnabled(!patch.isEmpty());
+    connect(buttons, SIGNAL(accepted()), &dialog, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), &dialog, SLOT(reject()));
+
+    auto layout = new QVBoxLayout(&dialog);
+    layout->addWidget(text);
+    layout->addWidget(buttons);
+
+    dialog.resize(600, 500);
+    if (dialog.exec() == QDialog::Accepted)
+    {
+        myUndoManager->push(
+            new ApplyScorePatch(score, patch, getCaret(), tr("Apply Changes")),
+            UndoManager::AFFECTS_ALL_SYSTEMS);
+    }
+}
+
+void PowerTabEditor::mergeChanges()
+{
+    Score baseScore;
+    if (!importScore(tr("Select the Original Version"), baseScore))
+        return;
+
+    Score otherScore;
+    if (!importScore(tr("Select the Version to Merge"), otherScore))
+        return;
+
+    Score &score = getLocation().getScore();
+    const ScoreUtils::MergeResult result =
+        ScoreUtils::merge(baseScore, score, otherScore);
+
+    if (!result.myPatch.isEmpty())
+    {
+        myUndoManager->push(new ApplyScorePatch(score, result.myPatch,
+                                                getCaret(),
+                                                tr("Merge Changes")),
+                            UndoManager::AFFECTS_ALL_SYSTEMS);
+    }
+
+    if (!result.myConflicts.empty())
+    {
+        QStringList conflicts;
+        for (const ScoreUtils::MergeConflict &conflict : result.myConflicts)
+        {
+            const QString description =
+                QString::fromStdString(conflict.myDescription);
+            if (conflict.mySystem < 0)
+                conflicts.append(description);
+            else
+            {
+                conflicts.append(tr("System %1: %2")
+                                     .arg(conflict.mySystem + 1)
+                                     .arg(description));
+            }
+        }
+
+        QMessageBox::warning(
+            this, tr("Merge Changes"),
+            tr("The following changes conflict with the current document and "
+               "were not merged:\n\n%1").arg(conflicts.join("\n")));
+    }
+    else if (result.myPatch.isEmpty())
+    {
+        QMessageBox::information(this, tr("Merge Changes"),
+                                 tr("There are no changes to merge."));
+    }
+}
+
+bool PowerTabEditor::importScore(const QString &title, Score &score)
+{
+    const QString filename = QFileDialog::getOpenFileName(
+        this, title, myPreviousDirectory,
+        QString::fromStdString(myFileFormatManager->importFileFilter()));
+
+    if (filename.isEmpty())
+        return false;
+
+    boost::optional<FileFormat> format = myFileFormatManager->findFormat(
+        QFileInfo(filename).suffix().toStdString());
+
+    if (!format)
+    {
+        QMessageBox::warning(this, tr("Error Opening File"),
+                             tr("Unsupported file type."));
+        return false;
+    }
+
+    return myFileFormatManager->importFile(score, filename.toStdString(),
+                                           *format, this);
+}
+
+void PowerTabEditor::openTabLibrary()
+{
+    if (!myTabLibrary)
+    {
+        myTabLibrary.reset(new TabLibrary());
+        myTabLibrary->load();
+    }
+
+    TabLibraryDialog dialog(this, *myTabLibrary);
+    if (dialog.exec() == QDialog::Accepted)
+    {
+        const QString filename = dialog.getSelectedFile();
+        if (!filename.isEmpty())
+            openFile(filename);
+    }
+}
+
 void PowerTabEditor::updateModified(bool clean)
 {
-    setWindowModified(!clean);
+    setWindowModified(!clean ||
+                      (myDocumentManager->hasOpenDocuments() &&
+                       myDocumentManager->getCurrentDocument().isModified()));
+}
+
+void PowerTabEditor::restoreRecoveredDocuments()
+{
+    const QStringList files = myAutoSave->findRecoveryFiles();
+    if (files.isEmpty())
+        return;
+
+    const int ret = QMessageBox::question(
+        this, tr("Restore Documents"),
+        tr("%n document(s) were not saved before the program last exited. "
+           "Do you want to restore them?", "", files.size()),
+        QMessageBox::Yes | QMessageBox::No | QMessageBox::Discard,
+        QMessageBox::Yes);
+
+    if (ret == QMessageBox::Yes)
+    {
+        const FileFormat format = *myFileFormatManager->findFormat("pt2");
+
+        for (const QString &file : files)
+        {
+            // Restored documents are left untitled, so that the user must
+            // choose where to save them. The recovery file is kept until the
+            // document is saved or closed.
+            Document &doc = myDocumentManager->addDocument();
+            if (myFileFormatManager->importFile(doc.getScore(),
+                                                file.toStdString(), format,
+                                                this))
+            {
+                doc.setModified(true);
+                myAutoSave->restoreDocument(doc, file);
+                setupNewTab();
+                setWindowModified(true);
+            }
+            else
+            {
+                myDocumentManager->removeDocument(
+                    myDocumentManager->getCurrentDocumentIndex());
+            }
+        }
+    }
+    // Otherwise, the documents are offered again the next time unless they
+    // are explicitly discarded.
+    else if (ret == QMessageBox::Discard)
+    {
+        for (const QString &file : files)
+            QFile::remove(file);
+    }
 }
 
 void PowerTabEditor::cycleTab(int offset)
@@ -446,6 +835,16 @@ void PowerTabEditor::editFileInformation()
 }
 
 void PowerTabEditor::startStopPlayback()
+{
+    togglePlayback(false);
+}
+
+void PowerTabEditor::startStopLoopPlayback()
+{
+    togglePlayback(true);
+}
+
+void PowerTabEditor::togglePlayback(bool loop)
 {
     myIsPlaying = !myIsPlaying;
 
@@ -458,9 +857,39 @@ void PowerTabEditor::startStopPlayback()
         myPlaybackWidget->setPlaybackMode(true);
 
         const ScoreLocation &location = getLocation();
+        int startPosition = location.getPositionIndex();
+        int endPosition = startPosition;
+
+        if (loop)
+        {
+            // Loop over the selected positions, or the current bar if there
+            // isn't a selection.
+            if (location.hasSelection())
+            {
+                startPosition = std::min(location.getSelectionStart(),
+                                         location.getPositionIndex());
+                endPosition = std::max(location.getSelectionStart(),
+                                       location.getPositionIndex());
+            }
+            else
+            {
+                const BarIndex &index = getBarIndex();
+                const int bar = index.findBar(SystemLocation(
+                    location.getSystemIndex(), startPosition));
+                if (bar >= 0 && index.getBarLocation(bar).getSystem() ==
+                                    location.getSystemIndex())
+                {
+                    startPosition = index.getBarLocation(bar).getPosition();
+                    endPosition = index.getBarEndPosition(bar) - 1;
+                }
+            }
+        }
+
         myMidiPlayer.reset(new MidiPlayer(
-            location.getScore(), location.getSystemIndex(),
-            location.getPositionIndex(), myPlaybackWidget->getPlaybackSpeed()));
+            copyScoreForPlayback(), location.getSystemIndex(), startPosition,
+            myPlaybackWidget->getPlaybackSpeed()));
+        if (loop)
+            myMidiPlayer->enableLooping(endPosition);
 
         connect(myMidiPlayer.get(), SIGNAL(playbackSystemChanged(int)), this,
                 SLOT(moveCaretToSystem(int)));
@@ -475,8 +904,10 @@ void PowerTabEditor::startStopPlayback()
     }
     else
     {
-        // If we manually stop playback, tell the midi thread to finish.
-        if (myMidiPlayer && myMidiPlayer->isRunning())
+        // Release the player even if playback finished by itself, so that
+        // later edits and settings changes aren't sent to it. If we manually
+        // stopped playback, this also tells the midi thread to finish.
+        if (myMidiPlayer)
         {
             // Avoid recursion from the finished() signal being called.
             myMidiPlayer->disconnect(this);
@@ -492,9 +923,14 @@ void PowerTabEditor::startStopPlayback()
     }
 }
 
-void PowerTabEditor::redrawSystem(int index)
+std::shared_ptr<const Score> PowerTabEditor::copyScoreForPlayback()
+{
+    return myPlaybackScoreCache.getSnapshot(getLocation().getScore());
+}
+
+void PowerTabEditor::redrawSystems(int firstSystem, int lastSystem)
 {
-    getScoreArea()->redrawSystem(index);
+    getScoreArea()->redrawSystems(firstSystem, lastSystem);
     updateCommands();
 }
 
@@ -658,13 +1094,15 @@ void PowerTabEditor::removeSelectedPositions()
 
 void PowerTabEditor::gotoBarline()
 {
-    GoToBarlineDialog dialog(this, getLocation().getScore());
+    const BarIndex &index = getBarIndex();
+    GoToBarlineDialog dialog(this, index.getBarCount());
 
     if (dialog.exec() == QDialog::Accepted)
     {
-        ScoreLocation location(dialog.getLocation());
-        getCaret().moveToSystem(location.getSystemIndex(), true);
-        getCaret().moveToPosition(location.getPositionIndex());
+        const SystemLocation &location =
+            index.getBarLocation(dialog.getBarNumber() - 1);
+        getCaret().moveToSystem(location.getSystem(), true);
+        getCaret().moveToPosition(location.getPosition());
     }
 }
 
@@ -680,6 +1118,54 @@ void PowerTabEditor::gotoRehearsalSign()
     }
 }
 
+void PowerTabEditor::findPhrase()
+{
+    const ScoreLocation &location = getLocation();
+    const std::vector<const Position *> positions =
+        location.getSelectedPositions();
+
+    if (positions.empty())
+    {
+        QMessageBox::information(this, tr("Find Phrase"),
+                                 tr("Select the notes to search for."));
+        return;
+    }
+
+    myPhrase = PhraseIndex::getPhrase(
+        location.getScore(), location.getSystemIndex(),
+        location.getStaffIndex(), location.getVoiceIndex(),
+        positions.front()->getPosition(), positions.back()->getPosition());
+
+    findNextPhrase();
+}
+
+void PowerTabEditor::findNextPhrase()
+{
+    if (myPhrase.empty())
+        return;
+
+    const std::vector<PhraseIndex::Match> matches =
+        getPhraseIndex().find(myPhrase, true);
+    if (matches.empty())
+        return;
+
+    // Move to the first match after the caret, wrapping around to the start
+    // of the score.
+    const ScoreLocation &location = getLocation();
+    const PhraseIndex::Match current(
+        location.getSystemIndex(), location.getStaffIndex(),
+        location.getVoiceIndex(), location.getPositionIndex());
+
+    auto match = std::upper_bound(matches.begin(), matches.end(), current);
+    if (match == matches.end())
+        match = matches.begin();
+
+    getCaret().moveToSystem(match->mySystem, true);
+    getCaret().moveToStaff(match->myStaff);
+    updateActiveVoice(match->myVoice);
+    getCaret().moveToPosition(match->myPosition);
+}
+
 void PowerTabEditor::editChordName()
 {
     ScoreLocation &location(getLocation());
@@ -798,6 +1284,116 @@ void PowerTabEditor::changeNoteDuration(bool increase)
     myUndoManager->endMacro();
 }
 
+void PowerTabEditor::transpose()
+{
+    bool accepted = false;
+    const int semitones = QInputDialog::getInt(
+        this, tr("Transpose"), tr("Semitones:"), 0, -24, 24, 1, &accepted);
+
+    if (accepted && semitones != 0)
+        pushBulkEdit(BulkEdit::transpose(semitones), tr("Transpose"));
+}
+
+void PowerTabEditor::retunePlayer()
+{
+    ScoreLocation &location = getLocation();
+    Score &score = location.getScore();
+
+    const PlayerChange *currentPlayers = ScoreUtils::getCurrentPlayers(
+        score, location.getSystemIndex(), location.getPositionIndex());
+    if (!currentPlayers)
+        return;
+
+    const std::vector<ActivePlayer> players =
+        currentPlayers->getActivePlayers(location.getStaffIndex());
+    if (players.empty())
+        return;
+
+    const int playerIndex = players.front().getPlayerNumber();
+    Player player(score.getPlayers()[playerIndex]);
+
+    TuningDialog dialog(this, player.getTuning(), *myTuningDictionary);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    const Tuning tuning = dialog.getTuning();
+    if (tuning.getStringCount() != player.getTuning().getStringCount())
+    {
+        QMessageBox::warning(this, tr("Retune Player"),
+                             tr("The new tuning must have the same number of "
+                                "strings as the player's current tuning."));
+        return;
+    }
+
+    std::unique_ptr<BulkEdit> command(new BulkEdit(
+        score, BulkEdit::retune(playerIndex, tuning), tr("Retune Player")));
+    if (!checkBlockedPositions(*command, tr("Retune Player")))
+        return;
+
+    // Refret the notes while the old tuning is still in place, and then
+    // update the player. The score is only redrawn once for both.
+    myUndoManager->beginMacro(tr("Retune Player"),
+                              UndoManager::AFFECTS_ALL_SYSTEMS,
+                              UndoManager::AFFECTS_ALL_SYSTEMS);
+    myUndoManager->push(command.release());
+
+    player.setTuning(tuning);
+    myUndoManager->push(new EditPlayer(score, playerIndex, player));
+    myUndoManager->endMacro(UndoManager::AFFECTS_ALL_SYSTEMS,
+                            UndoManager::AFFECTS_ALL_SYSTEMS);
+}
+
+void PowerTabEditor::pushBulkEdit(const BulkEdit::Edit &edit,
+                                  const QString &text)
+{
+    const ScoreLocation &location = getLocation();
+
+    BulkEdit *command =
+        location.hasSelection() ? new BulkEdit(location, edit, text)
+                                : new BulkEdit(location.getScore(), edit, text);
+
+    if (command->getChangeCount() == 0 ||
+        !checkBlockedPositions(*command, text))
+    {
+        delete command;
+        return;
+    }
+
+    myUndoManager->push(command, command->getFirstSystem(),
+                        command->getLastSystem());
+}
+
+bool PowerTabEditor::checkBlockedPositions(const BulkEdit &command,
+                                           const QString &text)
+{
+    const std::vector<BulkEdit::BlockedPosition> &blocked =
+        command.getBlockedPositions();
+    if (blocked.empty())
+        return true;
+
+    // Only list the first few positions.
+    const size_t maxListed = 10;
+    QString locations;
+    for (size_t i = 0; i < std::min(blocked.size(), maxListed); ++i)
+    {
+        locations += tr("System %1, Staff %2, Position %3\n")
+                         .arg(blocked[i].mySystem + 1)
+                         .arg(blocked[i].myStaff + 1)
+                         .arg(blocked[i].myPosition + 1);
+    }
+    if (blocked.size() > maxListed)
+    {
+        locations += tr("(and %1 more)\n")
+                         .arg(static_cast<int>(blocked.size() - maxListed));
+    }
+
+    QMessageBox::warning(
+        this, text,
+        tr("The edit could not be applied, because the natural harmonics at "
+           "the following positions cannot be moved:\n\n%1").arg(locations));
+    return false;
+}
+
 void PowerTabEditor::addDot()
 {
     ScoreLocation &location = getLocation();
@@ -973,8 +1569,10 @@ void PowerTabEditor::editRehearsalSign()
 
     if (barline->hasRehearsalSign())
     {
+        // The following rehearsal signs are relabelled.
         myUndoManager->push(new RemoveRehearsalSign(location),
-                            UndoManager::AFFECTS_ALL_SYSTEMS);
+                            location.getSystemIndex(),
+                            location.getScore().getSystems().size() - 1);
     }
     else
     {
@@ -982,9 +1580,11 @@ void PowerTabEditor::editRehearsalSign()
 
         if (dialog.exec() == QDialog::Accepted)
         {
+            // The following rehearsal signs are relabelled.
             myUndoManager->push(new AddRehearsalSign(location,
                                                      dialog.getDescription()),
-                                UndoManager::AFFECTS_ALL_SYSTEMS);
+                                location.getSystemIndex(),
+                                location.getScore().getSystems().size() - 1);
         }
         else
             myRehearsalSignCommand->setChecked(false);
@@ -1338,7 +1938,15 @@ void PowerTabEditor::editPlayer(int playerIndex, const Player &player,
     ScoreLocation &location = getLocation();
 
     if (!undoable)
+    {
         location.getScore().getPlayers()[playerIndex] = player;
+        myMixer->updatePlayer(playerIndex, player);
+
+        // There isn't an undo command to trigger an update, so send the
+        // change to the MIDI player directly.
+        if (myMidiPlayer)
+            myMidiPlayer->updateScore(copyScoreForPlayback());
+    }
     else
     {
         myUndoManager->push(
@@ -1378,10 +1986,6 @@ void PowerTabEditor::showTuningDictionary()
 
 bool PowerTabEditor::eventFilter(QObject *object, QEvent *event)
 {
-    // Don't handle key presses during playback.
-    if (myIsPlaying)
-        return QMainWindow::eventFilter(object, event);
-
     ScoreArea *scorearea = getScoreArea();
     if (scorearea && event->type() == QEvent::KeyPress)
     {
@@ -1490,6 +2094,20 @@ void PowerTabEditor::createCommands()
                                   QKeySequence::SaveAs, this);
     connect(mySaveAsCommand, SIGNAL(triggered()), this, SLOT(saveFileAs()));
 
+    myCompareCommand = new Command(tr("Compare With..."), "File.Compare",
+                                   QKeySequence(), this);
+    connect(myCompareCommand, SIGNAL(triggered()), this,
+            SLOT(compareWithFile()));
+
+    myMergeCommand = new Command(tr("Merge Changes..."), "File.Merge",
+                                 QKeySequence(), this);
+    connect(myMergeCommand, SIGNAL(triggered()), this, SLOT(mergeChanges()));
+
+    myTabLibraryCommand = new Command(tr("Tab &Library..."), "File.TabLibrary",
+                                      QKeySequence(), this);
+    connect(myTabLibraryCommand, SIGNAL(triggered()), this,
+            SLOT(openTabLibrary()));
+
     myEditShortcutsCommand = new Command(tr("Customize Shortcuts..."),
                                          "File.CustomizeShortcuts",
                                          QKeySequence(), this);
@@ -1539,6 +2157,12 @@ void PowerTabEditor::createCommands()
     connect(myPlayPauseCommand, SIGNAL(triggered()), this,
             SLOT(startStopPlayback()));
 
+    myPlayLoopCommand = new Command(tr("Loop Selection"),
+                                    "Playback.LoopSelection",
+                                    Qt::SHIFT + Qt::Key_Space, this);
+    connect(myPlayLoopCommand, &QAction::triggered, this,
+            &PowerTabEditor::startStopLoopPlayback);
+
     myRewindCommand = new Command(tr("Rewind"), "Playback.Rewind",
                                   Qt::CTRL + Qt::Key_Left, this);
     connect(myRewindCommand, &QAction::triggered, this,
@@ -1675,6 +2299,17 @@ void PowerTabEditor::createCommands()
     connect(myGoToRehearsalSignCommand, SIGNAL(triggered()), this,
             SLOT(gotoRehearsalSign()));
 
+    myFindPhraseCommand = new Command(tr("Find Phrase"), "Position.FindPhrase",
+                                      QKeySequence::Find, this);
+    connect(myFindPhraseCommand, SIGNAL(triggered()), this,
+            SLOT(findPhrase()));
+
+    myFindNextPhraseCommand = new Command(tr("Find Next Phrase"),
+                                          "Position.FindNextPhrase",
+                                          QKeySequence::FindNext, this);
+    connect(myFindNextPhraseCommand, SIGNAL(triggered()), this,
+            SLOT(findNextPhrase()));
+
     // Text-related actions.
     myChordNameCommand = new Command(tr("Chord Name..."), "Text.ChordName",
                                      Qt::Key_C, this);
@@ -1855,6 +2490,61 @@ void PowerTabEditor::createCommands()
         editIrregularGrouping(false);
     });
 
+    myTransposeCommand = new Command(tr("Transpose..."), "Notes.Transpose",
+                                     QKeySequence(), this);
+    connect(myTransposeCommand, SIGNAL(triggered()), this, SLOT(transpose()));
+
+    myRetunePlayerCommand = new Command(tr("Retune Player..."),
+                                        "Notes.RetunePlayer", QKeySequence(),
+                                        this);
+    connect(myRetunePlayerCommand, SIGNAL(triggered()), this,
+            SLOT(retunePlayer()));
+
+    myDoubleDurationsCommand = new Command(tr("Double Durations"),
+                                           "Notes.DoubleDurations",
+                                           QKeySequence(), this);
+    connect(myDoubleDurationsCommand, &QAction::triggered, [=]() {
+        pushBulkEdit(BulkEdit::scaleDurations(2), tr("Double Durations"));
+    });
+
+    myHalveDurationsCommand = new Command(tr("Halve Durations"),
+                                          "Notes.HalveDurations",
+                                          QKeySequence(), this);
+    connect(myHalveDurationsCommand, &QAction::triggered, [=]() {
+        pushBulkEdit(BulkEdit::scaleDurations(0.5), tr("Halve Durations"));
+    });
+
+    myClearNotePropertiesCommand = new Command(tr("Clear Note Properties"),
+                                               "Notes.ClearNoteProperties",
+                                               QKeySequence(), this);
+    connect(myClearNotePropertiesCommand, &QAction::triggered, [=]() {
+        // Only clear the articulations and playing techniques. Properties
+        // such as rests, dots, ties, harmonics, and octave markers change
+        // the notes themselves and are left alone.
+        const std::vector<Position::SimpleProperty> positionProperties = {
+            Position::Vibrato,        Position::WideVibrato,
+            Position::ArpeggioUp,     Position::ArpeggioDown,
+            Position::PickStrokeUp,   Position::PickStrokeDown,
+            Position::Staccato,       Position::Marcato,
+            Position::Sforzando,      Position::TremoloPicking,
+            Position::PalmMuting,     Position::Tap,
+            Position::LetRing,        Position::Fermata
+        };
+
+        const std::vector<Note::SimpleProperty> noteProperties = {
+            Note::Muted,              Note::HammerOnOrPullOff,
+            Note::HammerOnFromNowhere, Note::PullOffToNowhere,
+            Note::GhostNote,          Note::SlideIntoFromBelow,
+            Note::SlideIntoFromAbove, Note::ShiftSlide,
+            Note::LegatoSlide,        Note::SlideOutOfDownwards,
+            Note::SlideOutOfUpwards
+        };
+
+        pushBulkEdit(BulkEdit::clearProperties(positionProperties,
+                                               noteProperties),
+                     tr("Clear Note Properties"));
+    });
+
     // Rest Actions.
     myRestDurationGroup = new QActionGroup(this);
 
@@ -2103,6 +2793,38 @@ void PowerTabEditor::createCommands()
     myInstrumentDockWidgetCommand =
         createCommandWrapper(myInstrumentDockWidget->toggleViewAction(),
                              "Window.Instruments", QKeySequence(), this);
+
+    myShowFrameRateCommand = new Command(tr("Show Frame Rate"),
+                                         "Window.ShowFrameRate",
+                                         QKeySequence(), this);
+    myShowFrameRateCommand->setCheckable(true);
+    connect(myShowFrameRateCommand, &QAction::toggled, [=](bool show) {
+        for (int i = 0; i < myTabWidget->count(); ++i)
+        {
+            static_cast<ScoreArea *>(myTabWidget->widget(i))
+                ->setShowFrameRate(show);
+        }
+    });
+
+    myRecordTraceCommand = new Command(tr("Record Performance Trace"),
+                                       "Window.RecordTrace", QKeySequence(),
+                                       this);
+    myRecordTraceCommand->setCheckable(true);
+    myRecordTraceCommand->setChecked(Tracing::isEnabled());
+    connect(myRecordTraceCommand, &QAction::toggled,
+            [=](bool enabled) { Tracing::setEnabled(enabled); });
+
+    myExportTraceCommand = new Command(tr("Export Performance Trace..."),
+                                       "Window.ExportTrace", QKeySequence(),
+                                       this);
+    connect(myExportTraceCommand, SIGNAL(triggered()), this,
+            SLOT(exportTrace()));
+
+    myMemoryReportCommand = new Command(tr("Memory Report..."),
+                                        "Window.MemoryReport", QKeySequence(),
+                                        this);
+    connect(myMemoryReportCommand, SIGNAL(triggered()), this,
+            SLOT(showMemoryReport()));
 }
 
 void PowerTabEditor::createMixer()
@@ -2228,6 +2950,10 @@ void PowerTabEditor::createMenus()
     myFileMenu->addSeparator();
     myFileMenu->addAction(mySaveAsCommand);
     myFileMenu->addSeparator();
+    myFileMenu->addAction(myCompareCommand);
+    myFileMenu->addAction(myMergeCommand);
+    myFileMenu->addSeparator();
+    myFileMenu->addAction(myTabLibraryCommand);
     myRecentFilesMenu = myFileMenu->addMenu(tr("Recent Files"));
     myFileMenu->addSeparator();
     myFileMenu->addAction(myEditShortcutsCommand);
@@ -2248,6 +2974,7 @@ void PowerTabEditor::createMenus()
     // Playback Menu.
     myPlaybackMenu = menuBar()->addMenu(tr("Play&back"));
     myPlaybackMenu->addAction(myPlayPauseCommand);
+    myPlaybackMenu->addAction(myPlayLoopCommand);
     myPlaybackMenu->addAction(myRewindCommand);
 
     // Position Menu.
@@ -2284,6 +3011,9 @@ void PowerTabEditor::createMenus()
     myPositionMenu->addSeparator();
     myPositionMenu->addAction(myGoToBarlineCommand);
     myPositionMenu->addAction(myGoToRehearsalSignCommand);
+    myPositionMenu->addSeparator();
+    myPositionMenu->addAction(myFindPhraseCommand);
+    myPositionMenu->addAction(myFindNextPhraseCommand);
 
     // Text Menu.
     myTextMenu = menuBar()->addMenu(tr("&Text"));
@@ -2344,6 +3074,15 @@ void PowerTabEditor::createMenus()
     myNotesMenu->addAction(myTripletCommand);
     myNotesMenu->addAction(myIrregularGroupingCommand);
 
+    myBulkEditMenu = myNotesMenu->addMenu(tr("Bulk Edit"));
+    myBulkEditMenu->addAction(myTransposeCommand);
+    myBulkEditMenu->addAction(myRetunePlayerCommand);
+    myBulkEditMenu->addSeparator();
+    myBulkEditMenu->addAction(myDoubleDurationsCommand);
+    myBulkEditMenu->addAction(myHalveDurationsCommand);
+    myBulkEditMenu->addSeparator();
+    myBulkEditMenu->addAction(myClearNotePropertiesCommand);
+
     // Rests Menu.
     myRestsMenu = menuBar()->addMenu(tr("Rests"));
     myRestsMenu->addAction(myWholeRestCommand);
@@ -2428,6 +3167,11 @@ void PowerTabEditor::createMenus()
     myWindowMenu->addSeparator();
     myWindowMenu->addAction(myMixerDockWidgetCommand);
     myWindowMenu->addAction(myInstrumentDockWidgetCommand);
+    myWindowMenu->addSeparator();
+    myWindowMenu->addAction(myShowFrameRateCommand);
+    myWindowMenu->addAction(myRecordTraceCommand);
+    myWindowMenu->addAction(myExportTraceCommand);
+    myWindowMenu->addAction(myMemoryReportCommand);
 }
 
 void PowerTabEditor::createTabArea()
@@ -2470,8 +3214,7 @@ void PowerTabEditor::setPreviousDirectory(const QString &fileName)
 
 void PowerTabEditor::setupNewTab()
 {
-    boost::timer timer;
-    qDebug() << "Tab creation started ...";
+    PTE_TRACE_SCOPE("PowerTabEditor::setupNewTab");
 
     Q_ASSERT(myDocumentManager->hasOpenDocuments());
     Document &doc = myDocumentManager->getCurrentDocument();
@@ -2483,6 +3226,7 @@ void PowerTabEditor::setupNewTab()
 
     auto scorearea = new ScoreArea(this);
     scorearea->renderDocument(doc, Staff::GuitarView);
+    scorearea->setShowFrameRate(myShowFrameRateCommand->isChecked());
     scorearea->installEventFilter(this);
 
     // Connect the signals for mouse clicks on time signatures, barlines, etc.
@@ -2537,8 +3281,6 @@ void PowerTabEditor::setupNewTab()
     enableEditing(true);
     updateCommands();
     scorearea->setFocus();
-
-    qDebug() << "Tab opened in" << timer.elapsed() << "seconds";
 }
 
 namespace
@@ -2560,13 +3302,12 @@ inline void updateNoteProperty(Command *command, const Note *note,
 
 void PowerTabEditor::updateCommands()
 {
-    // Disable editing during playback.
-    if (myIsPlaying)
-    {
-        enableEditing(false);
-        myPlayPauseCommand->setEnabled(true);
-        return;
-    }
+    // The score can be edited during playback since the MIDI player has its
+    // own copy, but playback is tied to the current document.
+    myCloseTabCommand->setEnabled(!myIsPlaying);
+    myNextTabCommand->setEnabled(!myIsPlaying);
+    myPrevTabCommand->setEnabled(!myIsPlaying);
+    myTabWidget->tabBar()->setEnabled(!myIsPlaying);
 
     ScoreLocation location = getLocation();
     const Score &score = location.getScore();
@@ -2753,7 +3494,7 @@ void PowerTabEditor::enableEditing(bool enable)
     QList<QMenu *> menuList;
     menuList << myPositionMenu << myPositionSectionMenu << myPositionStaffMenu
              << myTextMenu << mySectionMenu << myLineSpacingMenu << myNotesMenu
-             << myOctaveMenu << myRestsMenu << myMusicSymbolsMenu
+             << myOctaveMenu << myBulkEditMenu << myRestsMenu << myMusicSymbolsMenu
              << myTabSymbolsMenu << myPlaybackMenu << myEditMenu;
 
     for (QMenu *menu : menuList)
@@ -2764,6 +3505,8 @@ void PowerTabEditor::enableEditing(bool enable)
 
     myCloseTabCommand->setEnabled(enable);
     mySaveAsCommand->setEnabled(enable);
+    myCompareCommand->setEnabled(enable);
+    myMergeCommand->setEnabled(enable);
     myAddPlayerCommand->setEnabled(enable);
     myAddInstrumentCommand->setEnabled(enable);
     myPlayerChangeCommand->setEnabled(enable);
@@ -2820,8 +3563,17 @@ void PowerTabEditor::updateActiveVoice(int voice)
 
 void PowerTabEditor::updateLocationLabel()
 {
+    const ScoreLocation &location = getCaret().getLocation();
+    const int bar = getBarIndex().findBar(SystemLocation(
+        location.getSystemIndex(), location.getPositionIndex()));
+
     myPlaybackWidget->updateLocationLabel(
-        boost::lexical_cast<std::string>(getCaret().getLocation()));
+        tr("Bar: %1, System: %2, Staff: %3, Position: %4, String: %5")
+            .arg(bar + 1)
+            .arg(location.getSystemIndex() + 1)
+            .arg(location.getStaffIndex() + 1)
+            .arg(location.getPositionIndex() + 1)
+            .arg(location.getString() + 1));
 }
 
 void PowerTabEditor::editKeySignature(const ScoreLocation &keyLocation)
@@ -2836,8 +3588,9 @@ void PowerTabEditor::editKeySignature(const ScoreLocation &keyLocation)
     KeySignatureDialog dialog(this, barline->getKeySignature());
     if (dialog.exec() == QDialog::Accepted)
     {
-        myUndoManager->push(new EditKeySignature(location, dialog.getNewKey()),
-                            UndoManager::AFFECTS_ALL_SYSTEMS);
+        auto action = new EditKeySignature(location, dialog.getNewKey());
+        myUndoManager->push(action, location.getSystemIndex(),
+                            action->getLastAffectedSystem());
     }
 }
 
@@ -2853,9 +3606,10 @@ void PowerTabEditor::editTimeSignature(const ScoreLocation &timeLocation)
     TimeSignatureDialog dialog(this, barline->getTimeSignature());
     if (dialog.exec() == QDialog::Accepted)
     {
-        myUndoManager->push(new EditTimeSignature(location,
-                                                  dialog.getTimeSignature()),
-                            UndoManager::AFFECTS_ALL_SYSTEMS);
+        auto action =
+            new EditTimeSignature(location, dialog.getTimeSignature());
+        myUndoManager->push(action, location.getSystemIndex(),
+                            action->getLastAffectedSystem());
     }
 }
 
@@ -2991,8 +3745,9 @@ void PowerTabEditor::insertStaff(int index)
 
 void PowerTabEditor::adjustLineSpacing(int amount)
 {
-    myUndoManager->push(new AdjustLineSpacing(getLocation().getScore(), amount),
-                        UndoManager::AFFECTS_ALL_SYSTEMS);
+    Score &score = getLocation().getScore();
+    myUndoManager->push(new AdjustLineSpacing(score, amount), 0,
+                        score.getSystems().size() - 1);
 }
 
 ScoreArea *PowerTabEditor::getScoreArea()
@@ -3005,6 +3760,28 @@ Caret &PowerTabEditor::getCaret()
     return myDocumentManager->getCurrentDocument().getCaret();
 }
 
+const BarIndex &PowerTabEditor::getBarIndex()
+{
+    if (!myBarIndex)
+    {
+        myBarIndex.reset(new BarIndex(
+            myDocumentManager->getCurrentDocument().getScore()));
+    }
+
+    return *myBarIndex;
+}
+
+const PhraseIndex &PowerTabEditor::getPhraseIndex()
+{
+    if (!myPhraseIndex)
+    {
+        myPhraseIndex.reset(new PhraseIndex(
+            myDocumentManager->getCurrentDocument().getScore()));
+    }
+
+    return *myPhraseIndex;
+}
+
 ScoreLocation &PowerTabEditor::getLocation()
 {
     return getCaret().getLocation();
@@ -20,13 +20,18 @@
 
 #include <QMainWindow>
 
+#include <actions/bulkedit.h>
+#include <app/playbackscorecache.h>
 #include <app/pubsub/instrumentpubsub.h>
 #include <app/pubsub/playerpubsub.h>
 #include <memory>
 #include <score/position.h>
+#include <score/utils/phraseindex.h>
 #include <string>
 #include <vector>
 
+class AutoSave;
+class BarIndex;
 class Caret;
 class Command;
 class DocumentManager;
@@ -37,8 +42,10 @@ class Mixer;
 class PlaybackWidget;
 class QActionGroup;
 class RecentFiles;
+class Score;
 class ScoreArea;
 class ScoreLocation;
+class TabLibrary;
 class SettingsPubSub;
 class TuningDictionary;
 class UndoManager;
@@ -65,6 +72,9 @@ private slots:
     /// Handle when the active tab is changed.
     void switchTab(int index);
 
+    /// Releases the memory used by tabs that haven't been viewed recently.
+    void hibernateInactiveTabs();
+
     /// Closes the specified tab.
     /// @return True if the document was closed successfully.
     bool closeTab(int index);
@@ -77,10 +87,31 @@ private slots:
     /// @return True if the file was successfully saved.
     bool saveFileAs();
 
+    /// Lists the differences between the current document and another file,
+    /// and optionally applies them.
+    void compareWithFile();
+    /// Merges the changes from another copy of the current document, given
+    /// the version that both copies were edited from.
+    void mergeChanges();
+
+    /// Opens the tab library, which allows the user to search for and open
+    /// files from their collection.
+    void openTabLibrary();
+
+    /// Writes the recorded performance trace to a JSON file, which can be
+    /// viewed at chrome://tracing.
+    void exportTrace();
+    /// Displays the memory used by each document's score, undo history, and
+    /// rendered items.
+    void showMemoryReport();
+
     /// Update the titlebar to show whether the current document has been
     /// modified.
     void updateModified(bool);
 
+    /// Offers to restore any documents that were recovered after a crash.
+    void restoreRecoveredDocuments();
+
     /// Cycles through the tabs in the tab bar.
     /// @param offset Direction and number of tabs to move by
     /// (i.e. -1 moves back one tab).
@@ -104,9 +135,12 @@ private slots:
 
     /// Starts or stops playback of the score.
     void startStopPlayback();
+    /// Starts playing the selected positions (or the current bar) in a loop,
+    /// or stops playback.
+    void startStopLoopPlayback();
 
-    /// Redraws only the given system.
-    void redrawSystem(int);
+    /// Redraws only the given range of systems.
+    void redrawSystems(int firstSystem, int lastSystem);
     /// Redraws the entire score.
     void redrawScore();
 
@@ -154,6 +188,10 @@ private slots:
     void gotoBarline();
     /// Moves the caret to a specific rehearsal sign.
     void gotoRehearsalSign();
+    /// Searches for other occurrences of the selected phrase, in any key.
+    void findPhrase();
+    /// Moves the caret to the next occurrence of the phrase.
+    void findNextPhrase();
 
     /// Adds or removes a chord name at the current position.
     void editChordName();
@@ -178,6 +216,12 @@ private slots:
     void updateNoteDuration(Position::DurationType duration);
     /// Increase or decrease the current note duration.
     void changeNoteDuration(bool increase);
+    /// Transposes the selected notes, or the entire score if there is no
+    /// selection.
+    void transpose();
+    /// Changes the tuning of the current player, and refrets their notes so
+    /// that they keep the same pitch.
+    void retunePlayer();
     /// Adds a dot to the current position's duration.
     void addDot();
     /// Removes a dot from the current position's duration.
@@ -300,6 +344,9 @@ private:
     void updateCommands();
     /// Enables or disables all editing commands.
     void enableEditing(bool enable);
+    /// Returns a snapshot of the current score for the MIDI player, which
+    /// plays it from another thread.
+    std::shared_ptr<const Score> copyScoreForPlayback();
 
     /// Moves the caret back to the start, and restarts playback if necessary.
     void rewindPlaybackToStart();
@@ -330,6 +377,8 @@ private:
     void insertSystem(int index);
     /// Helper function to insert a staff at the given index in a system.
     void insertStaff(int index);
+    /// Starts or stops playback, optionally looping over the selection.
+    void togglePlayback(bool loop);
     /// Increases or decreases the line spacing by the given amount.
     void adjustLineSpacing(int amount);
 
@@ -339,12 +388,40 @@ private:
     Caret &getCaret();
     /// Returns the location of the caret within the active document.
     ScoreLocation &getLocation();
+    /// Prompts for a file and imports it into an empty score.
+    /// @return True if the file was imported successfully.
+    bool importScore(const QString &title, Score &score);
+    /// Applies an edit to the selected notes, or to the entire score if
+    /// there is no selection.
+    void pushBulkEdit(const BulkEdit::Edit &edit, const QString &text);
+    /// If some positions could not be edited, tells the user where they are.
+    /// @return False if the edit should not be applied.
+    bool checkBlockedPositions(const BulkEdit &command, const QString &text);
+    /// Returns the bar index for the active document, building it if
+    /// necessary.
+    const BarIndex &getBarIndex();
+    /// Returns the phrase index for the active document, building it if
+    /// necessary.
+    const PhraseIndex &getPhraseIndex();
 
     std::unique_ptr<DocumentManager> myDocumentManager;
     std::unique_ptr<FileFormatManager> myFileFormatManager;
     std::unique_ptr<UndoManager> myUndoManager;
     std::unique_ptr<MidiPlayer> myMidiPlayer;
+    /// Snapshots of the current score for the MIDI player, which are updated
+    /// incrementally as systems are edited.
+    PlaybackScoreCache myPlaybackScoreCache;
+    /// Updated as systems are edited, and rebuilt after a full redraw.
+    std::unique_ptr<BarIndex> myBarIndex;
+    /// Updated incrementally as systems are edited.
+    std::unique_ptr<PhraseIndex> myPhraseIndex;
+    /// The phrase that was last searched for.
+    std::vector<PhraseIndex::Event> myPhrase;
     std::unique_ptr<TuningDictionary> myTuningDictionary;
+    std::unique_ptr<AutoSave> myAutoSave;
+    /// Index of the user's files, which is loaded the first time the library
+    /// is opened.
+    std::unique_ptr<TabLibrary> myTabLibrary;
     std::shared_ptr<SettingsPubSub> mySettingsPubSub;
     PlayerEditPubSub myPlayerEditPubSub;
     PlayerRemovePubSub myPlayerRemovePubSub;
@@ -370,6 +447,9 @@ private:
     Command *myOpenFileCommand;
     Command *myCloseTabCommand;
     Command *mySaveAsCommand;
+    Command *myCompareCommand;
+    Command *myMergeCommand;
+    Command *myTabLibraryCommand;
     QMenu *myRecentFilesMenu;
     Command *myEditShortcutsCommand;
     Command *myEditPreferencesCommand;
@@ -385,6 +465,7 @@ private:
 
     QMenu *myPlaybackMenu;
     Command *myPlayPauseCommand;
+    Command *myPlayLoopCommand;
     Command *myRewindCommand;
 
     QMenu *myPositionMenu;
@@ -410,6 +491,8 @@ private:
     Command *myRemovePositionCommand;
     Command *myGoToBarlineCommand;
     Command *myGoToRehearsalSignCommand;
+    Command *myFindPhraseCommand;
+    Command *myFindNextPhraseCommand;
 
     QMenu *myTextMenu;
     Command *myChordNameCommand;
@@ -458,6 +541,12 @@ private:
     Command *myOctave15mbCommand;
     Command *myTripletCommand;
     Command *myIrregularGroupingCommand;
+    QMenu *myBulkEditMenu;
+    Command *myTransposeCommand;
+    Command *myRetunePlayerCommand;
+    Command *myDoubleDurationsCommand;
+    Command *myHalveDurationsCommand;
+    Command *myClearNotePropertiesCommand;
 
     QMenu *myRestsMenu;
     /// Used to ensure that only one duration option is checked at a time.
@@ -528,6 +617,10 @@ private:
     Command *myPrevTabCommand;
     Command *myMixerDockWidgetCommand;
     Command *myInstrumentDockWidgetCommand;
+    Command *myShowFrameRateCommand;
+    Command *myRecordTraceCommand;
+    Command *myExportTraceCommand;
+    Command *myMemoryReportCommand;
 
 #if 0
 
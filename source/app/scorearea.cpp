@@ -20,38 +20,76 @@
 #include <app/documentmanager.h>
 #include <app/pubsub/scorelocationpubsub.h>
 #include <app/pubsub/staffpubsub.h>
-#include <boost/timer.hpp>
+#include <algorithm>
 #include <painters/caretpainter.h>
+#include <painters/glyphbatchpainter.h>
+#include <painters/rastercacheeffect.h>
 #include <painters/systemrenderer.h>
-#include <QDebug>
 #include <QGraphicsItem>
+#include <QPainter>
+#include <QPixmapCache>
 #include <QProgressDialog>
 #include <score/score.h>
+#include <util/tracing.h>
 
 static const double SYSTEM_SPACING = 50;
+/// Minimum size (in KB) of the pixmap cache, which holds the rasterized
+/// systems. The default limit only has room for a few systems.
+static const int MIN_PIXMAP_CACHE_SIZE = 64 * 1024;
+/// Weight given to the newest frame when averaging the frame time.
+static const double FRAME_TIME_WEIGHT = 0.1;
+
+/// Rasterizes the system (when it is first painted, or after it changes) so
+/// that scrolling only needs to draw a single pixmap per system. The caret and
+/// selection are drawn on top by the caret painter, so moving them doesn't
+/// invalidate the cached system.
+static void cacheSystem(QGraphicsItem *system)
+{
+    system->setGraphicsEffect(new RasterCacheEffect(system));
+}
 
 ScoreArea::ScoreArea(QWidget *parent)
     : QGraphicsView(parent),
       myViewType(Staff::GuitarView),
       myCaretPainter(nullptr),
+      myIsHibernating(false),
+      myShowFrameRate(false),
+      myFrameTime(0),
       myKeySignatureClicked(std::make_shared<ScoreLocationPubSub>()),
       myTimeSignatureClicked(std::make_shared<ScoreLocationPubSub>()),
       myBarlineClicked(std::make_shared<ScoreLocationPubSub>()),
       myClefClicked(std::make_shared<StaffPubSub>())
 {
     setScene(&myScene);
+
+    if (QPixmapCache::cacheLimit() < MIN_PIXMAP_CACHE_SIZE)
+        QPixmapCache::setCacheLimit(MIN_PIXMAP_CACHE_SIZE);
+}
+
+ScoreArea::~ScoreArea()
+{
 }
 
 void ScoreArea::renderDocument(const Document &document, Staff::ViewType view)
 {
+    PTE_TRACE_SCOPE("ScoreArea::renderDocument");
+
     myScene.clear();
     myRenderedSystems.clear();
-    myDocument = document;
-    myViewType = view;
+    myIsHibernating = false;
 
     const Score &score = document.getScore();
 
-    boost::timer timer;
+    // A full redraw may be due to changes that aren't detected when reusing
+    // layouts (e.g. a different tuning), so only the fonts are kept.
+    if (myRenderer && myDocument && &*myDocument == &document)
+        myRenderer->clearCachedLayouts();
+    else
+        myRenderer.reset(new SystemRenderer(this, score));
+
+    myDocument = document;
+    myViewType = view;
+
     QProgressDialog progressDialog(tr("Rendering ..."), "", 0,
                                    score.getSystems().size());
     progressDialog.setCancelButton(nullptr);
@@ -70,10 +108,10 @@ void ScoreArea::renderDocument(const Document &document, Staff::ViewType view)
     for (const System &system : score.getSystems())
     {
         progressDialog.setValue(i);
-        SystemRenderer render(this, score);
 
-        QGraphicsItem *renderedSystem = render(system, i, myViewType);
+        QGraphicsItem *renderedSystem = (*myRenderer)(system, i, myViewType);
         renderedSystem->setPos(0, height);
+        cacheSystem(renderedSystem);
         myRenderedSystems << renderedSystem;
         myScene.addItem(renderedSystem);
         height += renderedSystem->boundingRect().height() + SYSTEM_SPACING;
@@ -86,36 +124,54 @@ void ScoreArea::renderDocument(const Document &document, Staff::ViewType view)
 
     progressDialog.setValue(i);
 
-    qDebug() << "Score rendered in" << timer.elapsed() << "seconds";
-    qDebug() << "Rendered " << myScene.items().size() << "items";
+    PTE_TRACE_COUNTER("ScoreArea::renderedItems", myScene.items().size());
 }
 
-void ScoreArea::redrawSystem(int index)
+void ScoreArea::redrawSystems(int firstSystem, int lastSystem)
 {
-    // Delete and remove the system from the scene.
-    delete myRenderedSystems.takeAt(index);
-
     const Score &score = myDocument->getScore();
-    SystemRenderer render(this, score);
-    QGraphicsItem *newSystem = render(score.getSystems()[index], index,
-                                        myViewType);
+    lastSystem = std::min(lastSystem, myRenderedSystems.size() - 1);
 
-    double height = 0;
-    if (index > 0)
+    bool heightChanged = false;
+    for (int index = firstSystem; index <= lastSystem; ++index)
     {
-        height = myRenderedSystems.at(index - 1)->sceneBoundingRect().bottom() +
-                SYSTEM_SPACING;
-    }
+        // If only the contents of some staves changed, just replace those
+        // staves. The system's height can't have changed.
+        if (myRenderer->updateStaves(myRenderedSystems.at(index),
+                                     score.getSystems()[index], index))
+        {
+            // Regenerate the cached pixmap.
+            myRenderedSystems.at(index)->update();
+            continue;
+        }
+
+        // Delete and remove the system from the scene.
+        const double prevHeight =
+            myRenderedSystems.at(index)->boundingRect().height();
+        delete myRenderedSystems.takeAt(index);
+
+        QGraphicsItem *newSystem = (*myRenderer)(score.getSystems()[index],
+                                                 index, myViewType);
+        cacheSystem(newSystem);
+        myScene.addItem(newSystem);
+        myRenderedSystems.insert(index, newSystem);
 
-    newSystem->setPos(0, height);
-    height += newSystem->boundingRect().height() + SYSTEM_SPACING;
-    myCaretPainter->setSystemRect(index, newSystem->sceneBoundingRect());
+        if (newSystem->boundingRect().height() != prevHeight)
+            heightChanged = true;
+    }
 
-    myScene.addItem(newSystem);
-    myRenderedSystems.insert(index, newSystem);
+    // Position the new systems, and shift the following systems if any of the
+    // heights changed.
+    double height = 0;
+    if (firstSystem > 0)
+    {
+        height = myRenderedSystems.at(firstSystem - 1)
+                     ->sceneBoundingRect().bottom() + SYSTEM_SPACING;
+    }
 
-    // Shift the following systems.
-    for (int i = index + 1; i < myRenderedSystems.size(); ++i)
+    const int lastMoved = heightChanged ? myRenderedSystems.size() - 1
+                                        : lastSystem;
+    for (int i = firstSystem; i <= lastMoved; ++i)
     {
         QGraphicsItem *system = myRenderedSystems[i];
         system->setPos(0, height);
@@ -124,6 +180,51 @@ void ScoreArea::redrawSystem(int index)
     }
 }
 
+void ScoreArea::hibernate()
+{
+    myScene.clear();
+    myRenderedSystems.clear();
+    myCaretPainter = nullptr;
+    myRenderer.reset();
+    myIsHibernating = true;
+}
+
+bool ScoreArea::isHibernating() const
+{
+    return myIsHibernating;
+}
+
+int ScoreArea::getItemCount() const
+{
+    return myScene.items().size();
+}
+
+size_t ScoreArea::getGlyphMemoryUsage() const
+{
+    size_t bytes = 0;
+    for (const QGraphicsItem *item : myScene.items())
+    {
+        auto glyphs = dynamic_cast<const GlyphBatchPainter *>(item);
+        if (glyphs)
+            bytes += glyphs->getMemoryUsage();
+    }
+
+    return bytes;
+}
+
+void ScoreArea::setActive(bool active)
+{
+    if (active)
+        myInactiveTimer.invalidate();
+    else if (!myInactiveTimer.isValid())
+        myInactiveTimer.start();
+}
+
+qint64 ScoreArea::getInactiveTime() const
+{
+    return myInactiveTimer.isValid() ? myInactiveTimer.elapsed() : 0;
+}
+
 std::shared_ptr<ScoreLocationPubSub> ScoreArea::getKeySignaturePubSub() const
 {
     return myKeySignatureClicked;
@@ -149,6 +250,58 @@ std::shared_ptr<StaffPubSub> ScoreArea::getClefPubSub() const
     return myClefClicked;
 }
 
+void ScoreArea::setShowFrameRate(bool show)
+{
+    myShowFrameRate = show;
+    // Scrolling normally only repaints the newly exposed area, which would
+    // leave copies of the readout behind. Repainting the whole viewport also
+    // gives the worst case frame time.
+    setViewportUpdateMode(show ? QGraphicsView::FullViewportUpdate
+                               : QGraphicsView::MinimalViewportUpdate);
+    viewport()->update();
+}
+
+void ScoreArea::paintEvent(QPaintEvent *event)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QGraphicsView::paintEvent(event);
+
+    const double elapsed = timer.nsecsElapsed() / 1.0e6;
+    myFrameTime = (myFrameTime == 0)
+                      ? elapsed
+                      : FRAME_TIME_WEIGHT * elapsed +
+                            (1 - FRAME_TIME_WEIGHT) * myFrameTime;
+}
+
+void ScoreArea::drawForeground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsView::drawForeground(painter, rect);
+
+    if (!myShowFrameRate)
+        return;
+
+    // The frame time is from the previous paint event, since this one is
+    // still in progress.
+    const QString text =
+        QString("%1 ms (%2 FPS)")
+            .arg(myFrameTime, 0, 'f', 2)
+            .arg(myFrameTime > 0 ? 1000.0 / myFrameTime : 0.0, 0, 'f', 0);
+
+    // Draw in viewport coordinates, so that the text doesn't scroll.
+    painter->save();
+    painter->resetTransform();
+    const QRect textRect = painter->fontMetrics().boundingRect(text).adjusted(
+        -4, -2, 4, 2);
+    const QRect box(viewport()->width() - textRect.width() - 4, 4,
+                    textRect.width(), textRect.height());
+    painter->fillRect(box, QColor(255, 255, 255, 200));
+    painter->setPen(Qt::black);
+    painter->drawText(box, Qt::AlignCenter, text);
+    painter->restore();
+}
+
 void ScoreArea::adjustScroll()
 {
     ensureVisible(myCaretPainter->sceneBoundingRect(), 0, 100);
@@ -20,6 +20,7 @@
 
 #include <boost/optional.hpp>
 #include <memory>
+#include <QElapsedTimer>
 #include <QGraphicsView>
 #include <QGraphicsScene>
 #include <score/staff.h>
@@ -28,18 +29,32 @@ class CaretPainter;
 class Document;
 class ScoreLocationPubSub;
 class StaffPubSub;
+class SystemRenderer;
 
 /// The visual display of the score.
 class ScoreArea : public QGraphicsView
 {
 public:
     explicit ScoreArea(QWidget *parent);
+    ~ScoreArea();
 
     void renderDocument(const Document &document, Staff::ViewType view);
 
-    /// Redraws the specified system, and shifts the following systems as
-    /// necessary.
-    void redrawSystem(int index);
+    /// Releases the rendered systems while the score isn't visible. The
+    /// score must be rendered again with renderDocument() before it is
+    /// displayed.
+    void hibernate();
+    bool isHibernating() const;
+
+    /// Records whether this is the active tab.
+    void setActive(bool active);
+    /// Returns the time (in milliseconds) since the tab was last active, or
+    /// zero if it is the active tab.
+    qint64 getInactiveTime() const;
+
+    /// Redraws the specified range of systems, and shifts the following
+    /// systems as necessary.
+    void redrawSystems(int firstSystem, int lastSystem);
 
     std::shared_ptr<ScoreLocationPubSub> getKeySignaturePubSub() const;
     std::shared_ptr<ScoreLocationPubSub> getTimeSignaturePubSub() const;
@@ -47,6 +62,19 @@ public:
     std::shared_ptr<ScoreLocationPubSub> getSelectionPubSub() const;
     std::shared_ptr<StaffPubSub> getClefPubSub() const;
 
+    /// Returns the number of graphics items in the scene.
+    int getItemCount() const;
+    /// Returns the number of bytes used by the batched text items (fret
+    /// numbers, note heads, etc) in the scene.
+    size_t getGlyphMemoryUsage() const;
+
+    /// Displays the average time taken to repaint the view.
+    void setShowFrameRate(bool show);
+
+protected:
+    virtual void paintEvent(QPaintEvent *event) override;
+    virtual void drawForeground(QPainter *painter, const QRectF &rect) override;
+
 private:
     /// Adjusts the scroll location whenever the caret moves.
     void adjustScroll();
@@ -56,6 +84,15 @@ private:
     Staff::ViewType myViewType;
     QList<QGraphicsItem *> myRenderedSystems;
     CaretPainter *myCaretPainter;
+    /// Reused across redraws, so that the fonts are only created once and
+    /// the layout of unchanged staves can be reused.
+    std::unique_ptr<SystemRenderer> myRenderer;
+    bool myIsHibernating;
+    /// Measures how long the tab has been inactive.
+    QElapsedTimer myInactiveTimer;
+    bool myShowFrameRate;
+    /// Moving average of the time (in milliseconds) taken to paint a frame.
+    double myFrameTime;
 
     std::shared_ptr<ScoreLocationPubSub> myKeySignatureClicked;
     std::shared_ptr<ScoreLocationPubSub> myTimeSignatureClicked;
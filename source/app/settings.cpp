@@ -28,6 +28,17 @@ namespace Settings
     const char *APP_RECENT_FILES = "app/recentFiles";
     const char *APP_WINDOW_STATE = "app/windowState";
 
+    const char *APP_AUTOSAVE_INTERVAL = "app/autosaveInterval";
+    const int APP_AUTOSAVE_INTERVAL_DEFAULT = 60;
+
+    const char *APP_HIBERNATE_TIMEOUT = "app/hibernateTimeout";
+    const int APP_HIBERNATE_TIMEOUT_DEFAULT = 600;
+
+    const char *APP_HIBERNATE_COMPRESS = "app/hibernateCompress";
+    const bool APP_HIBERNATE_COMPRESS_DEFAULT = true;
+
+    const char *APP_TAB_LIBRARY_DIRECTORIES = "app/tabLibraryDirectories";
+
     const char *MIDI_PREFERRED_API = "midi/preferredApi";
     const int MIDI_PREFERRED_API_DEFAULT = 0;
 
@@ -63,6 +74,9 @@ namespace Settings
     const char *MIDI_METRONOME_COUNTIN_VOLUME = "midi/metronomeCountInVolume";
     const int MIDI_METRONOME_COUNTIN_VOLUME_DEFAULT = 127;
 
+    const char *MIDI_LOOP_SPEED_INCREMENT = "midi/loopSpeedIncrement";
+    const int MIDI_LOOP_SPEED_INCREMENT_DEFAULT = 0;
+
     const char *GENERAL_OPEN_IN_NEW_WINDOW = "general/openFilesInNewWindow";
     const bool GENERAL_OPEN_IN_NEW_WINDOW_DEFAULT = false;
 
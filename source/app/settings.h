@@ -29,6 +29,17 @@ namespace Settings
     extern const char *APP_RECENT_FILES;
     extern const char *APP_WINDOW_STATE;
 
+    extern const char *APP_AUTOSAVE_INTERVAL;
+    extern const int APP_AUTOSAVE_INTERVAL_DEFAULT;
+
+    extern const char *APP_HIBERNATE_TIMEOUT;
+    extern const int APP_HIBERNATE_TIMEOUT_DEFAULT;
+
+    extern const char *APP_HIBERNATE_COMPRESS;
+    extern const bool APP_HIBERNATE_COMPRESS_DEFAULT;
+
+    extern const char *APP_TAB_LIBRARY_DIRECTORIES;
+
     extern const char *MIDI_PREFERRED_API;
     extern const int MIDI_PREFERRED_API_DEFAULT;
 
@@ -62,6 +73,9 @@ namespace Settings
     extern const char *MIDI_METRONOME_COUNTIN_VOLUME;
     extern const int MIDI_METRONOME_COUNTIN_VOLUME_DEFAULT;
 
+    extern const char *MIDI_LOOP_SPEED_INCREMENT;
+    extern const int MIDI_LOOP_SPEED_INCREMENT_DEFAULT;
+
     extern const char *GENERAL_OPEN_IN_NEW_WINDOW;
     extern const bool GENERAL_OPEN_IN_NEW_WINDOW_DEFAULT;
 
@@ -0,0 +1,303 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tablibrary.h"
+
+#include <formats/fileformatmanager.h>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrentMap>
+#include <score/score.h>
+#include <set>
+#include <stdexcept>
+#include <util/tracing.h>
+
+static const quint32 INDEX_MAGIC = 0x50544c42;
+static const quint32 INDEX_VERSION = 3;
+
+TabLibrary::Entry::Entry()
+    : myLastModified(0),
+      mySize(0),
+      myIsValid(false),
+      myPlayerCount(0)
+{
+}
+
+static QDataStream &operator<<(QDataStream &out, const TabLibrary::Entry &entry)
+{
+    out << entry.myPath << entry.myLastModified << entry.mySize << entry.myHash
+        << entry.myIsValid << entry.myError << entry.myTitle << entry.myArtist
+        << static_cast<qint32>(entry.myPlayerCount)
+        << static_cast<quint32>(entry.myTunings.size());
+
+    for (const Tuning &tuning : entry.myTunings)
+        out << tuning;
+
+    return out;
+}
+
+static QDataStream &operator>>(QDataStream &in, TabLibrary::Entry &entry)
+{
+    qint32 playerCount = 0;
+    quint32 tuningCount = 0;
+
+    in >> entry.myPath >> entry.myLastModified >> entry.mySize >>
+        entry.myHash >> entry.myIsValid >> entry.myError >> entry.myTitle >>
+        entry.myArtist >> playerCount >> tuningCount;
+
+    entry.myPlayerCount = playerCount;
+
+    entry.myTunings.clear();
+    for (quint32 i = 0; i < tuningCount && in.status() == QDataStream::Ok; ++i)
+    {
+        Tuning tuning;
+        in >> tuning;
+        entry.myTunings.push_back(tuning);
+    }
+
+    return in;
+}
+
+/// Fills in the entry's information from the score.
+static void readScore(const Score &score, TabLibrary::Entry &entry)
+{
+    const ScoreInfo &info = score.getScoreInfo();
+    if (info.getScoreType() == ScoreInfo::ScoreType::Song)
+    {
+        entry.myTitle = QString::fromStdString(info.getSongData().getTitle());
+        entry.myArtist =
+            QString::fromStdString(info.getSongData().getArtist());
+    }
+    else
+    {
+        entry.myTitle = QString::fromStdString(info.getLessonData().getTitle());
+        entry.myArtist =
+            QString::fromStdString(info.getLessonData().getAuthor());
+    }
+
+    entry.myTunings.clear();
+    for (const Player &player : score.getPlayers())
+        entry.myTunings.push_back(player.getTuning());
+    entry.myPlayerCount = static_cast<int>(score.getPlayers().size());
+}
+
+/// Reads the file's metadata (see FileFormatImporter::readMetadata()) if its
+/// contents have changed since it was last indexed. This is run from a worker
+/// thread, so it uses its own importers.
+static void indexFile(TabLibrary::Entry &entry)
+{
+    QFile file(entry.myPath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        entry.myIsValid = false;
+        entry.myError = file.errorString();
+        return;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(&file);
+    const QByteArray digest = hash.result();
+    file.close();
+
+    // The file may have been touched or copied without being modified.
+    if (entry.myIsValid && digest == entry.myHash)
+        return;
+
+    entry.myHash = digest;
+    entry.myIsValid = false;
+    entry.myError.clear();
+
+    FileFormatManager manager;
+    boost::optional<FileFormat> format =
+        manager.findFormat(QFileInfo(entry.myPath).suffix().toStdString());
+    if (!format)
+    {
+        entry.myError = QObject::tr("Unsupported file type.");
+        return;
+    }
+
+    try
+    {
+        Score score;
+        manager.readMetadata(score, entry.myPath.toStdString(), *format);
+        readScore(score, entry);
+        entry.myIsValid = true;
+    }
+    catch (const std::exception &e)
+    {
+        entry.myError = QString::fromLocal8Bit(e.what());
+    }
+}
+
+TabLibrary::TabLibrary(const QString &indexPath) : myIndexPath(indexPath)
+{
+}
+
+bool TabLibrary::load()
+{
+    myEntries.clear();
+
+    QFile file(myIndexPath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != INDEX_MAGIC || version != INDEX_VERSION)
+        return false;
+
+    for (quint32 i = 0; i < count; ++i)
+    {
+        Entry entry;
+        in >> entry;
+        if (in.status() != QDataStream::Ok)
+        {
+            myEntries.clear();
+            return false;
+        }
+
+        myEntries[entry.myPath] = entry;
+    }
+
+    return true;
+}
+
+void TabLibrary::save() const
+{
+    if (!QDir().mkpath(QFileInfo(myIndexPath).path()))
+        throw std::runtime_error("Could not create data directory");
+
+    // Commit the index atomically, so that an interrupted write doesn't lose
+    // the previous index.
+    QSaveFile file(myIndexPath);
+    if (!file.open(QIODevice::WriteOnly))
+        throw std::runtime_error("Could not open library index");
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    out << INDEX_MAGIC << INDEX_VERSION
+        << static_cast<quint32>(myEntries.size());
+    for (auto &entry : myEntries)
+        out << entry.second;
+
+    if (out.status() != QDataStream::Ok || !file.commit())
+        throw std::runtime_error("Could not write library index");
+}
+
+int TabLibrary::scan(const QString &directory, QStringList *errors)
+{
+    PTE_TRACE_SCOPE("TabLibrary::scan");
+    FileFormatManager manager;
+
+    // Find the files that are new or have been modified.
+    std::vector<Entry> pending;
+    std::set<QString> existingFiles;
+
+    QDirIterator it(directory, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        if (!manager.findFormat(info.suffix().toStdString()))
+            continue;
+
+        const QString path = info.absoluteFilePath();
+        const qint64 lastModified = info.lastModified().toMSecsSinceEpoch();
+        existingFiles.insert(path);
+
+        auto existing = myEntries.find(path);
+        if (existing != myEntries.end() &&
+            existing->second.myLastModified == lastModified &&
+            existing->second.mySize == info.size())
+        {
+            continue;
+        }
+
+        Entry entry = (existing != myEntries.end()) ? existing->second
+                                                     : Entry();
+        entry.myPath = path;
+        entry.myLastModified = lastModified;
+        entry.mySize = info.size();
+        pending.push_back(entry);
+    }
+
+    // Remove any files in this directory that have been deleted.
+    const QString prefix = QDir(directory).absolutePath() + "/";
+    for (auto entry = myEntries.begin(); entry != myEntries.end();)
+    {
+        if (entry->first.startsWith(prefix) &&
+            existingFiles.find(entry->first) == existingFiles.end())
+        {
+            entry = myEntries.erase(entry);
+        }
+        else
+            ++entry;
+    }
+
+    QtConcurrent::blockingMap(pending, indexFile);
+
+    for (const Entry &entry : pending)
+    {
+        myEntries[entry.myPath] = entry;
+
+        if (errors && !entry.myIsValid)
+            errors->append(QString("%1: %2").arg(entry.myPath, entry.myError));
+    }
+
+    return static_cast<int>(pending.size());
+}
+
+const TabLibrary::EntryMap &TabLibrary::getEntries() const
+{
+    return myEntries;
+}
+
+std::vector<const TabLibrary::Entry *> TabLibrary::find(
+    const QString &text) const
+{
+    std::vector<const Entry *> matches;
+
+    for (auto &entry : myEntries)
+    {
+        if (entry.second.myTitle.contains(text, Qt::CaseInsensitive) ||
+            entry.second.myArtist.contains(text, Qt::CaseInsensitive))
+        {
+            matches.push_back(&entry.second);
+        }
+    }
+
+    return matches;
+}
+
+QString TabLibrary::defaultIndexPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::DataLocation) +
+           "/library.idx";
+}
@@ -0,0 +1,93 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef APP_TABLIBRARY_H
+#define APP_TABLIBRARY_H
+
+#include <map>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <score/tuning.h>
+#include <vector>
+
+/// An on-disk index of the scores in a set of directories. It stores enough
+/// information to browse and search the library without loading any scores,
+/// and rescanning a directory only imports the files that have changed.
+class TabLibrary
+{
+public:
+    struct Entry
+    {
+        Entry();
+
+        QString myPath;
+        /// Used to cheaply detect changes without reading the file.
+        qint64 myLastModified;
+        qint64 mySize;
+        /// Hash of the file's contents, to avoid re-importing a file that
+        /// was touched or copied without being modified.
+        QByteArray myHash;
+        /// False if the file could not be imported.
+        bool myIsValid;
+        /// The reason that the file could not be imported.
+        QString myError;
+        QString myTitle;
+        QString myArtist;
+        /// The tuning of each player. Power Tab 1.7 files only include the
+        /// guitar score's players in their metadata, so bass players are not
+        /// listed.
+        std::vector<Tuning> myTunings;
+        int myPlayerCount;
+    };
+
+    typedef std::map<QString, Entry> EntryMap;
+
+    TabLibrary(const QString &indexPath = defaultIndexPath());
+
+    /// Reads the index from disk. If the index does not exist or cannot be
+    /// read, the library is left empty and false is returned.
+    bool load();
+
+    /// Writes the index to disk.
+    /// @throw std::runtime_error
+    void save() const;
+
+    /// Recursively scans the directory for supported files. The metadata of
+    /// new or modified files is read in parallel, and files that no longer
+    /// exist are removed from the index. Returns the number of files that
+    /// were read.
+    /// @param errors If provided, a message is added for each file that could
+    /// not be read.
+    int scan(const QString &directory, QStringList *errors = nullptr);
+
+    /// Returns all of the indexed files, keyed by their absolute path.
+    const EntryMap &getEntries() const;
+
+    /// Returns the files whose title or artist contains the given text.
+    std::vector<const Entry *> find(const QString &text) const;
+
+    /// Returns the default location of the index, in the user's data
+    /// directory.
+    static QString defaultIndexPath();
+
+private:
+    QString myIndexPath;
+    EntryMap myEntries;
+};
+
+#endif
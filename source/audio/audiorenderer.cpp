@@ -0,0 +1,192 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "audiorenderer.h"
+
+#include <algorithm>
+#include <audio/bendevent.h>
+#include <audio/metronomeevent.h>
+#include <audio/midievent.h>
+#include <audio/midiplayer.h>
+#include <audio/playbacksettings.h>
+#include <audio/synthesizer.h>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrentMap>
+
+/// The number of frames that are synthesized before being added to the mix.
+static const int BLOCK_SIZE = 4096;
+/// The maximum time (in seconds) that notes can ring after the last event.
+static const int MAX_TAIL_LENGTH = 10;
+
+/// Shared state for the threads that render each track.
+struct Mixer
+{
+    std::vector<float> myOutput;
+    QMutex myMutex;
+};
+
+/// Synthesizes audio up to the given frame, and adds it to the mix.
+static void renderFrames(Synthesizer &synth, long &position, long endFrame,
+                         Mixer &mixer)
+{
+    std::vector<float> buffer;
+
+    while (position < endFrame)
+    {
+        // Skip over any silence.
+        if (!synth.isActive())
+        {
+            position = endFrame;
+            break;
+        }
+
+        const int count =
+            static_cast<int>(std::min<long>(BLOCK_SIZE, endFrame - position));
+        buffer.assign(2 * count, 0.0f);
+        synth.render(buffer.data(), count);
+
+        {
+            QMutexLocker lock(&mixer.myMutex);
+
+            const size_t end = 2 * (position + count);
+            if (mixer.myOutput.size() < end)
+                mixer.myOutput.resize(end, 0.0f);
+
+            std::transform(buffer.begin(), buffer.end(),
+                           mixer.myOutput.begin() + 2 * position,
+                           mixer.myOutput.begin() + 2 * position,
+                           [](float x, float y) { return x + y; });
+        }
+
+        position += count;
+    }
+}
+
+static void renderTrack(const MidiPlayer::ScheduledEventList &track,
+                        const PlaybackSettings &settings, Mixer &mixer)
+{
+    Synthesizer synth(AudioRenderer::SAMPLE_RATE);
+    synth.setPitchBendRange(track.front().second->getChannel(),
+                            BendEvent::PITCH_BEND_RANGE);
+
+    long position = 0;
+    for (auto &event : track)
+    {
+        const long frame = std::lround(event.first *
+                                       AudioRenderer::SAMPLE_RATE / 1000.0);
+        renderFrames(synth, position, frame, mixer);
+
+        event.second->performEvent(synth, settings);
+    }
+
+    // Let any notes finish ringing.
+    renderFrames(synth, position,
+                 position + MAX_TAIL_LENGTH * AudioRenderer::SAMPLE_RATE,
+                 mixer);
+}
+
+std::vector<float> AudioRenderer::render(
+    const std::shared_ptr<const Score> &score)
+{
+    MidiPlayer player(score, 0, 0, 100);
+    MidiPlayer::EventList events;
+    MidiPlayer::ScheduledEventList performance;
+    player.generatePerformance(events, performance);
+
+    const PlaybackSettings settings;
+
+    // Split the events into a track for each channel, which can be
+    // synthesized independently.
+    std::map<int, MidiPlayer::ScheduledEventList> channels;
+    for (auto &event : performance)
+    {
+        if (!settings.isMetronomeEnabled() &&
+            dynamic_cast<const MetronomeEvent *>(event.second))
+        {
+            continue;
+        }
+
+        channels[event.second->getChannel()].push_back(event);
+    }
+
+    std::vector<MidiPlayer::ScheduledEventList> tracks;
+    for (auto &channel : channels)
+        tracks.push_back(std::move(channel.second));
+
+    Mixer mixer;
+    QtConcurrent::blockingMap(
+        tracks, [&](const MidiPlayer::ScheduledEventList &track) {
+            renderTrack(track, settings, mixer);
+        });
+
+    // Avoid clipping if the tracks are too loud when combined.
+    float peak = 0;
+    for (float sample : mixer.myOutput)
+        peak = std::max(peak, std::abs(sample));
+
+    if (peak > 1.0f)
+    {
+        for (float &sample : mixer.myOutput)
+            sample /= peak;
+    }
+
+    return std::move(mixer.myOutput);
+}
+
+/// Writes an integer in little-endian format.
+static void writeValue(std::ostream &output, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        output.put(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+void AudioRenderer::writeWav(std::ostream &output,
+                             const std::vector<float> &samples)
+{
+    const int numChannels = 2;
+    const int bytesPerSample = 2;
+    const uint32_t dataSize =
+        static_cast<uint32_t>(samples.size() * bytesPerSample);
+
+    output.write("RIFF", 4);
+    writeValue(output, 36 + dataSize, 4);
+    output.write("WAVE", 4);
+
+    output.write("fmt ", 4);
+    writeValue(output, 16, 4);
+    writeValue(output, 1, 2); // PCM format.
+    writeValue(output, numChannels, 2);
+    writeValue(output, SAMPLE_RATE, 4);
+    writeValue(output, SAMPLE_RATE * numChannels * bytesPerSample, 4);
+    writeValue(output, numChannels * bytesPerSample, 2);
+    writeValue(output, 8 * bytesPerSample, 2);
+
+    output.write("data", 4);
+    writeValue(output, dataSize, 4);
+
+    for (float sample : samples)
+    {
+        const float clamped = std::min(std::max(sample, -1.0f), 1.0f);
+        const int16_t value = static_cast<int16_t>(std::lround(clamped * 32767));
+        writeValue(output, static_cast<uint16_t>(value), bytesPerSample);
+    }
+}
@@ -0,0 +1,42 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUDIO_AUDIORENDERER_H
+#define AUDIO_AUDIORENDERER_H
+
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+class Score;
+
+/// Renders a score to audio without a MIDI device, using the built-in
+/// synthesizer.
+namespace AudioRenderer
+{
+const int SAMPLE_RATE = 44100;
+
+/// Plays through the score (including any repeats) and returns the
+/// interleaved stereo samples. Each player's track is synthesized on a
+/// separate thread.
+std::vector<float> render(const std::shared_ptr<const Score> &score);
+
+/// Writes the samples from render() as a 16-bit stereo WAV file.
+void writeWav(std::ostream &output, const std::vector<float> &samples);
+}
+
+#endif
@@ -0,0 +1,377 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "barindex.h"
+
+#include <algorithm>
+#include <audio/midiplayer.h>
+#include <audio/repeatcontroller.h>
+#include <score/score.h>
+#include <score/utils.h>
+#include <score/voiceutils.h>
+#include <utility>
+
+/// Stop following repeats and directions after this many passes through the
+/// score, in case they never reach the end of the score.
+static const int MAX_PASSES = 100;
+
+/// Computes the length of a bar (in quarter notes) in the same way as the
+/// MIDI player, which lasts for the longer of its notes and its time
+/// signature. Empty bars are skipped during playback.
+static double getBarLength(const System &system, const Barline &leftBar,
+                           const Barline &rightBar)
+{
+    const TimeSignature &timeSig = leftBar.getTimeSignature();
+    const double meterDuration =
+        (4.0 / timeSig.getBeatValue()) * timeSig.getBeatsPerMeasure();
+
+    double notesDuration = 0;
+    for (const Staff &staff : system.getStaves())
+    {
+        for (const Voice &voice : staff.getVoices())
+        {
+            double duration = 0;
+            for (const Position &pos : ScoreUtils::findInRange(
+                     voice.getPositions(), leftBar.getPosition(),
+                     rightBar.getPosition() - 1))
+            {
+                if (pos.hasMultiBarRest())
+                    duration += meterDuration * pos.getMultiBarRestCount();
+                else
+                    duration += VoiceUtils::getDurationTime(voice, pos);
+            }
+
+            notesDuration = std::max(notesDuration, duration);
+        }
+    }
+
+    if (notesDuration == 0)
+        return 0;
+
+    return std::max(notesDuration, meterDuration);
+}
+
+/// Returns the system's last tempo marker that is before the end of a bar,
+/// which remains in effect for the following systems.
+static const TempoMarker *getLastTempoMarker(const System &system)
+{
+    const int endPosition = system.getBarlines().back().getPosition();
+
+    const TempoMarker *lastMarker = nullptr;
+    for (const TempoMarker &marker : system.getTempoMarkers())
+    {
+        if (marker.getPosition() < endPosition)
+            lastMarker = &marker;
+    }
+
+    return lastMarker;
+}
+
+/// Returns the order of the position relative to the system's barlines.
+static int getBarlineOrder(const System &system, int position)
+{
+    int order = 0;
+    for (const Barline &barline : system.getBarlines())
+    {
+        if (barline.getPosition() < position)
+            order += 2;
+        else if (barline.getPosition() == position)
+            ++order;
+    }
+
+    return order;
+}
+
+BarIndex::Bar::Bar(int position, int endPosition, double length)
+    : myPosition(position), myEndPosition(endPosition), myLength(length)
+{
+}
+
+BarIndex::PlayedBar::PlayedBar(double startTime, int bar)
+    : myStartTime(startTime), myBar(bar)
+{
+}
+
+bool BarIndex::RepeatLayout::operator==(const RepeatLayout &other) const
+{
+    return myBarlines == other.myBarlines &&
+           myDirections == other.myDirections &&
+           myAlternateEndings == other.myAlternateEndings;
+}
+
+BarIndex::BarIndex(const Score &score)
+    : myDuration(0)
+{
+    for (const System &system : score.getSystems())
+        mySystems.push_back(indexSystem(system));
+
+    computeBarDurations(score);
+    computePlaybackOrder(score);
+}
+
+void BarIndex::updateSystems(const Score &score, int firstSystem,
+                             int lastSystem)
+{
+    // Systems were inserted or removed, so the whole score must be indexed.
+    if (score.getSystems().size() != mySystems.size())
+    {
+        *this = BarIndex(score);
+        return;
+    }
+
+    firstSystem = std::max(firstSystem, 0);
+    lastSystem = std::min(lastSystem, static_cast<int>(mySystems.size()) - 1);
+
+    bool barCountChanged = false;
+    bool tempoChanged = false;
+    bool repeatsChanged = false;
+    for (int i = firstSystem; i <= lastSystem; ++i)
+    {
+        IndexedSystem system = indexSystem(score.getSystems()[i]);
+        IndexedSystem &prevSystem = mySystems[i];
+
+        barCountChanged |= (system.myBars.size() != prevSystem.myBars.size());
+        tempoChanged |= (system.myLastTempo != prevSystem.myLastTempo);
+        repeatsChanged |= !(system.myRepeats == prevSystem.myRepeats);
+
+        system.myFirstBar = prevSystem.myFirstBar;
+        prevSystem = std::move(system);
+    }
+
+    // Adding or removing a bar renumbers the following bars, and a tempo
+    // change affects the following systems. Otherwise, only the edited
+    // systems' bars need to be updated.
+    if (barCountChanged)
+        computeBarDurations(score);
+    else
+    {
+        updateBarDurations(
+            score, firstSystem,
+            tempoChanged ? static_cast<int>(mySystems.size()) - 1 : lastSystem);
+    }
+
+    if (barCountChanged || repeatsChanged)
+        computePlaybackOrder(score);
+    else
+        computePlaybackTimes();
+}
+
+BarIndex::IndexedSystem BarIndex::indexSystem(const System &system)
+{
+    IndexedSystem indexedSystem;
+    indexedSystem.myFirstBar = 0;
+
+    for (const Barline &leftBar : system.getBarlines())
+    {
+        indexedSystem.myRepeats.myBarlines.push_back(std::make_pair(
+            static_cast<int>(leftBar.getBarType()), leftBar.getRepeatCount()));
+
+        const Barline *rightBar = system.getNextBarline(leftBar.getPosition());
+        if (!rightBar)
+            continue;
+
+        indexedSystem.myBars.push_back(
+            Bar(leftBar.getPosition(), rightBar->getPosition(),
+                getBarLength(system, leftBar, *rightBar)));
+    }
+
+    if (const TempoMarker *marker = getLastTempoMarker(system))
+        indexedSystem.myLastTempo = MidiPlayer::getQuarterNoteDuration(marker);
+
+    for (Direction direction : system.getDirections())
+    {
+        direction.setPosition(
+            getBarlineOrder(system, direction.getPosition()));
+        indexedSystem.myRepeats.myDirections.push_back(direction);
+    }
+
+    for (AlternateEnding ending : system.getAlternateEndings())
+    {
+        ending.setPosition(getBarlineOrder(system, ending.getPosition()));
+        indexedSystem.myRepeats.myAlternateEndings.push_back(ending);
+    }
+
+    return indexedSystem;
+}
+
+void BarIndex::computeBarDurations(const Score &score)
+{
+    int barCount = 0;
+    for (IndexedSystem &system : mySystems)
+    {
+        system.myFirstBar = barCount;
+        barCount += static_cast<int>(system.myBars.size());
+    }
+
+    myBarLocations.resize(barCount);
+    myBarEndPositions.resize(barCount);
+    myBarDurations.resize(barCount);
+
+    updateBarDurations(score, 0, static_cast<int>(mySystems.size()) - 1);
+}
+
+void BarIndex::updateBarDurations(const Score &score, int firstSystem,
+                                  int lastSystem)
+{
+    // Find the tempo marker that is active at the start of the first system.
+    const TempoMarker *tempoMarker = nullptr;
+    for (int i = firstSystem - 1; i >= 0 && !tempoMarker; --i)
+        tempoMarker = getLastTempoMarker(score.getSystems()[i]);
+
+    for (int systemIndex = firstSystem; systemIndex <= lastSystem;
+         ++systemIndex)
+    {
+        const System &system = score.getSystems()[systemIndex];
+        const IndexedSystem &indexedSystem = mySystems[systemIndex];
+        auto tempoIt = system.getTempoMarkers().begin();
+
+        int barIndex = indexedSystem.myFirstBar;
+        for (const Bar &bar : indexedSystem.myBars)
+        {
+            // Use the last tempo marker before the end of the bar.
+            while (tempoIt != system.getTempoMarkers().end() &&
+                   tempoIt->getPosition() < bar.myEndPosition)
+            {
+                tempoMarker = &*tempoIt;
+                ++tempoIt;
+            }
+
+            myBarLocations[barIndex] =
+                SystemLocation(systemIndex, bar.myPosition);
+            myBarEndPositions[barIndex] = bar.myEndPosition;
+            myBarDurations[barIndex] =
+                bar.myLength * MidiPlayer::getQuarterNoteDuration(tempoMarker);
+            ++barIndex;
+        }
+    }
+}
+
+void BarIndex::computePlaybackOrder(const Score &score)
+{
+    // Repeats and directions are triggered at barlines, including the end bar
+    // of each system (which doesn't start a new bar).
+    std::vector<std::pair<SystemLocation, int>> barlines;
+    int bar = 0;
+    int systemIndex = 0;
+    for (const System &system : score.getSystems())
+    {
+        for (const Barline &barline : system.getBarlines())
+        {
+            const bool isEndBar = (&barline == &system.getBarlines().back());
+            barlines.push_back(std::make_pair(
+                SystemLocation(systemIndex, barline.getPosition()),
+                isEndBar ? -1 : bar++));
+        }
+
+        ++systemIndex;
+    }
+
+    myPlaybackOrder.clear();
+
+    RepeatController repeatController(score);
+    SystemLocation prevLocation;
+
+    size_t i = 0;
+    const size_t maxSteps = MAX_PASSES * barlines.size();
+    for (size_t step = 0; i < barlines.size() && step < maxSteps; ++step)
+    {
+        const SystemLocation &location = barlines[i].first;
+
+        SystemLocation newLocation;
+        if (repeatController.checkForRepeat(prevLocation, location,
+                                            newLocation))
+        {
+            prevLocation = newLocation;
+            i = std::lower_bound(
+                    barlines.begin(), barlines.end(),
+                    std::make_pair(newLocation, -1)) - barlines.begin();
+            continue;
+        }
+
+        const int currentBar = barlines[i].second;
+        if (currentBar >= 0)
+            myPlaybackOrder.push_back(PlayedBar(0, currentBar));
+
+        prevLocation = location;
+        ++i;
+    }
+
+    computePlaybackTimes();
+}
+
+void BarIndex::computePlaybackTimes()
+{
+    myStartTimes.assign(myBarLocations.size(), -1);
+
+    double time = 0;
+    for (PlayedBar &playedBar : myPlaybackOrder)
+    {
+        if (myStartTimes[playedBar.myBar] < 0)
+            myStartTimes[playedBar.myBar] = time;
+
+        playedBar.myStartTime = time;
+        time += myBarDurations[playedBar.myBar];
+    }
+
+    myDuration = time;
+}
+
+int BarIndex::getBarCount() const
+{
+    return static_cast<int>(myBarLocations.size());
+}
+
+const SystemLocation &BarIndex::getBarLocation(int bar) const
+{
+    return myBarLocations.at(bar);
+}
+
+int BarIndex::getBarEndPosition(int bar) const
+{
+    return myBarEndPositions.at(bar);
+}
+
+int BarIndex::findBar(const SystemLocation &location) const
+{
+    auto it = std::upper_bound(myBarLocations.begin(), myBarLocations.end(),
+                               location);
+    if (it == myBarLocations.begin())
+        return myBarLocations.empty() ? -1 : 0;
+
+    return static_cast<int>(it - myBarLocations.begin()) - 1;
+}
+
+double BarIndex::getStartTime(int bar) const
+{
+    return myStartTimes.at(bar);
+}
+
+int BarIndex::findBarAtTime(double time) const
+{
+    auto it = std::upper_bound(
+        myPlaybackOrder.begin(), myPlaybackOrder.end(), time,
+        [](double t, const PlayedBar &bar) { return t < bar.myStartTime; });
+    if (it == myPlaybackOrder.begin())
+        return myPlaybackOrder.empty() ? -1 : myPlaybackOrder.front().myBar;
+
+    return (it - 1)->myBar;
+}
+
+double BarIndex::getDuration() const
+{
+    return myDuration;
+}
@@ -0,0 +1,142 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUDIO_BARINDEX_H
+#define AUDIO_BARINDEX_H
+
+#include <boost/optional/optional.hpp>
+#include <score/alternateending.h>
+#include <score/direction.h>
+#include <score/systemlocation.h>
+#include <utility>
+#include <vector>
+
+class Score;
+class System;
+
+/// Indexes the bars in a score, so that bar numbers, locations in the score,
+/// and playback times can be quickly mapped to each other.
+/// The index is a snapshot of the score, and must be updated after any edits.
+class BarIndex
+{
+public:
+    explicit BarIndex(const Score &score);
+
+    /// Indexes the given systems again after they have been edited. The rest
+    /// of the score is only updated if the edit changed its bar numbers or
+    /// tempo, and the playback order is only recomputed if the repeats or
+    /// directions changed. If systems were inserted or removed, the whole
+    /// score is indexed.
+    void updateSystems(const Score &score, int firstSystem, int lastSystem);
+
+    /// Returns the number of bars in the score.
+    int getBarCount() const;
+
+    /// Returns the location of the start of the bar.
+    const SystemLocation &getBarLocation(int bar) const;
+
+    /// Returns the position of the barline at the end of the bar.
+    int getBarEndPosition(int bar) const;
+
+    /// Returns the bar containing the given location, or -1 if there are no
+    /// bars.
+    int findBar(const SystemLocation &location) const;
+
+    /// Returns the time (in milliseconds) at which the bar is first played,
+    /// or -1 if the bar is never played.
+    double getStartTime(int bar) const;
+
+    /// Returns the bar that is being played at the given time, taking repeats
+    /// and musical directions into account.
+    int findBarAtTime(double time) const;
+
+    /// Returns the total playback time (in milliseconds) of the score.
+    double getDuration() const;
+
+private:
+    struct Bar
+    {
+        Bar(int position, int endPosition, double length);
+
+        int myPosition;
+        int myEndPosition;
+        /// The duration of the bar in quarter notes, which is independent of
+        /// the tempo.
+        double myLength;
+    };
+
+    struct PlayedBar
+    {
+        PlayedBar(double startTime, int bar);
+
+        double myStartTime;
+        int myBar;
+    };
+
+    /// The parts of a system that determine the order in which its bars are
+    /// played. Each position is replaced by its order relative to the
+    /// barlines, so that e.g. adding a note doesn't count as a change.
+    struct RepeatLayout
+    {
+        bool operator==(const RepeatLayout &other) const;
+
+        /// The type and repeat count of each barline.
+        std::vector<std::pair<int, int>> myBarlines;
+        std::vector<Direction> myDirections;
+        std::vector<AlternateEnding> myAlternateEndings;
+    };
+
+    struct IndexedSystem
+    {
+        std::vector<Bar> myBars;
+        /// The index of the system's first bar in the score.
+        int myFirstBar;
+        /// The duration of a quarter note for the system's last tempo marker,
+        /// which determines the tempo of the following systems.
+        boost::optional<double> myLastTempo;
+        RepeatLayout myRepeats;
+    };
+
+    /// Finds the bars in a system and computes their lengths.
+    static IndexedSystem indexSystem(const System &system);
+
+    /// Numbers the bars and computes their durations from the indexed
+    /// systems and the score's tempo markers.
+    void computeBarDurations(const Score &score);
+
+    /// Computes the durations of the bars in the given range of systems,
+    /// which must already be numbered.
+    void updateBarDurations(const Score &score, int firstSystem,
+                            int lastSystem);
+
+    /// Computes the order in which the bars are played.
+    void computePlaybackOrder(const Score &score);
+
+    /// Computes the start times of the bars, without changing the order in
+    /// which they are played.
+    void computePlaybackTimes();
+
+    std::vector<IndexedSystem> mySystems;
+    std::vector<SystemLocation> myBarLocations;
+    std::vector<int> myBarEndPositions;
+    std::vector<double> myBarDurations;
+    std::vector<double> myStartTimes;
+    std::vector<PlayedBar> myPlaybackOrder;
+    double myDuration;
+};
+
+#endif
@@ -35,7 +35,8 @@ BendEvent::BendEvent(int channel, double startTime, int position,
 {
 }
 
-void BendEvent::performEvent(MidiOutputDevice &device) const
+void BendEvent::performEvent(MidiOutputDevice &device,
+                             const PlaybackSettings &) const
 {
     device.setPitchBend(myChannel, myBendAmount);
 }
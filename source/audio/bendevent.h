@@ -32,7 +32,8 @@ public:
     BendEvent(int channel, double startTime, int position, int system,
               uint8_t myBendAmount);
 
-    virtual void performEvent(MidiOutputDevice &device) const override;
+    virtual void performEvent(MidiOutputDevice &device,
+                              const PlaybackSettings &settings) const override;
 
 private:
     const uint8_t myBendAmount;
@@ -0,0 +1,99 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "channelallocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <score/generalmidi.h>
+#include <score/score.h>
+
+/// Every channel except the percussion channel can be used by a player.
+static const int CHANNELS_PER_PORT = Midi::NUM_MIDI_CHANNELS_PER_PORT - 1;
+
+ChannelAllocator::ChannelAllocator(const Score &score)
+    : myChannels(score.getPlayers().size(), -1),
+      myPortCount(1)
+{
+    std::vector<int> usedChannels(Midi::MAX_MIDI_PORTS, 0);
+    // The channels in the order that they were assigned, in case they need
+    // to be shared.
+    std::vector<int> assignedChannels;
+
+    auto assignChannel = [&](int port) {
+        int channel = usedChannels[port]++;
+        if (channel >= Midi::PERCUSSION_CHANNEL)
+            ++channel;
+
+        channel += port * Midi::NUM_MIDI_CHANNELS_PER_PORT;
+        myPortCount = std::max(myPortCount, port + 1);
+        assignedChannels.push_back(channel);
+        return channel;
+    };
+
+    // Assign channels to the players that have been pinned to a port first.
+    int i = 0;
+    for (const Player &player : score.getPlayers())
+    {
+        // Player ensures that the port is valid, even when loading a file.
+        assert(!player.hasMidiPort() || (player.getMidiPort() >= 0 &&
+                                         player.getMidiPort() <
+                                             Midi::MAX_MIDI_PORTS));
+
+        if (player.hasMidiPort() &&
+            usedChannels[player.getMidiPort()] < CHANNELS_PER_PORT)
+        {
+            myChannels[i] = assignChannel(player.getMidiPort());
+        }
+
+        ++i;
+    }
+
+    // Fill up the ports in order with the remaining players. If every
+    // channel is in use, the remaining players have to share channels.
+    int port = 0;
+    size_t sharedChannel = 0;
+    for (int &channel : myChannels)
+    {
+        if (channel >= 0)
+            continue;
+
+        while (port < Midi::MAX_MIDI_PORTS &&
+               usedChannels[port] == CHANNELS_PER_PORT)
+        {
+            ++port;
+        }
+
+        if (port < Midi::MAX_MIDI_PORTS)
+            channel = assignChannel(port);
+        else
+        {
+            channel = assignedChannels[sharedChannel];
+            sharedChannel = (sharedChannel + 1) % assignedChannels.size();
+        }
+    }
+}
+
+int ChannelAllocator::getChannel(int player) const
+{
+    return myChannels.at(player);
+}
+
+int ChannelAllocator::getPortCount() const
+{
+    return myPortCount;
+}
@@ -0,0 +1,45 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUDIO_CHANNELALLOCATOR_H
+#define AUDIO_CHANNELALLOCATOR_H
+
+#include <vector>
+
+class Score;
+
+/// Assigns a MIDI port and channel to each player in the score, so that
+/// scores with more players than the channels on a single port can be played
+/// back without players sharing a channel.
+/// Channels are numbered as (port * 16 + channel).
+class ChannelAllocator
+{
+public:
+    explicit ChannelAllocator(const Score &score);
+
+    /// Returns the channel that the player's events should be sent to.
+    int getChannel(int player) const;
+
+    /// Returns the number of ports that need to be opened.
+    int getPortCount() const;
+
+private:
+    std::vector<int> myChannels;
+    int myPortCount;
+};
+
+#endif
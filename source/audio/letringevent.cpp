@@ -30,7 +30,8 @@ LetRingEvent::LetRingEvent(int channel, double startTime, int position,
 {
 }
 
-void LetRingEvent::performEvent(MidiOutputDevice &device) const
+void LetRingEvent::performEvent(MidiOutputDevice &device,
+                                const PlaybackSettings &) const
 {
 #if defined(LOG_MIDI_EVENTS)
     qDebug() << "Let Ring " << ((myEventType == LET_RING_ON) ? "On" : "Off")
@@ -32,7 +32,8 @@ public:
     LetRingEvent(int channel, double startTime, int position, int system,
                  EventType eventType);
 
-    virtual void performEvent(MidiOutputDevice &device) const override;
+    virtual void performEvent(MidiOutputDevice &device,
+                              const PlaybackSettings &settings) const override;
 
 private:
     const EventType myEventType;
@@ -17,9 +17,8 @@
   
 #include "metronomeevent.h"
 
-#include <app/settings.h>
 #include <audio/midioutputdevice.h>
-#include <QSettings>
+#include <audio/playbacksettings.h>
 #include <score/generalmidi.h>
 
 #if defined(LOG_MIDI_EVENTS)
@@ -33,44 +32,26 @@ MetronomeEvent::MetronomeEvent(int channel, double startTime, double duration,
 {
 }
 
-uint8_t MetronomeEvent::getMetronomePreset()
-{
-    QSettings settings;
-    return Midi::MIDI_PERCUSSION_PRESET_OFFSET +
-           settings.value(Settings::MIDI_METRONOME_PRESET,
-                          Settings::MIDI_METRONOME_PRESET_DEFAULT).toUInt();
-}
-
-void MetronomeEvent::performEvent(MidiOutputDevice &device) const
+void MetronomeEvent::performEvent(MidiOutputDevice &device,
+                                  const PlaybackSettings &settings) const
 {
 #if defined(LOG_MIDI_EVENTS)
     qDebug() << "Metronome: " << mySystem << ", " << myPosition << " at " <<
                 myStartTime;
 #endif
 
-    QSettings settings;
     uint8_t velocity;
 
     // Check if the metronome has been disabled.
-    if (!settings.value(Settings::MIDI_METRONOME_ENABLED,
-                        Settings::MIDI_METRONOME_ENABLED_DEFAULT).toBool())
-    {
+    if (!settings.isMetronomeEnabled())
         velocity = 0;
-    }
     else if (myVelocity == WeakAccent)
-    {
-        velocity = settings.value(Settings::MIDI_METRONOME_WEAK_ACCENT,
-                                  Settings::MIDI_METRONOME_WEAK_ACCENT_DEFAULT).toUInt();
-    }
+        velocity = settings.getWeakAccentVolume();
     else
-    {
-        velocity =
-            settings.value(Settings::MIDI_METRONOME_STRONG_ACCENT,
-                           Settings::MIDI_METRONOME_STRONG_ACCENT_DEFAULT).toUInt();
-    }
+        velocity = settings.getStrongAccentVolume();
 
     // The metronome events use the percussion channel, so we don't need to perform
     // a patch change. The note determines whether we hear a cymbal, snare, etc.
     device.setChannelMaxVolume(myChannel, Midi::MAX_MIDI_CHANNEL_VOLUME);
-    device.playNote(myChannel, getMetronomePreset(), velocity);
+    device.playNote(myChannel, settings.getMetronomePreset(), velocity);
 }
@@ -33,9 +33,8 @@ public:
     MetronomeEvent(int channel, double startTime, double duration,
                    int position, int system, VelocityType myVelocity);
 
-    virtual void performEvent(MidiOutputDevice &device) const override;
-
-    static uint8_t getMetronomePreset();
+    virtual void performEvent(MidiOutputDevice &device,
+                              const PlaybackSettings &settings) const override;
 
 private:
     const VelocityType myVelocity;
@@ -32,6 +32,11 @@ MidiEvent::MidiEvent(int channel, double startTime, double duration,
 {
 }
 
+int MidiEvent::getChannel() const
+{
+    return myChannel;
+}
+
 int MidiEvent::getPosition() const
 {
     return myPosition;
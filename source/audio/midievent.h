@@ -19,6 +19,7 @@
 #define AUDIO_MIDIEVENT_H
 
 class MidiOutputDevice;
+class PlaybackSettings;
 
 class MidiEvent
 {
@@ -33,8 +34,10 @@ public:
     bool operator<(const MidiEvent &event) const;
 
     /// Performs the event by sending commands to the MIDI output device.
-    virtual void performEvent(MidiOutputDevice &sequencer) const = 0;
+    virtual void performEvent(MidiOutputDevice &sequencer,
+                              const PlaybackSettings &settings) const = 0;
 
+    int getChannel() const;
     int getPosition() const;
     int getSystem() const;
     double getDuration() const;
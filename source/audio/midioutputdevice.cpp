@@ -17,17 +17,28 @@
   
 #include "midioutputdevice.h"
 
+#include <memory>
 #include <RtMidi.h>
 #include <score/dynamic.h>
 #include <score/generalmidi.h>
 
-MidiOutputDevice::MidiOutputDevice() : myMidiOut(nullptr)
+MidiOutputDevice::MidiOutputDevice()
 {
-    for (int i = 0; i < NUM_CHANNELS; ++i)
+    for (int i = 0; i < NUM_CHANNELS * Midi::MAX_MIDI_PORTS; ++i)
     {
         channelMaxVolumes[i] = Midi::MAX_MIDI_CHANNEL_VOLUME;
         channelActiveVolumes[i] = Dynamic::fff;
     }
+}
+
+MidiOutputDevice::~MidiOutputDevice()
+{
+}
+
+void MidiOutputDevice::loadApis()
+{
+    if (!myMidiOuts.empty())
+        return;
 
     // Create all MIDI APIs supported on this platform.
     std::vector<RtMidi::Api> rtMidiApis;
@@ -49,21 +60,22 @@ MidiOutputDevice::MidiOutputDevice() : myMidiOut(nullptr)
         }
     }
 
-    // Select a default midiout.
     assert(!myMidiOuts.empty() && "No MIDI APIs compiled");
-    myMidiOut = &myMidiOuts[0];
 }
 
-MidiOutputDevice::~MidiOutputDevice()
+bool MidiOutputDevice::sendMidiMessage(int channel, unsigned char type,
+                                       unsigned char b, unsigned char c)
 {
-}
+    if (myPorts.empty())
+        return false;
+
+    const size_t port = channel / NUM_CHANNELS;
+    RtMidiOut *midiOut = port < myPorts.size() ? myPorts[port]
+                                               : myPorts.front();
 
-bool MidiOutputDevice::sendMidiMessage(unsigned char a, unsigned char b,
-                                       unsigned char c)
-{
     std::vector<uint8_t> message;
 
-    message.push_back(a);
+    message.push_back(type + channel % NUM_CHANNELS);
 
     if (b <= 127)
         message.push_back(b);
@@ -73,7 +85,7 @@ bool MidiOutputDevice::sendMidiMessage(unsigned char a, unsigned char b,
 
     try
     {
-        myMidiOut->sendMessage(&message);
+        midiOut->sendMessage(&message);
     }
     catch (...)
     {
@@ -83,45 +95,82 @@ bool MidiOutputDevice::sendMidiMessage(unsigned char a, unsigned char b,
     return true;
 }
 
+void MidiOutputDevice::closePorts()
+{
+    for (RtMidiOut *midiOut : myPorts)
+        midiOut->closePort();
+
+    myPorts.clear();
+    myExtraPorts.clear();
+}
+
 bool MidiOutputDevice::initialize(size_t preferredApi,
-                                  unsigned int preferredPort)
+                                  unsigned int preferredPort, int portCount)
 {
-    myMidiOut->closePort(); // Close any open ports.
+    loadApis();
+    closePorts();
 
     if (preferredApi >= myMidiOuts.size())
         return false;
 
-    myMidiOut = &myMidiOuts[preferredApi];
-    unsigned int num_ports = myMidiOut->getPortCount();
+    RtMidiOut *midiOut = &myMidiOuts[preferredApi];
+    unsigned int num_ports = midiOut->getPortCount();
 
     if (num_ports == 0)
         return false;
 
     try
     {
-        myMidiOut->openPort(preferredPort);
+        midiOut->openPort(preferredPort);
     }
     catch (...)
     {
          return false;
     }
 
+    myPorts.push_back(midiOut);
+
+    // Use the ports after the preferred port for any other players.
+    for (int i = 1; i < portCount; ++i)
+    {
+        const unsigned int port = preferredPort + i;
+        if (port >= num_ports)
+            break;
+
+        try
+        {
+            std::unique_ptr<RtMidiOut> extraPort(
+                new RtMidiOut(midiOut->getCurrentApi()));
+            extraPort->openPort(port);
+
+            myExtraPorts.push_back(extraPort.release());
+            myPorts.push_back(&myExtraPorts.back());
+        }
+        catch (...)
+        {
+            break;
+        }
+    }
+
     return true;
 }
 
 size_t MidiOutputDevice::getApiCount()
 {
+    loadApis();
     return myMidiOuts.size();
 }
 
 unsigned int MidiOutputDevice::getPortCount(size_t api)
 {
+    loadApis();
     assert(api < myMidiOuts.size() && "Programming error, api doesn't exist");
     return myMidiOuts[api].getPortCount();
 }
 
 std::string MidiOutputDevice::getPortName(size_t api, unsigned int port)
 {
+    loadApis();
     assert(api < myMidiOuts.size() && "Programming error, api doesn't exist");
     return myMidiOuts[api].getPortName(port);
 }
@@ -137,7 +186,7 @@ bool MidiOutputDevice::setPatch(int channel, uint8_t patch)
     // - first parameter is 0xC0-0xCF with C being the id and 0-F being the
     //   channel (0-15).
     // - second parameter is the new patch (0-127).
-    return sendMidiMessage(ProgramChange + channel, patch, -1);
+    return sendMidiMessage(channel, ProgramChange, patch, -1);
 }
 
 bool MidiOutputDevice::setVolume (int channel, uint8_t volume)
@@ -147,7 +196,7 @@ bool MidiOutputDevice::setVolume (int channel, uint8_t volume)
     channelActiveVolumes[channel] = volume;
 
     return sendMidiMessage(
-        ControlChange + channel, ChannelVolume,
+        channel, ControlChange, ChannelVolume,
         static_cast<int>((volume / 127.0) * channelMaxVolumes[channel]));
 }
 
@@ -162,7 +211,7 @@ bool MidiOutputDevice::setPan(int channel, uint8_t pan)
     // first parameter is 0xB0-0xBF with B being the id and 0-F being the channel (0-15)
     // second parameter is the control to change (0-127), 10 is channel pan
     // third parameter is the new pan (0-127)
-    return sendMidiMessage(ControlChange + channel, PanChange, pan);
+    return sendMidiMessage(channel, ControlChange, PanChange, pan);
 }
 
 bool MidiOutputDevice::setPitchBend (int channel, uint8_t bend)
@@ -170,7 +219,7 @@ bool MidiOutputDevice::setPitchBend (int channel, uint8_t bend)
     if (bend > 127)
         bend = 127;
 
-    return sendMidiMessage(PitchWheel + channel, 0, bend);
+    return sendMidiMessage(channel, PitchWheel, 0, bend);
 }
 
 bool MidiOutputDevice::playNote(int channel, uint8_t pitch, uint8_t velocity)
@@ -193,7 +242,7 @@ bool MidiOutputDevice::playNote(int channel, uint8_t pitch, uint8_t velocity)
     // first parameter 0x90-9x9F with 9 being the id and 0-F being the channel (0-15)
     // second parameter is the pitch of the note (0-127), 60 would be a 'middle C'
     // third parameter is the velocity of the note (1-127), 0 is not allowed, 64 would be no velocity
-    return sendMidiMessage(NoteOn + channel, pitch, velocity);
+    return sendMidiMessage(channel, NoteOn, pitch, velocity);
 }
 
 bool MidiOutputDevice::stopNote(int channel, uint8_t pitch)
@@ -204,7 +253,7 @@ bool MidiOutputDevice::stopNote(int channel, uint8_t pitch)
     // MIDI note off
     // first parameter 0x80-9x8F with 8 being the id and 0-F being the channel (0-15)
     // second parameter is the pitch of the note (0-127), 60 would be a 'middle C'
-    return sendMidiMessage(NoteOff + channel, pitch, 127);
+    return sendMidiMessage(channel, NoteOff, pitch, 127);
 }
 
 bool MidiOutputDevice::setVibrato(int channel, uint8_t modulation)
@@ -212,22 +261,22 @@ bool MidiOutputDevice::setVibrato(int channel, uint8_t modulation)
     if (modulation > 127)
         modulation = 127;
 
-    return sendMidiMessage(ControlChange + channel, ModWheel, modulation);
+    return sendMidiMessage(channel, ControlChange, ModWheel, modulation);
 }
 
 bool MidiOutputDevice::setSustain(int channel, bool sustainOn)
 {
     const uint8_t value = sustainOn ? 127 : 0;
     
-    return sendMidiMessage(ControlChange + channel, HoldPedal, value);
+    return sendMidiMessage(channel, ControlChange, HoldPedal, value);
 }
 
 void MidiOutputDevice::setPitchBendRange(int channel, uint8_t semiTones)
 {
-    sendMidiMessage(ControlChange + channel, RpnMsb, 0);
-    sendMidiMessage(ControlChange + channel, RpnLsb, 0);
-    sendMidiMessage(ControlChange + channel, DataEntryCoarse, semiTones);
-    sendMidiMessage(ControlChange + channel, DataEntryFine, 0);
+    sendMidiMessage(channel, ControlChange, RpnMsb, 0);
+    sendMidiMessage(channel, ControlChange, RpnLsb, 0);
+    sendMidiMessage(channel, ControlChange, DataEntryCoarse, semiTones);
+    sendMidiMessage(channel, ControlChange, DataEntryFine, 0);
 }
 
 void MidiOutputDevice::setChannelMaxVolume(int channel, uint8_t newMaxVolume)
@@ -28,6 +28,7 @@
 #include <boost/ptr_container/ptr_vector.hpp>
 #include <cstdint>
 #include <map>
+#include <vector>
 
 class RtMidiOut;
 
@@ -37,9 +38,14 @@ public:
     static const int NUM_CHANNELS = 16;
 
     MidiOutputDevice();
-    ~MidiOutputDevice();
+    virtual ~MidiOutputDevice();
 
-    bool initialize(size_t preferredApi, unsigned int preferredPort);
+    /// Opens the preferred port. If more than one port is requested, the
+    /// following ports are also opened (if they are available).
+    /// Channels are numbered as (port * NUM_CHANNELS + channel), and the
+    /// events for a port that could not be opened are sent to the first port.
+    bool initialize(size_t preferredApi, unsigned int preferredPort,
+                    int portCount = 1);
     size_t getApiCount();
     unsigned int getPortCount(size_t api);
     std::string getPortName(size_t api, unsigned int port);
@@ -81,10 +87,25 @@ public:
         RpnMsb = 101
     };
 
+protected:
+    /// Sends a message to the port for the given channel. Values greater
+    /// than 127 for the data bytes are omitted from the message.
+    virtual bool sendMidiMessage(int channel, unsigned char type,
+                                 unsigned char b, unsigned char c);
+
 private:
+    /// Creates the MIDI APIs the first time that they are needed, so that
+    /// subclasses which don't send messages to RtMidi don't require a MIDI
+    /// device to be available.
+    void loadApis();
+    void closePorts();
+
+    /// One instance for each MIDI API, which is used for the first port.
     boost::ptr_vector<RtMidiOut> myMidiOuts;
-    RtMidiOut* myMidiOut;
-    bool sendMidiMessage(unsigned char a, unsigned char b, unsigned char c);
+    /// Instances for any additional ports.
+    boost::ptr_vector<RtMidiOut> myExtraPorts;
+    /// The open ports.
+    std::vector<RtMidiOut *> myPorts;
 
     /// Maximum volume for each channel (as set in the mixer).
     std::map<int, int> channelMaxVolumes;
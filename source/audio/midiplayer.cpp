@@ -17,12 +17,13 @@
   
 #include "midiplayer.h"
 
-#include <app/settings.h>
 #include <audio/bendevent.h>
+#include <audio/channelallocator.h>
 #include <audio/letringevent.h>
 #include <audio/metronomeevent.h>
 #include <audio/midievent.h>
 #include <audio/midioutputdevice.h>
+#include <audio/playbacksettings.h>
 #include <audio/playnoteevent.h>
 #include <audio/repeatcontroller.h>
 #include <audio/restevent.h>
@@ -30,18 +31,20 @@
 #include <audio/vibratoevent.h>
 #include <audio/volumechangeevent.h>
 #include <boost/math/special_functions/round.hpp>
+#include <chrono>
+#include <cmath>
+#include <functional>
 #include <QDebug>
-#include <QSettings>
+#include <QRunnable>
 #include <score/generalmidi.h>
 #include <score/score.h>
 #include <score/scorelocation.h>
 #include <score/systemlocation.h>
 #include <score/utils.h>
 #include <score/voiceutils.h>
+#include <util/tracing.h>
 
-// Channel 10 is used for percussion in General MIDI.
-static const int PERCUSSION_CHANNEL = 9;
-static const int METRONOME_CHANNEL = PERCUSSION_CHANNEL;
+static const int METRONOME_CHANNEL = Midi::PERCUSSION_CHANNEL;
 
 /// For grace notes, use the duration of 32nd note at 120bpm, which is fairly
 /// fast.
@@ -60,40 +63,264 @@ public:
     {
     }
 
-    virtual void performEvent(MidiOutputDevice &) const override
+    virtual void performEvent(MidiOutputDevice &,
+                              const PlaybackSettings &) const override
     {
     }
 };
 
-MidiPlayer::MidiPlayer(const Score &score, int startSystem, int startPosition,
-                       int speed)
+/// Runs a function in a thread pool.
+class FunctionTask : public QRunnable
+{
+public:
+    explicit FunctionTask(const std::function<void()> &function)
+        : myFunction(function)
+    {
+    }
+
+    virtual void run() override
+    {
+        myFunction();
+    }
+
+private:
+    std::function<void()> myFunction;
+};
+
+/// Generates the MIDI events for a score. This only depends on the score,
+/// channel assignments, and settings, so it can safely be used from any thread.
+class EventGenerator
+{
+public:
+    typedef MidiPlayer::EventList EventList;
+
+    EventGenerator(const Score &score, const ChannelAllocator &channels,
+                   const PlaybackSettings &settings)
+        : myScore(score), myChannels(channels), mySettings(settings)
+    {
+    }
+
+    /// Generates the events for the entire score, sorted by start time.
+    void generateEvents(EventList &eventList) const;
+
+private:
+    /// Generates a list of all notes in the given bar.
+    /// @returns The timestamp of the end of the last event in the bar.
+    double generateEventsForBar(const System &system, int systemIndex,
+                                const Staff &staff, int staffIndex,
+                                const Voice &voice, int voiceIndex, int leftPos,
+                                int rightPos, const double barStartTime,
+                                EventList &eventList,
+                                uint8_t &activePitchBend) const;
+
+    /// Returns the MIDI channel that should be used for the player.
+    int getChannel(const ActivePlayer &player) const;
+
+    /// Calculates the duration of a note in the given position.
+    double calculateNoteDuration(int system, const Voice &voice,
+                                 const Position &pos) const;
+
+    /// Computes the duration of a whole rest. If it's the only rest/note in the
+    /// bar, then it lasts for the entire bar instead of 4 beats.
+    double getWholeRestDuration(const System &system, int systemIndex,
+                                const Voice &voice, const Position &pos,
+                                double originalDuration) const;
+
+    /// Computes the pitch of a note, including things like harmonics.
+    int getActualNotePitch(const Note &note, const Tuning &tuning) const;
+
+    /// Generates metronome events for a bar.
+    /// @param notesEndTime The timestamp of the last note event in the bar.
+    double generateMetronome(const System &system, int systemIndex,
+                             const Barline &barline, double startTime,
+                             const double notesEndTime,
+                             EventList &eventList) const;
+
+    /// Holds basic information about a bend - used to simplify the generateBends function
+    struct BendEventInfo
+    {
+        BendEventInfo(double timestamp, uint8_t pitchBendAmout);
+
+        double timestamp;
+        uint8_t pitchBendAmount;
+    };
+
+    void generateBends(std::vector<BendEventInfo> &bends,
+                       uint8_t &activePitchBend, double startTime,
+                       double duration, double currentTempo,
+                       const Note &note) const;
+
+    void generateSlides(std::vector<BendEventInfo> &bends, double startTime,
+                        double noteDuration, double currentTempo,
+                        const Note &note, const Note *nextNote) const;
+
+    /// Generates a series of BendEvents to perform a gradual bend over the
+    /// given duration. Bends the note from the startBendAmount to the
+    /// releaseBendAmount over the note duration.
+    void generateGradualBend(std::vector<BendEventInfo> &bends,
+                             double startTime, double duration,
+                             int startBendAmount, int releaseBendAmount) const;
+#if 0
+    void generateTremoloBar(std::vector<BendEventInfo>& bends, double startTime,
+                            double noteDuration, double currentTempo, const Position* position);
+#endif
+
+    const Score &myScore;
+    const ChannelAllocator &myChannels;
+    const PlaybackSettings &mySettings;
+};
+
+/// Walks through the events in the order that they are performed, following
+/// any repeats or directions in the score. This is shared by real-time
+/// playback and generatePerformance().
+class EventWalker
+{
+public:
+    typedef MidiPlayer::EventList EventList;
+    typedef std::function<void(int)> LocationCallback;
+    /// Called at the start of each bar. If a newer version of the score is
+    /// returned, its events must have already replaced the event list, and
+    /// the walk resumes from the same location in the new score.
+    typedef std::function<std::shared_ptr<const Score>()> BarCallback;
+
+    EventWalker(const std::shared_ptr<const Score> &score,
+                const EventList &eventList,
+                const SystemLocation &startLocation,
+                const LocationCallback &systemChanged = LocationCallback(),
+                const LocationCallback &positionChanged = LocationCallback(),
+                const BarCallback &barStarted = BarCallback());
+
+    /// Returns the next event to perform, or null at the end of the score.
+    const MidiEvent *next();
+    /// Returns the event after the one that was last returned by next(), which
+    /// determines how long to wait before the next event.
+    const MidiEvent *peekNext() const;
+
+private:
+    /// Resumes from the current location in a new version of the score,
+    /// keeping track of the repeats and directions that were already performed.
+    void switchScore(const std::shared_ptr<const Score> &score);
+
+    std::shared_ptr<const Score> myScore;
+    const EventList &myEventList;
+    std::unique_ptr<RepeatController> myRepeatController;
+    EventList::const_iterator myNextEvent;
+    boost::optional<SystemLocation> myStartLocation;
+    SystemLocation myCurrentLocation;
+    SystemLocation myPrevLocation;
+    LocationCallback mySystemChanged;
+    LocationCallback myPositionChanged;
+    BarCallback myBarStarted;
+};
+
+/// Returns the active tempo marker, if one exists.
+static const TempoMarker *getCurrentTempoMarker(const Score &score,
+                                                int systemIndex, int position)
+{
+    const TempoMarker *lastMarker = nullptr;
+
+    int i = 0;
+    for (const System &system : score.getSystems())
+    {
+        if (i > systemIndex)
+            break;
+
+        for (const TempoMarker &marker : system.getTempoMarkers())
+        {
+            if (i < systemIndex ||
+               (i == systemIndex && marker.getPosition() <= position))
+            {
+                lastMarker = &marker;
+            }
+        }
+
+        ++i;
+    }
+
+    return lastMarker;
+}
+
+/// Returns the current tempo (duration of a quarter note in milliseconds).
+static double getCurrentTempo(const Score &score, int system, int position)
+{
+    return MidiPlayer::getQuarterNoteDuration(
+        getCurrentTempoMarker(score, system, position));
+}
+
+MidiPlayer::MidiPlayer(const std::shared_ptr<const Score> &score,
+                       int startSystem, int startPosition, int speed)
     : myScore(score),
+      myHasPendingScore(false),
+      myScoreVersion(0),
       myStartSystem(startSystem),
       myStartPosition(startPosition),
       myIsPlaying(false),
-      myPlaybackSpeed(speed)
+      myPlaybackSpeed(speed),
+      mySettings(std::make_shared<PlaybackSettings>()),
+      mySettingsChanged(false)
 {
+    myPreparePool.setMaxThreadCount(1);
 }
 
 MidiPlayer::~MidiPlayer()
 {
     setIsPlaying(false);
     wait();
+    myPreparePool.waitForDone();
+}
+
+void MidiPlayer::enableLooping(int endPosition)
+{
+    myLoopEndPosition = endPosition;
+}
+
+void MidiPlayer::updateSettings(
+    const std::shared_ptr<const PlaybackSettings> &settings)
+{
+    std::atomic_store(&mySettings, settings);
+    mySettingsChanged = true;
+}
+
+void MidiPlayer::updateScore(const std::shared_ptr<const Score> &score)
+{
+    const int version = ++myScoreVersion;
+    myPreparePool.start(new FunctionTask([=]() {
+        preparePendingScore(score, version);
+    }));
+}
+
+void MidiPlayer::preparePendingScore(const std::shared_ptr<const Score> &score,
+                                     int version)
+{
+    // Don't bother generating events if the score was edited again.
+    if (version != myScoreVersion)
+        return;
+
+    // Nothing here is shared with the playback thread until the pending score
+    // is handed off below.
+    auto pending = std::make_shared<PendingScore>();
+    pending->myScore = score;
+    pending->myChannels.reset(new ChannelAllocator(*score));
+    pending->myEvents = generateEvents(*score, *pending->myChannels,
+                                       *std::atomic_load(&mySettings));
+
+    // The tasks are run in order, so this never replaces a newer version.
+    std::atomic_store(&myPendingScore, pending);
+    myHasPendingScore = true;
 }
 
 void MidiPlayer::run()
 {
     setIsPlaying(true);
 
-    EventList eventList;
-    generateEvents(eventList);
+    myChannels.reset(new ChannelAllocator(*myScore));
+    EventList eventList = generateEvents(*myScore, *myChannels,
+                                         *std::atomic_load(&mySettings));
 
-    // Sort the events by their start time, and play them in order.
-    std::stable_sort(
-        eventList.begin(), eventList.end(),
-        [](const std::unique_ptr<MidiEvent> & e1,
-           const std::unique_ptr<MidiEvent> & e2) { return *e1 < *e2; });
-    playMidiEvents(eventList);
+    if (myLoopEndPosition)
+        playLoop(eventList);
+    else
+        playMidiEvents(eventList);
 }
 
 void MidiPlayer::setIsPlaying(bool set)
@@ -106,8 +333,21 @@ bool MidiPlayer::isPlaying() const
     return myIsPlaying;
 }
 
-void MidiPlayer::generateEvents(EventList &eventList)
+MidiPlayer::EventList MidiPlayer::generateEvents(
+    const Score &score, const ChannelAllocator &channels,
+    const PlaybackSettings &settings)
+{
+    EventList eventList;
+    EventGenerator(score, channels, settings).generateEvents(eventList);
+    return eventList;
+}
+
+void EventGenerator::generateEvents(EventList &eventList) const
 {
+    PTE_TRACE_SCOPE("MidiPlayer::generateEvents");
+
+    eventList.clear();
+
     double time = 0;
 
     int systemIndex = 0;
@@ -171,6 +411,31 @@ void MidiPlayer::generateEvents(EventList &eventList)
 
         ++systemIndex;
     }
+
+    // Sort the events by their start time, so that they can be played in order.
+    std::stable_sort(
+        eventList.begin(), eventList.end(),
+        [](const std::unique_ptr<MidiEvent> & e1,
+           const std::unique_ptr<MidiEvent> & e2) { return *e1 < *e2; });
+
+    PTE_TRACE_COUNTER("MidiPlayer::events", eventList.size());
+}
+
+bool MidiPlayer::swapPendingScore(EventList &eventList)
+{
+    // Avoid the lock in std::atomic_exchange unless there is a new score.
+    if (!myHasPendingScore.exchange(false))
+        return false;
+
+    std::shared_ptr<PendingScore> pending = std::atomic_exchange(
+        &myPendingScore, std::shared_ptr<PendingScore>());
+    if (!pending)
+        return false;
+
+    myScore = pending->myScore;
+    myChannels = std::move(pending->myChannels);
+    eventList = std::move(pending->myEvents);
+    return true;
 }
 
 /// Returns the appropriate note velocity type for the given position/note.
@@ -187,21 +452,16 @@ static PlayNoteEvent::VelocityType getNoteVelocity(const Position &pos,
         return PlayNoteEvent::DefaultVelocity;
 }
 
-/// Returns the MIDI channel that should be used for the player.
-/// Since channel 10 is reserved for percussion, we can't use that
-/// channel for regular instruments.
-static int getChannel(const ActivePlayer &player)
+int EventGenerator::getChannel(const ActivePlayer &player) const
 {
-    int channel = player.getPlayerNumber();
-    if (channel >= PERCUSSION_CHANNEL)
-        channel++;
-    return channel;
+    return myChannels.getChannel(player.getPlayerNumber());
 }
 
-double MidiPlayer::generateEventsForBar(
+double EventGenerator::generateEventsForBar(
     const System &system, int systemIndex, const Staff &staff, int staffIndex,
     const Voice &voice, int voiceIndex, int leftPos, int rightPos,
-    const double barStartTime, EventList &eventList, uint8_t &activePitchBend)
+    const double barStartTime, EventList &eventList,
+    uint8_t &activePitchBend) const
 {
     ScoreLocation location(myScore, systemIndex, staffIndex, voiceIndex);
     const Voice *prevVoice = VoiceUtils::getAdjacentVoice(location, -1);
@@ -214,7 +474,8 @@ double MidiPlayer::generateEventsForBar(
          ScoreUtils::findInRange(voice.getPositions(), leftPos, rightPos))
     {
         const int position = pos.getPosition();
-        const double currentTempo = getCurrentTempo(systemIndex, position);
+        const double currentTempo =
+            getCurrentTempo(myScore, systemIndex, position);
 
         // Each note at a position has the same duration.
         double duration = calculateNoteDuration(systemIndex, voice, pos);
@@ -552,12 +813,25 @@ double MidiPlayer::generateEventsForBar(
     return startTime;
 }
 
-void MidiPlayer::performCountIn(MidiOutputDevice &device,
-                                const SystemLocation &location)
+void MidiPlayer::initializeDevice(MidiOutputDevice &device,
+                                  const PlaybackSettings &settings) const
 {
-    QSettings settings;
+    // Set the port for RtMidi, and open enough ports for all of the players.
+    device.initialize(settings.getPreferredApi(), settings.getPreferredPort(),
+                      myChannels->getPortCount());
 
-    const System &system = myScore.getSystems()[location.getSystem()];
+    // Set pitch bend settings for each channel to one octave.
+    const int numChannels =
+        myChannels->getPortCount() * Midi::NUM_MIDI_CHANNELS_PER_PORT;
+    for (int i = 0; i < numChannels; ++i)
+        device.setPitchBendRange(i, BendEvent::PITCH_BEND_RANGE);
+}
+
+void MidiPlayer::performCountIn(MidiOutputDevice &device,
+                                const SystemLocation &location,
+                                const PlaybackSettings &settings)
+{
+    const System &system = myScore->getSystems()[location.getSystem()];
     const Barline *barline = system.getPreviousBarline(location.getPosition());
     // Use the start bar if necessary.
     if (!barline)
@@ -570,16 +844,12 @@ void MidiPlayer::performCountIn(MidiOutputDevice &device,
     const uint8_t beatValue = timeSig.getBeatValue();
 
     // Figure out the duration of a pulse.
-    const double tempo = getCurrentTempo(location.getSystem(), location.getPosition());
+    const double tempo = getCurrentTempo(*myScore, location.getSystem(),
+                                         location.getPosition());
     const double duration = (tempo * 4.0 / beatValue) * beatsPerMeasure / numPulses;
 
-    const uint8_t velocity =
-        settings.value(Settings::MIDI_METRONOME_COUNTIN_VOLUME,
-                       Settings::MIDI_METRONOME_COUNTIN_VOLUME_DEFAULT).toUInt();
-    const uint8_t preset =
-        Midi::MIDI_PERCUSSION_PRESET_OFFSET +
-        settings.value(Settings::MIDI_METRONOME_COUNTIN_PRESET,
-                       Settings::MIDI_METRONOME_COUNTIN_PRESET_DEFAULT).toUInt();
+    const uint8_t velocity = settings.getCountInVolume();
+    const uint8_t preset = settings.getCountInPreset();
 
     const double speedShiftFactor = 100.0 / myPlaybackSpeed;
 
@@ -596,57 +866,42 @@ void MidiPlayer::performCountIn(MidiOutputDevice &device,
     }
 }
 
-void MidiPlayer::playMidiEvents(const EventList &eventList)
+EventWalker::EventWalker(const std::shared_ptr<const Score> &score,
+                         const EventList &eventList,
+                         const SystemLocation &startLocation,
+                         const LocationCallback &systemChanged,
+                         const LocationCallback &positionChanged,
+                         const BarCallback &barStarted)
+    : myScore(score),
+      myEventList(eventList),
+      myRepeatController(new RepeatController(*score)),
+      myNextEvent(eventList.begin()),
+      myStartLocation(startLocation),
+      mySystemChanged(systemChanged),
+      myPositionChanged(positionChanged),
+      myBarStarted(barStarted)
 {
-    boost::optional<SystemLocation> startLocation =
-        SystemLocation(myStartSystem, myStartPosition);
-
-    MidiOutputDevice device;
-    // Set the port for RtMidi.
-    QSettings settings;
-    device.initialize(
-                settings.value(Settings::MIDI_PREFERRED_API,
-                               Settings::MIDI_PREFERRED_API_DEFAULT).toInt(),
-                settings.value(Settings::MIDI_PREFERRED_PORT,
-                               Settings::MIDI_PREFERRED_PORT_DEFAULT).toInt());
-
-    // Set pitch bend settings for each channel to one octave.
-    for (int i = 0; i < Midi::NUM_MIDI_CHANNELS_PER_PORT; ++i)
-        device.setPitchBendRange(i, BendEvent::PITCH_BEND_RANGE);
+}
 
-    if (settings.value(Settings::MIDI_METRONOME_ENABLE_COUNTIN,
-                       Settings::MIDI_METRONOME_ENABLE_COUNTIN_DEFAULT).toBool())
+const MidiEvent *EventWalker::next()
+{
+    while (myNextEvent != myEventList.end())
     {
-        performCountIn(device, *startLocation);
-    }
-
-    RepeatController repeatController(myScore);
-
-    SystemLocation currentLocation;
-    SystemLocation prevLocation;
-
-    typedef EventList::const_iterator MidiEventIterator;
-    MidiEventIterator activeEvent = eventList.begin();
-
-    while (activeEvent != eventList.end())
-    {
-        if (!isPlaying())
-            return;
-
-        const SystemLocation eventLocation((*activeEvent)->getSystem(),
-                                           (*activeEvent)->getPosition());
+        const MidiEvent &event = **myNextEvent;
+        const SystemLocation eventLocation(event.getSystem(),
+                                           event.getPosition());
 
 #if defined(LOG_MIDI_EVENTS)
         qDebug() << "Playback location: " << eventLocation.getSystem() << ", "
                  << eventLocation.getPosition();
 #endif
 
-        if (startLocation)
+        if (myStartLocation)
         {
             // If we haven't reached the starting position yet, keep going.
-            if (eventLocation < *startLocation)
+            if (eventLocation < *myStartLocation)
             {
-                ++activeEvent;
+                ++myNextEvent;
                 continue;
             }
             // If we just reached the starting position, update the system index
@@ -654,58 +909,146 @@ void MidiPlayer::playMidiEvents(const EventList &eventList)
             // system change.
             else
             {
-                emit playbackSystemChanged(startLocation->getSystem());
-                currentLocation.setSystem(startLocation->getSystem());
-                prevLocation = currentLocation;
-                startLocation.reset();
+                if (mySystemChanged)
+                    mySystemChanged(myStartLocation->getSystem());
+                myCurrentLocation.setSystem(myStartLocation->getSystem());
+                myPrevLocation = myCurrentLocation;
+                myStartLocation.reset();
             }
         }
 
         // If we've moved to a new position, move the caret.
-        if (eventLocation.getPosition() > currentLocation.getPosition())
+        if (eventLocation.getPosition() > myCurrentLocation.getPosition())
         {
-            prevLocation = currentLocation;
-            currentLocation.setPosition(eventLocation.getPosition());
-            emit playbackPositionChanged(currentLocation.getPosition());
+            myPrevLocation = myCurrentLocation;
+            myCurrentLocation.setPosition(eventLocation.getPosition());
+            if (myPositionChanged)
+                myPositionChanged(myCurrentLocation.getPosition());
         }
 
         // Moving on to a new system, so we need to reset the position to 0 to
         // ensure playback begins at the start of the staff.
-        if (eventLocation.getSystem() != currentLocation.getSystem())
+        if (eventLocation.getSystem() != myCurrentLocation.getSystem())
         {
-            currentLocation.setSystem(eventLocation.getSystem());
-            currentLocation.setPosition(0);
-            prevLocation = currentLocation;
-            emit playbackSystemChanged(currentLocation.getSystem());
+            myCurrentLocation.setSystem(eventLocation.getSystem());
+            myCurrentLocation.setPosition(0);
+            myPrevLocation = myCurrentLocation;
+            if (mySystemChanged)
+                mySystemChanged(myCurrentLocation.getSystem());
+        }
+
+        // Give the caller a chance to switch to the latest version of the
+        // score at the start of a bar.
+        if (myBarStarted && eventLocation == myCurrentLocation &&
+            ScoreUtils::findByPosition(
+                myScore->getSystems()[myCurrentLocation.getSystem()]
+                    .getBarlines(),
+                myCurrentLocation.getPosition()))
+        {
+            std::shared_ptr<const Score> score = myBarStarted();
+            if (score)
+            {
+                switchScore(score);
+                continue;
+            }
         }
 
         SystemLocation newLocation;
-        if (repeatController.checkForRepeat(prevLocation, currentLocation,
-                                            newLocation))
+        if (myRepeatController->checkForRepeat(myPrevLocation,
+                                               myCurrentLocation, newLocation))
         {
 #ifdef LOG_MIDI_EVENTS
             qDebug() << "Moving to: " << newLocation.getSystem()
                      << ", " << newLocation.getPosition();
-            qDebug() << "From position: " << currentLocation.getSystem()
-                     << ", " << currentLocation.getPosition()
-                     << " at " << activeEvent->getStartTime();
+            qDebug() << "From position: " << myCurrentLocation.getSystem()
+                     << ", " << myCurrentLocation.getPosition()
+                     << " at " << event.getStartTime();
 #endif
-            startLocation = newLocation;
-            currentLocation = prevLocation = SystemLocation(0, 0);
-            emit playbackSystemChanged(startLocation->getSystem());
-            emit playbackPositionChanged(startLocation->getPosition());
-            activeEvent = eventList.begin();
+            myStartLocation = newLocation;
+            myCurrentLocation = myPrevLocation = SystemLocation(0, 0);
+            if (mySystemChanged)
+                mySystemChanged(newLocation.getSystem());
+            if (myPositionChanged)
+                myPositionChanged(newLocation.getPosition());
+            myNextEvent = myEventList.begin();
             continue;
         }
 
-        (*activeEvent)->performEvent(device);
+        ++myNextEvent;
+        return &event;
+    }
+
+    return nullptr;
+}
+
+const MidiEvent *EventWalker::peekNext() const
+{
+    if (myNextEvent == myEventList.end())
+        return nullptr;
+    else
+        return myNextEvent->get();
+}
+
+void EventWalker::switchScore(const std::shared_ptr<const Score> &score)
+{
+    // The current repeat controller refers to the previous score, so keep it
+    // alive until the controller is replaced.
+    std::shared_ptr<const Score> prevScore = myScore;
+    myScore = score;
+
+    std::unique_ptr<RepeatController> controller(
+        new RepeatController(*myScore));
+    controller->copyState(*myRepeatController);
+    myRepeatController = std::move(controller);
+
+    myStartLocation = myCurrentLocation;
+    myCurrentLocation = myPrevLocation = SystemLocation(0, 0);
+    myNextEvent = myEventList.begin();
+}
+
+void MidiPlayer::playMidiEvents(EventList &eventList)
+{
+    const SystemLocation startLocation(myStartSystem, myStartPosition);
+
+    std::shared_ptr<const PlaybackSettings> settings =
+        std::atomic_load(&mySettings);
+
+    MidiOutputDevice device;
+    initializeDevice(device, *settings);
+
+    if (settings->isCountInEnabled())
+        performCountIn(device, startLocation, *settings);
+
+    // Switch to the latest version of the score at the start of a bar, and
+    // resume playback from the same location.
+    EventWalker walker(
+        myScore, eventList, startLocation,
+        [this](int system) { emit playbackSystemChanged(system); },
+        [this](int position) { emit playbackPositionChanged(position); },
+        [&]() {
+            return swapPendingScore(eventList) ? myScore
+                                               : std::shared_ptr<const Score>();
+        });
+
+    while (const MidiEvent *event = walker.next())
+    {
+        if (!isPlaying())
+            return;
+
+        // Pick up any changes to the settings since the previous event.
+        if (mySettingsChanged.exchange(false))
+            settings = std::atomic_load(&mySettings);
+        {
+            PTE_TRACE_SCOPE("MidiPlayer::performEvent");
+            event->performEvent(device, *settings);
+        }
 
         // Add delay between this event and the next one.
-        MidiEventIterator nextEvent = boost::next(activeEvent);
-        if (nextEvent != eventList.end())
+        const MidiEvent *nextEvent = walker.peekNext();
+        if (nextEvent)
         {
-            const int sleepDuration = abs((*nextEvent)->getStartTime() -
-                                          (*activeEvent)->getStartTime());
+            const int sleepDuration =
+                abs(nextEvent->getStartTime() - event->getStartTime());
 
             // Slow down or speed up playback.
             const double speedShiftFactor = 100.0 / myPlaybackSpeed;
@@ -717,17 +1060,164 @@ void MidiPlayer::playMidiEvents(const EventList &eventList)
         }
         else // last note
         {
-            usleep(1000 * (*activeEvent)->getDuration());
+            usleep(1000 * event->getDuration());
         }
+    }
+}
+
+void MidiPlayer::generatePerformance(EventList &eventList,
+                                     ScheduledEventList &performance)
+{
+    myChannels.reset(new ChannelAllocator(*myScore));
+    eventList = generateEvents(*myScore, *myChannels,
+                               *std::atomic_load(&mySettings));
+    performance.clear();
 
-        ++activeEvent;
+    const double speedShiftFactor = 100.0 / myPlaybackSpeed;
+    double currentTime = 0;
+
+    // Record when each event would be performed instead of waiting for it.
+    EventWalker walker(myScore, eventList,
+                       SystemLocation(myStartSystem, myStartPosition));
+    while (const MidiEvent *event = walker.next())
+    {
+        performance.push_back(std::make_pair(currentTime, event));
+
+        const MidiEvent *nextEvent = walker.peekNext();
+        if (nextEvent)
+        {
+            currentTime +=
+                std::abs(nextEvent->getStartTime() - event->getStartTime()) *
+                speedShiftFactor;
+        }
     }
 }
 
-double MidiPlayer::getCurrentTempo(int system, int position) const
+double MidiPlayer::findLoopEvents(const EventList &eventList,
+                                  ScheduledEventList &loopEvents) const
 {
-    const TempoMarker *marker = getCurrentTempoMarker(system, position);
+    loopEvents.clear();
+
+    const SystemLocation loopStart(myStartSystem, myStartPosition);
+    const SystemLocation loopEnd(myStartSystem, *myLoopEndPosition);
+
+    // The loop begins with its first event, and ends when the first event
+    // after the loop would begin (or when its last event ends, if the loop
+    // is at the end of the score).
+    boost::optional<double> startTime;
+    boost::optional<double> endTime;
+    double lastEventEnd = 0;
+
+    for (const std::unique_ptr<MidiEvent> &event : eventList)
+    {
+        const SystemLocation location(event->getSystem(),
+                                      event->getPosition());
+        if (location < loopStart)
+            continue;
+        else if (loopEnd < location)
+        {
+            if (!endTime || event->getStartTime() < *endTime)
+                endTime = event->getStartTime();
+            continue;
+        }
+
+        if (!startTime)
+            startTime = event->getStartTime();
+
+        loopEvents.push_back(std::make_pair(event->getStartTime(),
+                                            event.get()));
+        lastEventEnd = std::max(lastEventEnd, event->getStartTime() +
+                                                  event->getDuration());
+    }
+
+    if (!startTime)
+        return 0;
+
+    const double duration = (endTime ? *endTime : lastEventEnd) - *startTime;
 
+    // Any notes that ring past the end of the loop are stopped before the
+    // next pass begins.
+    for (auto &event : loopEvents)
+        event.first = std::min(event.first - *startTime, duration);
+
+    return duration;
+}
+
+void MidiPlayer::playLoop(EventList &eventList)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::shared_ptr<const PlaybackSettings> settings =
+        std::atomic_load(&mySettings);
+
+    MidiOutputDevice device;
+    initializeDevice(device, *settings);
+
+    const SystemLocation loopStart(myStartSystem, myStartPosition);
+    if (settings->isCountInEnabled())
+        performCountIn(device, loopStart, *settings);
+
+    ScheduledEventList loopEvents;
+    double loopDuration = findLoopEvents(eventList, loopEvents);
+
+    Clock::time_point nextEventTime = Clock::now();
+    double prevEventTime = 0;
+
+    for (int pass = 0; loopDuration > 0; ++pass)
+    {
+        // The playback speed can be gradually increased after each pass, up
+        // to the original tempo.
+        const int speedIncrease = pass * settings->getLoopSpeedIncrement();
+        auto getSpeedShiftFactor = [=]() {
+            const int speed = myPlaybackSpeed;
+            return 100.0 /
+                   std::min(speed + speedIncrease, std::max(speed, 100));
+        };
+
+        emit playbackSystemChanged(myStartSystem);
+        emit playbackPositionChanged(myStartPosition);
+        int currentPosition = myStartPosition;
+
+        for (auto &event : loopEvents)
+        {
+            nextEventTime += std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::milli>(
+                    (event.first - prevEventTime) * getSpeedShiftFactor()));
+            prevEventTime = event.first;
+
+            const auto delay = std::chrono::duration_cast<
+                std::chrono::microseconds>(nextEventTime - Clock::now());
+            if (delay.count() > 0)
+                usleep(delay.count());
+
+            if (!isPlaying())
+                return;
+
+            if (event.second->getPosition() > currentPosition)
+            {
+                currentPosition = event.second->getPosition();
+                emit playbackPositionChanged(currentPosition);
+            }
+
+            if (mySettingsChanged.exchange(false))
+                settings = std::atomic_load(&mySettings);
+            event.second->performEvent(device, *settings);
+        }
+
+        // The next pass starts exactly one loop duration after this one.
+        nextEventTime += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(
+                (loopDuration - prevEventTime) * getSpeedShiftFactor()));
+        prevEventTime = 0;
+
+        // Pick up any edits to the score between passes.
+        if (swapPendingScore(eventList))
+            loopDuration = findLoopEvents(eventList, loopEvents);
+    }
+}
+
+double MidiPlayer::getQuarterNoteDuration(const TempoMarker *marker)
+{
     // Default tempo in case there is no tempo marker in the score.
     double bpm = TempoMarker::DEFAULT_BEATS_PER_MINUTE;
     TempoMarker::BeatType beatType = TempoMarker::Quarter;
@@ -759,42 +1249,17 @@ double MidiPlayer::getCurrentTempo(int system, int position) const
     return (60.0 / (bpm * factor) * 1000.0);
 }
 
-const TempoMarker *MidiPlayer::getCurrentTempoMarker(int systemIndex,
-                                                     int position) const
-{
-    const TempoMarker *lastMarker = nullptr;
-
-    int i = 0;
-    for (const System &system : myScore.getSystems())
-    {
-        if (i > systemIndex)
-            break;
-
-        for (const TempoMarker &marker : system.getTempoMarkers())
-        {
-            if (i < systemIndex ||
-               (i == systemIndex && marker.getPosition() <= position))
-            {
-                lastMarker = &marker;
-            }
-        }
-
-        ++i;
-    }
-
-    return lastMarker;
-}
-
-double MidiPlayer::calculateNoteDuration(int system, const Voice &voice,
-                                         const Position &pos) const
+double EventGenerator::calculateNoteDuration(int system, const Voice &voice,
+                                             const Position &pos) const
 {
-    const double tempo = getCurrentTempo(system, pos.getPosition());
+    const double tempo = getCurrentTempo(myScore, system, pos.getPosition());
     return VoiceUtils::getDurationTime(voice, pos) * tempo;
 }
 
-double MidiPlayer::getWholeRestDuration(const System &system, int systemIndex,
-                                        const Voice &voice, const Position &pos,
-                                        double originalDuration) const
+double EventGenerator::getWholeRestDuration(const System &system,
+                                            int systemIndex, const Voice &voice,
+                                            const Position &pos,
+                                            double originalDuration) const
 {
     const Barline *prevBar = system.getPreviousBarline(pos.getPosition());
     // Use the start bar if necessary.
@@ -818,7 +1283,8 @@ double MidiPlayer::getWholeRestDuration(const System &system, int systemIndex,
     // Otherwise, extend the rest for the entire bar.
     const TimeSignature& currentTimeSignature = prevBar->getTimeSignature();
 
-    const double tempo = getCurrentTempo(systemIndex, pos.getPosition());
+    const double tempo =
+        getCurrentTempo(myScore, systemIndex, pos.getPosition());
     double beatDuration = currentTimeSignature.getBeatValue();
     double duration = tempo * 4.0 / beatDuration;
     int numBeats = currentTimeSignature.getBeatsPerMeasure();
@@ -827,10 +1293,12 @@ double MidiPlayer::getWholeRestDuration(const System &system, int systemIndex,
     return duration;
 }
 
-double MidiPlayer::generateMetronome(const System &system, int systemIndex,
-                                     const Barline &barline, double startTime,
-                                     const double notesEndTime,
-                                     EventList &eventList) const
+double EventGenerator::generateMetronome(const System &system,
+                                         int systemIndex,
+                                         const Barline &barline,
+                                         double startTime,
+                                         const double notesEndTime,
+                                         EventList &eventList) const
 {
     const TimeSignature& timeSig = barline.getTimeSignature();
 
@@ -842,7 +1310,7 @@ double MidiPlayer::generateMetronome(const System &system, int systemIndex,
     const int position = barline.getPosition();
 
     // Figure out duration of pulse.
-    const double tempo = getCurrentTempo(systemIndex, position);
+    const double tempo = getCurrentTempo(myScore, systemIndex, position);
     const double duration = (tempo * 4.0 / beatValue) * beatsPerMeasure / numPulses;
 
     // Check for multi-bar rests, as we need to generate more metronome events
@@ -874,6 +1342,8 @@ double MidiPlayer::generateMetronome(const System &system, int systemIndex,
                                       (notesEndTime - startTime) / duration);
     }
 
+    const uint8_t metronomePreset = mySettings.getMetronomePreset();
+
     for (int repeat = 0; repeat < repeatCount; ++repeat)
     {
         for (uint8_t i = 0; i < numPulses; ++i)
@@ -888,7 +1358,7 @@ double MidiPlayer::generateMetronome(const System &system, int systemIndex,
             startTime += duration;
             eventList.emplace_back(new StopNoteEvent(
                 METRONOME_CHANNEL, startTime, position, systemIndex,
-                MetronomeEvent::getMetronomePreset()));
+                metronomePreset));
         }
     }
 
@@ -896,7 +1366,8 @@ double MidiPlayer::generateMetronome(const System &system, int systemIndex,
     return startTime;
 }
 
-int MidiPlayer::getActualNotePitch(const Note &note, const Tuning &tuning) const
+int EventGenerator::getActualNotePitch(const Note &note,
+                                       const Tuning &tuning) const
 {
     const int openStringPitch = tuning.getNote(note.getString(), false) +
             tuning.getCapo();
@@ -924,10 +1395,10 @@ int MidiPlayer::getActualNotePitch(const Note &note, const Tuning &tuning) const
     return pitch;
 }
 
-void MidiPlayer::generateBends(std::vector<BendEventInfo> &bends,
-                               uint8_t &activePitchBend, double startTime,
-                               double duration, double currentTempo,
-                               const Note &note)
+void EventGenerator::generateBends(std::vector<BendEventInfo> &bends,
+                                   uint8_t &activePitchBend, double startTime,
+                                   double duration, double currentTempo,
+                                   const Note &note) const
 {
     const Bend &bend = note.getBend();
 
@@ -1008,10 +1479,10 @@ void MidiPlayer::generateBends(std::vector<BendEventInfo> &bends,
         activePitchBend = releaseAmount;
 }
 
-void MidiPlayer::generateGradualBend(std::vector<BendEventInfo> &bends,
-                                     double startTime, double duration,
-                                     int startBendAmount,
-                                     int releaseBendAmount) const
+void EventGenerator::generateGradualBend(std::vector<BendEventInfo> &bends,
+                                         double startTime, double duration,
+                                         int startBendAmount,
+                                         int releaseBendAmount) const
 {
     const int numBendEvents = abs(startBendAmount - releaseBendAmount);
     const double bendEventDuration = duration / numBendEvents;
@@ -1026,8 +1497,8 @@ void MidiPlayer::generateGradualBend(std::vector<BendEventInfo> &bends,
     }
 }
 
-MidiPlayer::BendEventInfo::BendEventInfo(double timestamp,
-                                         uint8_t pitchBendAmount)
+EventGenerator::BendEventInfo::BendEventInfo(double timestamp,
+                                             uint8_t pitchBendAmount)
     : timestamp(timestamp), pitchBendAmount(pitchBendAmount)
 {
 }
@@ -1038,10 +1509,10 @@ void MidiPlayer::changePlaybackSpeed(int newPlaybackSpeed)
 }
 
 /// Generates slides for the given note
-void MidiPlayer::generateSlides(std::vector<BendEventInfo> &bends,
-                                double startTime, double noteDuration,
-                                double currentTempo, const Note &note,
-                                const Note *nextNote)
+void EventGenerator::generateSlides(std::vector<BendEventInfo> &bends,
+                                    double startTime, double noteDuration,
+                                    double currentTempo, const Note &note,
+                                    const Note *nextNote) const
 {
     const int SLIDE_OUT_OF_STEPS = 5;
 
@@ -1106,8 +1577,10 @@ void MidiPlayer::generateSlides(std::vector<BendEventInfo> &bends,
 }
 
 #if 0
-void MidiPlayer::generateTremoloBar(std::vector<BendEventInfo>& bends, double startTime,
-                                    double noteDuration, double currentTempo, const Position* position)
+void EventGenerator::generateTremoloBar(std::vector<BendEventInfo>& bends,
+                                        double startTime, double noteDuration,
+                                        double currentTempo,
+                                        const Position* position)
 {
     uint8_t type = 0, duration = 0, pitch = 0;
     position->GetTremoloBar(type, duration, pitch);
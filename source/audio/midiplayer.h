@@ -19,34 +19,71 @@
 #define AUDIO_MIDIPLAYER_H
 
 #include <atomic>
-#include <cstdint>
+#include <boost/optional/optional.hpp>
 #include <memory>
 #include <QThread>
+#include <QThreadPool>
+#include <utility>
+#include <vector>
 
-class Barline;
+class ChannelAllocator;
 class MidiEvent;
 class MidiOutputDevice;
-class Note;
-class Position;
+class PlaybackSettings;
 class Score;
 class SystemLocation;
-class Staff;
-class System;
 class TempoMarker;
-class Tuning;
-class Voice;
 
 class MidiPlayer : public QThread
 {
     Q_OBJECT
 
 public:
-    MidiPlayer(const Score &score, int startSystem, int startPosition,
-               int speed);
+    typedef std::vector<std::unique_ptr<MidiEvent>> EventList;
+    /// A sequence of events, along with the time (in milliseconds) at which
+    /// each event is performed.
+    typedef std::vector<std::pair<double, const MidiEvent *>>
+        ScheduledEventList;
+
+    /// The player uses its own copy of the score, so the original score can
+    /// be edited during playback.
+    MidiPlayer(const std::shared_ptr<const Score> &score, int startSystem,
+               int startPosition, int speed);
     ~MidiPlayer();
 
     void changePlaybackSpeed(int newPlaybackSpeed);
 
+    /// Plays the positions from the start position up to and including the
+    /// given position repeatedly, until playback is stopped. This must be
+    /// called before the player is started.
+    void enableLooping(int endPosition);
+
+    /// Replaces the settings used by the playback thread. The new settings
+    /// take effect at the next event.
+    void updateSettings(const std::shared_ptr<const PlaybackSettings> &settings);
+
+    /// Replaces the score that is being played (e.g. after an edit). The
+    /// events for the new score are generated in the background, and the new
+    /// score takes effect at the start of the next bar after they are ready.
+    void updateScore(const std::shared_ptr<const Score> &score);
+
+    /// Generates the events for the score and lays them out in the order they
+    /// would be played, following any repeats or directions, without
+    /// performing them. This can be used to render the score offline.
+    void generatePerformance(EventList &eventList,
+                             ScheduledEventList &performance);
+
+    /// Generates the events for the entire score, sorted by start time. This
+    /// doesn't use any of the player's state, so it can be called from any
+    /// thread.
+    static EventList generateEvents(const Score &score,
+                                    const ChannelAllocator &channels,
+                                    const PlaybackSettings &settings);
+
+    /// Returns the duration of a quarter note in milliseconds for the given
+    /// tempo marker, or for the default tempo if there is no tempo marker.
+    static double getQuarterNoteDuration(const TempoMarker *marker);
+
 signals:
     // These signals are used to move the caret when a position change is
     // necessary
@@ -54,86 +91,73 @@ signals:
     void playbackPositionChanged(int position);
 
 private:
-    typedef std::vector<std::unique_ptr<MidiEvent>> EventList;
-
     virtual void run() override;
     void setIsPlaying(bool set);
     bool isPlaying() const;
 
-    void generateEvents(EventList &eventList);
-    void playMidiEvents(const EventList &eventList);
+    void playMidiEvents(EventList &eventList);
+
+    /// Finds the events that are inside the loop.
+    /// @returns The duration of a single pass through the loop.
+    double findLoopEvents(const EventList &eventList,
+                          ScheduledEventList &loopEvents) const;
+    /// Plays the loop repeatedly. The start of each event is scheduled
+    /// relative to the start of playback rather than to the previous event,
+    /// so that timing errors don't accumulate between passes.
+    void playLoop(EventList &eventList);
+
+    /// Generates the events for a new version of the score, and makes it
+    /// available to the playback thread. This is run in the background.
+    void preparePendingScore(const std::shared_ptr<const Score> &score,
+                             int version);
+    /// Switches to the pending score and its events, if one was prepared by
+    /// updateScore().
+    bool swapPendingScore(EventList &eventList);
+    /// Opens the output ports and sets up each channel.
+    void initializeDevice(MidiOutputDevice &device,
+                          const PlaybackSettings &settings) const;
     void performCountIn(MidiOutputDevice &device,
-                        const SystemLocation &location);
-
-    /// Generates a list of all notes in the given bar.
-    /// @returns The timestamp of the end of the last event in the bar.
-    double generateEventsForBar(const System &system, int systemIndex,
-                                const Staff &staff, int staffIndex,
-                                const Voice &voice, int voiceIndex, int leftPos,
-                                int rightPos, const double barStartTime,
-                                EventList &eventList, uint8_t &activePitchBend);
-
-    /// Returns the current tempo (duration of a quarter note in milliseconds).
-    double getCurrentTempo(int system, int position) const;
-
-    /// Returns the active tempo marker, if one exists.
-    const TempoMarker *getCurrentTempoMarker(int systemIndex, int position) const;
-
-    /// Calculates the duration of a note in the given position.
-    double calculateNoteDuration(int system, const Voice &voice,
-                                 const Position &pos) const;
-
-    /// Computes the duration of a whole rest. If it's the only rest/note in the
-    /// bar, then it lasts for the entire bar instead of 4 beats.
-    double getWholeRestDuration(const System &system, int systemIndex,
-                                const Voice &voice, const Position &pos,
-                                double originalDuration) const;
-
-    /// Computes the pitch of a note, including things like harmonics.
-    int getActualNotePitch(const Note &note, const Tuning &tuning) const;
-
-    /// Generates metronome events for a bar.
-    /// @param notesEndTime The timestamp of the last note event in the bar.
-    double generateMetronome(const System &system, int systemIndex,
-                             const Barline &barline, double startTime,
-                             const double notesEndTime,
-                             EventList &eventList) const;
-
-    const Score &myScore;
+                        const SystemLocation &location,
+                        const PlaybackSettings &settings);
+
+    /// A newer version of the score, along with its events.
+    struct PendingScore
+    {
+        std::shared_ptr<const Score> myScore;
+        std::unique_ptr<ChannelAllocator> myChannels;
+        EventList myEvents;
+    };
+
+    /// The score being played. This is only accessed by the playback thread.
+    std::shared_ptr<const Score> myScore;
+    /// The latest prepared version of the score, which is handed to the
+    /// playback thread. This must only be accessed with std::atomic_store /
+    /// std::atomic_exchange. These use a lock internally rather than being
+    /// lock-free, so the playback thread only takes the score after
+    /// myHasPendingScore is set.
+    std::shared_ptr<PendingScore> myPendingScore;
+    std::atomic<bool> myHasPendingScore;
+    /// Incremented for each call to updateScore(), so that the background
+    /// thread can skip versions of the score that were already replaced.
+    std::atomic<int> myScoreVersion;
+    /// Prepares the pending scores one at a time, in the order they were
+    /// provided.
+    QThreadPool myPreparePool;
+    /// The channel assigned to each player in the current score.
+    std::unique_ptr<ChannelAllocator> myChannels;
     const int myStartSystem;
     const int myStartPosition;
+    /// The last position of the loop, if looping is enabled.
+    boost::optional<int> myLoopEndPosition;
     std::atomic<bool> myIsPlaying;
     /// The current playback speed (percent).
     std::atomic<int> myPlaybackSpeed;
-
-    /// Holds basic information about a bend - used to simplify the generateBends function
-    struct BendEventInfo
-    {
-        BendEventInfo(double timestamp, uint8_t pitchBendAmout);
-
-        double timestamp;
-        uint8_t pitchBendAmount;
-    };
-
-    void generateBends(std::vector<BendEventInfo> &bends,
-                       uint8_t &activePitchBend, double startTime,
-                       double duration, double currentTempo, const Note &note);
-
-    void generateSlides(std::vector<BendEventInfo> &bends, double startTime,
-                        double noteDuration, double currentTempo,
-                        const Note &note, const Note *nextNote);
-
-    /// Generates a series of BendEvents to perform a gradual bend over the
-    /// given duration. Bends the note from the startBendAmount to the
-    /// releaseBendAmount over the note duration.
-    void generateGradualBend(std::vector<BendEventInfo> &bends,
-                             double startTime, double duration,
-                             int startBendAmount, int releaseBendAmount) const;
-#if 0
-    void generateTremoloBar(std::vector<BendEventInfo>& bends, double startTime,
-                            double noteDuration, double currentTempo, const Position* position);
-#endif
-
+    /// Snapshot of the playback settings. This is shared with the GUI thread,
+    /// so it must only be accessed with std::atomic_load / std::atomic_store.
+    /// Like myPendingScore, these aren't lock-free, so during playback the
+    /// settings are only loaded again after mySettingsChanged is set.
+    std::shared_ptr<const PlaybackSettings> mySettings;
+    std::atomic<bool> mySettingsChanged;
 };
 
 #endif
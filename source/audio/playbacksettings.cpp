@@ -0,0 +1,129 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "playbacksettings.h"
+
+#include <app/settings.h>
+#include <QSettings>
+#include <score/generalmidi.h>
+
+PlaybackSettings::PlaybackSettings()
+{
+    QSettings settings;
+
+    myPreferredApi = settings.value(Settings::MIDI_PREFERRED_API,
+                                    Settings::MIDI_PREFERRED_API_DEFAULT).toInt();
+    myPreferredPort =
+        settings.value(Settings::MIDI_PREFERRED_PORT,
+                       Settings::MIDI_PREFERRED_PORT_DEFAULT).toInt();
+
+    myVibratoLevel =
+        settings.value(Settings::MIDI_VIBRATO_LEVEL,
+                       Settings::MIDI_VIBRATO_LEVEL_DEFAULT).toUInt();
+    myWideVibratoLevel =
+        settings.value(Settings::MIDI_WIDE_VIBRATO_LEVEL,
+                       Settings::MIDI_WIDE_VIBRATO_LEVEL_DEFAULT).toUInt();
+
+    myMetronomeEnabled =
+        settings.value(Settings::MIDI_METRONOME_ENABLED,
+                       Settings::MIDI_METRONOME_ENABLED_DEFAULT).toBool();
+    myMetronomePreset =
+        Midi::MIDI_PERCUSSION_PRESET_OFFSET +
+        settings.value(Settings::MIDI_METRONOME_PRESET,
+                       Settings::MIDI_METRONOME_PRESET_DEFAULT).toUInt();
+    myStrongAccentVolume =
+        settings.value(Settings::MIDI_METRONOME_STRONG_ACCENT,
+                       Settings::MIDI_METRONOME_STRONG_ACCENT_DEFAULT).toUInt();
+    myWeakAccentVolume =
+        settings.value(Settings::MIDI_METRONOME_WEAK_ACCENT,
+                       Settings::MIDI_METRONOME_WEAK_ACCENT_DEFAULT).toUInt();
+
+    myCountInEnabled =
+        settings.value(Settings::MIDI_METRONOME_ENABLE_COUNTIN,
+                       Settings::MIDI_METRONOME_ENABLE_COUNTIN_DEFAULT).toBool();
+    myCountInPreset =
+        Midi::MIDI_PERCUSSION_PRESET_OFFSET +
+        settings.value(Settings::MIDI_METRONOME_COUNTIN_PRESET,
+                       Settings::MIDI_METRONOME_COUNTIN_PRESET_DEFAULT).toUInt();
+    myCountInVolume =
+        settings.value(Settings::MIDI_METRONOME_COUNTIN_VOLUME,
+                       Settings::MIDI_METRONOME_COUNTIN_VOLUME_DEFAULT).toUInt();
+
+    myLoopSpeedIncrement =
+        settings.value(Settings::MIDI_LOOP_SPEED_INCREMENT,
+                       Settings::MIDI_LOOP_SPEED_INCREMENT_DEFAULT).toInt();
+}
+
+int PlaybackSettings::getPreferredApi() const
+{
+    return myPreferredApi;
+}
+
+int PlaybackSettings::getPreferredPort() const
+{
+    return myPreferredPort;
+}
+
+uint8_t PlaybackSettings::getVibratoLevel() const
+{
+    return myVibratoLevel;
+}
+
+uint8_t PlaybackSettings::getWideVibratoLevel() const
+{
+    return myWideVibratoLevel;
+}
+
+bool PlaybackSettings::isMetronomeEnabled() const
+{
+    return myMetronomeEnabled;
+}
+
+uint8_t PlaybackSettings::getMetronomePreset() const
+{
+    return myMetronomePreset;
+}
+
+uint8_t PlaybackSettings::getStrongAccentVolume() const
+{
+    return myStrongAccentVolume;
+}
+
+uint8_t PlaybackSettings::getWeakAccentVolume() const
+{
+    return myWeakAccentVolume;
+}
+
+bool PlaybackSettings::isCountInEnabled() const
+{
+    return myCountInEnabled;
+}
+
+uint8_t PlaybackSettings::getCountInPreset() const
+{
+    return myCountInPreset;
+}
+
+uint8_t PlaybackSettings::getCountInVolume() const
+{
+    return myCountInVolume;
+}
+
+int PlaybackSettings::getLoopSpeedIncrement() const
+{
+    return myLoopSpeedIncrement;
+}
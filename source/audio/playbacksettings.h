@@ -0,0 +1,69 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUDIO_PLAYBACKSETTINGS_H
+#define AUDIO_PLAYBACKSETTINGS_H
+
+#include <cstdint>
+
+/// An immutable snapshot of the settings that are used during playback.
+/// The playback thread reads these fields directly instead of accessing
+/// QSettings, which can lock or sync to disk in the middle of playback.
+class PlaybackSettings
+{
+public:
+    /// Reads the current values from QSettings. This should be done from the
+    /// GUI thread.
+    PlaybackSettings();
+
+    int getPreferredApi() const;
+    int getPreferredPort() const;
+
+    uint8_t getVibratoLevel() const;
+    uint8_t getWideVibratoLevel() const;
+
+    bool isMetronomeEnabled() const;
+    /// Returns the note used for the metronome in the percussion channel.
+    uint8_t getMetronomePreset() const;
+    uint8_t getStrongAccentVolume() const;
+    uint8_t getWeakAccentVolume() const;
+
+    bool isCountInEnabled() const;
+    /// Returns the note used for the count-in in the percussion channel.
+    uint8_t getCountInPreset() const;
+    uint8_t getCountInVolume() const;
+
+    /// Returns the amount (in percent) by which the playback speed is
+    /// increased after each pass through a loop.
+    int getLoopSpeedIncrement() const;
+
+private:
+    int myPreferredApi;
+    int myPreferredPort;
+    uint8_t myVibratoLevel;
+    uint8_t myWideVibratoLevel;
+    bool myMetronomeEnabled;
+    uint8_t myMetronomePreset;
+    uint8_t myStrongAccentVolume;
+    uint8_t myWeakAccentVolume;
+    bool myCountInEnabled;
+    uint8_t myCountInPreset;
+    uint8_t myCountInVolume;
+    int myLoopSpeedIncrement;
+};
+
+#endif
@@ -39,7 +39,8 @@ PlayNoteEvent::PlayNoteEvent(int channel, double startTime, double duration,
 {
 }
 
-void PlayNoteEvent::performEvent(MidiOutputDevice &device) const
+void PlayNoteEvent::performEvent(MidiOutputDevice &device,
+                                 const PlaybackSettings &) const
 {
 #if defined(LOG_MIDI_EVENTS)
     qDebug() << "Play Note: " << mySystem << ", " << myPosition << " at " <<
@@ -40,7 +40,8 @@ public:
                   const Instrument &instrument, bool isMuted,
                   VelocityType velocity);
 
-    virtual void performEvent(MidiOutputDevice &device) const override;
+    virtual void performEvent(MidiOutputDevice &device,
+                              const PlaybackSettings &settings) const override;
 
 private:
     const uint8_t myPitch;
@@ -0,0 +1,175 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pluckedstring.h"
+
+#include <algorithm>
+#include <cmath>
+
+/// Extra space in the delay line, so that the history only needs to be moved
+/// occasionally.
+static const int BUFFER_PADDING = 256;
+/// The string is considered silent below this level (about -80dB).
+static const float SILENCE_THRESHOLD = 1e-4f;
+/// Decay time (in seconds) after the string is released.
+static const double RELEASE_TIME = 0.08;
+/// How often (in samples) to check whether the string has become silent.
+static const int CHECK_INTERVAL = 4096;
+
+PluckedString::PluckedString(int sampleRate, double frequency,
+                             double velocity, uint32_t seed)
+    : mySampleRate(sampleRate),
+      myFrequency(frequency),
+      myIsReleased(false),
+      myIsFinished(false),
+      mySamplesSinceCheck(0)
+{
+    // Lower notes ring for longer.
+    myDecayTime = std::min(std::max(4.0 * std::sqrt(82.4 / frequency), 0.5),
+                           8.0);
+
+    // Leave enough room to bend the note down by two octaves.
+    myHistorySize = static_cast<int>(sampleRate / (frequency * 0.25)) + 3;
+    myBuffer.assign(myHistorySize + BUFFER_PADDING, 0.0f);
+    myWritePos = myHistorySize;
+
+    updateFilter();
+
+    // Fill the delay line with noise. Softer notes are darker as well as
+    // quieter.
+    const int length = myDelay + 2;
+    const float brightness = static_cast<float>(0.2 + 0.7 * velocity);
+    std::vector<float> noise(length);
+    uint32_t state = seed ? seed : 1;
+    float filtered = 0;
+    for (float &sample : noise)
+    {
+        state = state * 1664525u + 1013904223u;
+        const float white = (state >> 8) / static_cast<float>(1 << 23) - 1.0f;
+        filtered += brightness * (white - filtered);
+        sample = filtered;
+    }
+
+    // Remove any DC offset, which would otherwise never decay.
+    float mean = 0;
+    for (float sample : noise)
+        mean += sample;
+    mean /= length;
+
+    float *excitation = &myBuffer[myWritePos - length];
+    for (int i = 0; i < length; ++i)
+        excitation[i] = static_cast<float>(velocity) * (noise[i] - mean);
+}
+
+void PluckedString::setFrequency(double frequency)
+{
+    myFrequency = frequency;
+    updateFilter();
+}
+
+void PluckedString::setDecayTime(double seconds)
+{
+    myDecayTime = seconds;
+    updateFilter();
+}
+
+void PluckedString::release()
+{
+    myIsReleased = true;
+    updateFilter();
+}
+
+void PluckedString::updateFilter()
+{
+    // The two-point average in the loop adds half a sample of delay.
+    double delay = std::max(mySampleRate / myFrequency - 0.5, 1.0);
+    delay = std::min(delay, myHistorySize - 2.0);
+
+    myDelay = static_cast<int>(delay);
+    const double fraction = delay - myDelay;
+
+    // Choose the loop gain so that the note decays by 60dB over the decay
+    // time.
+    const double decayTime =
+        myIsReleased ? std::min(RELEASE_TIME, myDecayTime) : myDecayTime;
+    const double gain =
+        std::pow(10.0, -3.0 * (delay + 0.5) / (decayTime * mySampleRate));
+
+    // The two-point average, convolved with the linear interpolation for the
+    // fractional delay.
+    myCoeffs[0] = static_cast<float>(0.5 * gain * (1 - fraction));
+    myCoeffs[1] = static_cast<float>(0.5 * gain);
+    myCoeffs[2] = static_cast<float>(0.5 * gain * fraction);
+}
+
+void PluckedString::render(float *output, int count)
+{
+    const float c0 = myCoeffs[0];
+    const float c1 = myCoeffs[1];
+    const float c2 = myCoeffs[2];
+
+    while (count > 0 && !myIsFinished)
+    {
+        if (myWritePos == static_cast<int>(myBuffer.size()))
+        {
+            std::copy(myBuffer.end() - myHistorySize, myBuffer.end(),
+                      myBuffer.begin());
+            myWritePos = myHistorySize;
+        }
+
+        // Each sample only depends on samples from at least one period ago,
+        // so a block of up to one period can be computed without any
+        // dependencies between iterations, which allows the compiler to
+        // vectorize these loops.
+        const int n = std::min(
+            std::min(count, myDelay),
+            static_cast<int>(myBuffer.size()) - myWritePos);
+
+        float *y = &myBuffer[myWritePos];
+        const float *y0 = y - myDelay;
+        const float *y1 = y0 - 1;
+        const float *y2 = y0 - 2;
+
+        for (int i = 0; i < n; ++i)
+            y[i] = c0 * y0[i] + c1 * y1[i] + c2 * y2[i];
+
+        for (int i = 0; i < n; ++i)
+            output[i] += y[i];
+
+        myWritePos += n;
+        output += n;
+        count -= n;
+
+        // Occasionally check the level over the most recent period.
+        mySamplesSinceCheck += n;
+        if (mySamplesSinceCheck >= CHECK_INTERVAL)
+        {
+            mySamplesSinceCheck = 0;
+
+            float peak = 0;
+            for (int i = myWritePos - myDelay - 2; i < myWritePos; ++i)
+                peak = std::max(peak, std::abs(myBuffer[i]));
+
+            myIsFinished = peak < SILENCE_THRESHOLD;
+        }
+    }
+}
+
+bool PluckedString::isFinished() const
+{
+    return myIsFinished;
+}
@@ -0,0 +1,79 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUDIO_PLUCKEDSTRING_H
+#define AUDIO_PLUCKEDSTRING_H
+
+#include <cstdint>
+#include <vector>
+
+/// A Karplus-Strong plucked string, which is used to synthesize guitar and
+/// bass notes without requiring a soundfont.
+/// The string is excited with a burst of filtered noise, which then
+/// circulates through a damped delay line whose length sets the pitch.
+class PluckedString
+{
+public:
+    /// @param velocity The strength of the pluck, from 0 to 1.
+    /// @param seed Seeds the noise burst, so that rendering is
+    /// deterministic.
+    PluckedString(int sampleRate, double frequency, double velocity,
+                  uint32_t seed);
+
+    /// Changes the pitch of the string (e.g. for bends or vibrato). The
+    /// frequency cannot be lowered by more than two octaves.
+    void setFrequency(double frequency);
+
+    /// Sets the time (in seconds) for the note to decay by 60dB.
+    void setDecayTime(double seconds);
+
+    /// Damps the string, so that the note dies away quickly.
+    void release();
+
+    /// Adds the next samples to the output buffer.
+    void render(float *output, int count);
+
+    /// Returns whether the string has become silent.
+    bool isFinished() const;
+
+private:
+    void updateFilter();
+
+    const int mySampleRate;
+    double myFrequency;
+    double myDecayTime;
+    bool myIsReleased;
+    bool myIsFinished;
+
+    /// The delay line, which holds the most recent output samples. Samples
+    /// are appended at myWritePos, and the history is moved back to the
+    /// start of the buffer when the end is reached.
+    std::vector<float> myBuffer;
+    int myWritePos;
+    /// The number of samples of history that are kept.
+    int myHistorySize;
+
+    /// The integer part of the loop delay.
+    int myDelay;
+    /// The filter taps, which combine the loop's lowpass filter and the
+    /// interpolation for the fractional part of the delay.
+    float myCoeffs[3];
+
+    int mySamplesSinceCheck;
+};
+
+#endif
@@ -17,6 +17,7 @@
 
 #include "repeatcontroller.h"
 
+#include <algorithm>
 #include <iostream>
 #include <score/score.h>
 #include <score/utils.h>
@@ -77,6 +78,25 @@ SystemLocation RepeatState::performRepeat(const SystemLocation &loc)
     }
 }
 
+void RepeatState::copyState(const RepeatState &other)
+{
+    myActiveRepeat = other.myActiveRepeat;
+
+    // Subtract the repeats that were already performed, since the repeat
+    // count may have been changed in the new version of the score.
+    for (auto &repeat : myRemainingRepeats)
+    {
+        auto otherRepeat = other.myRemainingRepeats.find(repeat.first);
+        if (otherRepeat != other.myRemainingRepeats.end())
+        {
+            const int performed =
+                other.myRepeatedSection.getRepeatEndBars().at(repeat.first) -
+                1 - otherRepeat->second;
+            repeat.second = std::max(0, repeat.second - performed);
+        }
+    }
+}
+
 RepeatController::RepeatController(const Score &score)
     : myDirectionIndex(score),
       myRepeatIndex(score)
@@ -113,3 +133,22 @@ bool RepeatController::checkForRepeat(const SystemLocation &prevLocation,
     // Return true if a position shift occurred.
     return newLocation != currentLocation;
 }
+
+void RepeatController::copyState(const RepeatController &other)
+{
+    myDirectionIndex.copyState(other.myDirectionIndex);
+
+    // Match up the repeated sections by their start bar.
+    for (auto &state : myRepeatStates)
+    {
+        for (auto &otherState : other.myRepeatStates)
+        {
+            if (state.first->getStartBarLocation() ==
+                otherState.first->getStartBarLocation())
+            {
+                state.second.copyState(otherState.second);
+                break;
+            }
+        }
+    }
+}
@@ -32,6 +32,9 @@ public:
     int getCurrentRepeatNumber() const;
     void reset();
     SystemLocation performRepeat(const SystemLocation &loc);
+    /// Copies the active repeat and remaining repeat counts from the state of
+    /// the same section in another version of the score.
+    void copyState(const RepeatState &other);
 
 private:
     const RepeatedSection &myRepeatedSection;
@@ -52,6 +55,11 @@ public:
                         const SystemLocation &currentLocation,
                         SystemLocation &newLocation);
 
+    /// Copies the playback state (performed repeats and directions) from a
+    /// controller for another version of the score, e.g. after the score is
+    /// edited during playback.
+    void copyState(const RepeatController &other);
+
 private:
     DirectionIndex myDirectionIndex;
     RepeatIndexer myRepeatIndex;
@@ -23,7 +23,8 @@ RestEvent::RestEvent(int channel, double startTime, double duration,
 {
 }
 
-void RestEvent::performEvent(MidiOutputDevice &) const
+void RestEvent::performEvent(MidiOutputDevice &,
+                             const PlaybackSettings &) const
 {
     // Do nothing.
 }
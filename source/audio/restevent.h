@@ -28,7 +28,8 @@ public:
     RestEvent(int channel, double startTime, double duration,
               int position, int system);
 
-    virtual void performEvent(MidiOutputDevice &device) const override;
+    virtual void performEvent(MidiOutputDevice &device,
+                              const PlaybackSettings &settings) const override;
 };
 
 #endif
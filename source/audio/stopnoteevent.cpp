@@ -30,7 +30,8 @@ StopNoteEvent::StopNoteEvent(int channel, double startTime, int position,
 {
 }
 
-void StopNoteEvent::performEvent(MidiOutputDevice &device) const
+void StopNoteEvent::performEvent(MidiOutputDevice &device,
+                                 const PlaybackSettings &) const
 {
 #if defined(LOG_MIDI_EVENTS)
     qDebug() << "Stop Note: " << mySystem << ", " << myPosition << " at " <<
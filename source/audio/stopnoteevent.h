@@ -27,7 +27,8 @@ public:
     StopNoteEvent(int channel, double startTime, int position, int system,
                   uint8_t pitch);
 
-    virtual void performEvent(MidiOutputDevice &device) const override;
+    virtual void performEvent(MidiOutputDevice &device,
+                              const PlaybackSettings &settings) const override;
 
 private:
     const uint8_t myPitch;
@@ -0,0 +1,477 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "synthesizer.h"
+
+#include <algorithm>
+#include <audio/pluckedstring.h>
+#include <cmath>
+#include <score/generalmidi.h>
+
+/// The voices are mixed in small chunks, so that pitch bends and vibrato are
+/// applied smoothly.
+static const int CHUNK_SIZE = 64;
+static const double VIBRATO_RATE = 5.0;
+/// The vibrato depth (in semitones) at the maximum modulation level.
+static const double MAX_VIBRATO_DEPTH = 0.5;
+static const double MUTED_DECAY_TIME = 0.15;
+static const double PI = 3.14159265358979323846;
+
+/// A note that is being played.
+class SynthVoice
+{
+public:
+    SynthVoice(int channel, int pitch)
+        : myChannel(channel), myPitch(pitch), myIsHeld(false),
+          myIsReleased(false)
+    {
+    }
+
+    virtual ~SynthVoice()
+    {
+    }
+
+    virtual void render(float *output, int count) = 0;
+    virtual bool isFinished() const = 0;
+    virtual void setPitchOffset(double)
+    {
+    }
+
+    void release()
+    {
+        myIsReleased = true;
+        myIsHeld = false;
+        onRelease();
+    }
+
+    const int myChannel;
+    const int myPitch;
+    /// The note has been stopped, but the sustain pedal is down.
+    bool myIsHeld;
+    bool myIsReleased;
+
+private:
+    virtual void onRelease()
+    {
+    }
+};
+
+static double getFrequency(double pitch)
+{
+    return 440.0 * std::pow(2.0, (pitch - 69) / 12.0);
+}
+
+namespace {
+/// A guitar or bass note.
+class StringVoice : public SynthVoice
+{
+public:
+    StringVoice(int sampleRate, int channel, int pitch, int velocity,
+                uint32_t seed, bool muted)
+        : SynthVoice(channel, pitch),
+          myString(sampleRate, getFrequency(pitch), velocity / 127.0, seed),
+          myPitchOffset(0)
+    {
+        if (muted)
+            myString.setDecayTime(MUTED_DECAY_TIME);
+    }
+
+    virtual void render(float *output, int count) override
+    {
+        myString.render(output, count);
+    }
+
+    virtual bool isFinished() const override
+    {
+        return myString.isFinished();
+    }
+
+    virtual void setPitchOffset(double offset) override
+    {
+        if (offset != myPitchOffset)
+        {
+            myPitchOffset = offset;
+            myString.setFrequency(getFrequency(myPitch + offset));
+        }
+    }
+
+private:
+    virtual void onRelease() override
+    {
+        myString.release();
+    }
+
+    PluckedString myString;
+    double myPitchOffset;
+};
+
+/// A drum sound, which is a mix of a decaying tone (whose pitch can drop
+/// over time) and a burst of noise. Drums always play until they have
+/// decayed, regardless of when the note is stopped.
+class DrumVoice : public SynthVoice
+{
+public:
+    DrumVoice(int sampleRate, int channel, int pitch, int velocity,
+              uint32_t seed)
+        : SynthVoice(channel, pitch),
+          mySampleRate(sampleRate),
+          myLevel(velocity / 127.0f),
+          myToneLevel(0),
+          myNoiseLevel(0),
+          myIsHighPassed(false),
+          myPhase(0),
+          myNoiseState(seed ? seed : 1),
+          myPrevNoise(0)
+    {
+        double startFreq = 1000;
+        double endFreq = 1000;
+        double toneDecay = 0.01;
+        double noiseDecay = 0.01;
+
+        switch (pitch)
+        {
+        case 35: // Acoustic bass drum.
+        case 36: // Bass drum.
+            startFreq = 150;
+            endFreq = 50;
+            toneDecay = 0.12;
+            myToneLevel = 1.0f;
+            myNoiseLevel = 0.1f;
+            noiseDecay = 0.005;
+            break;
+        case 37: // Side stick.
+        case 38: // Acoustic snare.
+        case 40: // Electric snare.
+            startFreq = endFreq = 185;
+            toneDecay = 0.04;
+            myToneLevel = 0.5f;
+            myNoiseLevel = 0.8f;
+            noiseDecay = 0.06;
+            break;
+        case 42: // Closed hi-hat.
+        case 44: // Pedal hi-hat.
+            myNoiseLevel = 0.5f;
+            noiseDecay = 0.02;
+            myIsHighPassed = true;
+            break;
+        case 46: // Open hi-hat.
+            myNoiseLevel = 0.5f;
+            noiseDecay = 0.15;
+            myIsHighPassed = true;
+            break;
+        case 49: // Crash cymbals.
+        case 52:
+        case 55:
+        case 57:
+            myNoiseLevel = 0.5f;
+            noiseDecay = 0.5;
+            myIsHighPassed = true;
+            break;
+        case 51: // Ride cymbals.
+        case 53:
+        case 59:
+            myNoiseLevel = 0.4f;
+            noiseDecay = 0.35;
+            myIsHighPassed = true;
+            break;
+        case 41: // Toms.
+        case 43:
+        case 45:
+        case 47:
+        case 48:
+        case 50:
+            startFreq = 80 + (pitch - 41) * 18;
+            endFreq = startFreq * 0.75;
+            toneDecay = 0.15;
+            myToneLevel = 0.8f;
+            break;
+        default: // Use a short click for anything else (e.g. the metronome).
+            myToneLevel = 0.5f;
+            break;
+        }
+
+        myFrequency = startFreq;
+        myEndFrequency = endFreq;
+        myFrequencyDecay = std::exp(-30.0 / sampleRate);
+        myToneDecay = static_cast<float>(std::exp(-1.0 / (toneDecay *
+                                                          sampleRate)));
+        myNoiseDecay = static_cast<float>(std::exp(-1.0 / (noiseDecay *
+                                                           sampleRate)));
+    }
+
+    virtual void render(float *output, int count) override
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            myFrequency = myEndFrequency +
+                          (myFrequency - myEndFrequency) * myFrequencyDecay;
+            myPhase += 2 * PI * myFrequency / mySampleRate;
+            if (myPhase > 2 * PI)
+                myPhase -= 2 * PI;
+
+            myNoiseState = myNoiseState * 1664525u + 1013904223u;
+            float noise = (myNoiseState >> 8) / static_cast<float>(1 << 23) -
+                          1.0f;
+            if (myIsHighPassed)
+            {
+                const float white = noise;
+                noise = 0.5f * (white - myPrevNoise);
+                myPrevNoise = white;
+            }
+
+            output[i] += myLevel *
+                         (myToneLevel * static_cast<float>(std::sin(myPhase)) +
+                          myNoiseLevel * noise);
+
+            myToneLevel *= myToneDecay;
+            myNoiseLevel *= myNoiseDecay;
+        }
+    }
+
+    virtual bool isFinished() const override
+    {
+        return myToneLevel < 1e-4f && myNoiseLevel < 1e-4f;
+    }
+
+private:
+    const int mySampleRate;
+    const float myLevel;
+    float myToneLevel;
+    float myNoiseLevel;
+    float myToneDecay;
+    float myNoiseDecay;
+    bool myIsHighPassed;
+    double myFrequency;
+    double myEndFrequency;
+    double myFrequencyDecay;
+    double myPhase;
+    uint32_t myNoiseState;
+    float myPrevNoise;
+};
+}
+
+Synthesizer::ChannelState::ChannelState()
+    : myProgram(0),
+      myVolume(100),
+      myPan(64),
+      myModulation(0),
+      mySustain(false),
+      myRpnMsb(127),
+      myRpnLsb(127),
+      myBendRange(2),
+      myPitchBend(0)
+{
+}
+
+Synthesizer::Synthesizer(int sampleRate)
+    : mySampleRate(sampleRate),
+      myChannels(NUM_CHANNELS * Midi::MAX_MIDI_PORTS),
+      myTime(0),
+      myNextSeed(1),
+      myVoiceBuffer(CHUNK_SIZE)
+{
+}
+
+Synthesizer::~Synthesizer()
+{
+}
+
+bool Synthesizer::sendMidiMessage(int channel, unsigned char type,
+                                  unsigned char b, unsigned char c)
+{
+    if (channel < 0 || channel >= static_cast<int>(myChannels.size()))
+        return false;
+
+    switch (type)
+    {
+    case NoteOn:
+        noteOn(channel, b, c);
+        break;
+    case NoteOff:
+        noteOff(channel, b);
+        break;
+    case ControlChange:
+        controlChange(channel, b, c);
+        break;
+    case ProgramChange:
+        myChannels[channel].myProgram = b;
+        break;
+    case PitchWheel:
+    {
+        ChannelState &state = myChannels[channel];
+        const int value = ((c << 7) | b) - 8192;
+        state.myPitchBend = value / 8192.0 * state.myBendRange;
+        break;
+    }
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+void Synthesizer::noteOn(int channel, int pitch, int velocity)
+{
+    if (velocity == 0)
+    {
+        noteOff(channel, pitch);
+        return;
+    }
+
+    const ChannelState &state = myChannels[channel];
+    std::unique_ptr<SynthVoice> voice;
+
+    if (channel % NUM_CHANNELS == Midi::PERCUSSION_CHANNEL)
+    {
+        voice.reset(new DrumVoice(mySampleRate, channel, pitch, velocity,
+                                  myNextSeed++));
+    }
+    else
+    {
+        // Playing the same note again restarts the string.
+        for (auto &other : myVoices)
+        {
+            if (other->myChannel == channel && other->myPitch == pitch &&
+                !other->myIsReleased)
+            {
+                other->release();
+            }
+        }
+
+        voice.reset(new StringVoice(
+            mySampleRate, channel, pitch, velocity, myNextSeed++,
+            state.myProgram == Midi::MIDI_PRESET_ELECTRIC_GUITAR_MUTED));
+        voice->setPitchOffset(getPitchOffset(state));
+    }
+
+    myVoices.push_back(std::move(voice));
+}
+
+void Synthesizer::noteOff(int channel, int pitch)
+{
+    const bool sustain = myChannels[channel].mySustain;
+
+    for (auto &voice : myVoices)
+    {
+        if (voice->myChannel == channel && voice->myPitch == pitch &&
+            !voice->myIsReleased)
+        {
+            if (sustain)
+                voice->myIsHeld = true;
+            else
+                voice->release();
+        }
+    }
+}
+
+void Synthesizer::controlChange(int channel, int control, int value)
+{
+    ChannelState &state = myChannels[channel];
+
+    switch (control)
+    {
+    case ModWheel:
+        state.myModulation = value;
+        break;
+    case ChannelVolume:
+        state.myVolume = value;
+        break;
+    case PanChange:
+        state.myPan = value;
+        break;
+    case HoldPedal:
+        state.mySustain = value >= 64;
+        if (!state.mySustain)
+        {
+            for (auto &voice : myVoices)
+            {
+                if (voice->myChannel == channel && voice->myIsHeld)
+                    voice->release();
+            }
+        }
+        break;
+    case RpnMsb:
+        state.myRpnMsb = value;
+        break;
+    case RpnLsb:
+        state.myRpnLsb = value;
+        break;
+    case DataEntryCoarse:
+        // RPN 0 is the pitch bend range.
+        if (state.myRpnMsb == 0 && state.myRpnLsb == 0)
+            state.myBendRange = value;
+        break;
+    }
+}
+
+double Synthesizer::getPitchOffset(const ChannelState &state) const
+{
+    double offset = state.myPitchBend;
+
+    if (state.myModulation > 0)
+    {
+        offset += MAX_VIBRATO_DEPTH * state.myModulation / 127.0 *
+                  std::sin(2 * PI * VIBRATO_RATE * myTime / mySampleRate);
+    }
+
+    return offset;
+}
+
+void Synthesizer::render(float *output, int frames)
+{
+    for (int start = 0; start < frames; start += CHUNK_SIZE)
+    {
+        const int count = std::min(CHUNK_SIZE, frames - start);
+        float *chunk = output + 2 * start;
+
+        for (auto &voice : myVoices)
+        {
+            const ChannelState &state = myChannels[voice->myChannel];
+            voice->setPitchOffset(getPitchOffset(state));
+
+            std::fill(myVoiceBuffer.begin(), myVoiceBuffer.end(), 0.0f);
+            voice->render(myVoiceBuffer.data(), count);
+
+            // Use an equal power pan law.
+            const double volume = state.myVolume / 127.0;
+            const double angle = state.myPan / 127.0 * PI / 2;
+            const float left =
+                static_cast<float>(volume * volume * std::cos(angle));
+            const float right =
+                static_cast<float>(volume * volume * std::sin(angle));
+
+            for (int i = 0; i < count; ++i)
+            {
+                chunk[2 * i] += left * myVoiceBuffer[i];
+                chunk[2 * i + 1] += right * myVoiceBuffer[i];
+            }
+        }
+
+        myVoices.erase(std::remove_if(myVoices.begin(), myVoices.end(),
+                                      [](const std::unique_ptr<SynthVoice> &voice) {
+                           return voice->isFinished();
+                       }),
+                       myVoices.end());
+
+        myTime += count;
+    }
+}
+
+bool Synthesizer::isActive() const
+{
+    return !myVoices.empty();
+}
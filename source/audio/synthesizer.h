@@ -0,0 +1,82 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUDIO_SYNTHESIZER_H
+#define AUDIO_SYNTHESIZER_H
+
+#include <audio/midioutputdevice.h>
+#include <memory>
+#include <vector>
+
+class SynthVoice;
+
+/// A software synthesizer, which renders the MIDI messages sent to it as
+/// audio instead of sending them to a MIDI port.
+/// Melodic instruments are played with a plucked string model, and the
+/// percussion channel uses a simple synthesized drum kit.
+class Synthesizer : public MidiOutputDevice
+{
+public:
+    explicit Synthesizer(int sampleRate);
+    ~Synthesizer();
+
+    /// Adds the next frames of audio to the interleaved stereo buffer.
+    void render(float *output, int frames);
+
+    /// Returns whether any notes are still sounding.
+    bool isActive() const;
+
+protected:
+    virtual bool sendMidiMessage(int channel, unsigned char type,
+                                 unsigned char b, unsigned char c) override;
+
+private:
+    struct ChannelState
+    {
+        ChannelState();
+
+        int myProgram;
+        int myVolume;
+        int myPan;
+        int myModulation;
+        bool mySustain;
+        /// The registered parameter selected for data entry.
+        int myRpnMsb;
+        int myRpnLsb;
+        /// The pitch bend range, in semitones.
+        int myBendRange;
+        /// The current pitch bend, in semitones.
+        double myPitchBend;
+    };
+
+    void noteOn(int channel, int pitch, int velocity);
+    void noteOff(int channel, int pitch);
+    void controlChange(int channel, int control, int value);
+    /// Returns the pitch offset (in semitones) from the pitch wheel and
+    /// vibrato.
+    double getPitchOffset(const ChannelState &state) const;
+
+    const int mySampleRate;
+    std::vector<ChannelState> myChannels;
+    std::vector<std::unique_ptr<SynthVoice>> myVoices;
+    /// Number of frames rendered so far, which is used for the vibrato.
+    long myTime;
+    uint32_t myNextSeed;
+    std::vector<float> myVoiceBuffer;
+};
+
+#endif
@@ -17,9 +17,8 @@
   
 #include "vibratoevent.h"
 
-#include <app/settings.h>
 #include <audio/midioutputdevice.h>
-#include <QSettings>
+#include <audio/playbacksettings.h>
 
 #ifdef LOG_MIDI_EVENTS
 #include <QDebug>
@@ -34,7 +33,8 @@ VibratoEvent::VibratoEvent(int channel, double startTime, int position,
 {
 }
 
-void VibratoEvent::performEvent(MidiOutputDevice &device) const
+void VibratoEvent::performEvent(MidiOutputDevice &device,
+                                const PlaybackSettings &settings) const
 {
 #ifdef LOG_MIDI_EVENTS
     qDebug() << "Vibrato: " << mySystem << ", " << myPosition << " at " <<
@@ -45,19 +45,12 @@ void VibratoEvent::performEvent(MidiOutputDevice &device) const
     {
     case VibratoEvent::VibratoOn:
     {
-        QSettings settings;
         uint8_t vibratoWidth = 0;
 
         if (myVibratoType == NormalVibrato)
-        {
-            vibratoWidth = settings.value(Settings::MIDI_VIBRATO_LEVEL,
-                                          Settings::MIDI_VIBRATO_LEVEL_DEFAULT).toUInt();
-        }
+            vibratoWidth = settings.getVibratoLevel();
         else if (myVibratoType == WideVibrato)
-        {
-            vibratoWidth = settings.value(Settings::MIDI_WIDE_VIBRATO_LEVEL,
-                                          Settings::MIDI_WIDE_VIBRATO_LEVEL_DEFAULT).toUInt();
-        }
+            vibratoWidth = settings.getWideVibratoLevel();
 
         device.setVibrato(myChannel, vibratoWidth);
     }
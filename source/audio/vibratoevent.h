@@ -38,7 +38,8 @@ public:
     VibratoEvent(int channel, double startTime, int position, int system,
                  EventType myEventType, VibratoType myVibratoType = NormalVibrato);
 
-    virtual void performEvent(MidiOutputDevice &device) const override;
+    virtual void performEvent(MidiOutputDevice &device,
+                              const PlaybackSettings &settings) const override;
 
 private:
     const EventType myEventType;
@@ -27,7 +27,8 @@ VolumeChangeEvent::VolumeChangeEvent(int channel, double startTime,
 {
 }
 
-void VolumeChangeEvent::performEvent(MidiOutputDevice &device) const
+void VolumeChangeEvent::performEvent(MidiOutputDevice &device,
+                                     const PlaybackSettings &) const
 {
     device.setVolume(myChannel, myNewVolume);
 }
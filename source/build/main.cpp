@@ -17,21 +17,174 @@
  
 #include <app/powertabeditor.h>
 #include <app/settings.h>
+#include <audio/audiorenderer.h>
 #include <boost/program_options.hpp>
+#include <formats/fileformatmanager.h>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <painters/imageexporter.h>
 #include <QApplication>
+#include <QFileInfo>
+#include <QFontDatabase>
 #include <QLocalServer>
 #include <QLocalSocket>
 #include <QSettings>
+#include <score/score.h>
+#include <score/utils/memoryusage.h>
+#include <stdexcept>
+#include <util/tracing.h>
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #endif
 
+/// Returns whether the option was passed on the command line. This is needed
+/// before the application (and the option parser) is created.
+static bool hasOption(int argc, char *argv[], const std::string &option)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]).find(option) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+/// Imports the score without displaying any error dialogs.
+/// @throw std::exception If the file could not be imported.
+static void importScore(const std::string &filename, Score &score)
+{
+    FileFormatManager fileFormatManager;
+    boost::optional<FileFormat> format = fileFormatManager.findFormat(
+        QFileInfo(QString::fromStdString(filename)).suffix().toStdString());
+    if (!format)
+        throw std::runtime_error("Unsupported file type - " + filename);
+
+    fileFormatManager.importFile(score, filename, *format);
+}
+
+/// Renders the score to a WAV file, without opening the editor.
+static int renderAudio(const std::string &filename,
+                       const std::string &outputFilename)
+{
+    try
+    {
+        auto score = std::make_shared<Score>();
+        importScore(filename, *score);
+
+        const std::vector<float> samples = AudioRenderer::render(score);
+
+        std::ofstream output(outputFilename, std::ios::binary);
+        AudioRenderer::writeWav(output, samples);
+        if (!output)
+            throw std::runtime_error("Could not write " + outputFilename);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/// Exports the score as images or a PDF file, without opening the editor.
+static int exportScore(const std::string &filename,
+                       const std::string &outputFilename)
+{
+    const boost::optional<ImageExporter::Format> format =
+        ImageExporter::findFormat(
+            QFileInfo(QString::fromStdString(outputFilename))
+                .suffix()
+                .toStdString());
+    if (!format)
+    {
+        std::cerr << "Error: Unsupported export format - " << outputFilename
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Load the fonts that are used by the score.
+    QFontDatabase::addApplicationFont(":fonts/emmentaler-13.otf");
+    QFontDatabase::addApplicationFont(":fonts/LiberationSans-Regular.ttf");
+
+    try
+    {
+        Score score;
+        importScore(filename, score);
+
+        ImageExporter exporter(score);
+        for (const std::string &file :
+             exporter.exportPages(outputFilename, *format))
+        {
+            std::cout << file << std::endl;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/// Prints the memory used by the score, before and after compaction.
+static int printMemoryReport(const std::string &filename)
+{
+    try
+    {
+        Score score;
+        importScore(filename, score);
+
+        std::cout << filename << std::endl << std::endl;
+        ScoreUtils::printMemoryUsage(std::cout,
+                                     ScoreUtils::getMemoryUsage(score));
+
+        ScoreUtils::compact(score);
+        std::cout << std::endl << "After compaction:" << std::endl << std::endl;
+        ScoreUtils::printMemoryUsage(std::cout,
+                                     ScoreUtils::getMemoryUsage(score));
+        std::cout << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/// Writes the performance trace that was recorded with the --trace option.
+static void writeTrace(const std::string &filename)
+{
+    if (filename.empty())
+        return;
+
+    std::ofstream output(filename);
+    Tracing::exportJson(output);
+    if (!output)
+        std::cerr << "Error: Could not write trace - " << filename << std::endl;
+}
+
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
+    // Exporting doesn't show any windows, so it can run without a display.
+    const bool isExporting = hasOption(argc, argv, "--export");
+    if (isExporting && qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    // Rendering audio or printing a memory report doesn't need the GUI at
+    // all.
+    std::unique_ptr<QCoreApplication> app(
+        ((hasOption(argc, argv, "--render-audio") ||
+          hasOption(argc, argv, "--memory-report")) && !isExporting)
+            ? new QCoreApplication(argc, argv)
+            : new QApplication(argc, argv));
 
     // Set the app information (used by e.g. QSettings).
     QCoreApplication::setOrganizationName("Power Tab");
@@ -45,6 +198,7 @@ int main(int argc, char *argv[])
 #endif
 
     QStringList filesToOpen;
+    std::string traceFilename;
 
     namespace po = boost::program_options;
     po::options_description desc("Usage: powertabeditor [options] [files...] "
@@ -54,6 +208,18 @@ int main(int argc, char *argv[])
         desc.add_options()
             ("help,h", "Displays this help.")
             ("version,v", "Displays version information.")
+            ("render-audio", po::value<std::string>(),
+             "Renders the first file to the given WAV file, without opening "
+             "the editor.")
+            ("export", po::value<std::string>(),
+             "Exports the first file to the given PNG, SVG, or PDF file, "
+             "without opening the editor.")
+            ("memory-report",
+             "Prints the memory used by each file, before and after "
+             "compaction, without opening the editor.")
+            ("trace", po::value<std::string>(),
+             "Records a performance trace and writes it to the given JSON "
+             "file on exit.")
             ("files", po::value<std::vector<std::string>>(),
              "The files to be opened, optionally.");
         po::positional_options_description p;
@@ -80,12 +246,60 @@ int main(int argc, char *argv[])
             return EXIT_SUCCESS;
         }
 
+        if (vm.count("trace"))
+        {
+            traceFilename = vm["trace"].as<std::string>();
+            Tracing::setEnabled(true);
+        }
+
         if (vm.count("files"))
         {
             auto files = vm["files"].as<std::vector<std::string>>();
             for (auto &file : files)
                 filesToOpen.push_back(QString::fromStdString(file));
         }
+
+        if (vm.count("memory-report"))
+        {
+            int result = EXIT_SUCCESS;
+            for (const QString &file : filesToOpen)
+            {
+                if (printMemoryReport(file.toStdString()) != EXIT_SUCCESS)
+                    result = EXIT_FAILURE;
+            }
+
+            writeTrace(traceFilename);
+            return result;
+        }
+
+        if (vm.count("render-audio") || vm.count("export"))
+        {
+            if (filesToOpen.empty())
+            {
+                std::cerr << "Error: No input file." << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            const std::string filename = filesToOpen.front().toStdString();
+            int result = EXIT_SUCCESS;
+
+            if (vm.count("render-audio") &&
+                renderAudio(filename, vm["render-audio"].as<std::string>()) !=
+                    EXIT_SUCCESS)
+            {
+                result = EXIT_FAILURE;
+            }
+
+            if (vm.count("export") &&
+                exportScore(filename, vm["export"].as<std::string>()) !=
+                    EXIT_SUCCESS)
+            {
+                result = EXIT_FAILURE;
+            }
+
+            writeTrace(traceFilename);
+            return result;
+        }
     }
     catch(po::error &e)
     {
@@ -145,5 +359,7 @@ int main(int argc, char *argv[])
     program.show();
     program.openFiles(filesToOpen);
 
-    return a.exec();
+    const int result = app->exec();
+    writeTrace(traceFilename);
+    return result;
 }
@@ -18,30 +18,15 @@
 #include "gotobarlinedialog.h"
 #include "ui_gotobarlinedialog.h"
 
-#include <score/score.h>
-
-GoToBarlineDialog::GoToBarlineDialog(QWidget *parent, const Score &score)
+GoToBarlineDialog::GoToBarlineDialog(QWidget *parent, int barCount)
     : QDialog(parent),
       ui(new Ui::GoToBarlineDialog)
 {
     ui->setupUi(this);
 
-    for (long systemIndex = 0; systemIndex < score.getSystems().size();
-         ++systemIndex)
-    {
-        const System &system = score.getSystems()[systemIndex];
-        // Index all barlines except for the end bar.
-        for (long i = 0; i < system.getBarlines().size() - 1; ++i)
-        {
-            myLocations.push_back(new ScoreLocation(score, systemIndex, 0,
-                                      system.getBarlines()[i].getPosition()));
-
-        }
-    }
-
     ui->barlineSpinBox->setValue(1);
     ui->barlineSpinBox->setMinimum(1);
-    ui->barlineSpinBox->setMaximum(static_cast<int>(myLocations.size()));
+    ui->barlineSpinBox->setMaximum(barCount);
 }
 
 GoToBarlineDialog::~GoToBarlineDialog()
@@ -49,9 +34,7 @@ GoToBarlineDialog::~GoToBarlineDialog()
     delete ui;
 }
 
-/// Returns the location of the selected barline.
-ScoreLocation GoToBarlineDialog::getLocation() const
+int GoToBarlineDialog::getBarNumber() const
 {
-    const int index = ui->barlineSpinBox->value();
-    return myLocations.at(index - 1);
+    return ui->barlineSpinBox->value();
 }
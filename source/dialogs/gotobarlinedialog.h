@@ -18,30 +18,23 @@
 #ifndef DIALOGS_GOTOBARLINEDIALOG_H
 #define DIALOGS_GOTOBARLINEDIALOG_H
 
-#include <boost/ptr_container/ptr_vector.hpp>
 #include <QDialog>
-#include <score/scorelocation.h>
 
 namespace Ui {
 class GoToBarlineDialog;
 }
 
-class Score;
-
 class GoToBarlineDialog : public QDialog
 {
 public:
-    explicit GoToBarlineDialog(QWidget *parent, const Score &score);
+    explicit GoToBarlineDialog(QWidget *parent, int barCount);
     ~GoToBarlineDialog();
 
-    /// Returns the location of the selected barline.
-    ScoreLocation getLocation() const;
+    /// Returns the selected bar number (starting from 1).
+    int getBarNumber() const;
 
 private:
     Ui::GoToBarlineDialog *ui;
-    // ScoreLocation doesn't have a copy assignment operator, so this is the
-    // simplest alternative until C++11.
-    boost::ptr_vector<ScoreLocation> myLocations;
 };
 
 #endif
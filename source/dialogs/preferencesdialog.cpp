@@ -70,6 +70,8 @@ PreferencesDialog::PreferencesDialog(
 
     ui->countInVolumeSpinBox->setRange(0, 127);
 
+    ui->loopSpeedIncrementSpinBox->setRange(0, 50);
+
     loadCurrentSettings();
 }
 
@@ -128,6 +130,10 @@ void PreferencesDialog::loadCurrentSettings()
         settings.value(Settings::MIDI_METRONOME_COUNTIN_VOLUME,
                        Settings::MIDI_METRONOME_COUNTIN_VOLUME_DEFAULT).toInt());
 
+    ui->loopSpeedIncrementSpinBox->setValue(
+        settings.value(Settings::MIDI_LOOP_SPEED_INCREMENT,
+                       Settings::MIDI_LOOP_SPEED_INCREMENT_DEFAULT).toInt());
+
     ui->openInNewWindowCheckBox->setChecked(
         settings.value(Settings::GENERAL_OPEN_IN_NEW_WINDOW,
                        Settings::GENERAL_OPEN_IN_NEW_WINDOW_DEFAULT).toBool());
@@ -185,6 +191,9 @@ void PreferencesDialog::accept()
     settings.setValue(Settings::MIDI_METRONOME_COUNTIN_VOLUME,
                       ui->countInVolumeSpinBox->value());
 
+    settings.setValue(Settings::MIDI_LOOP_SPEED_INCREMENT,
+                      ui->loopSpeedIncrementSpinBox->value());
+
     settings.setValue(Settings::GENERAL_OPEN_IN_NEW_WINDOW,
                       ui->openInNewWindowCheckBox->isChecked());
 
@@ -0,0 +1,177 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+  
+#include "tablibrarydialog.h"
+
+#include <app/settings.h>
+#include <app/tablibrary.h>
+#include <QApplication>
+#include <QDialogButtonBox>
+#include <QDir>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSettings>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <stdexcept>
+
+TabLibraryDialog::TabLibraryDialog(QWidget *parent, TabLibrary &library)
+    : QDialog(parent), myLibrary(library)
+{
+    setWindowTitle(tr("Tab Library"));
+    setModal(true);
+
+    mySearchEdit = new QLineEdit(this);
+    mySearchEdit->setPlaceholderText(tr("Search by title or artist"));
+    connect(mySearchEdit, SIGNAL(textChanged(QString)), this,
+            SLOT(updateEntries()));
+
+    myTree = new QTreeWidget(this);
+    myTree->setHeaderLabels(QStringList() << tr("Title") << tr("Artist")
+                                          << tr("Players") << tr("File"));
+    myTree->setRootIsDecorated(false);
+    myTree->setSortingEnabled(true);
+    myTree->sortByColumn(0, Qt::AscendingOrder);
+    connect(myTree, SIGNAL(itemActivated(QTreeWidgetItem *, int)), this,
+            SLOT(openItem(QTreeWidgetItem *)));
+
+    auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Open |
+                                          QDialogButtonBox::Close);
+    QPushButton *addButton =
+        buttonBox->addButton(tr("Add Folder..."), QDialogButtonBox::ActionRole);
+    connect(addButton, SIGNAL(clicked()), this, SLOT(addDirectory()));
+    QPushButton *rescanButton =
+        buttonBox->addButton(tr("Rescan"), QDialogButtonBox::ActionRole);
+    connect(rescanButton, SIGNAL(clicked()), this, SLOT(rescan()));
+    connect(buttonBox, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
+
+    QPushButton *openButton = buttonBox->button(QDialogButtonBox::Open);
+    openButton->setEnabled(false);
+    connect(myTree, &QTreeWidget::currentItemChanged,
+            [=](QTreeWidgetItem *current, QTreeWidgetItem *) {
+                openButton->setEnabled(current != nullptr);
+            });
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(mySearchEdit);
+    layout->addWidget(myTree);
+    layout->addWidget(buttonBox);
+    setLayout(layout);
+    resize(700, 500);
+
+    updateEntries();
+}
+
+QString TabLibraryDialog::getSelectedFile() const
+{
+    if (!mySelectedFile.isEmpty())
+        return mySelectedFile;
+
+    QTreeWidgetItem *item = myTree->currentItem();
+    return item ? item->data(0, Qt::UserRole).toString() : QString();
+}
+
+void TabLibraryDialog::addDirectory()
+{
+    const QString directory = QFileDialog::getExistingDirectory(
+        this, tr("Add Folder to Library"), QDir::homePath());
+    if (directory.isEmpty())
+        return;
+
+    QSettings settings;
+    QStringList directories =
+        settings.value(Settings::APP_TAB_LIBRARY_DIRECTORIES).toStringList();
+    if (!directories.contains(directory))
+    {
+        directories.append(directory);
+        settings.setValue(Settings::APP_TAB_LIBRARY_DIRECTORIES, directories);
+    }
+
+    scanDirectories(QStringList(directory));
+}
+
+void TabLibraryDialog::rescan()
+{
+    QSettings settings;
+    scanDirectories(
+        settings.value(Settings::APP_TAB_LIBRARY_DIRECTORIES).toStringList());
+}
+
+void TabLibraryDialog::scanDirectories(const QStringList &directories)
+{
+    QStringList errors;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    for (const QString &directory : directories)
+        myLibrary.scan(directory, &errors);
+    QApplication::restoreOverrideCursor();
+
+    updateEntries();
+
+    if (!errors.isEmpty())
+    {
+        QMessageBox message(this);
+        message.setIcon(QMessageBox::Warning);
+        message.setWindowTitle(tr("Tab Library"));
+        message.setText(tr("%n file(s) could not be read.", "", errors.size()));
+        message.setDetailedText(errors.join("\n"));
+        message.exec();
+    }
+
+    try
+    {
+        myLibrary.save();
+    }
+    catch (const std::exception &e)
+    {
+        QMessageBox::warning(this, tr("Tab Library"),
+                             tr("Error saving the library index - %1")
+                                 .arg(e.what()));
+    }
+}
+
+void TabLibraryDialog::updateEntries()
+{
+    myTree->setSortingEnabled(false);
+    myTree->clear();
+
+    for (const TabLibrary::Entry *entry : myLibrary.find(mySearchEdit->text()))
+    {
+        if (!entry->myIsValid)
+            continue;
+
+        auto item = new QTreeWidgetItem(myTree);
+        item->setText(0, entry->myTitle);
+        item->setText(1, entry->myArtist);
+        item->setData(2, Qt::DisplayRole, entry->myPlayerCount);
+        item->setText(3, QDir::toNativeSeparators(entry->myPath));
+        item->setData(0, Qt::UserRole, entry->myPath);
+    }
+
+    myTree->setSortingEnabled(true);
+    myTree->header()->resizeSections(QHeaderView::ResizeToContents);
+}
+
+void TabLibraryDialog::openItem(QTreeWidgetItem *item)
+{
+    mySelectedFile = item->data(0, Qt::UserRole).toString();
+    accept();
+}
@@ -0,0 +1,60 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+  
+#ifndef DIALOGS_TABLIBRARYDIALOG_H
+#define DIALOGS_TABLIBRARYDIALOG_H
+
+#include <QDialog>
+
+class QLineEdit;
+class QTreeWidget;
+class QTreeWidgetItem;
+class TabLibrary;
+
+/// Allows the user to browse and search the files in the tab library, and to
+/// choose which directories are indexed.
+class TabLibraryDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    TabLibraryDialog(QWidget *parent, TabLibrary &library);
+
+    /// Returns the path of the file that the user chose to open.
+    QString getSelectedFile() const;
+
+private slots:
+    /// Adds a new directory to the library and scans it.
+    void addDirectory();
+    /// Rescans all of the library's directories for new or modified files.
+    void rescan();
+    /// Updates the list of files to match the search text.
+    void updateEntries();
+    void openItem(QTreeWidgetItem *item);
+
+private:
+    /// Scans the given directories, reports any files that could not be read,
+    /// and writes the updated index to disk.
+    void scanDirectories(const QStringList &directories);
+
+    TabLibrary &myLibrary;
+    QLineEdit *mySearchEdit;
+    QTreeWidget *myTree;
+    QString mySelectedFile;
+};
+
+#endif
@@ -65,6 +65,12 @@ FileFormatImporter::~FileFormatImporter()
 {
 }
 
+void FileFormatImporter::readMetadata(const std::string &filename,
+                                      Score &score)
+{
+    load(filename, score);
+}
+
 FileFormat FileFormatImporter::fileFormat() const
 {
     return myFormat;
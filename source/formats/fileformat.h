@@ -58,6 +58,14 @@ public:
     /// @throw FileFormatException
     virtual void load(const std::string &filename, Score &score) = 0;
 
+    /// Imports only the file's header information (title, artist, etc) and,
+    /// if they can be found without reading the rest of the file, the players.
+    /// This is intended for quickly scanning a large number of files, so
+    /// importers should stop reading as early as possible. By default, the
+    /// entire file is loaded.
+    /// @throw FileFormatException
+    virtual void readMetadata(const std::string &filename, Score &score);
+
     /// Returns the file format corresponding to this importer.
     FileFormat fileFormat() const;
 
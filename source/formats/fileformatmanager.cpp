@@ -23,6 +23,8 @@
 #include <formats/powertab/powertabexporter.h>
 #include <formats/powertab_old/powertaboldimporter.h>
 #include <QMessageBox>
+#include <stdexcept>
+#include <util/tracing.h>
 
 FileFormatManager::FileFormatManager()
 {
@@ -66,26 +68,41 @@ std::string FileFormatManager::importFileFilter() const
     return filterAll + filterOther;
 }
 
+void FileFormatManager::importFile(Score &score, const std::string &filename,
+                                   const FileFormat &format)
+{
+    PTE_TRACE_SCOPE("FileFormatManager::importFile");
+
+    if (myImporters.find(format) == myImporters.end())
+        throw std::runtime_error("Unsupported file format");
+
+    myImporters.at(format).load(filename, score);
+}
+
 bool FileFormatManager::importFile(Score &score, const std::string &filename,
                                    const FileFormat &format, QWidget *parentWindow)
 {
-    if (myImporters.find(format) != myImporters.end())
+    try
     {
-        try
-        {
-            myImporters.at(format).load(filename, score);
-            return true;
-        }
-        catch (const std::exception &e)
-        {
-            QMessageBox msgBox(parentWindow);
-            msgBox.setText(QObject::tr("Error importing file - ") + QString(e.what()));
-            msgBox.exec();
-            return false;
-        }
+        importFile(score, filename, format);
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        QMessageBox msgBox(parentWindow);
+        msgBox.setText(QObject::tr("Error importing file - ") + QString(e.what()));
+        msgBox.exec();
+        return false;
     }
+}
 
-    return false;
+void FileFormatManager::readMetadata(Score &score, const std::string &filename,
+                                     const FileFormat &format)
+{
+    if (myImporters.find(format) == myImporters.end())
+        throw std::runtime_error("Unsupported file format");
+
+    myImporters.at(format).readMetadata(filename, score);
 }
 
 std::string FileFormatManager::exportFileFilter() const
@@ -41,9 +41,21 @@ public:
     std::string importFileFilter() const;
 
     /// Imports a file into the given score.
+    /// @throw std::exception If the file could not be imported.
+    void importFile(Score &score, const std::string &filename,
+                    const FileFormat &format);
+
+    /// Imports a file into the given score, and displays a message box if
+    /// an error occurs.
     bool importFile(Score &score, const std::string &filename,
                     const FileFormat &format, QWidget *parentWindow);
 
+    /// Imports the header information for a file, without necessarily loading
+    /// the entire score. See FileFormatImporter::readMetadata().
+    /// @throw std::exception If the file could not be read.
+    void readMetadata(Score &score, const std::string &filename,
+                      const FileFormat &format);
+
     /// Returns a correctly formatted file filter for a Qt file dialog.
     std::string exportFileFilter() const;
 
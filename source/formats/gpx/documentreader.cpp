@@ -18,36 +18,114 @@
 #include "documentreader.h"
 
 #include <boost/date_time/gregorian/gregorian_types.hpp>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <score/generalmidi.h>
 #include <score/score.h>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
 
 static const int POSITIONS_PER_SYSTEM = 35;
 
 using namespace pugi;
 
-/// Utility function for parsing a string of space-separated values.
-template <typename T>
-static void convertStringToList(const std::string &source, std::vector<T> &dest)
+/// Ids are expected to be (nearly) consecutive, so anything far beyond the
+/// number of elements indicates a corrupt file rather than a sparse table.
+static const int MAX_ID_SLACK = 1024;
+
+/// Utility function for parsing a string of space-separated integers.
+static void convertStringToList(const char *source, std::vector<int> &dest)
 {
-    std::stringstream ss(source);
-    T item;
     dest.clear();
 
-    while (ss >> item)
+    char *end = nullptr;
+    for (long item = std::strtol(source, &end, 10); end != source;
+         item = std::strtol(source, &end, 10))
     {
-        dest.push_back(item);
+        dest.push_back(static_cast<int>(item));
+        source = end;
     }
 
     if (dest.empty())
         std::cerr << "Parsing of list failed!!" << std::endl;
 }
 
-Gpx::DocumentReader::DocumentReader(const std::string &xml)
+/// Returns the number of child elements, which is used to size the tables.
+static int countChildren(const xml_node &node)
+{
+    int count = 0;
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling())
+    {
+        ++count;
+    }
+
+    return count;
+}
+
+/// Stores the item in the table at the index given by its id.
+template <typename T>
+static void insertById(std::vector<T> &table, T &&item, int maxId)
+{
+    if (item.id < 0 || item.id > maxId)
+        throw std::runtime_error("Invalid id");
+
+    if (item.id >= static_cast<int>(table.size()))
+    {
+        // Mark any unused slots, so that references to them can be detected.
+        T unused = T();
+        unused.id = -1;
+        table.resize(item.id + 1, unused);
+    }
+
+    const int id = item.id;
+    table[id] = std::move(item);
+}
+
+/// Returns the item with the given id, or null if there isn't one (e.g. an
+/// id of -1 is used for unused voices).
+template <typename T>
+static const T *findById(const std::vector<T> &table, int id)
+{
+    if (id < 0 || id >= static_cast<int>(table.size()) || table[id].id != id)
+        return nullptr;
+
+    return &table[id];
+}
+
+/// Returns the item with the given id.
+/// @throw std::out_of_range
+template <typename T>
+static const T &getById(const std::vector<T> &table, int id)
+{
+    const T *item = findById(table, id);
+    if (!item)
+        throw std::out_of_range("Invalid id");
+
+    return *item;
+}
+
+/// Finds the first property whose child has the given name.
+static xml_node findProperty(const xml_node &properties, const char *child)
+{
+    for (xml_node property = properties.child("Property"); property;
+         property = property.next_sibling("Property"))
+    {
+        xml_node node = property.child(child);
+        if (node)
+            return node;
+    }
+
+    return xml_node();
+}
+
+Gpx::DocumentReader::DocumentReader(std::string xml)
+    : myBuffer(std::move(xml))
 {
-    xml_parse_result result = myXmlData.load(xml.c_str());
+    xml_parse_result result = myXmlData.load_buffer_inplace(&myBuffer[0],
+                                                            myBuffer.size());
 
     if (result.status != pugi::status_ok)
         throw std::runtime_error(result.description());
@@ -70,6 +148,12 @@ void Gpx::DocumentReader::readScore(Score &score)
     readMasterBars(score);
 }
 
+void Gpx::DocumentReader::readMetadata(Score &score)
+{
+    readHeader(score);
+    readTracks(score);
+}
+
 void Gpx::DocumentReader::readHeader(Score &score)
 {
     ScoreInfo info;
@@ -119,8 +203,7 @@ void Gpx::DocumentReader::readTracks(Score &score)
             Tuning tuning = player.getTuning();
             // Read the tuning - need to convert from a string of numbers
             // separated by spaces to a vector of integers.
-            xml_node pitches = properties.select_single_node(
-                        "./Property/Pitches").node();
+            xml_node pitches = findProperty(properties, "Pitches");
             if (pitches)
 			{
 				std::vector<int> tuningNotes;
@@ -131,8 +214,7 @@ void Gpx::DocumentReader::readTracks(Score &score)
             }
 
             // Read capo
-            xml_node capo = properties.select_single_node(
-                        "./Property/Fret").node();
+            xml_node capo = findProperty(properties, "Fret");
             tuning.setCapo(capo.text().as_int());
 
             player.setTuning(tuning);
@@ -145,31 +227,40 @@ void Gpx::DocumentReader::readTracks(Score &score)
 
 void Gpx::DocumentReader::readBars()
 {
-    for (xml_node currentBar : myFile.child("Bars"))
+    const xml_node bars = myFile.child("Bars");
+    const int maxId = countChildren(bars) + MAX_ID_SLACK;
+
+    for (xml_node currentBar : bars)
     {
         Gpx::Bar bar;
         bar.id = currentBar.attribute("id").as_int();
         convertStringToList(currentBar.child_value("Voices"), bar.voiceIds);
 
-        myBars[bar.id] = bar;
+        insertById(myBars, std::move(bar), maxId);
     }
 }
 
 void Gpx::DocumentReader::readVoices()
 {
-    for (xml_node currentVoice : myFile.child("Voices"))
+    const xml_node voices = myFile.child("Voices");
+    const int maxId = countChildren(voices) + MAX_ID_SLACK;
+
+    for (xml_node currentVoice : voices)
     {
         Gpx::Voice voice;
         voice.id = currentVoice.attribute("id").as_int();
         convertStringToList(currentVoice.child_value("Beats"), voice.beatIds);
 
-        myVoices[voice.id] = voice;
+        insertById(myVoices, std::move(voice), maxId);
     }
 }
 
 void Gpx::DocumentReader::readBeats()
 {
-    for (xml_node currentBeat : myFile.child("Beats"))
+    const xml_node beats = myFile.child("Beats");
+    const int maxId = countChildren(beats) + MAX_ID_SLACK;
+
+    for (xml_node currentBeat : beats)
     {
         Gpx::Beat beat;
         beat.id = currentBeat.attribute("id").as_int();
@@ -184,36 +275,47 @@ void Gpx::DocumentReader::readBeats()
         if (properties)
         {
             // Search for brush direction in the properties list.
-            xml_node brush = properties.select_single_node(
-                        "./Property[@name = 'Brush']/Direction").node();
+            xml_node brush = properties.find_child_by_attribute(
+                "Property", "name", "Brush").child("Direction");
             if (brush)
             {
                 beat.brushDirection = brush.child_value();
             }
         }
 
-        myBeats[beat.id] = beat;
+        insertById(myBeats, std::move(beat), maxId);
     }
 }
 
 void Gpx::DocumentReader::readRhythms()
 {
-    for (xml_node currentRhythm : myFile.child("Rhythms"))
+    static const std::pair<const char *, int> noteValues[] = {
+        { "Whole", 1 }, { "Half", 2 }, { "Quarter", 4 }, { "Eighth", 8 },
+        { "16th", 16 }, { "32nd", 32 }, { "64th", 64 }
+    };
+
+    const xml_node rhythms = myFile.child("Rhythms");
+    const int maxId = countChildren(rhythms) + MAX_ID_SLACK;
+
+    for (xml_node currentRhythm : rhythms)
     {
         Gpx::Rhythm rhythm;
         rhythm.id = currentRhythm.attribute("id").as_int();
 
         // Convert duration to PowerTab format.
-        const std::string noteValueStr = currentRhythm.child_value("NoteValue");
+        const char *noteValueStr = currentRhythm.child_value("NoteValue");
 
-        std::map<std::string, int> noteValuesToInt = {
-			{ "Whole", 1 }, { "Half", 2 }, { "Quarter", 4 },
-			{ "Eighth", 8 }, { "16th", 16 }, { "32nd", 32 },
-			{ "64th", 64 }
-		};
+        rhythm.noteValue = 0;
+        for (auto &noteValue : noteValues)
+        {
+            if (std::strcmp(noteValue.first, noteValueStr) == 0)
+            {
+                rhythm.noteValue = noteValue.second;
+                break;
+            }
+        }
 
-        assert(noteValuesToInt.find(noteValueStr) != noteValuesToInt.end());
-        rhythm.noteValue = noteValuesToInt.find(noteValueStr)->second;
+        assert(rhythm.noteValue != 0);
 
         // Handle dotted/double dotted notes
         int numDots = currentRhythm.child("AugmentationDot").attribute(
@@ -222,37 +324,44 @@ void Gpx::DocumentReader::readRhythms()
         rhythm.dotted = numDots == 1;
         rhythm.doubleDotted = numDots == 2;
 
-        myRhythms[rhythm.id] = rhythm;
+        insertById(myRhythms, std::move(rhythm), maxId);
     }
 }
 
 void Gpx::DocumentReader::readNotes()
 {
-    for (xml_node currentNote : myFile.child("Notes"))
+    const xml_node notes = myFile.child("Notes");
+    const int maxId = countChildren(notes) + MAX_ID_SLACK;
+
+    for (xml_node currentNote : notes)
     {
         Gpx::TabNote note;
         note.id = currentNote.attribute("id").as_int();
         note.properties = currentNote.child("Properties");
 
-        note.tied = currentNote.child("Tie").attribute(
-                    "destination").as_string() == std::string("true");
-        note.ghostNote = currentNote.child_value("AntiAccent") ==
-                std::string("Normal");
+        note.tied = std::strcmp(currentNote.child("Tie").attribute(
+                                    "destination").as_string(), "true") == 0;
+        note.ghostNote =
+            std::strcmp(currentNote.child_value("AntiAccent"), "Normal") == 0;
         note.accentType = currentNote.child("Accent").text().as_int();
         note.vibratoType = currentNote.child_value("Vibrato");
         note.letRing = !currentNote.child("LetRing").empty();
         note.trillNote = currentNote.child("Trill").text().as_int(-1);
 
-        myNotes[note.id] = note;
+        insertById(myNotes, std::move(note), maxId);
     }
 }
 
 void Gpx::DocumentReader::readAutomations()
 {
-    for (xpath_node node :
-         myFile.select_nodes("./MasterTrack/Automations/Automation"))
+    const xml_node automations =
+        myFile.child("MasterTrack").child("Automations");
+    const int maxBar = countChildren(myFile.child("MasterBars"));
+
+    for (xml_node currentAutomation = automations.child("Automation");
+         currentAutomation;
+         currentAutomation = currentAutomation.next_sibling("Automation"))
     {
-        xml_node currentAutomation = node.node();
         Gpx::Automation gpxAutomation;
         gpxAutomation.type = currentAutomation.child_value("Type");
         gpxAutomation.linear = currentAutomation.child(
@@ -265,9 +374,16 @@ void Gpx::DocumentReader::readAutomations()
         convertStringToList(currentAutomation.child_value(
                                 "Value"), gpxAutomation.value);
 
+        // Ignore automations that don't refer to a valid bar.
+        if (gpxAutomation.bar < 0 || gpxAutomation.bar >= maxBar)
+            continue;
+
+        if (gpxAutomation.bar >= static_cast<int>(myAutomations.size()))
+            myAutomations.resize(gpxAutomation.bar + 1);
+
         // TODO - this code doesn't support having multiple automations in a
         // bar.
-        myAutomations[gpxAutomation.bar] = gpxAutomation;
+        myAutomations[gpxAutomation.bar] = std::move(gpxAutomation);
     }
 }
 
@@ -285,11 +401,9 @@ void Gpx::DocumentReader::readMasterBars(Score &score)
 
     int barIndex = 0;
     int startPos = 0;
-    for (xml_node masterBar : myFile.child("MasterBars"))
+    for (xml_node masterBar = myFile.child("MasterBars").child("MasterBar");
+         masterBar; masterBar = masterBar.next_sibling("MasterBar"))
     {
-        if (masterBar.name() != std::string("MasterBar"))
-            continue;
-
         // Try to create a new system every so often.
         if (startPos > POSITIONS_PER_SYSTEM)
         {
@@ -305,9 +419,9 @@ void Gpx::DocumentReader::readMasterBars(Score &score)
 
         Barline barline;
 
-        if (myAutomations.find(barIndex) != myAutomations.end())
+        if (barIndex < static_cast<int>(myAutomations.size()))
         {
-            const Automation automation = myAutomations.find(barIndex)->second;
+            const Automation &automation = myAutomations[barIndex];
             if (automation.type == "Tempo")
             {
                 if (automation.value.size() != 2)
@@ -343,31 +457,42 @@ void Gpx::DocumentReader::readMasterBars(Score &score)
             int currentPos = (startPos != 0) ? startPos + 1 : 0;
 
             // TODO - import multiple voices.
-            for (int beatId :
-                 myVoices[myBars[barIds[i]].voiceIds.at(0)].beatIds)
+            // Skip any bars or beats that are missing, rather than rejecting
+            // the whole file.
+            const Gpx::Bar *bar = findById(myBars, barIds[i]);
+            const Gpx::Voice *voice =
+                (bar && !bar->voiceIds.empty())
+                    ? findById(myVoices, bar->voiceIds.front())
+                    : nullptr;
+            if (!voice)
+                continue;
+
+            for (int beatId : voice->beatIds)
             {
-                const Gpx::Beat &beat = myBeats[beatId];
+                const Gpx::Beat *beat = findById(myBeats, beatId);
+                if (!beat)
+                    continue;
 
                 Position pos;
-                if (beat.arpeggioType == "Up")
+                if (beat->arpeggioType == "Up")
                     pos.setProperty(Position::ArpeggioUp);
-                else if (beat.arpeggioType == "Down")
+                else if (beat->arpeggioType == "Down")
                     pos.setProperty(Position::ArpeggioDown);
-                if (beat.brushDirection == "Up")
+                if (beat->brushDirection == "Up")
                     pos.setProperty(Position::PickStrokeDown);
-                else if (beat.brushDirection == "Down")
+                else if (beat->brushDirection == "Down")
                     pos.setProperty(Position::PickStrokeUp);
 
-                pos.setProperty(Position::TremoloPicking, beat.tremoloPicking);
-                pos.setProperty(Position::Acciaccatura, beat.graceNote);
+                pos.setProperty(Position::TremoloPicking, beat->tremoloPicking);
+                pos.setProperty(Position::Acciaccatura, beat->graceNote);
 
-                const Gpx::Rhythm &rhythm = myRhythms.at(beat.rhythmId);
+                const Gpx::Rhythm &rhythm = getById(myRhythms, beat->rhythmId);
                 pos.setDurationType(static_cast<Position::DurationType>(
                                         rhythm.noteValue));
                 pos.setProperty(Position::Dotted, rhythm.dotted);
                 pos.setProperty(Position::DoubleDotted, rhythm.doubleDotted);
 
-                for (int noteId : beat.noteIds)
+                for (int noteId : beat->noteIds)
                 {
                     Note note = convertNote(noteId, pos,
                                             score.getPlayers()[i].getTuning());
@@ -470,7 +595,7 @@ void Gpx::DocumentReader::readTimeSignature(const xml_node &masterBar,
 Note Gpx::DocumentReader::convertNote(int noteId, Position &position,
                                       const Tuning &tuning) const
 {
-    Gpx::TabNote gpxNote = myNotes.at(noteId);
+    const Gpx::TabNote &gpxNote = getById(myNotes, noteId);
     Note ptbNote;
 
     ptbNote.setProperty(Note::Tied, gpxNote.tied);
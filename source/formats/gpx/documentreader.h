@@ -18,9 +18,9 @@
 #ifndef FORMATS_GPX_DOCUMENTREADER_H
 #define FORMATS_GPX_DOCUMENTREADER_H
 
-#include <map>
 #include <pugixml.hpp>
 #include <score/note.h>
+#include <string>
 #include <vector>
 
 class Barline;
@@ -76,6 +76,8 @@ struct TabNote
     pugi::xml_node properties;
 };
 
+/// Automations are indexed by bar rather than by id. An automation with an
+/// empty type indicates that the bar has no automation.
 struct Automation
 {
     std::string type;
@@ -89,10 +91,14 @@ struct Automation
 class DocumentReader
 {
 public:
-    DocumentReader(const std::string &xml);
+    /// The XML is parsed in place, so the reader takes ownership of it.
+    DocumentReader(std::string xml);
 
     void readScore(Score &score);
 
+    /// Reads the header and tracks, but skips over all of the bars.
+    void readMetadata(Score &score);
+
 private:
     /// Loads the header information (song title, artist, etc).
     void readHeader(Score &score);
@@ -113,15 +119,19 @@ private:
                            TimeSignature &timeSignature);
     Note convertNote(int noteId, Position &position, const Tuning &tuning) const;
 
+    /// The document's nodes point into this buffer.
+    std::string myBuffer;
     pugi::xml_document myXmlData;
     pugi::xml_node myFile;
 
-    std::map<int, Gpx::Bar> myBars;
-    std::map<int, Gpx::Voice> myVoices;
-    std::map<int, Gpx::Beat> myBeats;
-    std::map<int, Gpx::Rhythm> myRhythms;
-    std::map<int, Gpx::TabNote> myNotes;
-    std::map<int, Gpx::Automation> myAutomations;
+    // GPIF ids are small consecutive integers, so they are used directly as
+    // indices into these tables.
+    std::vector<Gpx::Bar> myBars;
+    std::vector<Gpx::Voice> myVoices;
+    std::vector<Gpx::Beat> myBeats;
+    std::vector<Gpx::Rhythm> myRhythms;
+    std::vector<Gpx::TabNote> myNotes;
+    std::vector<Gpx::Automation> myAutomations;
 };
 }
 
@@ -22,6 +22,7 @@
 #include <cassert>
 #include <formats/fileformat.h>
 #include "util.h"
+#include <utility>
 
 enum ChunkHeader
 {
@@ -102,6 +103,17 @@ const std::string &Gpx::FileSystem::getFileContents(
         return file->second;
 }
 
+std::string Gpx::FileSystem::takeFileContents(const std::string &filename)
+{
+    auto file = myFiles.find(filename);
+    if (file == myFiles.end())
+        throw FileFormatException("Invalid filename");
+
+    std::string contents = std::move(file->second);
+    myFiles.erase(file);
+    return contents;
+}
+
 void Gpx::FileSystem::readUncompressedData(std::vector<uint8_t> &data)
 {
     // Remove the BCFS header.
@@ -145,8 +157,8 @@ void Gpx::FileSystem::readUncompressedData(std::vector<uint8_t> &data)
                 // Trim extra NULL characters.
                 fileName.erase(fileName.find_last_not_of('\0') + 1);
 
-                std::string file(fileData.begin(), fileData.begin() + fileSize);
-                myFiles[fileName] = file;
+                myFiles[fileName].assign(fileData.begin(),
+                                         fileData.begin() + fileSize);
             }
         }
     }
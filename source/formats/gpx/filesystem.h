@@ -36,6 +36,9 @@ public:
     FileSystem(std::istream &stream);
 
     const std::string &getFileContents(const std::string &filename) const;
+    /// Removes the file from the filesystem and returns its contents, which
+    /// avoids copying large files.
+    std::string takeFileContents(const std::string &filename);
 
 private:
     void readUncompressedData(std::vector<uint8_t> &data);
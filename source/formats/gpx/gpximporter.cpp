@@ -32,6 +32,15 @@ void GpxImporter::load(const std::string &filename, Score &score)
     std::ifstream file(filename.c_str(), std::ios::binary | std::ios::in);
     Gpx::FileSystem fs(file);
 
-    Gpx::DocumentReader reader(fs.getFileContents("score.gpif"));
+    Gpx::DocumentReader reader(fs.takeFileContents("score.gpif"));
     reader.readScore(score);
 }
+
+void GpxImporter::readMetadata(const std::string &filename, Score &score)
+{
+    std::ifstream file(filename.c_str(), std::ios::binary | std::ios::in);
+    Gpx::FileSystem fs(file);
+
+    Gpx::DocumentReader reader(fs.takeFileContents("score.gpif"));
+    reader.readMetadata(score);
+}
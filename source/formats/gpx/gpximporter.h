@@ -26,6 +26,9 @@ public:
     GpxImporter();
 
     virtual void load(const std::string &filename, Score &score) override;
+
+    virtual void readMetadata(const std::string &filename,
+                              Score &score) override;
 };
 
 #endif
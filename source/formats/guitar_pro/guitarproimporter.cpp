@@ -48,6 +48,27 @@ void GuitarProImporter::load(const std::string &filename, Score &score)
     std::ifstream in(filename, std::ios::binary | std::ios::in);
     Gp::InputStream stream(in);
 
+    std::vector<Gp::Bar> bars;
+    readTracksAndBarlines(stream, score, bars);
+    readSystems(stream, score, bars);
+
+    ScoreUtils::adjustRehearsalSigns(score);
+}
+
+void GuitarProImporter::readMetadata(const std::string &filename,
+                                     Score &score)
+{
+    std::ifstream in(filename, std::ios::binary | std::ios::in);
+    Gp::InputStream stream(in);
+
+    std::vector<Gp::Bar> bars;
+    readTracksAndBarlines(stream, score, bars);
+}
+
+void GuitarProImporter::readTracksAndBarlines(Gp::InputStream &stream,
+                                              Score &score,
+                                              std::vector<Gp::Bar> &bars)
+{
     findFileVersion(stream);
 
     ScoreInfo info;
@@ -73,13 +94,8 @@ void GuitarProImporter::load(const std::string &filename, Score &score)
     const uint32_t numMeasures = stream.read<uint32_t>();
     const uint32_t numTracks = stream.read<uint32_t>();
 
-    std::vector<Gp::Bar> bars;
     readBarlines(stream, numMeasures, bars);
-
     readTracks(stream, score, numTracks, channels);
-    readSystems(stream, score, bars);
-
-    ScoreUtils::adjustRehearsalSigns(score);
 }
 
 void GuitarProImporter::findFileVersion(Gp::InputStream &stream)
@@ -51,7 +51,17 @@ public:
 
     virtual void load(const std::string &filename, Score &score) override;
 
+    /// Reads the header and the tracks (players), which are stored before
+    /// the contents of the measures.
+    virtual void readMetadata(const std::string &filename,
+                              Score &score) override;
+
 private:
+    /// Reads everything up to the contents of the measures: the header, the
+    /// initial tempo, the measures' barlines, and the tracks.
+    void readTracksAndBarlines(Gp::InputStream &stream, Score &score,
+                               std::vector<Gp::Bar> &bars);
+
     /// Check that the file version string is valid, and set the version flag
     /// for the input stream.
     /// @throw FileFormatException
@@ -22,7 +22,126 @@
 #include <boost/iostreams/filter/gzip.hpp>
 #include <fstream>
 #include <score/score.h>
+#include <score/scoreinfo.h>
 #include <score/serialization.h>
+#include <sstream>
+
+namespace
+{
+/// Reads the members of the score object that are needed for the metadata.
+/// The systems are always empty, since they are removed from the text by
+/// readMetadataText().
+struct ScoreHeader
+{
+    template <class Archive>
+    void serialize(Archive &ar, const FileVersion /*version*/)
+    {
+        ar("score_info", myInfo);
+        ar("systems", mySystems);
+        ar("players", myPlayers);
+        ar("instruments", myInstruments);
+    }
+
+    ScoreInfo myInfo;
+    std::vector<System> mySystems;
+    std::vector<Player> myPlayers;
+    std::vector<Instrument> myInstruments;
+};
+}
+
+/// Skips over the rest of a JSON array or object, after its opening bracket
+/// has been read.
+static void skipJsonValue(std::istream &input)
+{
+    bool inString = false;
+    bool escaped = false;
+    int depth = 1;
+
+    char c;
+    while (input.get(c))
+    {
+        if (inString)
+        {
+            if (escaped)
+                escaped = false;
+            else if (c == '\\')
+                escaped = true;
+            else if (c == '"')
+                inString = false;
+        }
+        else if (c == '"')
+            inString = true;
+        else if (c == '{' || c == '[')
+            ++depth;
+        else if ((c == '}' || c == ']') && --depth == 0)
+            return;
+    }
+
+    throw FileFormatException("Unexpected end of file");
+}
+
+/// Copies the JSON text up to the end of the score object, and then closes
+/// the document object. The score's systems are replaced by an empty array,
+/// which avoids parsing most of the file. The players are stored after the
+/// systems, so the rest of the file still needs to be decompressed.
+static std::string readMetadataText(std::istream &input)
+{
+    std::string text;
+    std::string lastString;
+    std::string currentString;
+    bool inString = false;
+    bool escaped = false;
+    int depth = 0;
+
+    char c;
+    while (input.get(c))
+    {
+        if (inString)
+        {
+            text += c;
+
+            if (escaped)
+                escaped = false;
+            else if (c == '\\')
+                escaped = true;
+            else if (c == '"')
+            {
+                inString = false;
+                lastString = currentString;
+            }
+            else
+                currentString += c;
+        }
+        else if (c == '"')
+        {
+            text += c;
+            inString = true;
+            currentString.clear();
+        }
+        // The score's members are nested inside the document and score
+        // objects.
+        else if (c == '[' && depth == 2 && lastString == "systems")
+        {
+            skipJsonValue(input);
+            text += "[]";
+        }
+        else if (c == '{' || c == '[')
+        {
+            text += c;
+            ++depth;
+        }
+        else if (c == '}' || c == ']')
+        {
+            text += c;
+            if (--depth == 1)
+                return text + "}";
+        }
+        else
+            text += c;
+    }
+
+    throw FileFormatException("Unexpected end of file");
+}
 
 PowerTabImporter::PowerTabImporter()
     : FileFormatImporter(getPowerTabFileFormat())
@@ -41,3 +160,23 @@ void PowerTabImporter::load(const std::string &filename, Score &score)
     std::istream compressed_input(&in);
     ScoreUtils::load(compressed_input, "score", score);
 }
+
+void PowerTabImporter::readMetadata(const std::string &filename, Score &score)
+{
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    boost::iostreams::filtering_istreambuf in;
+    in.push(boost::iostreams::gzip_decompressor());
+    in.push(file);
+
+    std::istream compressed_input(&in);
+    std::istringstream header_input(readMetadataText(compressed_input));
+
+    ScoreHeader header;
+    ScoreUtils::load(header_input, "score", header);
+    score.setScoreInfo(header.myInfo);
+
+    for (const Player &player : header.myPlayers)
+        score.insertPlayer(player);
+    for (const Instrument &instrument : header.myInstruments)
+        score.insertInstrument(instrument);
+}
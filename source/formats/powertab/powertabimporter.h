@@ -26,6 +26,11 @@ public:
     PowerTabImporter();
 
     virtual void load(const std::string &filename, Score &score) override;
+
+    /// Reads the score information, players, and instruments, but skips
+    /// over the systems without parsing them.
+    virtual void readMetadata(const std::string &filename,
+                              Score &score) override;
 };
 
 #endif
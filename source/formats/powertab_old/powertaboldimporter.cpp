@@ -27,10 +27,12 @@
 #include "powertabdocument/note.h"
 #include "powertabdocument/position.h"
 #include "powertabdocument/powertabdocument.h"
+#include "powertabdocument/powertabinputstream.h"
 #include "powertabdocument/score.h"
 #include "powertabdocument/staff.h"
 #include "powertabdocument/system.h"
 #include "powertabdocument/tempomarker.h"
+#include <fstream>
 #include <score/generalmidi.h>
 #include <score/score.h>
 #include <score/systemlocation.h>
@@ -42,6 +44,18 @@ PowerTabOldImporter::PowerTabOldImporter()
 }
 
 void PowerTabOldImporter::load(const std::string &filename, Score &score)
+{
+    Score guitarScore;
+    Score bassScore;
+    loadUnmerged(filename, score, guitarScore, bassScore);
+
+    ScoreMerger merger(score, guitarScore, bassScore);
+    merger.merge();
+}
+
+void PowerTabOldImporter::loadUnmerged(const std::string &filename,
+                                       Score &score, Score &guitarScore,
+                                       Score &bassScore)
 {
     PowerTabDocument::Document document;
     document.Load(filename);
@@ -54,16 +68,31 @@ void PowerTabOldImporter::load(const std::string &filename, Score &score)
     
     assert(document.GetNumberOfScores() == 2);
 
-    // Convert the guitar score.
-    Score guitarScore;
+    // Convert the guitar and bass scores.
     convert(*document.GetScore(0), guitarScore);
-
-    // Convert and then merge the bass score.
-    Score bassScore;
     convert(*document.GetScore(1), bassScore);
+}
 
-    ScoreMerger merger(score, guitarScore, bassScore);
-    merger.merge();
+void PowerTabOldImporter::readMetadata(const std::string &filename,
+                                       Score &score)
+{
+    std::ifstream file(filename.c_str(),
+                       std::ifstream::in | std::ifstream::binary);
+    PowerTabDocument::PowerTabInputStream stream(file);
+
+    PowerTabDocument::PowerTabFileHeader header;
+    if (!header.Deserialize(stream))
+        throw FileFormatException("Invalid header");
+
+    ScoreInfo info;
+    convert(header, info);
+    score.setScoreInfo(info);
+
+    std::vector<PowerTabDocument::Score::GuitarPtr> guitars;
+    stream.ReadVector(guitars, header.GetVersion());
+
+    for (auto &guitar : guitars)
+        convert(*guitar, score);
 }
 
 void PowerTabOldImporter::convert(
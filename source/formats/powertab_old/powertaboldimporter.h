@@ -63,6 +63,17 @@ public:
     PowerTabOldImporter();
     virtual void load(const std::string &filename, Score &score) override;
 
+    /// Loads the file's header and its guitar and bass scores, which load()
+    /// then merges into a single score.
+    void loadUnmerged(const std::string &filename, Score &score,
+                      Score &guitarScore, Score &bassScore);
+
+    /// Reads the header and the guitar score's players, which are stored
+    /// immediately after the header. The bass score's players are not
+    /// imported, since they follow the entire guitar score.
+    virtual void readMetadata(const std::string &filename,
+                              Score &score) override;
+
 private:
     static void convert(const PowerTabDocument::PowerTabFileHeader &header,
                         ScoreInfo &info);
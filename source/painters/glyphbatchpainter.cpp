@@ -0,0 +1,117 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "glyphbatchpainter.h"
+
+#include <QFontMetricsF>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+GlyphCache::Glyph::Glyph(const QFont &font, const QString &text)
+    : myFont(font),
+      myText(text)
+{
+    const QFontMetricsF fm(myFont);
+    myWidth = fm.width(text);
+    myHeight = fm.height();
+
+    myText.setTextFormat(Qt::PlainText);
+    myText.setPerformanceHint(QStaticText::AggressiveCaching);
+    myText.prepare(QTransform(), myFont);
+}
+
+const GlyphCache::Glyph &GlyphCache::get(const QFont &font,
+                                         const QString &text)
+{
+    const auto key = std::make_pair(font.key(), text);
+
+    auto it = myGlyphs.find(key);
+    if (it == myGlyphs.end())
+        it = myGlyphs.insert(std::make_pair(key, Glyph(font, text))).first;
+
+    return it->second;
+}
+
+GlyphBatchPainter::Entry::Entry(const GlyphCache::Glyph &glyph,
+                                const QPointF &pos, const QColor &color)
+    : myGlyph(&glyph), myPosition(pos), myColor(color)
+{
+}
+
+GlyphBatchPainter::GlyphBatchPainter(const std::shared_ptr<GlyphCache> &cache)
+    : myCache(cache)
+{
+    // Only paint the entries that intersect the exposed area.
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    // Let mouse clicks pass through to the staff below.
+    setAcceptedMouseButtons(Qt::NoButton);
+}
+
+void GlyphBatchPainter::addText(const QFont &font, const QString &text,
+                                const QPointF &pos, const QColor &color)
+{
+    const GlyphCache::Glyph &glyph = myCache->get(font, text);
+    myEntries.push_back(Entry(glyph, pos, color));
+
+    prepareGeometryChange();
+    myBounds |= QRectF(pos, QSizeF(glyph.myWidth, glyph.myHeight));
+}
+
+double GlyphBatchPainter::getTextWidth(const QFont &font, const QString &text)
+{
+    return myCache->get(font, text).myWidth;
+}
+
+size_t GlyphBatchPainter::getMemoryUsage() const
+{
+    return myEntries.capacity() * sizeof(Entry);
+}
+
+void GlyphBatchPainter::paint(QPainter *painter,
+                              const QStyleOptionGraphicsItem *option, QWidget *)
+{
+    const QRectF exposed = option->exposedRect;
+    const QFont *currentFont = nullptr;
+    QColor currentColor;
+
+    for (const Entry &entry : myEntries)
+    {
+        const GlyphCache::Glyph &glyph = *entry.myGlyph;
+        if (!exposed.intersects(QRectF(entry.myPosition,
+                                       QSizeF(glyph.myWidth, glyph.myHeight))))
+        {
+            continue;
+        }
+
+        // Avoid redundant state changes, since most consecutive entries use
+        // the same font and color.
+        if (currentFont != &glyph.myFont &&
+            (!currentFont || *currentFont != glyph.myFont))
+        {
+            painter->setFont(glyph.myFont);
+            currentFont = &glyph.myFont;
+        }
+
+        if (!currentColor.isValid() || currentColor != entry.myColor)
+        {
+            painter->setPen(entry.myColor);
+            currentColor = entry.myColor;
+        }
+
+        painter->drawStaticText(entry.myPosition, glyph.myText);
+    }
+}
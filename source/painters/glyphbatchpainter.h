@@ -0,0 +1,96 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAINTERS_GLYPHBATCHPAINTER_H
+#define PAINTERS_GLYPHBATCHPAINTER_H
+
+#include <map>
+#include <memory>
+#include <QColor>
+#include <QFont>
+#include <QGraphicsItem>
+#include <QStaticText>
+#include <utility>
+#include <vector>
+
+/// Caches the laid out text for each (font, string) pair, so that common
+/// strings such as fret numbers and music symbols are only shaped once.
+class GlyphCache
+{
+public:
+    struct Glyph
+    {
+        Glyph(const QFont &font, const QString &text);
+
+        QFont myFont;
+        QStaticText myText;
+        double myWidth;
+        double myHeight;
+    };
+
+    /// Returns the cached text layout, creating it if necessary.
+    /// The returned reference remains valid for the lifetime of the cache.
+    const Glyph &get(const QFont &font, const QString &text);
+
+private:
+    std::map<std::pair<QString, QString>, Glyph> myGlyphs;
+};
+
+/// Paints a large number of text items (tab numbers, noteheads, rests, etc)
+/// as a single graphics item, rather than creating a separate
+/// QGraphicsSimpleTextItem for each one.
+class GlyphBatchPainter : public QGraphicsItem
+{
+public:
+    GlyphBatchPainter(const std::shared_ptr<GlyphCache> &cache);
+
+    /// Adds text whose top-left corner is at the given location.
+    void addText(const QFont &font, const QString &text, const QPointF &pos,
+                 const QColor &color = Qt::black);
+
+    /// Returns the width of the text in the given font.
+    double getTextWidth(const QFont &font, const QString &text);
+
+    /// Returns the number of bytes allocated for the text items.
+    size_t getMemoryUsage() const;
+
+    virtual void paint(QPainter *painter,
+                       const QStyleOptionGraphicsItem *option,
+                       QWidget *) override;
+
+    virtual QRectF boundingRect() const override
+    {
+        return myBounds;
+    }
+
+private:
+    struct Entry
+    {
+        Entry(const GlyphCache::Glyph &glyph, const QPointF &pos,
+              const QColor &color);
+
+        const GlyphCache::Glyph *myGlyph;
+        QPointF myPosition;
+        QColor myColor;
+    };
+
+    std::shared_ptr<GlyphCache> myCache;
+    std::vector<Entry> myEntries;
+    QRectF myBounds;
+};
+
+#endif
@@ -0,0 +1,249 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "imageexporter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <cmath>
+#include <numeric>
+#include <painters/layoutinfo.h>
+#include <painters/systemrenderer.h>
+#include <QFileInfo>
+#include <QGraphicsItem>
+#include <QGraphicsScene>
+#include <QImage>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QSvgGenerator>
+#include <QtConcurrentMap>
+#include <score/score.h>
+#include <stdexcept>
+
+static const double PAGE_MARGIN = 40;
+static const double PAGE_WIDTH = LayoutInfo::STAFF_WIDTH + 2 * PAGE_MARGIN;
+/// Use the proportions of a letter-sized page.
+static const double PAGE_HEIGHT = PAGE_WIDTH * 11 / 8.5;
+static const double SYSTEM_SPACING = 50;
+
+ImageExporter::ImageExporter(const Score &score, Staff::ViewType view)
+    : myScore(score),
+      myView(view),
+      myScale(2)
+{
+}
+
+boost::optional<ImageExporter::Format> ImageExporter::findFormat(
+    const std::string &extension)
+{
+    const std::string ext = boost::algorithm::to_lower_copy(extension);
+
+    if (ext == "png")
+        return Png;
+    else if (ext == "svg")
+        return Svg;
+    else if (ext == "pdf")
+        return Pdf;
+    else
+        return boost::none;
+}
+
+void ImageExporter::setScale(double scale)
+{
+    myScale = scale;
+}
+
+std::vector<std::string> ImageExporter::exportPages(
+    const std::string &filename, Format format)
+{
+    renderSystems();
+    paginate();
+
+    std::vector<std::string> files;
+    if (format == Pdf)
+    {
+        if (!writePdf(filename))
+            throw std::runtime_error("Could not write " + filename);
+
+        files.push_back(filename);
+        return files;
+    }
+
+    const QFileInfo info(QString::fromStdString(filename));
+    for (size_t i = 0; i < myPages.size(); ++i)
+    {
+        files.push_back(QString("%1/%2-%3.%4")
+                            .arg(info.path())
+                            .arg(info.completeBaseName())
+                            .arg(i + 1)
+                            .arg(info.suffix())
+                            .toStdString());
+    }
+
+    // Each page is written to its own file, so the pages can be rasterized
+    // in parallel.
+    std::vector<int> pages(myPages.size());
+    std::iota(pages.begin(), pages.end(), 0);
+    std::atomic<bool> failed(false);
+
+    QtConcurrent::blockingMap(pages, [&](int page) {
+        const bool success = (format == Png)
+                                 ? writePng(myPages[page], files[page])
+                                 : writeSvg(myPages[page], files[page]);
+        if (!success)
+            failed = true;
+    });
+
+    if (failed)
+        throw std::runtime_error("Could not write " + filename);
+
+    return files;
+}
+
+void ImageExporter::renderSystems()
+{
+    const int numSystems = myScore.getSystems().size();
+    mySystems.assign(numSystems, RenderedSystem());
+
+    std::vector<int> systems(numSystems);
+    std::iota(systems.begin(), systems.end(), 0);
+
+    QtConcurrent::blockingMap(systems, [&](int index) {
+        // Each thread uses its own renderer and scene, since they are not
+        // thread-safe.
+        SystemRenderer renderer(nullptr, myScore);
+        QGraphicsScene scene;
+        scene.addItem(renderer(myScore.getSystems()[index], index, myView));
+
+        const QRectF bounds = scene.itemsBoundingRect();
+        RenderedSystem &system = mySystems[index];
+        system.mySize = bounds.size();
+
+        QPainter painter(&system.myPicture);
+        scene.render(&painter, QRectF(QPointF(0, 0), bounds.size()), bounds);
+    });
+}
+
+void ImageExporter::paginate()
+{
+    myPages.clear();
+
+    Page page;
+    double y = PAGE_MARGIN;
+    for (size_t i = 0; i < mySystems.size(); ++i)
+    {
+        const double height = mySystems[i].mySize.height();
+
+        // Start a new page if the system doesn't fit. A system that is taller
+        // than a page is scaled down when the page is painted.
+        if (!page.empty() && y + height > PAGE_HEIGHT - PAGE_MARGIN)
+        {
+            myPages.push_back(page);
+            page.clear();
+            y = PAGE_MARGIN;
+        }
+
+        page.push_back(std::make_pair(static_cast<int>(i), y));
+        y += height + SYSTEM_SPACING;
+    }
+
+    if (!page.empty() || myPages.empty())
+        myPages.push_back(page);
+}
+
+void ImageExporter::paintPage(QPainter &painter, const Page &page) const
+{
+    for (auto &entry : page)
+    {
+        const RenderedSystem &system = mySystems[entry.first];
+
+        painter.save();
+        painter.translate(PAGE_MARGIN, entry.second);
+
+        const double available = PAGE_HEIGHT - PAGE_MARGIN - entry.second;
+        if (system.mySize.height() > available)
+        {
+            const double scale = available / system.mySize.height();
+            painter.scale(scale, scale);
+        }
+
+        painter.drawPicture(0, 0, system.myPicture);
+        painter.restore();
+    }
+}
+
+bool ImageExporter::writePng(const Page &page,
+                             const std::string &filename) const
+{
+    QImage image(static_cast<int>(std::ceil(PAGE_WIDTH * myScale)),
+                 static_cast<int>(std::ceil(PAGE_HEIGHT * myScale)),
+                 QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+
+    QPainter painter(&image);
+    painter.setRenderHints(QPainter::Antialiasing |
+                           QPainter::TextAntialiasing);
+    painter.scale(myScale, myScale);
+    paintPage(painter, page);
+    painter.end();
+
+    return image.save(QString::fromStdString(filename), "PNG");
+}
+
+bool ImageExporter::writeSvg(const Page &page,
+                             const std::string &filename) const
+{
+    QSvgGenerator generator;
+    generator.setFileName(QString::fromStdString(filename));
+    generator.setSize(QSize(static_cast<int>(PAGE_WIDTH),
+                            static_cast<int>(PAGE_HEIGHT)));
+    generator.setViewBox(QRectF(0, 0, PAGE_WIDTH, PAGE_HEIGHT));
+
+    QPainter painter;
+    if (!painter.begin(&generator))
+        return false;
+
+    paintPage(painter, page);
+    return painter.end();
+}
+
+bool ImageExporter::writePdf(const std::string &filename) const
+{
+    QPdfWriter writer(QString::fromStdString(filename));
+    writer.setPageSize(QPagedPaintDevice::Letter);
+
+    QPainter painter;
+    if (!painter.begin(&writer))
+        return false;
+
+    const double scale = std::min(writer.width() / PAGE_WIDTH,
+                                  writer.height() / PAGE_HEIGHT);
+
+    for (size_t i = 0; i < myPages.size(); ++i)
+    {
+        if (i > 0)
+            writer.newPage();
+
+        painter.save();
+        painter.scale(scale, scale);
+        paintPage(painter, myPages[i]);
+        painter.restore();
+    }
+
+    return painter.end();
+}
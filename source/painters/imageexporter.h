@@ -0,0 +1,90 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAINTERS_IMAGEEXPORTER_H
+#define PAINTERS_IMAGEEXPORTER_H
+
+#include <boost/optional/optional.hpp>
+#include <QPicture>
+#include <score/staff.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+class QPainter;
+class Score;
+
+/// Exports the score as PNG or SVG pages, or as a PDF file, without needing a
+/// ScoreArea. A QApplication is still required, but it can use the
+/// "offscreen" platform when there is no display available.
+class ImageExporter
+{
+public:
+    enum Format
+    {
+        Png,
+        Svg,
+        Pdf
+    };
+
+    ImageExporter(const Score &score, Staff::ViewType view = Staff::GuitarView);
+
+    /// Returns the format corresponding to the given extension.
+    static boost::optional<Format> findFormat(const std::string &extension);
+
+    /// Sets the resolution of PNG pages, relative to the size of the score
+    /// on screen.
+    void setScale(double scale);
+
+    /// Renders the score and splits it into pages. Each PNG or SVG page is
+    /// written to a separate file (e.g. "score-1.png"), while a PDF file
+    /// contains all of the pages.
+    /// @returns The names of the files that were written.
+    /// @throw std::runtime_error If a file could not be written.
+    std::vector<std::string> exportPages(const std::string &filename,
+                                         Format format);
+
+private:
+    struct RenderedSystem
+    {
+        QPicture myPicture;
+        QSizeF mySize;
+    };
+
+    /// The systems on a page, along with their vertical offsets.
+    typedef std::vector<std::pair<int, double>> Page;
+
+    /// Renders each system into a separate scene and records it as a
+    /// picture. The systems are rendered in parallel.
+    void renderSystems();
+
+    /// Assigns the rendered systems to pages.
+    void paginate();
+
+    void paintPage(QPainter &painter, const Page &page) const;
+    bool writePng(const Page &page, const std::string &filename) const;
+    bool writeSvg(const Page &page, const std::string &filename) const;
+    bool writePdf(const std::string &filename) const;
+
+    const Score &myScore;
+    const Staff::ViewType myView;
+    double myScale;
+    std::vector<RenderedSystem> mySystems;
+    std::vector<Page> myPages;
+};
+
+#endif
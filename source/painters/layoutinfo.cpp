@@ -27,6 +27,7 @@
 #include <score/utils.h>
 #include <score/voiceutils.h>
 #include <set>
+#include <util/tracing.h>
 
 const double LayoutInfo::STAFF_WIDTH = 750;
 const int LayoutInfo::NUM_STD_NOTATION_LINES = 5;
@@ -54,6 +55,8 @@ LayoutInfo::LayoutInfo(const Score &score, const System &system, int systemIndex
       myStdNotationStaffAboveSpacing(0),
       myStdNotationStaffBelowSpacing(0)
 {
+    PTE_TRACE_SCOPE("LayoutInfo::LayoutInfo");
+
     computePositionSpacing();
     calculateTabStaffBelowLayout();
     calculateTabStaffAboveLayout();
@@ -317,29 +320,38 @@ static void updateMaxPosition(int &max, const Range &range)
         max = std::max(max, obj.getPosition());
 }
 
-void LayoutInfo::computePositionSpacing()
+int LayoutInfo::getNumPositions(const System &system)
 {
-    const double width = getFirstPositionX() + getCumulativeBarlineWidths();
+    int numPositions = 0;
 
-    // Find the number of positions needed for the system.
-    for (const Staff &staff : mySystem.getStaves())
+    for (const Staff &staff : system.getStaves())
     {
         for (const Voice &voice : staff.getVoices())
         {
             for (const Position &position : voice.getPositions())
             {
-                myNumPositions = std::max(myNumPositions,
-                                          position.getPosition());
+                numPositions = std::max(numPositions,
+                                        position.getPosition());
             }
         }
     }
 
-    updateMaxPosition(myNumPositions, mySystem.getBarlines());
-    updateMaxPosition(myNumPositions, mySystem.getTempoMarkers());
-    updateMaxPosition(myNumPositions, mySystem.getAlternateEndings());
-    updateMaxPosition(myNumPositions, mySystem.getChords());
-    updateMaxPosition(myNumPositions, mySystem.getDirections());
-    updateMaxPosition(myNumPositions, mySystem.getPlayerChanges());
+    updateMaxPosition(numPositions, system.getBarlines());
+    updateMaxPosition(numPositions, system.getTempoMarkers());
+    updateMaxPosition(numPositions, system.getAlternateEndings());
+    updateMaxPosition(numPositions, system.getChords());
+    updateMaxPosition(numPositions, system.getDirections());
+    updateMaxPosition(numPositions, system.getPlayerChanges());
+
+    return numPositions;
+}
+
+void LayoutInfo::computePositionSpacing()
+{
+    const double width = getFirstPositionX() + getCumulativeBarlineWidths();
+
+    // Find the number of positions needed for the system.
+    myNumPositions = getNumPositions(mySystem);
 
     const double availableSpace = STAFF_WIDTH - width;
     myPositionSpacing = availableSpace / (myNumPositions + 2);
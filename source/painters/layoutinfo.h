@@ -117,6 +117,8 @@ struct LayoutInfo
 
     double getPositionSpacing() const;
     int getNumPositions() const;
+    /// Returns the number of positions that are needed for the system.
+    static int getNumPositions(const System &system);
     double getFirstPositionX() const;
     double getPositionX(int position) const;
     int getPositionFromX(double x) const;
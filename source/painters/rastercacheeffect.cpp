@@ -0,0 +1,124 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "rastercacheeffect.h"
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QPaintDevice>
+#include <QStyleOptionGraphicsItem>
+#include <QtMath>
+
+/// Paints the item and its children (in stacking order) with the given
+/// transform from the item's coordinates to the painter's coordinates.
+static void paintItem(QPainter &painter, QGraphicsItem &item,
+                      const QTransform &transform)
+{
+    if (!item.isVisible())
+        return;
+
+    painter.save();
+    painter.setOpacity(painter.opacity() * item.opacity());
+
+    const QList<QGraphicsItem *> children = item.childItems();
+    auto paintChild = [&](QGraphicsItem *child) {
+        paintItem(painter, *child, child->itemTransform(&item) * transform);
+    };
+
+    int i = 0;
+    for (; i < children.size() &&
+           (children[i]->flags() & QGraphicsItem::ItemStacksBehindParent);
+         ++i)
+    {
+        paintChild(children[i]);
+    }
+
+    if (!(item.flags() & QGraphicsItem::ItemHasNoContents))
+    {
+        QStyleOptionGraphicsItem option;
+        option.exposedRect = item.boundingRect();
+        option.rect = option.exposedRect.toAlignedRect();
+
+        painter.save();
+        painter.setTransform(transform, true);
+        item.paint(&painter, &option, nullptr);
+        painter.restore();
+    }
+
+    for (; i < children.size(); ++i)
+        paintChild(children[i]);
+
+    painter.restore();
+}
+
+RasterCacheEffect::RasterCacheEffect(QGraphicsItem *item, QObject *parent)
+    : QGraphicsEffect(parent), myItem(item)
+{
+}
+
+RasterCacheEffect::~RasterCacheEffect()
+{
+    QPixmapCache::remove(myKey);
+}
+
+void RasterCacheEffect::draw(QPainter *painter)
+{
+    // The pixmap is in logical coordinates, so it stays valid when the view is
+    // scrolled. It is rendered at the device's resolution so that it isn't
+    // blurry on high DPI screens.
+    const qreal ratio = painter->device()->devicePixelRatio();
+    const QRectF bounds = sourceBoundingRect(Qt::LogicalCoordinates);
+
+    QPixmap pixmap;
+    if (!QPixmapCache::find(myKey, &pixmap) ||
+        pixmap.devicePixelRatio() != ratio)
+    {
+        pixmap = renderPixmap(bounds, ratio, painter->renderHints());
+        QPixmapCache::remove(myKey);
+        myKey = QPixmapCache::insert(pixmap);
+    }
+
+    if (!pixmap.isNull())
+        painter->drawPixmap(bounds.topLeft(), pixmap);
+}
+
+void RasterCacheEffect::sourceChanged(ChangeFlags)
+{
+    QPixmapCache::remove(myKey);
+    myKey = QPixmapCache::Key();
+}
+
+QPixmap RasterCacheEffect::renderPixmap(const QRectF &bounds, qreal ratio,
+                                        QPainter::RenderHints hints) const
+{
+    if (bounds.isEmpty())
+        return QPixmap();
+
+    QPixmap pixmap(qCeil(bounds.width() * ratio),
+                   qCeil(bounds.height() * ratio));
+    pixmap.setDevicePixelRatio(ratio);
+    pixmap.fill(Qt::transparent);
+
+    // The children are painted directly rather than with drawSource(), which
+    // skips any children that are outside of the exposed part of the view.
+    QPainter painter(&pixmap);
+    painter.setRenderHints(hints);
+    paintItem(painter, *myItem,
+              QTransform::fromTranslate(-bounds.left(), -bounds.top()));
+
+    return pixmap;
+}
@@ -0,0 +1,52 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAINTERS_RASTERCACHEEFFECT_H
+#define PAINTERS_RASTERCACHEEFFECT_H
+
+#include <QGraphicsEffect>
+#include <QPainter>
+#include <QPixmapCache>
+
+class QGraphicsItem;
+
+/// Paints an item and its children from a cached pixmap, so that scrolling
+/// past a system doesn't repaint each of its (possibly thousands of) child
+/// items. The pixmap is regenerated whenever the item or one of its children
+/// is updated.
+class RasterCacheEffect : public QGraphicsEffect
+{
+public:
+    /// @param item The item that the effect is applied to.
+    RasterCacheEffect(QGraphicsItem *item, QObject *parent = nullptr);
+    ~RasterCacheEffect();
+
+protected:
+    virtual void draw(QPainter *painter) override;
+    virtual void sourceChanged(ChangeFlags flags) override;
+
+private:
+    /// Renders the item and its children at the given device pixel ratio.
+    QPixmap renderPixmap(const QRectF &bounds, qreal ratio,
+                         QPainter::RenderHints hints) const;
+
+    QGraphicsItem *myItem;
+    /// The pixmap is stored in QPixmapCache, so it may be evicted.
+    QPixmapCache::Key myKey;
+};
+
+#endif
@@ -18,10 +18,13 @@
 #include "stdnotationnote.h"
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/functional/hash.hpp>
+#include <map>
 #include <numeric>
 #include <painters/layoutinfo.h>
 #include <painters/musicfont.h>
 #include <QFontMetricsF>
+#include <QMutex>
 #include <score/generalmidi.h>
 #include <score/score.h>
 #include <score/tuning.h>
@@ -39,8 +42,16 @@ static const std::unordered_map<char, int> theNotePositions = {
 StdNotationNote::StdNotationNote(const Position &pos, const Note &note,
                                  const KeySignature &key, const Tuning &tuning,
                                  double y)
+    : StdNotationNote(pos, note, key, tuning, y, NoAccidental)
+{
+    computeAccidentalType(false);
+}
+
+StdNotationNote::StdNotationNote(const Position &pos, const Note &note,
+                                 const KeySignature &key, const Tuning &tuning,
+                                 double y, AccidentalType accidental)
     : myY(y),
-      myAccidentalType(NoAccidental),
+      myAccidentalType(accidental),
       myPosition(&pos),
       myNote(&note),
       myKey(&key),
@@ -68,8 +79,96 @@ StdNotationNote::StdNotationNote(const Position &pos, const Note &note,
         myNoteHeadSymbol = MusicFont::MutedNoteHead;
     else if (pos.hasProperty(Position::Acciaccatura))
         myNoteHeadSymbol = MusicFont::QuarterNoteOrLess;
+}
 
-    computeAccidentalType(false);
+namespace
+{
+/// The computed notation for the notes in a bar, in the order that the notes
+/// appear.
+struct BarNotation
+{
+    std::vector<double> myLocations;
+    std::vector<StdNotationNote::AccidentalType> myAccidentals;
+};
+
+struct BarKeyHash
+{
+    size_t operator()(const std::vector<int> &key) const
+    {
+        return boost::hash_range(key.begin(), key.end());
+    }
+};
+
+/// Caches the notation for each bar, keyed by everything that affects the
+/// location and accidentals of the notes (clef, key signature, pitches, and
+/// octave symbols). Since the key describes the bar's contents, editing a
+/// note only requires that bar to be recomputed.
+class BarNotationCache
+{
+public:
+    bool find(const std::vector<int> &key, BarNotation &notation)
+    {
+        QMutexLocker lock(&myMutex);
+
+        auto it = myBars.find(key);
+        if (it == myBars.end())
+            return false;
+
+        notation = it->second;
+        return true;
+    }
+
+    void insert(const std::vector<int> &key, const BarNotation &notation)
+    {
+        QMutexLocker lock(&myMutex);
+
+        // Keep the cache from growing without bound.
+        if (myBars.size() >= MAX_SIZE)
+            myBars.clear();
+
+        myBars[key] = notation;
+    }
+
+private:
+    static const size_t MAX_SIZE = 50000;
+
+    QMutex myMutex;
+    std::unordered_map<std::vector<int>, BarNotation, BarKeyHash> myBars;
+};
+
+BarNotationCache theBarNotationCache;
+
+/// If there is no active player, use standard 8-string tuning as a default
+/// for calculating the music notation.
+Tuning getFallbackTuning()
+{
+    Tuning tuning;
+    std::vector<uint8_t> tuningNotes = tuning.getNotes();
+    tuningNotes.push_back(Midi::MIDI_NOTE_B2);
+    tuningNotes.push_back(Midi::MIDI_NOTE_E1);
+    tuning.setNotes(tuningNotes);
+    return tuning;
+}
+
+const Tuning theFallbackTuning = getFallbackTuning();
+
+/// Returns the width of each note head symbol in the music font.
+std::map<QChar, double> getNoteHeadWidths()
+{
+    const QFontMetricsF fm(MusicFont().getFont());
+
+    std::map<QChar, double> widths;
+    for (QChar symbol : { MusicFont::WholeNote, MusicFont::HalfNote,
+                          MusicFont::QuarterNoteOrLess,
+                          MusicFont::NaturalHarmonicNoteHead,
+                          MusicFont::ArtificialHarmonicNoteHead,
+                          MusicFont::MutedNoteHead })
+    {
+        widths[symbol] = fm.width(symbol);
+    }
+
+    return widths;
+}
 }
 
 void StdNotationNote::getNotesInStaff(
@@ -79,16 +178,40 @@ void StdNotationNote::getNotesInStaff(
     std::array<std::vector<NoteStem>, Staff::NUM_VOICES> &stemsByVoice,
     std::array<std::vector<BeamGroup>, Staff::NUM_VOICES> &groupsByVoice)
 {
-    // If there is no active player, use standard 8-string tuning as a default
-    // for calculating the music notation.
-    Tuning fallbackTuning;
-    std::vector<uint8_t> tuningNotes = fallbackTuning.getNotes();
-    tuningNotes.push_back(Midi::MIDI_NOTE_B2);
-    tuningNotes.push_back(Midi::MIDI_NOTE_E1);
-    fallbackTuning.setNotes(tuningNotes);
+    // The font metrics are only computed once, rather than for every staff.
+    static const std::map<QChar, double> theNoteHeadWidths =
+        getNoteHeadWidths();
+
+    // Find the players that are active at the start of the system, so that
+    // only the player changes within this system need to be checked.
+    const PlayerChange *initialPlayers =
+        ScoreUtils::getCurrentPlayers(score, systemIndex, -1);
+
+    // Find an active player so that we know what tuning to use.
+    auto getTuning = [&](int position) -> const Tuning & {
+        const PlayerChange *players = initialPlayers;
+        for (const PlayerChange &change : system.getPlayerChanges())
+        {
+            if (change.getPosition() <= position)
+                players = &change;
+        }
+
+        if (players)
+        {
+            const std::vector<ActivePlayer> activePlayers =
+                players->getActivePlayers(staffIndex);
+            if (!activePlayers.empty())
+            {
+                return score.getPlayers()[
+                    activePlayers.front().getPlayerNumber()].getTuning();
+            }
+        }
+
+        return theFallbackTuning;
+    };
 
-    QFont musicFont(MusicFont().getFont());
-    QFontMetricsF fm(musicFont);
+    std::vector<int> barKey;
+    std::vector<const Tuning *> tunings;
 
     int voiceIndex = 0;
     for (const Voice &voice : staff.getVoices())
@@ -103,13 +226,44 @@ void StdNotationNote::getNotesInStaff(
                 break;
 
             const size_t firstStem = stems.size();
+            const KeySignature &key = bar.getKeySignature();
+            auto positions = ScoreUtils::findInRange(voice.getPositions(),
+                                                     bar.getPosition(),
+                                                     nextBar->getPosition());
+
+            // Build the cache key for the bar.
+            barKey.clear();
+            barKey.push_back(staff.getClefType());
+            barKey.push_back(key.getKeyType());
+            barKey.push_back(key.getNumAccidentals());
+            barKey.push_back(key.usesSharps());
+            tunings.clear();
+
+            for (const Position &pos : positions)
+            {
+                if (pos.isRest() || pos.hasMultiBarRest())
+                    continue;
+
+                const Tuning &tuning = getTuning(pos.getPosition());
+                tunings.push_back(&tuning);
+
+                for (const Note &note : pos.getNotes())
+                {
+                    barKey.push_back(tuning.getNote(note.getString(), true) +
+                                     note.getFretNumber());
+                    barKey.push_back(getOctaveOffset(note));
+                }
+            }
+
+            BarNotation notation;
+            const bool isCached = theBarNotationCache.find(barKey, notation);
 
             // Store the current accidental for each line/space in the staff.
             std::map<int, AccidentalType> accidentals;
+            size_t tuningIndex = 0;
+            size_t noteIndex = 0;
 
-            for (const Position &pos : ScoreUtils::findInRange(
-                     voice.getPositions(), bar.getPosition(),
-                     nextBar->getPosition()))
+            for (const Position &pos : positions)
             {
                 Q_ASSERT(pos.getPosition() == 0 ||
                          pos.getPosition() != bar.getPosition());
@@ -126,59 +280,60 @@ void StdNotationNote::getNotesInStaff(
                     continue;
                 }
 
-                // Find an active player so that we know what tuning to use.
-                std::vector<ActivePlayer> activePlayers;
-                const PlayerChange *players = ScoreUtils::getCurrentPlayers(
-                            score, systemIndex, pos.getPosition());
-                if (players)
-                    activePlayers = players->getActivePlayers(staffIndex);
-
-                const Player *player = nullptr;
-                if (!activePlayers.empty())
-                {
-                    player = &score.getPlayers()[
-                            activePlayers.front().getPlayerNumber()];
-                }
-
+                const Tuning &tuning = *tunings[tuningIndex++];
                 double noteHeadWidth = 0;
 
                 for (const Note &note : pos.getNotes())
                 {
-                    const Tuning tuning = player ? player->getTuning() :
-                                                   fallbackTuning;
-                    const double y = getNoteLocation(
-                                staff, note, bar.getKeySignature(), tuning);
-
-                    noteLocations.push_back(y);
-
-                    notes.push_back(StdNotationNote(
-                                        pos, note, bar.getKeySignature(),
-                                        tuning, y));
-                    StdNotationNote &stdNote = notes.back();
-
-                    // Don't show accidentals if there are consecutive
-                    // identical notes on that line/space in the staff.
-                    if (accidentals.find(y) != accidentals.end() &&
-                        accidentals.find(y)->second == stdNote.getAccidentalType())
+                    if (isCached)
                     {
-                        stdNote.clearAccidental();
+                        const double y = notation.myLocations[noteIndex];
+                        noteLocations.push_back(y);
+                        notes.push_back(StdNotationNote(
+                            pos, note, key, tuning, y,
+                            notation.myAccidentals[noteIndex]));
                     }
                     else
                     {
-                        AccidentalType accidental = stdNote.getAccidentalType();
-                        // If we had some accidental and then returned to a note
-                        // in the key signature, then force its accidental or
-                        // natural sign to be shown.
+                        const double y =
+                            getNoteLocation(staff, note, key, tuning);
+                        noteLocations.push_back(y);
+                        notes.push_back(
+                            StdNotationNote(pos, note, key, tuning, y));
+                        StdNotationNote &stdNote = notes.back();
+
+                        // Don't show accidentals if there are consecutive
+                        // identical notes on that line/space in the staff.
                         if (accidentals.find(y) != accidentals.end() &&
-                            accidental == NoAccidental)
+                            accidentals.find(y)->second ==
+                                stdNote.getAccidentalType())
+                        {
+                            stdNote.clearAccidental();
+                        }
+                        else
                         {
-                            stdNote.showAccidental();
+                            AccidentalType accidental =
+                                stdNote.getAccidentalType();
+                            // If we had some accidental and then returned to
+                            // a note in the key signature, then force its
+                            // accidental or natural sign to be shown.
+                            if (accidentals.find(y) != accidentals.end() &&
+                                accidental == NoAccidental)
+                            {
+                                stdNote.showAccidental();
+                            }
+
+                            accidentals[y] = accidental;
                         }
 
-                        accidentals[y] = accidental;
+                        notation.myLocations.push_back(y);
+                        notation.myAccidentals.push_back(
+                            stdNote.getAccidentalType());
                     }
 
-                    noteHeadWidth = fm.width(stdNote.getNoteHeadSymbol());
+                    noteHeadWidth =
+                        theNoteHeadWidths.at(notes.back().getNoteHeadSymbol());
+                    ++noteIndex;
                 }
 
                 const double x = layout.getPositionX(pos.getPosition()) +
@@ -187,6 +342,9 @@ void StdNotationNote::getNotesInStaff(
                     NoteStem(voice, pos, x, noteHeadWidth, noteLocations));
             }
 
+            if (!isCached)
+                theBarNotationCache.insert(barKey, notation);
+
             computeBeaming(bar.getTimeSignature(), stems, firstStem, groups);
         }
 
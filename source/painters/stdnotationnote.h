@@ -69,6 +69,11 @@ public:
     void showAccidental();
 
 private:
+    /// Constructs a note whose accidental has already been computed.
+    StdNotationNote(const Position &pos, const Note &note,
+                    const KeySignature &key, const Tuning &tuning, double y,
+                    AccidentalType accidental);
+
     /// Return the offset of the note from the top of the staff.
     static double getNoteLocation(const Staff &staff, const Note &note,
                                   const KeySignature &key, const Tuning &tuning);
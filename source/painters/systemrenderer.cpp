@@ -21,10 +21,12 @@
 #include <boost/algorithm/clamp.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/range/adaptor/map.hpp>
+#include <boost/range/algorithm/equal.hpp>
 #include <boost/range/algorithm/find_if.hpp>
 #include <painters/barlinepainter.h>
 #include <painters/clefpainter.h>
 #include <painters/directionpainter.h>
+#include <painters/glyphbatchpainter.h>
 #include <painters/keysignaturepainter.h>
 #include <painters/layoutinfo.h>
 #include <painters/staffpainter.h>
@@ -46,6 +48,8 @@ SystemRenderer::SystemRenderer(const ScoreArea *scoreArea, const Score &score)
       myScore(score),
       myParentSystem(nullptr),
       myParentStaff(nullptr),
+      myGlyphBatch(nullptr),
+      myGlyphCache(std::make_shared<GlyphCache>()),
       myMusicNotationFont(myMusicFont.getFont()),
       myMusicFontMetrics(myMusicNotationFont),
       myPlainTextFont("Liberation Sans"),
@@ -61,6 +65,11 @@ SystemRenderer::SystemRenderer(const ScoreArea *scoreArea, const Score &score)
 QGraphicsItem *SystemRenderer::operator()(const System &system,
                                           int systemIndex, Staff::ViewType view)
 {
+    PTE_TRACE_SCOPE("SystemRenderer::render");
+
+    mySystemCopy.reset();
+    myCachedLayouts[systemIndex].resize(system.getStaves().size());
+
     // Draw the bounding rectangle for the system.
     myParentSystem = new QGraphicsRectItem();
     myParentSystem->setPen(QPen(QBrush(QColor(0, 0, 0, 127)), 0.5));
@@ -80,8 +89,7 @@ QGraphicsItem *SystemRenderer::operator()(const System &system,
 #endif
 
         const bool isFirstStaff = (height == 0);
-        LayoutConstPtr layout = std::make_shared<LayoutInfo>(
-            myScore, system, systemIndex, staff, i);
+        LayoutConstPtr layout = getLayout(system, systemIndex, i);
 
         if (isFirstStaff)
         {
@@ -89,40 +97,185 @@ QGraphicsItem *SystemRenderer::operator()(const System &system,
             height += layout->getSystemSymbolSpacing();
         }
 
-        myParentStaff = new StaffPainter(layout,
-                                         ScoreLocation(myScore, systemIndex, i),
-                                         myScoreArea->getSelectionPubSub());
+        drawStaff(system, systemIndex, staff, i, layout, isFirstStaff);
         myParentStaff->setPos(0, height);
         myParentStaff->setParentItem(myParentSystem);
+        myCachedLayouts[systemIndex][i].myStaffItem = myParentStaff;
         height += layout->getStaffHeight();
 
-        // Draw the clefs.
-        ClefPainter* clef = new ClefPainter(staff.getClefType(),
-                                            myMusicNotationFont, systemIndex, i,
-                                            myScoreArea->getClefPubSub());
-        clef->setPos(LayoutInfo::CLEF_PADDING, layout->getTopStdNotationLine());
-        clef->setParentItem(myParentStaff);
+        ++i;
+    }
 
-        drawTabClef(LayoutInfo::CLEF_PADDING, *layout);
+    myParentSystem->setRect(0, 0, LayoutInfo::STAFF_WIDTH, height);
+    return myParentSystem;
+}
 
-        drawBarlines(system, systemIndex, layout, isFirstStaff);
-        drawTabNotes(staff, layout);
-        drawLegato(staff, *layout);
-        drawSlides(staff, *layout);
+bool SystemRenderer::updateStaves(QGraphicsItem *systemItem,
+                                  const System &system, int systemIndex)
+{
+    PTE_TRACE_SCOPE("SystemRenderer::updateStaves");
 
-        drawSymbolsAboveStdNotationStaff(*layout);
-        drawSymbolsBelowStdNotationStaff(*layout);
-        drawSymbolsAboveTabStaff(staff, *layout);
-        drawSymbolsBelowTabStaff(*layout);
+    auto it = myCachedLayouts.find(systemIndex);
+    if (it == myCachedLayouts.end() ||
+        it->second.size() != system.getStaves().size())
+    {
+        return false;
+    }
 
-        drawPlayerChanges(system, i, *layout);
-        drawStdNotation(system, staff, *layout);
+    mySystemCopy.reset();
+    std::vector<CachedLayout> &cachedLayouts = it->second;
+    const QList<QGraphicsItem *> children = systemItem->childItems();
 
-        ++i;
+    // Find the staves that were modified. If anything that is shared between
+    // the staves was changed, the entire system must be redrawn.
+    std::vector<int> modifiedStaves;
+    for (size_t i = 0; i < cachedLayouts.size(); ++i)
+    {
+        const CachedLayout &cached = cachedLayouts[i];
+        if (!cached.myLayout || !children.contains(cached.myStaffItem) ||
+            cached.myLineSpacing != myScore.getLineSpacing() ||
+            !isSystemUnchanged(cached, system))
+        {
+            return false;
+        }
+
+        if (!isStaffUnchanged(cached, system, i))
+            modifiedStaves.push_back(i);
     }
 
-    myParentSystem->setRect(0, 0, LayoutInfo::STAFF_WIDTH, height);
-    return myParentSystem;
+    // Build the new layouts, and give up if the height of any staff changed
+    // since the following staves (and systems) would need to be moved.
+    std::vector<LayoutConstPtr> layouts;
+    for (int i : modifiedStaves)
+    {
+        const double prevHeight =
+            cachedLayouts[i].myLayout->getStaffHeight();
+        LayoutConstPtr layout = getLayout(system, systemIndex, i);
+        if (layout->getStaffHeight() != prevHeight)
+            return false;
+
+        layouts.push_back(layout);
+    }
+
+    for (size_t j = 0; j < modifiedStaves.size(); ++j)
+    {
+        const int i = modifiedStaves[j];
+        CachedLayout &cached = cachedLayouts[i];
+        const QPointF pos = cached.myStaffItem->pos();
+        delete cached.myStaffItem;
+        cached.myStaffItem = nullptr;
+
+        // System-level symbols such as rehearsal signs were not modified, so
+        // they don't need to be redrawn along with the first staff.
+        drawStaff(system, systemIndex, system.getStaves()[i], i, layouts[j],
+                  false);
+        myParentStaff->setPos(pos);
+        myParentStaff->setParentItem(systemItem);
+        cached.myStaffItem = myParentStaff;
+    }
+
+    return true;
+}
+
+void SystemRenderer::drawStaff(const System &system, int systemIndex,
+                               const Staff &staff, int staffIndex,
+                               const LayoutConstPtr &layout, bool isFirstStaff)
+{
+    myParentStaff = new StaffPainter(
+        layout, ScoreLocation(myScore, systemIndex, staffIndex),
+        myScoreArea ? myScoreArea->getSelectionPubSub() : nullptr);
+
+    myGlyphBatch = new GlyphBatchPainter(myGlyphCache);
+    myGlyphBatch->setParentItem(myParentStaff);
+
+    // Draw the clefs.
+    ClefPainter* clef = new ClefPainter(
+        staff.getClefType(), myMusicNotationFont, systemIndex, staffIndex,
+        myScoreArea ? myScoreArea->getClefPubSub() : nullptr);
+    clef->setPos(LayoutInfo::CLEF_PADDING, layout->getTopStdNotationLine());
+    clef->setParentItem(myParentStaff);
+
+    drawTabClef(LayoutInfo::CLEF_PADDING, *layout);
+
+    drawBarlines(system, systemIndex, layout, isFirstStaff);
+    drawTabNotes(staff, layout);
+    drawLegato(staff, *layout);
+    drawSlides(staff, *layout);
+
+    drawSymbolsAboveStdNotationStaff(*layout);
+    drawSymbolsBelowStdNotationStaff(*layout);
+    drawSymbolsAboveTabStaff(staff, *layout);
+    drawSymbolsBelowTabStaff(*layout);
+
+    drawPlayerChanges(system, staffIndex, *layout);
+    drawStdNotation(system, staff, *layout);
+}
+
+void SystemRenderer::clearCachedLayouts()
+{
+    myCachedLayouts.clear();
+}
+
+LayoutConstPtr SystemRenderer::getLayout(const System &system,
+                                         int systemIndex, int staffIndex)
+{
+    CachedLayout &cached = myCachedLayouts[systemIndex][staffIndex];
+    if (isLayoutValid(cached, system, staffIndex))
+        return cached.myLayout;
+
+    // The layout refers to the system and staff, so build it from a copy of
+    // the system that it keeps alive. Otherwise, an edit to the score would
+    // leave the cached layout with dangling references.
+    if (!mySystemCopy)
+        mySystemCopy = std::make_shared<const System>(system);
+
+    std::shared_ptr<const System> systemCopy = mySystemCopy;
+    cached.mySystem = systemCopy;
+    cached.myLineSpacing = myScore.getLineSpacing();
+    cached.myLayout = LayoutConstPtr(
+        new LayoutInfo(myScore, *systemCopy, systemIndex,
+                       systemCopy->getStaves()[staffIndex], staffIndex),
+        [systemCopy](const LayoutInfo *layout) { delete layout; });
+
+    return cached.myLayout;
+}
+
+bool SystemRenderer::isLayoutValid(const CachedLayout &cached,
+                                   const System &system, int staffIndex) const
+{
+    return cached.myLayout &&
+           cached.myLineSpacing == myScore.getLineSpacing() &&
+           isStaffUnchanged(cached, system, staffIndex) &&
+           isSystemUnchanged(cached, system);
+}
+
+bool SystemRenderer::isStaffUnchanged(const CachedLayout &cached,
+                                      const System &system, int staffIndex)
+{
+    const System &prevSystem = *cached.mySystem;
+    return staffIndex < static_cast<int>(prevSystem.getStaves().size()) &&
+           prevSystem.getStaves()[staffIndex] ==
+               system.getStaves()[staffIndex];
+}
+
+bool SystemRenderer::isSystemUnchanged(const CachedLayout &cached,
+                                       const System &system)
+{
+    const System &prevSystem = *cached.mySystem;
+
+    // The other staves only affect this staff's layout through the number of
+    // positions in the system.
+    return boost::equal(prevSystem.getBarlines(), system.getBarlines()) &&
+           boost::equal(prevSystem.getTempoMarkers(),
+                        system.getTempoMarkers()) &&
+           boost::equal(prevSystem.getAlternateEndings(),
+                        system.getAlternateEndings()) &&
+           boost::equal(prevSystem.getChords(), system.getChords()) &&
+           boost::equal(prevSystem.getDirections(), system.getDirections()) &&
+           boost::equal(prevSystem.getPlayerChanges(),
+                        system.getPlayerChanges()) &&
+           cached.myLayout->getNumPositions() ==
+               LayoutInfo::getNumPositions(system);
 }
 
 void SystemRenderer::drawTabClef(double x, const LayoutInfo &layout)
@@ -152,8 +305,9 @@ void SystemRenderer::drawBarlines(const System &system, int systemIndex,
         const KeySignature &keySig = barline.getKeySignature();
         const TimeSignature &timeSig = barline.getTimeSignature();
 
-        BarlinePainter *barlinePainter = new BarlinePainter(layout, barline,
-                location, myScoreArea->getBarlinePubSub());
+        BarlinePainter *barlinePainter = new BarlinePainter(
+            layout, barline, location,
+            myScoreArea ? myScoreArea->getBarlinePubSub() : nullptr);
 
         double x = layout->getPositionX(barline.getPosition());
         double keySigX = x + barlinePainter->boundingRect().width() - 1;
@@ -198,7 +352,8 @@ void SystemRenderer::drawBarlines(const System &system, int systemIndex,
         {
             KeySignaturePainter *keySigPainter = new KeySignaturePainter(
                         layout, keySig, location,
-                        myScoreArea->getKeySignaturePubSub());
+                        myScoreArea ? myScoreArea->getKeySignaturePubSub()
+                                    : nullptr);
 
             keySigPainter->setPos(keySigX, layout->getTopStdNotationLine());
             keySigPainter->setParentItem(myParentStaff);
@@ -208,7 +363,8 @@ void SystemRenderer::drawBarlines(const System &system, int systemIndex,
         {
             TimeSignaturePainter *timeSigPainter = new TimeSignaturePainter(
                         layout, timeSig, location,
-                        myScoreArea->getTimeSignaturePubSub());
+                        myScoreArea ? myScoreArea->getTimeSignaturePubSub()
+                                    : nullptr);
 
             timeSigPainter->setPos(timeSigX, layout->getTopStdNotationLine());
             timeSigPainter->setParentItem(myParentStaff);
@@ -273,16 +429,12 @@ void SystemRenderer::drawTabNotes(const Staff &staff,
                 const QString text = QString::fromStdString(
                             boost::lexical_cast<std::string>(note));
 
-                auto tabNote = new QGraphicsSimpleTextItem(text);
-                tabNote->setFont(myPlainTextFont);
-                tabNote->setBrush(note.hasProperty(Note::Tied) ?
-                                      Qt::lightGray : Qt::black);
-
-                centerItem(tabNote, location,
+                centerText(myPlainTextFont, text, location,
                            location + layout->getPositionSpacing(),
                            layout->getTabLine(note.getString() + 1) -
-                           0.6 * myPlainTextFont.pixelSize());
-                tabNote->setParentItem(myParentStaff);
+                           0.6 * myPlainTextFont.pixelSize(),
+                           note.hasProperty(Note::Tied) ? Qt::lightGray
+                                                        : Qt::black);
             }
 
             // Draw arpeggios if necessary.
@@ -303,6 +455,15 @@ void SystemRenderer::centerItem(QGraphicsItem *item, double xmin,
     item->setPos(centredX, y);
 }
 
+void SystemRenderer::centerText(const QFont &font, const QString &text,
+                                double xmin, double xmax, double y,
+                                const QColor &color)
+{
+    double textWidth = myGlyphBatch->getTextWidth(font, text);
+    double centredX = xmin + ((xmax - (xmin + textWidth)) / 2);
+    myGlyphBatch->addText(font, text, QPointF(centredX, y), color);
+}
+
 void SystemRenderer::drawArpeggio(const Position &position, double x,
                                   const LayoutInfo& layout)
 {
@@ -746,27 +907,30 @@ void SystemRenderer::drawSymbolsBelowTabStaff(const LayoutInfo &layout)
 {
     for (const SymbolGroup &symbolGroup : layout.getTabStaffBelowSymbols())
     {
-        QGraphicsItem *renderedSymbol = nullptr;
+        const double x = layout.getPositionX(symbolGroup.getLeftPosition());
+        const double xmax = x + symbolGroup.getWidth();
+        const double y = layout.getBottomTabLine() +
+                symbolGroup.getHeight() * LayoutInfo::TAB_SYMBOL_SPACING;
 
         switch (symbolGroup.getSymbolType())
         {
         case SymbolGroup::PickStrokeUp:
-            renderedSymbol = createPickStroke(QChar(MusicFont::PickStrokeUp));
+            drawPickStroke(QChar(MusicFont::PickStrokeUp), x, xmax, y);
             break;
         case SymbolGroup::PickStrokeDown:
-            renderedSymbol = createPickStroke(QChar(MusicFont::PickStrokeDown));
+            drawPickStroke(QChar(MusicFont::PickStrokeDown), x, xmax, y);
             break;
         case SymbolGroup::Tap:
-            renderedSymbol = createPlainTextSymbol("T", QFont::StyleNormal);
+            drawPlainTextSymbol("T", QFont::StyleNormal, x, xmax, y);
             break;
         case SymbolGroup::Hammeron:
-            renderedSymbol = createPlainTextSymbol("H", QFont::StyleNormal);
+            drawPlainTextSymbol("H", QFont::StyleNormal, x, xmax, y);
             break;
         case SymbolGroup::Pulloff:
-            renderedSymbol = createPlainTextSymbol("P", QFont::StyleNormal);
+            drawPlainTextSymbol("P", QFont::StyleNormal, x, xmax, y);
             break;
         case SymbolGroup::Slide:
-            renderedSymbol = createPlainTextSymbol("sl.", QFont::StyleItalic);
+            drawPlainTextSymbol("sl.", QFont::StyleItalic, x, xmax, y);
             break;
         case SymbolGroup::ArtificialHarmonic:
         {
@@ -774,56 +938,36 @@ void SystemRenderer::drawSymbolsBelowTabStaff(const LayoutInfo &layout)
                 symbolGroup.getVoice().getPositions(),
                 symbolGroup.getLeftPosition());
             Q_ASSERT(pos);
-            renderedSymbol = createArtificialHarmonicText(*pos);
+            drawPlainTextSymbol(getArtificialHarmonicText(*pos),
+                                QFont::StyleNormal, x, xmax, y);
             break;
         }
         default:
             Q_ASSERT(false);
             break;
         }
-
-        const double x = layout.getPositionX(symbolGroup.getLeftPosition());
-        centerItem(renderedSymbol, x, x + symbolGroup.getWidth(),
-                   layout.getBottomTabLine() +
-                   symbolGroup.getHeight() * LayoutInfo::TAB_SYMBOL_SPACING);
-
-        renderedSymbol->setParentItem(myParentStaff);
     }
 }
 
-QGraphicsItem *SystemRenderer::createPickStroke(const QString &text)
+void SystemRenderer::drawPickStroke(const QString &text, double xmin,
+                                    double xmax, double y)
 {
-    auto textItem = new QGraphicsSimpleTextItem(text);
-    textItem->setFont(myMusicNotationFont);
-    textItem->setPos(2, 2 - myMusicFontMetrics.ascent());
-
-    // Sticking the text in a QGraphicsItemGroup allows us to offset the
-    // position of the text from its default location
-    auto group = new QGraphicsItemGroup();
-    group->addToGroup(textItem);
-    return group;
+    // Offset the symbol slightly from its default location.
+    centerText(myMusicNotationFont, text, xmin + 2, xmax + 2,
+               y + 2 - myMusicFontMetrics.ascent());
 }
 
-QGraphicsItem *SystemRenderer::createPlainTextSymbol(const QString &text,
-                                                     QFont::Style style)
+void SystemRenderer::drawPlainTextSymbol(const QString &text,
+                                         QFont::Style style, double xmin,
+                                         double xmax, double y)
 {
     myPlainTextFont.setStyle(style);
-
-    auto textItem = new QGraphicsSimpleTextItem(text);
-    textItem->setFont(myPlainTextFont);
-    textItem->setPos(0, -8);
-
-    auto group = new QGraphicsItemGroup();
-    group->addToGroup(textItem);
-
+    centerText(myPlainTextFont, text, xmin, xmax, y - 8);
     myPlainTextFont.setStyle(QFont::StyleNormal);
-
-    return group;
 }
 
-/// Creates the text portion of an artificial harmonic, which displays the note.
-QGraphicsItem* SystemRenderer::createArtificialHarmonicText(
-        const Position &position)
+/// Returns the text portion of an artificial harmonic, which displays the note.
+QString SystemRenderer::getArtificialHarmonicText(const Position &position)
 {
     // Find the note that has the harmonic.
     auto it = boost::range::find_if(position.getNotes(), [] (const Note &note) {
@@ -840,9 +984,7 @@ QGraphicsItem* SystemRenderer::createArtificialHarmonicText(
     name.setBassKey(harmonic.getKey());
     name.setBassVariation(harmonic.getVariation());
 
-    return createPlainTextSymbol(
-                QString::fromStdString(boost::lexical_cast<std::string>(name)),
-                QFont::StyleNormal);
+    return QString::fromStdString(boost::lexical_cast<std::string>(name));
 }
 
 void SystemRenderer::drawSymbolsAboveTabStaff(const Staff &staff,
@@ -852,6 +994,10 @@ void SystemRenderer::drawSymbolsAboveTabStaff(const Staff &staff,
     {
         QGraphicsItem *renderedSymbol = nullptr;
         const double width = symbolGroup.getWidth();
+        const double x = layout.getPositionX(symbolGroup.getLeftPosition());
+        const double y = layout.getTopTabLine() -
+                LayoutInfo::STAFF_BORDER_SPACING -
+                symbolGroup.getHeight() * LayoutInfo::TAB_SYMBOL_SPACING;
 
         switch(symbolGroup.getSymbolType())
         {
@@ -864,12 +1010,10 @@ void SystemRenderer::drawSymbolsAboveTabStaff(const Staff &staff,
                                                         width, layout);
             break;
         case SymbolGroup::Vibrato:
-            renderedSymbol = drawContinuousFontSymbols(MusicFont::Vibrato,
-                                                       width);
+            drawContinuousFontSymbols(MusicFont::Vibrato, width, x, y);
             break;
         case SymbolGroup::WideVibrato:
-            renderedSymbol = drawContinuousFontSymbols(MusicFont::WideVibrato,
-                                                       width);
+            drawContinuousFontSymbols(MusicFont::WideVibrato, width, x, y);
             break;
         case SymbolGroup::PalmMuting:
             renderedSymbol = createConnectedSymbolGroup("P.M.",
@@ -877,10 +1021,10 @@ void SystemRenderer::drawSymbolsAboveTabStaff(const Staff &staff,
                                                         width, layout);
             break;
         case SymbolGroup::TremoloPicking:
-            renderedSymbol = createTremoloPicking(layout);
+            drawTremoloPicking(layout, x, y);
             break;
         case SymbolGroup::Trill:
-            renderedSymbol = createTrill(layout);
+            drawTrill(layout, x, y);
             break;
         case SymbolGroup::NaturalHarmonic:
             renderedSymbol = createConnectedSymbolGroup("N.H.",
@@ -893,7 +1037,7 @@ void SystemRenderer::drawSymbolsAboveTabStaff(const Staff &staff,
                 staff.getDynamics(), symbolGroup.getLeftPosition());
             Q_ASSERT(dynamic);
 
-            renderedSymbol = createDynamic(*dynamic);
+            drawDynamic(*dynamic, x, y);
             break;
         }
         case SymbolGroup::ArtificialHarmonic:
@@ -923,15 +1067,15 @@ void SystemRenderer::drawSymbolsAboveTabStaff(const Staff &staff,
             break;
         }
 
+        // Symbols that only consist of text are drawn directly into the
+        // glyph batch.
+        if (!renderedSymbol)
+            continue;
+
         // Bends are positioned differently, since they overlap with the
         // standard notation staff.
         if (symbolGroup.getSymbolType() != SymbolGroup::Bend)
-        {
-            renderedSymbol->setPos(
-                layout.getPositionX(symbolGroup.getLeftPosition()),
-                layout.getTopTabLine() - LayoutInfo::STAFF_BORDER_SPACING -
-                    symbolGroup.getHeight() * LayoutInfo::TAB_SYMBOL_SPACING);
-        }
+            renderedSymbol->setPos(x, y);
 
         renderedSymbol->setParentItem(myParentStaff);
     }
@@ -1069,61 +1213,44 @@ QGraphicsItem* SystemRenderer::createVolumeSwell(uint8_t width, const StaffData&
 }
 
 #endif
-QGraphicsItem *SystemRenderer::drawContinuousFontSymbols(QChar symbol,
-                                                         int width)
+void SystemRenderer::drawContinuousFontSymbols(QChar symbol, int width,
+                                               double x, double y)
 {
     QFont font = myMusicFont.getFont();
     font.setPixelSize(25);
 
-    const double symbolWidth = QFontMetricsF(font).width(symbol);
+    const QString text(1, symbol);
+    const double symbolWidth = myGlyphBatch->getTextWidth(font, text);
     const int numSymbols = width / symbolWidth;
-    QGraphicsSimpleTextItem *text = new QGraphicsSimpleTextItem(
-                QString(numSymbols, symbol));
-    text->setFont(font);
-    text->setPos(0, -25);
 
-    // A bit of a hack for getting around the height offset caused by the
-    // music font.
-    auto group = new QGraphicsItemGroup();
-    group->addToGroup(text);
-    return group;
+    // Offset to get around the height offset caused by the music font.
+    myGlyphBatch->addText(font, text.repeated(numSymbols), QPointF(x, y - 25));
 }
 
-QGraphicsItem *SystemRenderer::createTremoloPicking(const LayoutInfo& layout)
+void SystemRenderer::drawTremoloPicking(const LayoutInfo& layout, double x,
+                                        double y)
 {
     const double offset = LayoutInfo::TAB_SYMBOL_SPACING / 3;
-
-    auto group = new QGraphicsItemGroup();
+    const QString symbol(QChar(MusicFont::TremoloPicking));
 
     for (int i = 0; i < 3; i++)
     {
-        QGraphicsSimpleTextItem *line = new QGraphicsSimpleTextItem(
-                    QChar(MusicFont::TremoloPicking));
-        line->setFont(myMusicNotationFont);
-        centerItem(line, 0, layout.getPositionSpacing() * 1.25,
-                   -myMusicFontMetrics.ascent() - 7 + i * offset);
-        group->addToGroup(line);
+        centerText(myMusicNotationFont, symbol, x,
+                   x + layout.getPositionSpacing() * 1.25,
+                   y - myMusicFontMetrics.ascent() - 7 + i * offset);
     }
-
-    return group;
 }
 
-QGraphicsItem *SystemRenderer::createTrill(const LayoutInfo& layout)
+void SystemRenderer::drawTrill(const LayoutInfo& layout, double x, double y)
 {
     QFont font(myMusicFont.getFont());
     font.setPixelSize(21);
 
-    QGraphicsSimpleTextItem *text = new QGraphicsSimpleTextItem(
-                QChar(MusicFont::Trill));
-    text->setFont(font);
-    centerItem(text, 0, layout.getPositionSpacing(), -18);
-
-    auto group = new QGraphicsItemGroup();
-    group->addToGroup(text);
-    return group;
+    centerText(font, QChar(MusicFont::Trill), x,
+               x + layout.getPositionSpacing(), y - 18);
 }
 
-QGraphicsItem *SystemRenderer::createDynamic(const Dynamic &dynamic)
+void SystemRenderer::drawDynamic(const Dynamic &dynamic, double x, double y)
 {
     QString text = "fff";
     Dynamic::VolumeLevel volume = dynamic.getVolume();
@@ -1145,15 +1272,9 @@ QGraphicsItem *SystemRenderer::createDynamic(const Dynamic &dynamic)
     else if (volume <= Dynamic::ff)
         text = "ff";
 
-    auto textItem = new QGraphicsSimpleTextItem(text);
-    textItem->setFont(myMusicNotationFont);
-    textItem->setPos(0, -myMusicFontMetrics.ascent() + 10);
-
-    // Sticking the text in a QGraphicsItemGroup allows us to offset the
-    // position of the text from its default location.
-    auto group = new QGraphicsItemGroup();
-    group->addToGroup(textItem);
-    return group;
+    // Offset the position of the text from its default location.
+    myGlyphBatch->addText(myMusicNotationFont, text,
+                          QPointF(x, y - myMusicFontMetrics.ascent() + 10));
 }
 
 void SystemRenderer::drawStdNotation(const System &system, const Staff &staff,
@@ -1202,43 +1323,22 @@ void SystemRenderer::drawStdNotation(const System &system, const Staff &staff,
         const double y = note.getY() + layout.getTopStdNotationLine() -
                 myMusicFontMetrics.ascent();
 
-        QGraphicsItemGroup *group = nullptr;
-        QGraphicsSimpleTextItem *text = new QGraphicsSimpleTextItem(
-                    accidentalText + noteHead);
-        text->setFont(myMusicNotationFont);
+        myGlyphBatch->addText(myMusicNotationFont, accidentalText + noteHead,
+                              QPointF(x, y));
 
         if (note.isDotted() || note.isDoubleDotted())
         {
-            group = new QGraphicsItemGroup();
-            const double dotX = noteHeadWidth + 2;
-
-            const QChar dot(MusicFont::Dot);
-            QGraphicsSimpleTextItem *dotText = new QGraphicsSimpleTextItem(dot);
-            dotText->setPos(dotX, 0);
-            dotText->setFont(myMusicNotationFont);
-            group->addToGroup(dotText);
+            const double dotX = x + noteHeadWidth + 2;
+            const QString dot(QChar(MusicFont::Dot));
+            myGlyphBatch->addText(myMusicNotationFont, dot, QPointF(dotX, y));
 
             if (note.isDoubleDotted())
             {
-                QGraphicsSimpleTextItem *dotText2 = new QGraphicsSimpleTextItem(dot);
-                dotText2->setPos(dotX + 4, 0);
-                dotText2->setFont(myMusicNotationFont);
-                group->addToGroup(dotText2);
+                myGlyphBatch->addText(myMusicNotationFont, dot,
+                                      QPointF(dotX + 4, y));
             }
         }
 
-        if (group)
-        {
-            group->addToGroup(text);
-            group->setPos(x, y);
-            group->setParentItem(myParentStaff);
-        }
-        else
-        {
-            text->setPos(x, y);
-            text->setParentItem(myParentStaff);
-        }
-
         const int position = note.getPosition();
         minNoteLocations[position] = std::min(minNoteLocations[position],
                                               note.getY());
@@ -1428,39 +1528,43 @@ void SystemRenderer::drawRest(const Position &pos, double x, const LayoutInfo &l
         break;
     }
 
-    auto group = new QGraphicsItemGroup();
-    QGraphicsSimpleTextItem *text = new QGraphicsSimpleTextItem(symbol);
-    text->setFont(myMusicNotationFont);
-    text->setPos(0, y);
-    group->addToGroup(text);
-
-    // Draw dots if necessary.
-    const QChar dot = MusicFont::Dot;
+    const QString text(symbol);
+    const QString dot(QChar(MusicFont::Dot));
     const double dotX = myMusicNotationFont.pixelSize() / 2.0;
     // Position just below second line of staff.
     const double dotY = 1.6 * LayoutInfo::STD_NOTATION_LINE_SPACING -
             myMusicFontMetrics.ascent();
 
-    if (pos.hasProperty(Position::Dotted) ||
-        pos.hasProperty(Position::DoubleDotted))
+    const bool dotted = pos.hasProperty(Position::Dotted) ||
+            pos.hasProperty(Position::DoubleDotted);
+    const bool doubleDotted = pos.hasProperty(Position::DoubleDotted);
+
+    // Center the rest and its dots as a single unit.
+    double width = myGlyphBatch->getTextWidth(myMusicNotationFont, text);
+    if (dotted)
+    {
+        const double dotWidth = myGlyphBatch->getTextWidth(myMusicNotationFont,
+                                                           dot);
+        width = std::max(width, dotX + (doubleDotted ? 4 : 0) + dotWidth);
+    }
+
+    const double left = x + ((layout.getPositionSpacing() * 1.25 - width) / 2);
+    const double top = layout.getTopStdNotationLine();
+
+    myGlyphBatch->addText(myMusicNotationFont, text, QPointF(left, top + y));
+
+    // Draw dots if necessary.
+    if (dotted)
     {
-        QGraphicsSimpleTextItem *dotText = new QGraphicsSimpleTextItem(dot);
-        dotText->setPos(dotX, dotY);
-        dotText->setFont(myMusicNotationFont);
-        group->addToGroup(dotText);
+        myGlyphBatch->addText(myMusicNotationFont, dot,
+                              QPointF(left + dotX, top + dotY));
 
-        if (pos.hasProperty(Position::DoubleDotted))
+        if (doubleDotted)
         {
-            QGraphicsSimpleTextItem *dotText2 = new QGraphicsSimpleTextItem(dot);
-            dotText2->setPos(dotX + 4, dotY);
-            dotText2->setFont(myMusicNotationFont);
-            group->addToGroup(dotText2);
+            myGlyphBatch->addText(myMusicNotationFont, dot,
+                                  QPointF(left + dotX + 4, top + dotY));
         }
     }
-
-    centerItem(group, x, x + layout.getPositionSpacing() * 1.25,
-               layout.getTopStdNotationLine());
-    group->setParentItem(myParentStaff);
 }
 
 void SystemRenderer::drawLedgerLines(
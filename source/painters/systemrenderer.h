@@ -19,26 +19,82 @@
 #define PAINTERS_SYSTEMRENDERER_H
 
 #include <map>
+#include <memory>
 #include <painters/layoutinfo.h>
 #include <painters/musicfont.h>
+#include <QColor>
 #include <QFontMetricsF>
 #include <score/staff.h>
 
+class GlyphBatchPainter;
+class GlyphCache;
 class QGraphicsItem;
 class QGraphicsRectItem;
 class Score;
 class ScoreArea;
 class System;
 
+/// Renders systems of a score. The renderer can be reused for multiple
+/// systems and redraws, in which case the layout of any staff that has not
+/// changed since it was last rendered is reused.
 class SystemRenderer
 {
 public:
+    /// The score area may be null when rendering offscreen (e.g. for
+    /// exporting), in which case the rendered items ignore clicks.
     SystemRenderer(const ScoreArea *myScoreArea, const Score &myScore);
 
     QGraphicsItem *operator()(const System &system, int systemIndex,
                               Staff::ViewType view);
 
+    /// Updates a system that was previously rendered by this renderer, by
+    /// only redrawing the staves that were modified. Returns false if the
+    /// system must be fully redrawn instead (e.g. a system-level symbol was
+    /// changed, or the height of a staff changed).
+    bool updateStaves(QGraphicsItem *systemItem, const System &system,
+                      int systemIndex);
+
+    /// Discards all previous layouts (e.g. if the players or their tunings
+    /// have changed, or systems were inserted or removed).
+    void clearCachedLayouts();
+
 private:
+    struct CachedLayout
+    {
+        CachedLayout() : myStaffItem(nullptr), myLineSpacing(0) {}
+
+        /// Copy of the system that the layout was computed from.
+        std::shared_ptr<const System> mySystem;
+        LayoutConstPtr myLayout;
+        /// The item that the staff was last rendered to.
+        QGraphicsItem *myStaffItem;
+        int myLineSpacing;
+    };
+
+    /// Returns the layout for the staff, reusing the previous layout if
+    /// nothing that it depends on has changed.
+    LayoutConstPtr getLayout(const System &system, int systemIndex,
+                             int staffIndex);
+
+    /// Checks whether the layout can be reused for the given staff.
+    bool isLayoutValid(const CachedLayout &cached, const System &system,
+                       int staffIndex) const;
+
+    /// Checks whether the staff is unchanged since the layout was computed.
+    static bool isStaffUnchanged(const CachedLayout &cached,
+                                 const System &system, int staffIndex);
+
+    /// Checks whether any of the system-level items (barlines, chord text,
+    /// etc) were changed since the layout was computed.
+    static bool isSystemUnchanged(const CachedLayout &cached,
+                                  const System &system);
+
+    /// Draws the clefs, notes, and symbols for a staff. The new staff is
+    /// stored in myParentStaff.
+    void drawStaff(const System &system, int systemIndex, const Staff &staff,
+                   int staffIndex, const LayoutConstPtr &layout,
+                   bool isFirstStaff);
+
     /// Draws the tab clef.
     void drawTabClef(double x, const LayoutInfo &layout);
 
@@ -53,6 +109,11 @@ private:
     /// offset from xmin.
     void centerItem(QGraphicsItem *item, double xmin, double xmax, double y);
 
+    /// Adds centered text to the staff's glyph batch, using the text's width
+    /// to calculate the necessary offset from xmin.
+    void centerText(const QFont &font, const QString &text, double xmin,
+                    double xmax, double y, const QColor &color = Qt::black);
+
     /// Draws a arpeggio up/down at the given position.
     void drawArpeggio(const Position &position, double x,
                       const LayoutInfo &layout);
@@ -83,13 +144,14 @@ private:
     /// (hammerons, slides, etc).
     void drawSymbolsBelowTabStaff(const LayoutInfo &layout);
 
-    /// Creates a pick stroke symbol using the given character.
-    QGraphicsItem *createPickStroke(const QString &text);
+    /// Draws a pick stroke symbol using the given character.
+    void drawPickStroke(const QString &text, double xmin, double xmax,
+                        double y);
 
-    /// Creates a plain text item - useful for symbols that don't use the
+    /// Draws plain text - useful for symbols that don't use the
     /// music font (hammerons, slides, etc).
-    QGraphicsItem *createPlainTextSymbol(const QString &text,
-                                         QFont::Style style);
+    void drawPlainTextSymbol(const QString &text, QFont::Style style,
+                             double xmin, double xmax, double y);
 
     /// Draws symbols that appear above the standard notation staff (e.g. 8va).
     void drawSymbolsAboveStdNotationStaff(const LayoutInfo &layout);
@@ -118,19 +180,20 @@ private:
     void drawSymbolsAboveTabStaff(const Staff &staff, const LayoutInfo &layout);
 
     /// Draws a sequence of continuous music symbols (e.g. vibrato).
-    QGraphicsItem *drawContinuousFontSymbols(QChar symbol, int width);
+    void drawContinuousFontSymbols(QChar symbol, int width, double x,
+                                   double y);
 
-    /// Creates a tremolo picking symbol.
-    QGraphicsItem *createTremoloPicking(const LayoutInfo &layout);
+    /// Draws a tremolo picking symbol.
+    void drawTremoloPicking(const LayoutInfo &layout, double x, double y);
 
-    /// Creates a trill symbol.
-    QGraphicsItem *createTrill(const LayoutInfo &layout);
+    /// Draws a trill symbol.
+    void drawTrill(const LayoutInfo &layout, double x, double y);
 
-    /// Creates an artificial harmonic symbol.
-    QGraphicsItem *createArtificialHarmonicText(const Position &position);
+    /// Returns the text of an artificial harmonic symbol.
+    QString getArtificialHarmonicText(const Position &position);
 
-    /// Creates a dynamic symbol.
-    QGraphicsItem *createDynamic(const Dynamic &dynamic);
+    /// Draws a dynamic symbol.
+    void drawDynamic(const Dynamic &dynamic, double x, double y);
 
     /// Draws a group of bends.
     QGraphicsItem *createBendGroup(const SymbolGroup &group,
@@ -173,6 +236,16 @@ private:
 
     QGraphicsRectItem *myParentSystem;
     QGraphicsItem *myParentStaff;
+    /// Batches the text items (tab numbers, noteheads, etc) for the
+    /// current staff.
+    GlyphBatchPainter *myGlyphBatch;
+    std::shared_ptr<GlyphCache> myGlyphCache;
+
+    /// Previous layouts for each staff, indexed by system.
+    std::map<int, std::vector<CachedLayout>> myCachedLayouts;
+    /// Copy of the system currently being rendered, which is shared by any
+    /// new layouts for the system.
+    std::shared_ptr<const System> mySystemCopy;
 
     MusicFont myMusicFont;
     QFont myMusicNotationFont;
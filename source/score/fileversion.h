@@ -22,7 +22,10 @@
 
 enum class FileVersion : int {
     POWERTAB_2_0 = 1,
-    NUM_VERSIONS
+    /// Players can be assigned to a MIDI port.
+    PLAYER_MIDI_PORT = 2,
+    NUM_VERSIONS,
+    LATEST_VERSION = NUM_VERSIONS - 1
 };
 
 #endif
@@ -46,6 +46,10 @@ namespace Midi
     const uint8_t FIRST_MIDI_CHANNEL = 0;
     /// Last MIDI channel.
     const uint8_t LAST_MIDI_CHANNEL = 15;
+    /// Channel 10 is used for percussion in General MIDI.
+    const uint8_t PERCUSSION_CHANNEL = 9;
+    /// Maximum number of MIDI ports that players can be assigned to.
+    const uint8_t MAX_MIDI_PORTS = 8;
 
     /// Minimum volume level for a MIDI channel.
     const uint8_t MIN_MIDI_CHANNEL_VOLUME = 0;
@@ -33,7 +33,7 @@ bool Player::operator==(const Player &other) const
 {
     return myDescription == other.myDescription &&
            myMaxVolume == other.myMaxVolume && myPan == other.myPan &&
-           myTuning == other.myTuning;
+           myTuning == other.myTuning && myMidiPort == other.myMidiPort;
 }
 
 const std::string &Player::getDescription() const
@@ -82,3 +82,29 @@ void Player::setTuning(const Tuning &tuning)
     myTuning = tuning;
 }
 
+bool Player::hasMidiPort() const
+{
+    return myMidiPort.is_initialized();
+}
+
+int Player::getMidiPort() const
+{
+    return *myMidiPort;
+}
+
+void Player::setMidiPort(int port)
+{
+    checkMidiPort(port);
+    myMidiPort = port;
+}
+
+void Player::clearMidiPort()
+{
+    myMidiPort.reset();
+}
+
+void Player::checkMidiPort(int port)
+{
+    if (port < 0 || port >= Midi::MAX_MIDI_PORTS)
+        throw std::out_of_range("Invalid MIDI port");
+}
@@ -18,6 +18,7 @@
 #ifndef SCORE_PLAYER_H
 #define SCORE_PLAYER_H
 
+#include <boost/optional/optional.hpp>
 #include <cstdint>
 #include "fileversion.h"
 #include <string>
@@ -53,25 +54,49 @@ public:
     /// Sets the player's tuning.
     void setTuning(const Tuning &tuning);
 
+    /// Returns whether the player is assigned to a specific MIDI port,
+    /// rather than having a port chosen automatically during playback.
+    bool hasMidiPort() const;
+    /// Returns the MIDI port that the player is assigned to.
+    int getMidiPort() const;
+    /// Assigns the player to a MIDI port.
+    void setMidiPort(int port);
+    /// Lets a port be chosen automatically during playback.
+    void clearMidiPort();
+
     static const uint8_t MIN_VOLUME;
     static const uint8_t MAX_VOLUME;
     static const uint8_t MIN_PAN;
     static const uint8_t MAX_PAN;
 
 private:
+    /// Throws if the MIDI port doesn't exist.
+    static void checkMidiPort(int port);
+
     std::string myDescription;
     uint8_t myMaxVolume;
     uint8_t myPan;
     Tuning myTuning;
+    boost::optional<int> myMidiPort;
 };
 
 template <class Archive>
-void Player::serialize(Archive &ar, const FileVersion /*version*/)
+void Player::serialize(Archive &ar, const FileVersion version)
 {
 	ar("description", myDescription);
 	ar("max_volume", myMaxVolume);
 	ar("pan", myPan);
 	ar("tuning", myTuning);
+
+	if (version >= FileVersion::PLAYER_MIDI_PORT)
+	{
+		ar("midi_port", myMidiPort);
+
+		// Reject invalid ports from a file, since they can't be set through
+		// setMidiPort().
+		if (myMidiPort)
+			checkMidiPort(*myMidiPort);
+	}
 }
 
 #endif
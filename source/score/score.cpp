@@ -189,3 +189,16 @@ void ScoreUtils::adjustRehearsalSigns(Score &score)
         }
     }
 }
+
+void ScoreUtils::copy(const Score &source, Score &dest)
+{
+    dest.setScoreInfo(source.getScoreInfo());
+    dest.setLineSpacing(source.getLineSpacing());
+
+    for (const System &system : source.getSystems())
+        dest.insertSystem(system);
+    for (const Player &player : source.getPlayers())
+        dest.insertPlayer(player);
+    for (const Instrument &instrument : source.getInstruments())
+        dest.insertInstrument(instrument);
+}
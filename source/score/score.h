@@ -116,6 +116,10 @@ const PlayerChange *getCurrentPlayers(const Score &score, int systemIndex,
 /// Readjust the letters for the rehearsal signs in the score
 /// (i.e. assigning rehearsal signs the letters "A", "B", and so on).
 void adjustRehearsalSigns(Score &score);
+
+/// Makes a deep copy of the score into an empty destination score (e.g. for
+/// taking a snapshot that can be used from another thread).
+void copy(const Score &source, Score &dest);
 }
 
 #endif
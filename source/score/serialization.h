@@ -318,7 +318,7 @@ private:
 template <typename T>
 void save(std::ostream &output, const std::string &name, const T &obj)
 {
-    OutputArchive ar(output, FileVersion::POWERTAB_2_0);
+    OutputArchive ar(output, FileVersion::LATEST_VERSION);
     ar(name, obj);
 }
 
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <boost/range/adaptor/filtered.hpp>
 #include <boost/range/iterator_range_core.hpp>
+#include <iterator>
 
 namespace ScoreUtils {
 
@@ -78,6 +79,24 @@ namespace ScoreUtils {
             range, InPositionRange(left, right));
     }
 
+    /// Equivalent to findInRange(), but uses a binary search. The objects
+    /// must be ordered by position, as they are in a system or voice.
+    template <typename T>
+    boost::iterator_range<T> findInSortedRange(
+        const boost::iterator_range<T> &range, int left, int right)
+    {
+        typedef typename std::iterator_traits<T>::value_type Object;
+
+        const T first = std::lower_bound(
+            range.begin(), range.end(), left,
+            [](const Object &obj, int pos) { return obj.getPosition() < pos; });
+        const T last = std::upper_bound(
+            first, range.end(), right,
+            [](int pos, const Object &obj) { return pos < obj.getPosition(); });
+
+        return boost::make_iterator_range(first, last);
+    }
+
     // Some helper methods to reduce code duplication.
 
     /// Sorts objects by their positions in the system.
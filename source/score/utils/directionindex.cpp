@@ -19,7 +19,8 @@
 
 #include <score/score.h>
 
-DirectionIndex::DirectionIndex(const Score &score) : myScore(score)
+DirectionIndex::DirectionIndex(const Score &score)
+    : myScore(score), myActiveSymbol(DirectionSymbol::ActiveNone)
 {
     int i = 0;
     for (const System &system : score.getSystems())
@@ -73,6 +74,8 @@ SystemLocation DirectionIndex::performDirection(
         if (shouldPerformDirection(direction, myActiveSymbol, activeRepeat))
         {
             newLocation = followDirection(direction.getSymbolType());
+            myPerformedDirections.push_back(
+                std::make_pair(leftIt->first, direction.getSymbolType()));
             myDirections.erase(leftIt);
         }
     }
@@ -80,6 +83,25 @@ SystemLocation DirectionIndex::performDirection(
     return newLocation;
 }
 
+void DirectionIndex::copyState(const DirectionIndex &other)
+{
+    myActiveSymbol = other.myActiveSymbol;
+
+    for (auto &performed : other.myPerformedDirections)
+    {
+        auto range = myDirections.equal_range(performed.first);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second.getSymbolType() == performed.second)
+            {
+                myPerformedDirections.push_back(performed);
+                myDirections.erase(it);
+                break;
+            }
+        }
+    }
+}
+
 SystemLocation DirectionIndex::followDirection(DirectionSymbol::SymbolType type)
 {
     // Go to the end of the score.
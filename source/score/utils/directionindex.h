@@ -21,6 +21,8 @@
 #include <map>
 #include <score/direction.h>
 #include <score/systemlocation.h>
+#include <utility>
+#include <vector>
 
 class Score;
 
@@ -37,6 +39,11 @@ public:
                                     const SystemLocation &currentLocation,
                                     int activeRepeat);
 
+    /// Copies the playback state from an index for another version of the
+    /// score, i.e. the active symbol and the directions that were already
+    /// performed.
+    void copyState(const DirectionIndex &other);
+
 private:
     SystemLocation followDirection(DirectionSymbol::SymbolType symbol);
 
@@ -47,6 +54,10 @@ private:
     std::multimap<SystemLocation, DirectionSymbol> myDirections;
     /// Used for finding the location of a symbol type.
     std::map<DirectionSymbol::SymbolType, SystemLocation> mySymbolLocations;
+    /// The directions that have been performed (and removed from
+    /// myDirections).
+    std::vector<std::pair<SystemLocation, DirectionSymbol::SymbolType>>
+        myPerformedDirections;
 };
 
 #endif
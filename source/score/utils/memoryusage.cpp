@@ -0,0 +1,283 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "memoryusage.h"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <boost/date_time/gregorian/greg_date.hpp>
+#include <boost/optional/optional.hpp>
+#include <iomanip>
+#include <ostream>
+#include <score/fileversion.h>
+#include <score/score.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+/// Strings are grouped together, rather than by the name of each member.
+const char *STRING_ENTRY = "strings";
+/// An estimate of the size of each map node, excluding its value. Most
+/// implementations use a red-black tree with three pointers and a color.
+const size_t MAP_NODE_OVERHEAD = 4 * sizeof(void *);
+
+/// Returns whether the string's data is stored outside of the string object,
+/// rather than in the small string buffer.
+bool isHeapAllocated(const std::string &str)
+{
+    const char *data = str.data();
+    const char *object = reinterpret_cast<const char *>(&str);
+    return data < object || data >= object + sizeof(str);
+}
+
+/// Visits each object in the score using the serialize() methods, and adds up
+/// the memory allocated by vectors, maps and strings.
+class MemoryArchive
+{
+public:
+    explicit MemoryArchive(ScoreUtils::MemoryUsage &usage) : myUsage(usage)
+    {
+    }
+
+    template <typename T>
+    void operator()(const std::string &name, const T &obj)
+    {
+        visit(name, obj);
+    }
+
+private:
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value ||
+                            std::is_enum<T>::value>::type
+    visit(const std::string &, const T &)
+    {
+    }
+
+    void visit(const std::string &, const std::string &str)
+    {
+        ScoreUtils::MemoryUsage::Entry &entry = myUsage.myEntries[STRING_ENTRY];
+        ++entry.myCount;
+
+        if (isHeapAllocated(str))
+        {
+            entry.myBytes += str.capacity() + 1;
+            entry.mySlackBytes += str.capacity() - str.size();
+        }
+    }
+
+    void visit(const std::string &, const boost::gregorian::date &)
+    {
+    }
+
+    template <size_t N>
+    void visit(const std::string &, const std::bitset<N> &)
+    {
+    }
+
+    template <typename T>
+    void visit(const std::string &name, const boost::optional<T> &val)
+    {
+        if (val)
+            visit(name, *val);
+    }
+
+    template <typename T, size_t N>
+    void visit(const std::string &name, const std::array<T, N> &arr)
+    {
+        for (const T &obj : arr)
+            visit(name, obj);
+    }
+
+    template <typename T>
+    void visit(const std::string &name, const std::vector<T> &vec)
+    {
+        ScoreUtils::MemoryUsage::Entry &entry = myUsage.myEntries[name];
+        entry.myCount += vec.size();
+        entry.myBytes += vec.capacity() * sizeof(T);
+        entry.mySlackBytes += (vec.capacity() - vec.size()) * sizeof(T);
+
+        for (const T &obj : vec)
+            visit(name, obj);
+    }
+
+    template <typename K, typename V, typename C>
+    void visit(const std::string &name, const std::map<K, V, C> &map)
+    {
+        typedef typename std::map<K, V, C>::value_type ValueType;
+
+        ScoreUtils::MemoryUsage::Entry &entry = myUsage.myEntries[name];
+        entry.myCount += map.size();
+        entry.myBytes += map.size() * (sizeof(ValueType) + MAP_NODE_OVERHEAD);
+
+        for (const ValueType &pair : map)
+            visit(name, pair.second);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_class<T>::value>::type visit(
+        const std::string &, const T &obj)
+    {
+        const_cast<T &>(obj).serialize(*this, FileVersion::LATEST_VERSION);
+    }
+
+    ScoreUtils::MemoryUsage &myUsage;
+};
+
+/// Visits each object in the score using the serialize() methods, and
+/// releases any unused capacity.
+class CompactArchive
+{
+public:
+    template <typename T>
+    void operator()(const std::string &, T &obj)
+    {
+        visit(obj);
+    }
+
+private:
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value ||
+                            std::is_enum<T>::value>::type
+    visit(T &)
+    {
+    }
+
+    void visit(std::string &str)
+    {
+        str.shrink_to_fit();
+    }
+
+    void visit(boost::gregorian::date &)
+    {
+    }
+
+    template <size_t N>
+    void visit(std::bitset<N> &)
+    {
+    }
+
+    template <typename T>
+    void visit(boost::optional<T> &val)
+    {
+        if (val)
+            visit(*val);
+    }
+
+    template <typename T, size_t N>
+    void visit(std::array<T, N> &arr)
+    {
+        for (T &obj : arr)
+            visit(obj);
+    }
+
+    template <typename T>
+    void visit(std::vector<T> &vec)
+    {
+        vec.shrink_to_fit();
+
+        for (T &obj : vec)
+            visit(obj);
+    }
+
+    template <typename K, typename V, typename C>
+    void visit(std::map<K, V, C> &map)
+    {
+        for (auto &pair : map)
+            visit(pair.second);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_class<T>::value>::type visit(T &obj)
+    {
+        obj.serialize(*this, FileVersion::LATEST_VERSION);
+    }
+};
+}
+
+namespace ScoreUtils
+{
+MemoryUsage::Entry::Entry() : myCount(0), myBytes(0), mySlackBytes(0)
+{
+}
+
+size_t MemoryUsage::getTotalBytes() const
+{
+    size_t total = 0;
+    for (auto &entry : myEntries)
+        total += entry.second.myBytes;
+    return total;
+}
+
+size_t MemoryUsage::getTotalSlackBytes() const
+{
+    size_t total = 0;
+    for (auto &entry : myEntries)
+        total += entry.second.mySlackBytes;
+    return total;
+}
+
+MemoryUsage getMemoryUsage(const Score &score)
+{
+    MemoryUsage usage;
+
+    MemoryUsage::Entry &entry = usage.myEntries["score"];
+    entry.myCount = 1;
+    entry.myBytes = sizeof(Score);
+
+    MemoryArchive archive(usage);
+    archive("score", score);
+
+    return usage;
+}
+
+void compact(Score &score)
+{
+    CompactArchive archive;
+    archive("score", score);
+}
+
+void printMemoryUsage(std::ostream &output, const MemoryUsage &usage)
+{
+    // List the largest groups first.
+    std::vector<std::pair<std::string, MemoryUsage::Entry>> entries(
+        usage.myEntries.begin(), usage.myEntries.end());
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const std::pair<std::string, MemoryUsage::Entry> &a,
+                        const std::pair<std::string, MemoryUsage::Entry> &b) {
+        return a.second.myBytes > b.second.myBytes;
+    });
+
+    output << std::left << std::setw(24) << "Objects" << std::right
+           << std::setw(12) << "Count" << std::setw(14) << "Bytes"
+           << std::setw(14) << "Unused" << "\n";
+
+    for (auto &entry : entries)
+    {
+        output << std::left << std::setw(24) << entry.first << std::right
+               << std::setw(12) << entry.second.myCount << std::setw(14)
+               << entry.second.myBytes << std::setw(14)
+               << entry.second.mySlackBytes << "\n";
+    }
+
+    output << std::left << std::setw(24) << "Total" << std::right
+           << std::setw(12) << "" << std::setw(14) << usage.getTotalBytes()
+           << std::setw(14) << usage.getTotalSlackBytes() << "\n";
+}
+}
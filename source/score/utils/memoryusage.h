@@ -0,0 +1,67 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCORE_UTILS_MEMORYUSAGE_H
+#define SCORE_UTILS_MEMORYUSAGE_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <string>
+
+class Score;
+
+namespace ScoreUtils
+{
+/// A breakdown of the memory used by a score. The totals are grouped by the
+/// names that are used in the file format (e.g. "systems" or "notes").
+struct MemoryUsage
+{
+    struct Entry
+    {
+        Entry();
+
+        /// The number of objects.
+        size_t myCount;
+        /// The number of bytes allocated for the objects, including any unused
+        /// capacity.
+        size_t myBytes;
+        /// The number of allocated bytes that are not in use, which can be
+        /// released by compact().
+        size_t mySlackBytes;
+    };
+
+    size_t getTotalBytes() const;
+    size_t getTotalSlackBytes() const;
+
+    std::map<std::string, Entry> myEntries;
+};
+
+/// Computes the memory used by the score, by visiting each of the objects
+/// that would be serialized.
+MemoryUsage getMemoryUsage(const Score &score);
+
+/// Releases any unused capacity in the score's vectors and strings (e.g.
+/// after importing a file, which grows the vectors one element at a time).
+/// This invalidates any references to objects in the score.
+void compact(Score &score);
+
+/// Writes a table with the size of each group of objects.
+void printMemoryUsage(std::ostream &output, const MemoryUsage &usage);
+}
+
+#endif
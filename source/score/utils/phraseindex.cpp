@@ -0,0 +1,380 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "phraseindex.h"
+
+#include <algorithm>
+#include <boost/functional/hash.hpp>
+#include <limits>
+#include <score/score.h>
+#include <tuple>
+
+/// The number of events in each indexed contour. Shorter phrases are found by
+/// checking every note in the score.
+static const int CONTOUR_LENGTH = 4;
+
+PhraseIndex::Event::Event(int position, int pitch, int rhythm)
+    : myPosition(position), myPitch(pitch), myRhythm(rhythm)
+{
+}
+
+bool PhraseIndex::Event::isRest() const
+{
+    return myPitch < 0;
+}
+
+PhraseIndex::Match::Match(int system, int staff, int voice, int position)
+    : mySystem(system), myStaff(staff), myVoice(voice), myPosition(position)
+{
+}
+
+bool PhraseIndex::Match::operator<(const Match &other) const
+{
+    return std::tie(mySystem, myPosition, myStaff, myVoice) <
+           std::tie(other.mySystem, other.myPosition, other.myStaff,
+                    other.myVoice);
+}
+
+bool PhraseIndex::Match::operator==(const Match &other) const
+{
+    return mySystem == other.mySystem && myStaff == other.myStaff &&
+           myVoice == other.myVoice && myPosition == other.myPosition;
+}
+
+PhraseIndex::Start::Start(int voice, int event)
+    : myVoice(voice), myEvent(event)
+{
+}
+
+/// Returns the tuning of the first active player in the staff.
+static const Tuning &getTuning(const Score &score,
+                               const PlayerChange *players, int staff)
+{
+    static const Tuning theDefaultTuning;
+
+    if (players)
+    {
+        const std::vector<ActivePlayer> activePlayers =
+            players->getActivePlayers(staff);
+        if (!activePlayers.empty())
+        {
+            return score.getPlayers()[
+                activePlayers.front().getPlayerNumber()].getTuning();
+        }
+    }
+
+    return theDefaultTuning;
+}
+
+static int getRhythm(const Position &pos)
+{
+    int rhythm = 4 * static_cast<int>(pos.getDurationType());
+    if (pos.hasProperty(Position::Dotted))
+        rhythm += 1;
+    else if (pos.hasProperty(Position::DoubleDotted))
+        rhythm += 2;
+
+    return rhythm;
+}
+
+/// Finds the highest pitch at the position. Returns false if there are no
+/// notes, or if all of the notes are tied to the previous position.
+static bool getPitch(const Position &pos, const Tuning &tuning, int &pitch)
+{
+    if (pos.isRest())
+    {
+        pitch = -1;
+        return true;
+    }
+
+    bool found = false;
+    for (const Note &note : pos.getNotes())
+    {
+        if (note.hasProperty(Note::Tied) ||
+            note.getString() >= tuning.getStringCount())
+        {
+            continue;
+        }
+
+        const int notePitch =
+            tuning.getNote(note.getString(), false) + note.getFretNumber();
+        pitch = found ? std::max(pitch, notePitch) : notePitch;
+        found = true;
+    }
+
+    return found;
+}
+
+/// Reads the events between the left and right positions of a voice.
+static void readVoice(const Score &score, const System &system, int staff,
+                      const Voice &voice, const PlayerChange *currentPlayers,
+                      int left, int right,
+                      std::vector<PhraseIndex::Event> &events)
+{
+    auto change = system.getPlayerChanges().begin();
+    const auto lastChange = system.getPlayerChanges().end();
+
+    for (const Position &pos : voice.getPositions())
+    {
+        if (pos.getPosition() > right)
+            break;
+
+        while (change != lastChange &&
+               change->getPosition() <= pos.getPosition())
+        {
+            currentPlayers = &*change;
+            ++change;
+        }
+
+        int pitch;
+        if (pos.getPosition() >= left &&
+            getPitch(pos, getTuning(score, currentPlayers, staff), pitch))
+        {
+            events.push_back(
+                PhraseIndex::Event(pos.getPosition(), pitch, getRhythm(pos)));
+        }
+    }
+}
+
+/// Removes any rests from the start and end of the phrase.
+static void trimRests(std::vector<PhraseIndex::Event> &phrase)
+{
+    while (!phrase.empty() && phrase.back().isRest())
+        phrase.pop_back();
+
+    auto firstNote = std::find_if(
+        phrase.begin(), phrase.end(),
+        [](const PhraseIndex::Event &event) { return !event.isRest(); });
+    phrase.erase(phrase.begin(), firstNote);
+}
+
+PhraseIndex::PhraseIndex(const Score &score)
+{
+    mySystems.resize(score.getSystems().size());
+
+    const PlayerChange *currentPlayers = nullptr;
+    int i = 0;
+    for (const System &system : score.getSystems())
+    {
+        indexSystem(score, i, currentPlayers);
+
+        if (!system.getPlayerChanges().empty())
+            currentPlayers = &system.getPlayerChanges().back();
+
+        ++i;
+    }
+}
+
+void PhraseIndex::updateSystems(const Score &score, int firstSystem,
+                                int lastSystem)
+{
+    // Systems were inserted or removed, so the whole score must be indexed.
+    if (score.getSystems().size() != mySystems.size())
+    {
+        *this = PhraseIndex(score);
+        return;
+    }
+
+    firstSystem = std::max(firstSystem, 0);
+    lastSystem = std::min(lastSystem, static_cast<int>(mySystems.size()) - 1);
+
+    for (int i = firstSystem; i <= lastSystem; ++i)
+    {
+        indexSystem(score, i, ScoreUtils::getCurrentPlayers(score, i, -1));
+    }
+}
+
+std::vector<PhraseIndex::Event> PhraseIndex::getPhrase(const Score &score,
+                                                       int system, int staff,
+                                                       int voice, int left,
+                                                       int right)
+{
+    const System &currentSystem = score.getSystems()[system];
+
+    std::vector<Event> phrase;
+    readVoice(score, currentSystem, staff,
+              currentSystem.getStaves()[staff].getVoices()[voice],
+              ScoreUtils::getCurrentPlayers(score, system, -1), left, right,
+              phrase);
+    trimRests(phrase);
+
+    return phrase;
+}
+
+std::vector<PhraseIndex::Match> PhraseIndex::find(
+    const std::vector<Event> &phrase, bool matchRhythm) const
+{
+    std::vector<Event> query(phrase);
+    trimRests(query);
+
+    std::vector<Match> matches;
+    if (query.empty())
+        return matches;
+
+    auto check = [&](int system, const Start &start) {
+        if (this->matches(query, system, start, matchRhythm))
+        {
+            matches.push_back(Match(
+                system, start.myVoice / Staff::NUM_VOICES,
+                start.myVoice % Staff::NUM_VOICES,
+                mySystems[system].myVoices[start.myVoice][start.myEvent]
+                    .myPosition));
+        }
+    };
+
+    const bool useIndex = query.size() >= CONTOUR_LENGTH;
+    const size_t contour =
+        useIndex ? getContour(query.begin(), query.begin() + CONTOUR_LENGTH)
+                 : 0;
+
+    for (int i = 0; i < static_cast<int>(mySystems.size()); ++i)
+    {
+        const SystemEntry &entry = mySystems[i];
+
+        if (useIndex)
+        {
+            auto it = entry.myContours.find(contour);
+            if (it != entry.myContours.end())
+            {
+                for (const Start &start : it->second)
+                    check(i, start);
+            }
+
+            for (const Start &start : entry.myUnindexedStarts)
+                check(i, start);
+        }
+        else
+        {
+            for (size_t v = 0; v < entry.myVoices.size(); ++v)
+            {
+                for (size_t e = 0; e < entry.myVoices[v].size(); ++e)
+                {
+                    if (!entry.myVoices[v][e].isRest())
+                    {
+                        check(i, Start(static_cast<int>(v),
+                                       static_cast<int>(e)));
+                    }
+                }
+            }
+        }
+    }
+
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
+
+void PhraseIndex::indexSystem(const Score &score, int systemIndex,
+                              const PlayerChange *currentPlayers)
+{
+    const System &system = score.getSystems()[systemIndex];
+    SystemEntry entry;
+
+    int staffIndex = 0;
+    for (const Staff &staff : system.getStaves())
+    {
+        for (const Voice &voice : staff.getVoices())
+        {
+            entry.myVoices.push_back(std::vector<Event>());
+            readVoice(score, system, staffIndex, voice, currentPlayers, 0,
+                      std::numeric_limits<int>::max(), entry.myVoices.back());
+        }
+
+        ++staffIndex;
+    }
+
+    for (size_t v = 0; v < entry.myVoices.size(); ++v)
+    {
+        const std::vector<Event> &events = entry.myVoices[v];
+
+        for (size_t e = 0; e < events.size(); ++e)
+        {
+            if (events[e].isRest())
+                continue;
+
+            const Start start(static_cast<int>(v), static_cast<int>(e));
+
+            // The contour of the last few notes depends on the next system.
+            if (e + CONTOUR_LENGTH <= events.size())
+            {
+                auto begin = events.begin() + e;
+                entry.myContours[getContour(begin, begin + CONTOUR_LENGTH)]
+                    .push_back(start);
+            }
+            else
+                entry.myUnindexedStarts.push_back(start);
+        }
+    }
+
+    mySystems[systemIndex] = std::move(entry);
+}
+
+bool PhraseIndex::matches(const std::vector<Event> &phrase, int system,
+                          const Start &start, bool matchRhythm) const
+{
+    const int voice = start.myVoice;
+    const int firstPitch = phrase.front().myPitch;
+    const int startPitch =
+        mySystems[system].myVoices[voice][start.myEvent].myPitch;
+
+    size_t i = start.myEvent;
+    for (const Event &event : phrase)
+    {
+        // Continue into the next system if necessary.
+        while (i >= mySystems[system].myVoices[voice].size())
+        {
+            ++system;
+            i = 0;
+
+            if (system >= static_cast<int>(mySystems.size()) ||
+                voice >= static_cast<int>(mySystems[system].myVoices.size()))
+            {
+                return false;
+            }
+        }
+
+        const Event &other = mySystems[system].myVoices[voice][i];
+        if (event.isRest() != other.isRest() ||
+            (matchRhythm && event.myRhythm != other.myRhythm))
+        {
+            return false;
+        }
+
+        if (!event.isRest() &&
+            event.myPitch - firstPitch != other.myPitch - startPitch)
+        {
+            return false;
+        }
+
+        ++i;
+    }
+
+    return true;
+}
+
+template <typename EventIterator>
+size_t PhraseIndex::getContour(EventIterator begin, EventIterator end)
+{
+    const int firstPitch = begin->myPitch;
+
+    size_t seed = 0;
+    for (EventIterator it = begin; it != end; ++it)
+    {
+        boost::hash_combine(seed, it->isRest());
+        boost::hash_combine(seed, it->isRest() ? 0 : it->myPitch - firstPitch);
+    }
+
+    return seed;
+}
@@ -0,0 +1,119 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SCORE_UTILS_PHRASEINDEX_H
+#define SCORE_UTILS_PHRASEINDEX_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+class PlayerChange;
+class Score;
+
+/// Indexes the melody of each voice in the score as a sequence of pitches and
+/// rhythms, so that a phrase can be found in any key. Each system is indexed
+/// separately, so that only the edited systems need to be indexed again.
+class PhraseIndex
+{
+public:
+    /// A note (or rest) in a phrase. Only the highest note at each position
+    /// is used, and tied notes are ignored.
+    struct Event
+    {
+        Event(int position, int pitch, int rhythm);
+
+        bool isRest() const;
+
+        int myPosition;
+        /// The MIDI pitch, or -1 for a rest.
+        int myPitch;
+        /// The duration type and dots.
+        int myRhythm;
+    };
+
+    /// The location of a matching phrase.
+    struct Match
+    {
+        Match(int system, int staff, int voice, int position);
+
+        bool operator<(const Match &other) const;
+        bool operator==(const Match &other) const;
+
+        int mySystem;
+        int myStaff;
+        int myVoice;
+        int myPosition;
+    };
+
+    explicit PhraseIndex(const Score &score);
+
+    /// Indexes the given systems again after they have been edited. This
+    /// cannot be used if systems were inserted or removed, or if an edit
+    /// affects the tuning of later systems (e.g. a player change).
+    void updateSystems(const Score &score, int firstSystem, int lastSystem);
+
+    /// Returns the phrase formed by the positions in the given range of a
+    /// voice, with any leading or trailing rests removed.
+    static std::vector<Event> getPhrase(const Score &score, int system,
+                                        int staff, int voice, int left,
+                                        int right);
+
+    /// Finds every occurrence of the phrase in the score, transposed to any
+    /// key. The matches are ordered by their location in the score.
+    std::vector<Match> find(const std::vector<Event> &phrase,
+                            bool matchRhythm) const;
+
+private:
+    /// The start of a candidate phrase within a system.
+    struct Start
+    {
+        Start(int voice, int event);
+
+        /// The voice, numbered across all of the system's staves.
+        int myVoice;
+        int myEvent;
+    };
+
+    struct SystemEntry
+    {
+        /// The events for each voice in each staff.
+        std::vector<std::vector<Event>> myVoices;
+        /// Maps the contour of the next few notes to the phrases that start
+        /// with it.
+        std::unordered_map<size_t, std::vector<Start>> myContours;
+        /// Phrases that are too close to the end of the system to compute
+        /// their contour, which must always be checked.
+        std::vector<Start> myUnindexedStarts;
+    };
+
+    /// Indexes a system, given the player change that is active at its start.
+    void indexSystem(const Score &score, int systemIndex,
+                     const PlayerChange *currentPlayers);
+
+    /// Returns whether the phrase matches the events starting at the given
+    /// location, possibly continuing into the following systems.
+    bool matches(const std::vector<Event> &phrase, int system,
+                 const Start &start, bool matchRhythm) const;
+
+    /// Hashes the pitches of the events relative to the first event.
+    template <typename EventIterator>
+    static size_t getContour(EventIterator begin, EventIterator end);
+
+    std::vector<SystemEntry> mySystems;
+};
+
+#endif
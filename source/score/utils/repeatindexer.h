@@ -19,6 +19,7 @@
 #define SCORE_UTILS_REPEATINDEXER_H
 
 #include <boost/optional/optional.hpp>
+#include <map>
 #include <score/systemlocation.h>
 #include <set>
 #include <unordered_map>
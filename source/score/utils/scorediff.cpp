@@ -0,0 +1,823 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "scorediff.h"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <boost/functional/hash.hpp>
+#include <boost/range/algorithm/equal.hpp>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <score/fileversion.h>
+#include <score/score.h>
+#include <type_traits>
+#include <utility>
+
+namespace
+{
+/// The maximum size of the table used to align two sequences. If a larger
+/// section differs, it is treated as a single replacement.
+const size_t MAX_ALIGNMENT_CELLS = 16 * 1024 * 1024;
+
+/// Visits each object using the serialize() methods, and combines all of
+/// the values into a hash. Members with the ignored name are skipped.
+class HashArchive
+{
+public:
+    explicit HashArchive(const std::string &ignoredName)
+        : myIgnoredName(ignoredName), myHash(0)
+    {
+    }
+
+    template <typename T>
+    void operator()(const std::string &name, const T &obj)
+    {
+        if (myIgnoredName.empty() || name != myIgnoredName)
+            visit(obj);
+    }
+
+    size_t getHash() const
+    {
+        return myHash;
+    }
+
+private:
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value>::type visit(
+        const T &val)
+    {
+        boost::hash_combine(myHash, val);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_enum<T>::value>::type visit(const T &val)
+    {
+        boost::hash_combine(myHash, static_cast<int>(val));
+    }
+
+    void visit(const std::string &str)
+    {
+        boost::hash_combine(myHash, str);
+    }
+
+    template <size_t N>
+    void visit(const std::bitset<N> &bits)
+    {
+        boost::hash_combine(myHash, std::hash<std::bitset<N>>()(bits));
+    }
+
+    template <typename T>
+    void visit(const boost::optional<T> &val)
+    {
+        boost::hash_combine(myHash, static_cast<bool>(val));
+        if (val)
+            visit(*val);
+    }
+
+    template <typename T, size_t N>
+    void visit(const std::array<T, N> &arr)
+    {
+        for (const T &obj : arr)
+            visit(obj);
+    }
+
+    template <typename T>
+    void visit(const std::vector<T> &vec)
+    {
+        boost::hash_combine(myHash, vec.size());
+
+        for (const T &obj : vec)
+            visit(obj);
+    }
+
+    template <typename K, typename V, typename C>
+    void visit(const std::map<K, V, C> &map)
+    {
+        boost::hash_combine(myHash, map.size());
+
+        for (auto &pair : map)
+        {
+            visit(pair.first);
+            visit(pair.second);
+        }
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_class<T>::value>::type visit(const T &obj)
+    {
+        const_cast<T &>(obj).serialize(*this, FileVersion::LATEST_VERSION);
+    }
+
+    const std::string myIgnoredName;
+    size_t myHash;
+};
+
+template <typename T>
+size_t hashObject(const T &obj, const std::string &ignoredName = "")
+{
+    HashArchive archive(ignoredName);
+    archive("", obj);
+    return archive.getHash();
+}
+
+/// A range of items that differs between two sequences.
+struct Difference
+{
+    Difference(int originalIndex, int originalCount, int newIndex,
+               int newCount)
+        : myOriginalIndex(originalIndex),
+          myOriginalCount(originalCount),
+          myNewIndex(newIndex),
+          myNewCount(newCount)
+    {
+    }
+
+    int myOriginalIndex;
+    int myOriginalCount;
+    int myNewIndex;
+    int myNewCount;
+};
+
+/// Aligns two sequences by finding their longest common subsequence, and
+/// returns the ranges that differ.
+std::vector<Difference> align(int originalSize, int newSize,
+                              const std::function<bool(int, int)> &equal)
+{
+    // Skip the common prefix and suffix, which usually cover most of the
+    // sequence.
+    int prefix = 0;
+    while (prefix < originalSize && prefix < newSize && equal(prefix, prefix))
+        ++prefix;
+
+    int suffix = 0;
+    while (suffix < originalSize - prefix && suffix < newSize - prefix &&
+           equal(originalSize - suffix - 1, newSize - suffix - 1))
+    {
+        ++suffix;
+    }
+
+    const int n = originalSize - prefix - suffix;
+    const int m = newSize - prefix - suffix;
+
+    std::vector<Difference> differences;
+    if (n == 0 && m == 0)
+        return differences;
+
+    if (n == 0 || m == 0 ||
+        static_cast<size_t>(n + 1) * (m + 1) > MAX_ALIGNMENT_CELLS)
+    {
+        differences.push_back(Difference(prefix, n, prefix, m));
+        return differences;
+    }
+
+    // Compute the length of the longest common subsequence for each pair of
+    // suffixes.
+    std::vector<int> lengths((n + 1) * (m + 1), 0);
+    auto length = [&](int i, int j) -> int & {
+        return lengths[i * (m + 1) + j];
+    };
+
+    for (int i = n - 1; i >= 0; --i)
+    {
+        for (int j = m - 1; j >= 0; --j)
+        {
+            length(i, j) = equal(prefix + i, prefix + j)
+                               ? length(i + 1, j + 1) + 1
+                               : std::max(length(i + 1, j), length(i, j + 1));
+        }
+    }
+
+    // Walk through the table, recording the unmatched items between each
+    // pair of matched items.
+    int i = 0;
+    int j = 0;
+    int start_i = 0;
+    int start_j = 0;
+    auto addDifference = [&]() {
+        if (i > start_i || j > start_j)
+        {
+            differences.push_back(Difference(prefix + start_i, i - start_i,
+                                             prefix + start_j, j - start_j));
+        }
+    };
+
+    while (i < n && j < m)
+    {
+        if (equal(prefix + i, prefix + j))
+        {
+            addDifference();
+            start_i = ++i;
+            start_j = ++j;
+        }
+        else if (length(i + 1, j) >= length(i, j + 1))
+            ++i;
+        else
+            ++j;
+    }
+
+    i = n;
+    j = m;
+    addDifference();
+
+    return differences;
+}
+
+std::vector<size_t> hashSystems(const Score &score)
+{
+    std::vector<size_t> hashes;
+    for (const System &system : score.getSystems())
+        hashes.push_back(hashObject(system));
+    return hashes;
+}
+
+/// Aligns the systems of the two scores. Systems are only compared in full if
+/// their hashes match.
+std::vector<Difference> diffSystems(const Score &original,
+                                    const Score &modified)
+{
+    const std::vector<size_t> originalHashes = hashSystems(original);
+    const std::vector<size_t> modifiedHashes = hashSystems(modified);
+
+    return align(originalHashes.size(), modifiedHashes.size(),
+                 [&](int i, int j) {
+        return originalHashes[i] == modifiedHashes[j] &&
+               original.getSystems()[i] == modified.getSystems()[j];
+    });
+}
+
+template <typename Range>
+std::vector<typename Range::value_type> toVector(const Range &range)
+{
+    return std::vector<typename Range::value_type>(range.begin(),
+                                                   range.end());
+}
+
+std::vector<System> getSystems(const Score &score, int index, int count)
+{
+    return std::vector<System>(score.getSystems().begin() + index,
+                               score.getSystems().begin() + index + count);
+}
+
+/// Returns the version of the object that includes the changes from both
+/// sides, or null if they were changed differently.
+template <typename T>
+const T *choose(const T &base, const T &ours, const T &theirs)
+{
+    if (ours == base)
+        return &theirs;
+    else if (theirs == base || theirs == ours)
+        return &ours;
+    else
+        return nullptr;
+}
+
+template <typename T>
+void mergeValue(const T &base, const T &ours, const T &theirs,
+                const std::string &description, boost::optional<T> &result,
+                std::vector<ScoreUtils::MergeConflict> &conflicts)
+{
+    const T *value = choose(base, ours, theirs);
+    if (!value)
+        conflicts.push_back(ScoreUtils::MergeConflict(description, -1));
+    else if (!(*value == ours))
+        result = *value;
+}
+
+/// Returns whether the systems have the same symbols, ignoring their staves.
+bool haveEqualSymbols(const System &a, const System &b)
+{
+    return boost::range::equal(a.getBarlines(), b.getBarlines()) &&
+           boost::range::equal(a.getTempoMarkers(), b.getTempoMarkers()) &&
+           boost::range::equal(a.getAlternateEndings(),
+                               b.getAlternateEndings()) &&
+           boost::range::equal(a.getDirections(), b.getDirections()) &&
+           boost::range::equal(a.getPlayerChanges(), b.getPlayerChanges()) &&
+           boost::range::equal(a.getChords(), b.getChords());
+}
+
+/// Merges a system that was modified on both sides. The staves and the
+/// system's other symbols (barlines, tempo markers, etc) are each taken from
+/// whichever side modified them.
+bool mergeSystem(const System &base, const System &ours, const System &theirs,
+                 int systemIndex,
+                 std::vector<ScoreUtils::MergeConflict> &conflicts,
+                 System &merged)
+{
+    const size_t staffCount = ours.getStaves().size();
+    if (base.getStaves().size() != staffCount ||
+        theirs.getStaves().size() != staffCount)
+    {
+        conflicts.push_back(ScoreUtils::MergeConflict("staves", systemIndex));
+        return false;
+    }
+
+    bool success = true;
+
+    const size_t baseHash = hashObject(base, "staves");
+    const size_t ourHash = hashObject(ours, "staves");
+    const size_t theirHash = hashObject(theirs, "staves");
+
+    // The hashes can collide, so a match is confirmed by comparing the
+    // symbols.
+    const bool oursUnchanged =
+        ourHash == baseHash && haveEqualSymbols(ours, base);
+
+    if (oursUnchanged)
+        merged = theirs;
+    else
+    {
+        merged = ours;
+
+        const bool theirsUnchanged =
+            theirHash == baseHash && haveEqualSymbols(theirs, base);
+        const bool sameChanges =
+            theirHash == ourHash && haveEqualSymbols(theirs, ours);
+
+        if (!theirsUnchanged && !sameChanges)
+        {
+            conflicts.push_back(
+                ScoreUtils::MergeConflict("system symbols", systemIndex));
+            success = false;
+        }
+    }
+
+    for (size_t i = 0; i < staffCount; ++i)
+    {
+        const Staff *staff = choose(base.getStaves()[i], ours.getStaves()[i],
+                                    theirs.getStaves()[i]);
+        if (staff)
+            merged.getStaves()[i] = *staff;
+        else
+        {
+            conflicts.push_back(ScoreUtils::MergeConflict(
+                "staff " + std::to_string(i + 1), systemIndex));
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+/// The contents of a bar, independent of where the bar is in the system.
+struct BarContents
+{
+    size_t myHash;
+    /// The hash of each position, for each staff and voice.
+    std::vector<std::vector<size_t>> myPositions;
+};
+
+std::vector<BarContents> getBars(const System &system)
+{
+    std::vector<BarContents> bars;
+    const std::vector<Barline> barlines = toVector(system.getBarlines());
+
+    for (size_t i = 0; i + 1 < barlines.size(); ++i)
+    {
+        const int left = barlines[i].getPosition();
+        const int right = barlines[i + 1].getPosition();
+
+        BarContents bar;
+        Barline barline(barlines[i]);
+        barline.setPosition(0);
+        bar.myHash = hashObject(barline);
+
+        for (const Staff &staff : system.getStaves())
+        {
+            for (const Voice &voice : staff.getVoices())
+            {
+                std::vector<size_t> positions;
+                for (const Position &pos : voice.getPositions())
+                {
+                    if (pos.getPosition() < left || pos.getPosition() >= right)
+                        continue;
+
+                    Position relativePos(pos);
+                    relativePos.setPosition(pos.getPosition() - left);
+                    positions.push_back(hashObject(relativePos));
+                    boost::hash_combine(bar.myHash, positions.back());
+                }
+
+                boost::hash_combine(bar.myHash, positions.size());
+                bar.myPositions.push_back(positions);
+            }
+
+            for (const Dynamic &dynamic : staff.getDynamics())
+            {
+                if (dynamic.getPosition() < left ||
+                    dynamic.getPosition() >= right)
+                {
+                    continue;
+                }
+
+                Dynamic relativeDynamic(dynamic);
+                relativeDynamic.setPosition(dynamic.getPosition() - left);
+                boost::hash_combine(bar.myHash, hashObject(relativeDynamic));
+            }
+        }
+
+        bars.push_back(bar);
+    }
+
+    return bars;
+}
+
+void printRange(std::ostream &output, const std::string &name, int first,
+                int count)
+{
+    if (count == 1)
+        output << name << " " << first + 1;
+    else
+        output << name << "s " << first + 1 << "-" << first + count;
+}
+
+void printBarChanges(std::ostream &output, int systemIndex,
+                     const BarContents &original, const BarContents &modified,
+                     int barIndex)
+{
+    int added = 0;
+    int removed = 0;
+
+    const size_t count =
+        std::min(original.myPositions.size(), modified.myPositions.size());
+    for (size_t i = 0; i < count; ++i)
+    {
+        const std::vector<size_t> &a = original.myPositions[i];
+        const std::vector<size_t> &b = modified.myPositions[i];
+
+        for (const Difference &difference :
+             align(a.size(), b.size(), [&](int x, int y) {
+                 return a[x] == b[y];
+             }))
+        {
+            removed += difference.myOriginalCount;
+            added += difference.myNewCount;
+        }
+    }
+
+    output << "System " << systemIndex + 1 << ", bar " << barIndex + 1;
+    if (added == 0 && removed == 0)
+        output << ": changed\n";
+    else
+    {
+        output << ": " << added << " position(s) added, " << removed
+               << " removed\n";
+    }
+}
+
+void printSystemChanges(std::ostream &output, int systemIndex,
+                        const System &original, const System &modified)
+{
+    if (original.getStaves().size() != modified.getStaves().size())
+    {
+        output << "System " << systemIndex + 1 << ": "
+               << original.getStaves().size() << " staves changed to "
+               << modified.getStaves().size() << "\n";
+    }
+
+    const std::vector<BarContents> originalBars = getBars(original);
+    const std::vector<BarContents> modifiedBars = getBars(modified);
+
+    const std::vector<Difference> differences =
+        align(originalBars.size(), modifiedBars.size(), [&](int i, int j) {
+            return originalBars[i].myHash == modifiedBars[j].myHash;
+        });
+
+    // Changes to other symbols, such as tempo markers.
+    if (differences.empty())
+        output << "System " << systemIndex + 1 << ": changed\n";
+
+    for (const Difference &difference : differences)
+    {
+        const int paired =
+            std::min(difference.myOriginalCount, difference.myNewCount);
+        for (int i = 0; i < paired; ++i)
+        {
+            printBarChanges(output, systemIndex,
+                            originalBars[difference.myOriginalIndex + i],
+                            modifiedBars[difference.myNewIndex + i],
+                            difference.myOriginalIndex + i);
+        }
+
+        if (difference.myOriginalCount > paired)
+        {
+            output << "System " << systemIndex + 1 << ": ";
+            printRange(output, "bar", difference.myOriginalIndex + paired,
+                       difference.myOriginalCount - paired);
+            output << " removed\n";
+        }
+        else if (difference.myNewCount > paired)
+        {
+            output << "System " << systemIndex + 1 << ": "
+                   << difference.myNewCount - paired
+                   << " bar(s) added before bar "
+                   << difference.myOriginalIndex + paired + 1 << "\n";
+        }
+    }
+}
+}
+
+namespace ScoreUtils
+{
+ScorePatch::Hunk::Hunk() : myIndex(0), myRemovedCount(0)
+{
+}
+
+ScorePatch::Hunk::Hunk(int index, int removedCount,
+                       const std::vector<System> &systems)
+    : myIndex(index), myRemovedCount(removedCount), mySystems(systems)
+{
+}
+
+bool ScorePatch::isEmpty() const
+{
+    return !myScoreInfo && !myPlayers && !myInstruments && !myLineSpacing &&
+           myHunks.empty();
+}
+
+MergeConflict::MergeConflict(const std::string &description, int system)
+    : myDescription(description), mySystem(system)
+{
+}
+
+ScorePatch diff(const Score &original, const Score &modified)
+{
+    ScorePatch patch;
+
+    if (!(original.getScoreInfo() == modified.getScoreInfo()))
+        patch.myScoreInfo = modified.getScoreInfo();
+
+    const std::vector<Player> players = toVector(modified.getPlayers());
+    if (toVector(original.getPlayers()) != players)
+        patch.myPlayers = players;
+
+    const std::vector<Instrument> instruments =
+        toVector(modified.getInstruments());
+    if (toVector(original.getInstruments()) != instruments)
+        patch.myInstruments = instruments;
+
+    if (original.getLineSpacing() != modified.getLineSpacing())
+        patch.myLineSpacing = modified.getLineSpacing();
+
+    for (const Difference &difference : diffSystems(original, modified))
+    {
+        patch.myHunks.push_back(ScorePatch::Hunk(
+            difference.myOriginalIndex, difference.myOriginalCount,
+            getSystems(modified, difference.myNewIndex,
+                       difference.myNewCount)));
+    }
+
+    return patch;
+}
+
+ScorePatch applyPatch(Score &score, const ScorePatch &patch)
+{
+    ScorePatch inverse;
+
+    if (patch.myScoreInfo)
+    {
+        inverse.myScoreInfo = score.getScoreInfo();
+        score.setScoreInfo(*patch.myScoreInfo);
+    }
+
+    if (patch.myPlayers)
+    {
+        inverse.myPlayers = toVector(score.getPlayers());
+
+        for (int i = static_cast<int>(score.getPlayers().size()) - 1; i >= 0;
+             --i)
+        {
+            score.removePlayer(i);
+        }
+
+        for (const Player &player : *patch.myPlayers)
+            score.insertPlayer(player);
+    }
+
+    if (patch.myInstruments)
+    {
+        inverse.myInstruments = toVector(score.getInstruments());
+
+        for (int i = static_cast<int>(score.getInstruments().size()) - 1;
+             i >= 0; --i)
+        {
+            score.removeInstrument(i);
+        }
+
+        for (const Instrument &instrument : *patch.myInstruments)
+            score.insertInstrument(instrument);
+    }
+
+    if (patch.myLineSpacing)
+    {
+        inverse.myLineSpacing = score.getLineSpacing();
+        score.setLineSpacing(*patch.myLineSpacing);
+    }
+
+    // The inverse hunks refer to the systems' indices after the earlier hunks
+    // have been applied.
+    int offset = 0;
+    for (const ScorePatch::Hunk &hunk : patch.myHunks)
+    {
+        const int count = static_cast<int>(hunk.mySystems.size());
+        inverse.myHunks.push_back(ScorePatch::Hunk(
+            hunk.myIndex + offset, count, std::vector<System>()));
+        offset += count - hunk.myRemovedCount;
+    }
+
+    // Apply the hunks from the end of the score, so that the indices of the
+    // remaining hunks are unaffected.
+    for (size_t i = patch.myHunks.size(); i-- > 0;)
+    {
+        const ScorePatch::Hunk &hunk = patch.myHunks[i];
+        std::vector<System> &removed = inverse.myHunks[i].mySystems;
+
+        for (int j = 0; j < hunk.myRemovedCount; ++j)
+        {
+            removed.push_back(std::move(score.getSystems()[hunk.myIndex]));
+            score.removeSystem(hunk.myIndex);
+        }
+
+        for (size_t j = 0; j < hunk.mySystems.size(); ++j)
+            score.insertSystem(hunk.mySystems[j], hunk.myIndex + j);
+    }
+
+    return inverse;
+}
+
+MergeResult merge(const Score &base, const Score &ours, const Score &theirs)
+{
+    MergeResult result;
+    ScorePatch &patch = result.myPatch;
+    std::vector<MergeConflict> &conflicts = result.myConflicts;
+
+    mergeValue(base.getScoreInfo(), ours.getScoreInfo(),
+               theirs.getScoreInfo(), "score information", patch.myScoreInfo,
+               conflicts);
+    mergeValue(toVector(base.getPlayers()), toVector(ours.getPlayers()),
+               toVector(theirs.getPlayers()), "players", patch.myPlayers,
+               conflicts);
+    mergeValue(toVector(base.getInstruments()),
+               toVector(ours.getInstruments()),
+               toVector(theirs.getInstruments()), "instruments",
+               patch.myInstruments, conflicts);
+    mergeValue(base.getLineSpacing(), ours.getLineSpacing(),
+               theirs.getLineSpacing(), "line spacing", patch.myLineSpacing,
+               conflicts);
+
+    const std::vector<Difference> ourChanges = diffSystems(base, ours);
+    const std::vector<Difference> theirChanges = diffSystems(base, theirs);
+
+    // Find the index in "ours" of each system that was not changed there.
+    const int baseCount = static_cast<int>(base.getSystems().size());
+    std::vector<int> ourIndices(baseCount, -1);
+    {
+        int baseIndex = 0;
+        int ourIndex = 0;
+        for (const Difference &change : ourChanges)
+        {
+            while (baseIndex < change.myOriginalIndex)
+                ourIndices[baseIndex++] = ourIndex++;
+
+            baseIndex += change.myOriginalCount;
+            ourIndex += change.myNewCount;
+        }
+
+        while (baseIndex < baseCount)
+            ourIndices[baseIndex++] = ourIndex++;
+    }
+
+    for (const Difference &change : theirChanges)
+    {
+        const int start = change.myOriginalIndex;
+        const int end = start + change.myOriginalCount;
+
+        // Find the changes in "ours" that overlap. Insertions at the same
+        // index also overlap, since their order would be ambiguous.
+        std::vector<const Difference *> overlapping;
+        for (const Difference &other : ourChanges)
+        {
+            const int otherStart = other.myOriginalIndex;
+            const int otherEnd = otherStart + other.myOriginalCount;
+
+            if ((start < otherEnd && otherStart < end) || start == otherStart)
+                overlapping.push_back(&other);
+        }
+
+        const std::vector<System> theirSystems =
+            getSystems(theirs, change.myNewIndex, change.myNewCount);
+
+        if (overlapping.empty())
+        {
+            const int index = start < baseCount
+                                  ? ourIndices[start]
+                                  : static_cast<int>(ours.getSystems().size());
+            patch.myHunks.push_back(
+                ScorePatch::Hunk(index, change.myOriginalCount, theirSystems));
+            continue;
+        }
+
+        const Difference &other = *overlapping.front();
+        if (overlapping.size() == 1 && other.myOriginalIndex == start &&
+            other.myOriginalCount == change.myOriginalCount &&
+            other.myNewCount == change.myNewCount)
+        {
+            // Both sides made the same change.
+            if (theirSystems ==
+                getSystems(ours, other.myNewIndex, other.myNewCount))
+            {
+                continue;
+            }
+
+            // Both sides modified the same systems, so try to merge each
+            // system.
+            if (change.myNewCount == change.myOriginalCount)
+            {
+                for (int i = 0; i < change.myNewCount; ++i)
+                {
+                    const int ourIndex = other.myNewIndex + i;
+                    const System &ourSystem = ours.getSystems()[ourIndex];
+
+                    System merged;
+                    if (mergeSystem(base.getSystems()[start + i], ourSystem,
+                                    theirSystems[i], ourIndex, conflicts,
+                                    merged) &&
+                        !(merged == ourSystem))
+                    {
+                        patch.myHunks.push_back(ScorePatch::Hunk(
+                            ourIndex, 1, std::vector<System>(1, merged)));
+                    }
+                }
+
+                continue;
+            }
+        }
+
+        conflicts.push_back(MergeConflict("systems", other.myNewIndex));
+    }
+
+    return result;
+}
+
+void printPatch(std::ostream &output, const Score &original,
+                const ScorePatch &patch)
+{
+    if (patch.myScoreInfo)
+        output << "Score information changed\n";
+    if (patch.myPlayers)
+        output << "Players changed\n";
+    if (patch.myInstruments)
+        output << "Instruments changed\n";
+    if (patch.myLineSpacing)
+        output << "Line spacing changed\n";
+
+    for (const ScorePatch::Hunk &hunk : patch.myHunks)
+    {
+        const int count = static_cast<int>(hunk.mySystems.size());
+        const int paired = std::min(hunk.myRemovedCount, count);
+
+        for (int i = 0; i < paired; ++i)
+        {
+            printSystemChanges(output, hunk.myIndex + i,
+                               original.getSystems()[hunk.myIndex + i],
+                               hunk.mySystems[i]);
+        }
+
+        if (hunk.myRemovedCount > paired)
+        {
+            printRange(output, "System", hunk.myIndex + paired,
+                       hunk.myRemovedCount - paired);
+            output << " removed\n";
+        }
+        else if (count > paired)
+        {
+            output << count - paired << " system(s) added before ";
+            if (hunk.myIndex + paired <
+                static_cast<int>(original.getSystems().size()))
+            {
+                output << "system " << hunk.myIndex + paired + 1 << "\n";
+            }
+            else
+                output << "the end of the score\n";
+        }
+    }
+
+    if (patch.isEmpty())
+        output << "No changes\n";
+}
+}
@@ -0,0 +1,103 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SCORE_UTILS_SCOREDIFF_H
+#define SCORE_UTILS_SCOREDIFF_H
+
+#include <boost/optional/optional.hpp>
+#include <iosfwd>
+#include <score/instrument.h>
+#include <score/player.h>
+#include <score/scoreinfo.h>
+#include <score/system.h>
+#include <string>
+#include <vector>
+
+class Score;
+
+namespace ScoreUtils
+{
+/// The differences between two versions of a score, which can be applied to
+/// the original score to produce the modified score. Only the systems that
+/// were changed are stored.
+struct ScorePatch
+{
+    /// Replaces a range of systems.
+    struct Hunk
+    {
+        Hunk();
+        Hunk(int index, int removedCount, const std::vector<System> &systems);
+
+        /// The index of the first system to replace, in the original score.
+        int myIndex;
+        /// The number of systems to remove.
+        int myRemovedCount;
+        /// The systems to insert in their place.
+        std::vector<System> mySystems;
+    };
+
+    /// Returns whether the patch does not change anything.
+    bool isEmpty() const;
+
+    boost::optional<ScoreInfo> myScoreInfo;
+    boost::optional<std::vector<Player>> myPlayers;
+    boost::optional<std::vector<Instrument>> myInstruments;
+    boost::optional<int> myLineSpacing;
+    /// The changes to the systems, ordered by index. The hunks do not
+    /// overlap.
+    std::vector<Hunk> myHunks;
+};
+
+/// A change that could not be merged, since both versions of the score
+/// modified the same part of the base score differently.
+struct MergeConflict
+{
+    MergeConflict(const std::string &description, int system);
+
+    /// A description of what was changed (e.g. "players" or "staff 2").
+    std::string myDescription;
+    /// The affected system in "ours", or -1 if the conflict is not in a
+    /// system.
+    int mySystem;
+};
+
+struct MergeResult
+{
+    /// The non-conflicting changes from "theirs", to be applied to "ours".
+    ScorePatch myPatch;
+    std::vector<MergeConflict> myConflicts;
+};
+
+/// Computes the changes between two scores. The systems are aligned by
+/// comparing their hashes, so unchanged systems are skipped cheaply even if
+/// systems were inserted or removed elsewhere in the score.
+ScorePatch diff(const Score &original, const Score &modified);
+
+/// Applies a patch to the score that it was computed from, and returns the
+/// patch that reverts the changes.
+ScorePatch applyPatch(Score &score, const ScorePatch &patch);
+
+/// Merges the changes made between "base" and "theirs" into "ours". Systems
+/// that were modified on both sides are merged staff by staff.
+MergeResult merge(const Score &base, const Score &ours, const Score &theirs);
+
+/// Writes a summary of the changes, listing the modified bars of each system
+/// and the number of positions that were added or removed.
+void printPatch(std::ostream &output, const Score &original,
+                const ScorePatch &patch);
+}
+
+#endif
@@ -19,16 +19,13 @@
 
 #include <score/score.h>
 #include <score/utils.h>
-#include <score/voiceutils.h>
-#include <unordered_set>
 
 /// Approximate upper limit on the number of positions in a system.
 static const int POSITION_LIMIT = 30;
 
 ScoreMerger::ScoreMerger(Score &dest, Score &guitarScore, Score &bassScore)
     : myDestScore(dest),
-      myDestCaret(dest),
-      myDestLoc(myDestCaret.getLocation()),
+      myDestPosition(0),
       myGuitarScore(guitarScore),
       myBassScore(bassScore),
       myGuitarState(guitarScore, false),
@@ -64,52 +61,47 @@ static void hideSignaturesAndRehearsalSign(Barline &bar)
     bar.setTimeSignature(time);
 }
 
-static int insertWholeRest(ScoreLocation &dest, ScoreLocation &)
+static int insertWholeRest(Voice &dest, const Voice &, int destPosition)
 {
-    Position wholeRest(dest.getPositionIndex(), Position::WholeNote);
+    Position wholeRest(destPosition, Position::WholeNote);
     wholeRest.setRest();
-    dest.getVoice().insertPosition(wholeRest);
+    dest.insertPosition(wholeRest);
 
     // A whole rest should probably span at least a few positions.
     return 8;
 }
 
-static int insertMultiBarRest(ScoreLocation &dest, ScoreLocation &, int count)
+static int insertMultiBarRest(Voice &dest, const Voice &, int destPosition,
+                              int count)
 {
-    Position rest(dest.getPositionIndex(), Position::WholeNote);
+    Position rest(destPosition, Position::WholeNote);
     rest.setRest();
     rest.setMultiBarRest(count);
-    dest.getVoice().insertPosition(rest);
+    dest.insertPosition(rest);
 
     // A multi-bar rest should probably span at least a few positions.
     return 16;
 }
 
-static void getPositionRange(const ScoreLocation &dest, const ScoreLocation &src,
-        int &offset, int &left, int &right)
+/// Returns the position of the last note in the irregular grouping.
+static int getGroupEnd(const Voice &voice, const IrregularGrouping &group)
 {
-    const System &srcSystem = src.getSystem();
-    const Barline *srcBar = src.getBarline();
-    assert(srcBar);
-    const Barline *nextSrcBar = srcSystem.getNextBarline(srcBar->getPosition());
-    assert(nextSrcBar);
-
-    offset = dest.getPositionIndex() - srcBar->getPosition();
-    if (srcBar->getPosition() != 0)
-        --offset;
-
-    left = srcBar->getPosition();
-    right = nextSrcBar->getPosition();
+    auto positions = voice.getPositions();
+    auto first = ScoreUtils::findInSortedRange(positions, group.getPosition(),
+                                               group.getPosition()).begin();
+    const int index = std::min<int>(
+        static_cast<int>(first - positions.begin()) + group.getLength() - 1,
+        static_cast<int>(positions.size()) - 1);
+
+    return positions[index].getPosition();
 }
 
 /// Copy notes from the source bar to the destination.
-static int copyNotes(ScoreLocation &dest, ScoreLocation &src)
+static int copyNotes(Voice &dest, const Voice &src, int offset, int left,
+                     int right)
 {
-    int offset, left, right;
-    getPositionRange(dest, src, offset, left, right);
-
-    auto positions = ScoreUtils::findInRange(src.getVoice().getPositions(),
-                                             left, right);
+    auto positions =
+        ScoreUtils::findInSortedRange(src.getPositions(), left, right);
 
     if (!positions.empty())
     {
@@ -117,15 +109,31 @@ static int copyNotes(ScoreLocation &dest, ScoreLocation &src)
         {
             Position newPos(pos);
             newPos.setPosition(newPos.getPosition() + offset);
-            dest.getVoice().insertPosition(newPos);
+            dest.insertPosition(newPos);
+        }
+
+        // Irregular groups don't overlap, so only the groups that start in
+        // the bar and the last group that starts before it need to be
+        // checked.
+        auto groups = src.getIrregularGroupings();
+        auto groupsEnd =
+            ScoreUtils::findInSortedRange(groups, groups.empty()
+                                                      ? 0
+                                                      : groups.front().getPosition(),
+                                          right).end();
+        auto groupsBegin = groupsEnd;
+        while (groupsBegin != groups.begin() &&
+               getGroupEnd(src, *(groupsBegin - 1)) >= left)
+        {
+            --groupsBegin;
         }
 
-        for (const IrregularGrouping *group :
-             VoiceUtils::getIrregularGroupsInRange(src.getVoice(), left, right))
+        for (const IrregularGrouping &group :
+             boost::make_iterator_range(groupsBegin, groupsEnd))
         {
-            IrregularGrouping newGroup(*group);
+            IrregularGrouping newGroup(group);
             newGroup.setPosition(newGroup.getPosition() + offset);
-            dest.getVoice().insertIrregularGrouping(newGroup);
+            dest.insertIrregularGrouping(newGroup);
         }
 
         int length = right - left;
@@ -138,17 +146,26 @@ static int copyNotes(ScoreLocation &dest, ScoreLocation &src)
         return 0;
 }
 
-int ScoreMerger::importNotes(
-    ScoreLocation &dest, State &srcState,
-    std::function<int(ScoreLocation &, ScoreLocation &)> action)
+ScoreMerger::BarRange ScoreMerger::getBarRange(const State &state) const
 {
-    ScoreLocation &srcLoc = srcState.loc;
+    const SourceBar &bar = state.getBar();
 
-    System &destSystem = dest.getSystem();
-    const System &srcSystem = srcLoc.getSystem();
+    BarRange range;
+    range.myDestPosition = myDestPosition;
+    range.myOffset = myDestPosition - bar.myLeft;
+    if (bar.myLeft != 0)
+        --range.myOffset;
 
-    int offset, left, right;
-    getPositionRange(dest, srcLoc, offset, left, right);
+    range.myLeft = bar.myLeft;
+    range.myRight = bar.myRight;
+    return range;
+}
+
+int ScoreMerger::importNotes(State &srcState, const ImportAction &action)
+{
+    System &destSystem = myDestScore.getSystems().back();
+    const System &srcSystem = srcState.getSystem();
+    const BarRange range = getBarRange(srcState);
 
     const int staffOffset = srcState.isBass ? myNumGuitarStaves : 0;
     int length = 0;
@@ -156,11 +173,12 @@ int ScoreMerger::importNotes(
     // Merge the notes for each staff.
     for (int i = 0; i < srcSystem.getStaves().size(); ++i)
     {
+        const Staff &srcStaff = srcSystem.getStaves()[i];
+
         // Ensure that there are enough staves in the destination system.
         if ((!srcState.isBass && myNumGuitarStaves <= i) ||
             destSystem.getStaves().size() <= i + staffOffset)
         {
-            const Staff &srcStaff = srcSystem.getStaves()[i];
             Staff destStaff(srcStaff.getStringCount());
             destStaff.setClefType(srcStaff.getClefType());
             destStaff.setViewType(srcState.isBass ? Staff::BassView : Staff::GuitarView);
@@ -170,29 +188,27 @@ int ScoreMerger::importNotes(
                 ++myNumGuitarStaves;
         }
 
-        myDestLoc.setStaffIndex(i + staffOffset);
-        srcLoc.setStaffIndex(i);
+        Staff &destStaff = destSystem.getStaves()[i + staffOffset];
 
         // Import dynamics, but don't repeatedly do so when expanding a
         // multi-bar rest.
         if (!srcState.expandingMultibarRest)
         {
-            for (const Dynamic &dynamic : ScoreUtils::findInRange(
-                        srcLoc.getStaff().getDynamics(), left, right - 1))
+            for (const Dynamic &dynamic : ScoreUtils::findInSortedRange(
+                     srcStaff.getDynamics(), range.myLeft, range.myRight - 1))
             {
                 Dynamic newDynamic(dynamic);
-                newDynamic.setPosition(newDynamic.getPosition() + offset);
-                dest.getStaff().insertDynamic(newDynamic);
+                newDynamic.setPosition(newDynamic.getPosition() +
+                                       range.myOffset);
+                destStaff.insertDynamic(newDynamic);
             }
         }
 
         // Import each voice.
         for (int v = 0; v < Staff::NUM_VOICES; ++v)
         {
-            myDestLoc.setVoiceIndex(v);
-            srcLoc.setVoiceIndex(v);
-
-            length = std::max(length, action(myDestLoc, srcLoc));
+            length = std::max(length, action(destStaff.getVoices()[v],
+                                             srcStaff.getVoices()[v], range));
         }
     }
 
@@ -224,24 +240,22 @@ void ScoreMerger::copyBarsFromSource(
     else
         state = &myBassState;
 
-    const Barline *srcBar = state->loc.getBarline();
-    const System *srcSystem = &state->loc.getSystem();
+    const SourceBar &bar = state->getBar();
+    const System &srcSystem = state->getSystem();
+    const Barline &srcBar = srcSystem.getBarlines()[bar.myBarlineIndex];
+    const Barline &nextSrcBar = srcSystem.getBarlines()[bar.myBarlineIndex + 1];
     const bool isCopied = state->expandingMultibarRest;
 
-    assert(srcBar);
-    const Barline *nextSrcBar = srcSystem->getNextBarline(srcBar->getPosition());
-    assert(nextSrcBar);
-
     // Only set the left bar's properties when we're at the start of the system,
     // or after we've detected that bars are being copied (i.e. we want to clear
     // duplicate repeat ends if a multi-bar rest appears directly before a
     // repeat end bar).
     int destPosition = destBar.getPosition();
-    if (destPosition == 0 || (srcBar->getPosition() == 0 &&
-                              srcBar->getBarType() != Barline::SingleBar) ||
+    if (destPosition == 0 || (srcBar.getPosition() == 0 &&
+                              srcBar.getBarType() != Barline::SingleBar) ||
         isCopied || state->repeatState == State::EXPANDING_REPEAT)
     {
-        destBar = *srcBar;
+        destBar = srcBar;
         removeRepeatsWhenExpanding(isExpanding, destBar);
         // The first bar cannot be the end of a repeat.
         if (destPosition == 0 && destBar.getBarType() == Barline::RepeatEnd)
@@ -253,7 +267,7 @@ void ScoreMerger::copyBarsFromSource(
         hideSignaturesAndRehearsalSign(destBar);
 
     // Set the right bar's properties.
-    nextDestBar = *nextSrcBar;
+    nextDestBar = nextSrcBar;
     removeRepeatsWhenExpanding(isExpanding, nextDestBar);
 
     if (nextDestBar.getBarType() == Barline::RepeatEnd &&
@@ -264,10 +278,10 @@ void ScoreMerger::copyBarsFromSource(
 
     // If the next bar is at the end of the source system, return the start bar
     // of the next system.
-    if (nextSrcBar == &srcSystem->getBarlines().back())
+    if (&nextSrcBar == &srcSystem.getBarlines().back())
     {
-        const Score &srcScore = state->loc.getScore();
-        const int systemIndex = state->loc.getSystemIndex();
+        const Score &srcScore = state->score;
+        const int systemIndex = bar.mySystemIndex;
         if (srcScore.getSystems().size() > systemIndex + 1)
         {
             const System &nextSrcSystem = srcScore.getSystems()[systemIndex + 1];
@@ -277,16 +291,14 @@ void ScoreMerger::copyBarsFromSource(
     }
 }
 
-const PlayerChange *ScoreMerger::findPlayerChange(const State &state)
+const PlayerChange *ScoreMerger::findPlayerChange(const State &state) const
 {
     if (state.outOfNotes() || state.expandingMultibarRest)
         return nullptr;
 
-    int offset, left, right;
-    getPositionRange(myDestLoc, state.loc, offset, left, right);
-
-    auto changes = ScoreUtils::findInRange(
-        state.loc.getSystem().getPlayerChanges(), left, right - 1);
+    const SourceBar &bar = state.getBar();
+    auto changes = ScoreUtils::findInSortedRange(
+        state.getSystem().getPlayerChanges(), bar.myLeft, bar.myRight - 1);
 
     return changes.empty() ? nullptr : &changes.front();
 }
@@ -301,8 +313,7 @@ void ScoreMerger::mergePlayerChanges()
     // insert a player change to ensure that player are assigned to the correct
     // staves.
     if (guitarChange || bassChange ||
-        (myNumGuitarStaves != myPrevNumGuitarStaves &&
-         myDestLoc.getPositionIndex() == 0))
+        (myNumGuitarStaves != myPrevNumGuitarStaves && myDestPosition == 0))
     {
         PlayerChange change;
 
@@ -310,18 +321,14 @@ void ScoreMerger::mergePlayerChanges()
         {
             // If there is only a player change in the bass score, carry over
             // the current active players from the guitar score.
-            guitarChange = ScoreUtils::getCurrentPlayers(
-                myGuitarScore, myGuitarState.loc.getSystemIndex(),
-                myGuitarState.loc.getPositionIndex());
+            guitarChange = myGuitarState.getBar().myCurrentPlayers;
         }
 
         if (!bassChange && !myBassState.done)
         {
             // If there is only a player change in the guitar score, carry over
             // the current active players from the bass score.
-            bassChange = ScoreUtils::getCurrentPlayers(
-                myBassScore, myBassState.loc.getSystemIndex(),
-                myBassState.loc.getPositionIndex());
+            bassChange = myBassState.getBar().myCurrentPlayers;
         }
 
         // Merge in data from only the active staves.
@@ -341,7 +348,7 @@ void ScoreMerger::mergePlayerChanges()
         // staff/player/instrument numbers.
         if (bassChange)
         {
-            for (int i = 0; i < myBassState.loc.getSystem().getStaves().size();
+            for (int i = 0; i < myBassState.getSystem().getStaves().size();
                  ++i)
             {
                 for (const ActivePlayer &player :
@@ -357,8 +364,8 @@ void ScoreMerger::mergePlayerChanges()
             }
         }
 
-        change.setPosition(myDestLoc.getPositionIndex());
-        myDestLoc.getSystem().insertPlayerChange(change);
+        change.setPosition(myDestPosition);
+        myDestScore.getSystems().back().insertPlayerChange(change);
     }
 }
 
@@ -369,22 +376,25 @@ static void copySymbols(
     const boost::iterator_range<typename std::vector<Symbol>::const_iterator> &destSymbols,
     void (System::*addSymbol)(const Symbol &), int offset, int left, int right)
 {
-    std::unordered_set<int> filledPositions;
-    for (const Symbol &destSymbol : destSymbols)
-        filledPositions.insert(destSymbol.getPosition());
-
+    // Check for duplicates before inserting anything, since the insertions
+    // invalidate the destination range.
+    std::vector<Symbol> symbols;
     for (const Symbol &srcSymbol :
-         ScoreUtils::findInRange(srcSymbols, left, right - 1))
+         ScoreUtils::findInSortedRange(srcSymbols, left, right - 1))
     {
         Symbol symbol(srcSymbol);
         symbol.setPosition(srcSymbol.getPosition() + offset);
 
         // We might get duplicate symbols from the two scores.
-        if (filledPositions.find(symbol.getPosition()) != filledPositions.end())
-            continue;
+        if (ScoreUtils::findInSortedRange(destSymbols, symbol.getPosition(),
+                                          symbol.getPosition()).empty())
+        {
+            symbols.push_back(symbol);
+        }
+    }
 
+    for (const Symbol &symbol : symbols)
         (destSystem.*addSymbol)(symbol);
-    }
 }
 
 void ScoreMerger::mergeSystemSymbols()
@@ -394,24 +404,24 @@ void ScoreMerger::mergeSystemSymbols()
         if (state->outOfNotes() || state->expandingMultibarRest)
             continue;
 
-        int offset, left, right;
-        getPositionRange(myDestLoc, state->loc, offset, left, right);
-
-        const System &srcSystem = state->loc.getSystem();
-        System &destSystem = myDestLoc.getSystem();
+        const BarRange range = getBarRange(*state);
+        const System &srcSystem = state->getSystem();
+        System &destSystem = myDestScore.getSystems().back();
 
         copySymbols(srcSystem.getTempoMarkers(), destSystem,
                     destSystem.getTempoMarkers(), &System::insertTempoMarker,
-                    offset, left, right);
+                    range.myOffset, range.myLeft, range.myRight);
 
         copySymbols(srcSystem.getChords(), destSystem, destSystem.getChords(),
-                    &System::insertChord, offset, left, right);
+                    &System::insertChord, range.myOffset, range.myLeft,
+                    range.myRight);
 
         if (state->repeatState != State::EXPANDING_REPEAT)
         {
             copySymbols(srcSystem.getAlternateEndings(), destSystem,
                         destSystem.getAlternateEndings(),
-                        &System::insertAlternateEnding, offset, left, right);
+                        &System::insertAlternateEnding, range.myOffset,
+                        range.myLeft, range.myRight);
         }
     }
 }
@@ -420,12 +430,14 @@ void ScoreMerger::merge()
 {
     mergePlayers();
     myDestScore.insertSystem(System());
+    myDestPosition = 0;
 
     while (true)
     {
-        System &destSystem = myDestLoc.getSystem();
-        Barline *destBar = myDestLoc.getBarline();
-        assert(destBar);
+        System &destSystem = myDestScore.getSystems().back();
+        // The current bar is always the last bar before the end bar.
+        Barline *destBar =
+            &destSystem.getBarlines()[destSystem.getBarlines().size() - 2];
         Barline nextDestBar;
         boost::optional<Barline> nextSystemStartBar;
 
@@ -447,8 +459,8 @@ void ScoreMerger::merge()
         copyBarsFromSource(*destBar, nextDestBar, nextSystemStartBar);
 
         // We will insert the notes at the first position after the barline.
-        if (myDestLoc.getPositionIndex() != 0)
-            myDestCaret.moveHorizontal(1);
+        if (myDestPosition != 0)
+            ++myDestPosition;
 
         // TODO - this also needs to handle mismatched repeats, alternate
         // endings, and directions.
@@ -465,11 +477,14 @@ void ScoreMerger::merge()
             const int count = std::min(myGuitarState.multibarRestCount,
                                        myBassState.multibarRestCount);
 
-            auto action = std::bind(insertMultiBarRest, std::placeholders::_1,
-                                    std::placeholders::_2, count);
-            barLength = importNotes(myDestLoc, myGuitarState, action);
-            barLength = std::max(
-                barLength, importNotes(myDestLoc, myBassState, action));
+            auto action = [=](Voice &dest, const Voice &src,
+                              const BarRange &range) {
+                return insertMultiBarRest(dest, src, range.myDestPosition,
+                                          count);
+            };
+            barLength = importNotes(myGuitarState, action);
+            barLength =
+                std::max(barLength, importNotes(myBassState, action));
 
             myGuitarState.multibarRestCount -= count;
             myBassState.multibarRestCount -= count;
@@ -488,13 +503,24 @@ void ScoreMerger::merge()
                 // system in the destination score.
                 if (state->inMultibarRest || state->finishing)
                 {
-                    length = importNotes(myDestLoc, *state, insertWholeRest);
+                    length = importNotes(*state, [](Voice &dest,
+                                                    const Voice &src,
+                                                    const BarRange &range) {
+                        return insertWholeRest(dest, src, range.myDestPosition);
+                    });
 
                     if (state->inMultibarRest)
                         --state->multibarRestCount;
                 }
                 else
-                    length = importNotes(myDestLoc, *state, copyNotes);
+                {
+                    length = importNotes(*state, [](Voice &dest,
+                                                    const Voice &src,
+                                                    const BarRange &range) {
+                        return copyNotes(dest, src, range.myOffset,
+                                         range.myLeft, range.myRight);
+                    });
+                }
 
                 barLength = std::max(barLength, length);
             }
@@ -546,7 +572,7 @@ void ScoreMerger::merge()
                 myDestScore.insertSystem(System());
                 myPrevNumGuitarStaves = myNumGuitarStaves;
                 myNumGuitarStaves = 0;
-                myDestCaret.moveSystem(1);
+                myDestPosition = 0;
             }
         }
         else
@@ -562,7 +588,7 @@ void ScoreMerger::merge()
             {
                 nextDestBar.setPosition(nextBarPos);
                 destSystem.insertBarline(nextDestBar);
-                myDestCaret.moveToNextBar();
+                myDestPosition = nextBarPos;
                 ++nextBarPos;
             }
 
@@ -571,7 +597,7 @@ void ScoreMerger::merge()
             {
                 nextSystemStartBar->setPosition(nextBarPos);
                 destSystem.insertBarline(*nextSystemStartBar);
-                myDestCaret.moveToNextBar();
+                myDestPosition = nextBarPos;
             }
 
             destSystem.getBarlines().back().setPosition(nextBarPos + 10);
@@ -579,10 +605,10 @@ void ScoreMerger::merge()
     }
 }
 
-ScoreMerger::State::State(Score &score, bool isBass)
-    : caret(score),
+ScoreMerger::State::State(const Score &score, bool isBass)
+    : score(score),
       repeatIndex(score),
-      loc(caret.getLocation()),
+      barIndex(0),
       isBass(isBass),
       inMultibarRest(false),
       expandingMultibarRest(false),
@@ -590,20 +616,97 @@ ScoreMerger::State::State(Score &score, bool isBass)
       repeatState(NO_REPEAT),
       remainingRepeats(0),
       numMergedRepeats(0),
+      repeatedSection(nullptr),
       done(false),
       finishing(false)
 {
     bool empty = true;
+    const PlayerChange *currentPlayers = nullptr;
+
+    // Split the score into bars up front, so that merging only needs to walk
+    // through this list.
+    int systemIndex = 0;
     for (const System &system : score.getSystems())
     {
+        systemStarts.push_back(static_cast<int>(bars.size()));
+
         for (const Staff &staff : system.getStaves())
         {
             for (const Voice &voice : staff.getVoices())
                 empty &= voice.getPositions().empty();
         }
 
-        if (!empty)
-            break;
+        auto changes = system.getPlayerChanges();
+        auto change = changes.begin();
+        auto barlines = system.getBarlines();
+
+        for (int i = 0; i < static_cast<int>(barlines.size()) - 1; ++i)
+        {
+            SourceBar bar;
+            bar.mySystemIndex = systemIndex;
+            bar.myBarlineIndex = i;
+            bar.myLeft = barlines[i].getPosition();
+            bar.myRight = barlines[i + 1].getPosition();
+            bar.myMultiBarRest = nullptr;
+
+            for (; change != changes.end() &&
+                   change->getPosition() <= bar.myLeft;
+                 ++change)
+            {
+                currentPlayers = &*change;
+            }
+            bar.myCurrentPlayers = currentPlayers;
+
+            for (const Staff &staff : system.getStaves())
+            {
+                for (const Voice &voice : staff.getVoices())
+                {
+                    for (const Position &pos : ScoreUtils::findInSortedRange(
+                             voice.getPositions(), bar.myLeft, bar.myRight))
+                    {
+                        if (!bar.myMultiBarRest && pos.hasMultiBarRest())
+                            bar.myMultiBarRest = &pos;
+                    }
+                }
+            }
+
+            bars.push_back(bar);
+        }
+
+        // Player changes after the last bar still apply to the next system.
+        for (; change != changes.end(); ++change)
+            currentPlayers = &*change;
+
+        ++systemIndex;
+    }
+
+    // Find the repeated section around each bar. The +1 offset is important
+    // - the bar after a repeat end barline shouldn't be considered part of
+    // that repeat section. This gives the same result as
+    // RepeatIndexer::findRepeat(), but the repeats that have already ended are
+    // discarded rather than being searched again for every bar.
+    std::vector<const RepeatedSection *> openRepeats;
+    auto repeats = repeatIndex.getRepeats();
+    auto nextRepeat = repeats.begin();
+    for (SourceBar &bar : bars)
+    {
+        const SystemLocation location(bar.mySystemIndex, bar.myLeft + 1);
+
+        for (; nextRepeat != repeats.end() &&
+               !(location < nextRepeat->getStartBarLocation());
+             ++nextRepeat)
+        {
+            openRepeats.push_back(&*nextRepeat);
+        }
+
+        while (!openRepeats.empty() &&
+               openRepeats.back()->getLastEndBarLocation() < location)
+        {
+            openRepeats.pop_back();
+        }
+
+        bar.myRepeatedSection =
+            openRepeats.empty() ? nullptr : openRepeats.back();
     }
 
     // If it looks like the score is unused, don't do anything.
@@ -611,6 +714,16 @@ ScoreMerger::State::State(Score &score, bool isBass)
         done = true;
 }
 
+const ScoreMerger::SourceBar &ScoreMerger::State::getBar() const
+{
+    return bars[barIndex];
+}
+
+const System &ScoreMerger::State::getSystem() const
+{
+    return score.getSystems()[getBar().mySystemIndex];
+}
+
 bool ScoreMerger::State::outOfNotes() const
 {
     return done || finishing;
@@ -631,26 +744,35 @@ void ScoreMerger::State::advance()
     // need to first finish expanding that.
     if (!inMultibarRest && repeatState != NO_REPEAT && remainingRepeats)
     {
-        const Barline *nextBar = caret.getLocation().getSystem().getNextBarline(
-            caret.getLocation().getPositionIndex());
-        SystemLocation endBarLoc(caret.getLocation().getSystemIndex(),
-                                 nextBar->getPosition());
+        const SourceBar &bar = getBar();
+        SystemLocation endBarLoc(bar.mySystemIndex, bar.myRight);
 
         if (repeatedSection->getRepeatEndBars().find(endBarLoc) !=
             repeatedSection->getRepeatEndBars().end())
         {
-            caret.moveToSystem(
-                repeatedSection->getStartBarLocation().getSystem(), true);
-            caret.moveToPosition(
-                repeatedSection->getStartBarLocation().getPosition());
+            const SystemLocation &startLoc =
+                repeatedSection->getStartBarLocation();
+            const int startSystem = startLoc.getSystem();
+            auto barlines = score.getSystems()[startSystem].getBarlines();
+            auto startBar = ScoreUtils::findInSortedRange(
+                barlines, startLoc.getPosition(), startLoc.getPosition());
+            assert(!startBar.empty());
+
+            barIndex = systemStarts[startSystem] +
+                       static_cast<int>(startBar.begin() - barlines.begin());
             --remainingRepeats;
             return;
         }
     }
 
     // Otherwise, just move on to the next bar.
-    if (!inMultibarRest && !caret.moveToNextBar())
-        finishing = true;
+    if (!inMultibarRest)
+    {
+        if (barIndex + 1 < static_cast<int>(bars.size()))
+            ++barIndex;
+        else
+            finishing = true;
+    }
 }
 
 void ScoreMerger::State::finishIfPossible()
@@ -667,7 +789,7 @@ void ScoreMerger::State::checkForMultibarRest()
     if (inMultibarRest)
         return;
 
-    const Position *rest = loc.findMultiBarRest();
+    const Position *rest = getBar().myMultiBarRest;
     if (rest)
     {
         inMultibarRest = true;
@@ -677,13 +799,8 @@ void ScoreMerger::State::checkForMultibarRest()
 
 void ScoreMerger::State::checkForRepeatedSection()
 {
-    // The +1 offset is important - the bar after a repeat end barline shouldn't
-    // be considered part of that repeat section, so we need to move off of that
-    // barline.
     auto oldSection = repeatedSection;
-    repeatedSection = repeatIndex.findRepeat(
-        SystemLocation(caret.getLocation().getSystemIndex(),
-                       caret.getLocation().getPositionIndex() + 1));
+    repeatedSection = getBar().myRepeatedSection;
     if (repeatedSection)
     {
         // Detect when we've entered a new repeat section, and if we just
@@ -700,44 +817,35 @@ void ScoreMerger::State::checkForRepeatedSection()
         repeatState = NO_REPEAT;
 }
 
-static int getRepeatedSectionWidth(Score &score, const RepeatedSection &sec)
+int ScoreMerger::State::getRepeatedSectionWidth(
+    const RepeatedSection &section) const
 {
-    auto &startLoc = sec.getStartBarLocation();
-    auto &endLoc = sec.getLastEndBarLocation();
+    auto &startLoc = section.getStartBarLocation();
+    auto &endLoc = section.getLastEndBarLocation();
 
-    Caret caret(score);
-    caret.moveToSystem(startLoc.getSystem(), true);
-    caret.moveToPosition(startLoc.getPosition());
+    auto barlines = score.getSystems()[startLoc.getSystem()].getBarlines();
+    auto startBar = ScoreUtils::findInSortedRange(
+        barlines, startLoc.getPosition(), startLoc.getPosition());
+    assert(!startBar.empty());
 
     int count = 0;
-    do
+    for (int i = systemStarts[startLoc.getSystem()] +
+                 static_cast<int>(startBar.begin() - barlines.begin());
+         i < static_cast<int>(bars.size()); ++i)
     {
-        if (SystemLocation(caret.getLocation().getSystemIndex(),
-                           caret.getLocation().getPositionIndex()) >= endLoc)
-        {
+        const SourceBar &bar = bars[i];
+        if (SystemLocation(bar.mySystemIndex, bar.myLeft) >= endLoc)
             break;
-        }
 
-        const Position *multiRest = caret.getLocation().findMultiBarRest();
-        if (multiRest)
-            count += multiRest->getMultiBarRestCount();
+        if (bar.myMultiBarRest)
+            count += bar.myMultiBarRest->getMultiBarRestCount();
         else
             ++count;
-
-    } while (caret.moveToNextBar());
+    }
 
     return count;
 }
 
-static bool haveSameStructure(Score &score1, const RepeatedSection &sec1,
-                              Score &score2, const RepeatedSection &sec2)
-{
-    // For now, just check whether they contain the same number of bars.
-    // TODO - handle alternate endings, nested repeats, etc.
-    return getRepeatedSectionWidth(score1, sec1) ==
-           getRepeatedSectionWidth(score2, sec2);
-}
-
 void ScoreMerger::State::compareRepeatedSection(State &other)
 {
     // Check if we can actually merge these sections.
@@ -749,9 +857,9 @@ void ScoreMerger::State::compareRepeatedSection(State &other)
 
         // If the two sections have the same number of bars, etc., then we don't
         // need to expand the repeats.
-        if (haveSameStructure(caret.getLocation().getScore(), *repeatedSection,
-                              other.caret.getLocation().getScore(),
-                              *other.repeatedSection))
+        // TODO - handle alternate endings, nested repeats, etc.
+        if (getRepeatedSectionWidth(*repeatedSection) ==
+            other.getRepeatedSectionWidth(*other.repeatedSection))
         {
             // The repeated sections might have a different number of repeats,
             // so we need to compute how many repetitions we can merge them for.
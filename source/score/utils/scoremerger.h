@@ -18,11 +18,21 @@
 #ifndef SCORE_UTILS_SCOREMERGER_H
 #define SCORE_UTILS_SCOREMERGER_H
 
-#include <app/caret.h>
+#include <boost/optional/optional.hpp>
+#include <functional>
 #include <score/utils/repeatindexer.h>
+#include <vector>
 
+class Barline;
 class PlayerChange;
-
+class Position;
+class Score;
+class System;
+class Voice;
+
+/// Merges the guitar and bass scores from a version 1.7 file into a single
+/// score. The destination score is built bar by bar, and is only ever
+/// appended to.
 class ScoreMerger
 {
     struct State;
@@ -33,12 +43,43 @@ public:
     void merge();
 
 private:
+    /// A bar from one of the source scores.
+    struct SourceBar
+    {
+        int mySystemIndex;
+        /// Index of the bar's starting barline within the system.
+        int myBarlineIndex;
+        /// Positions of the bar's starting barline and the next barline.
+        int myLeft;
+        int myRight;
+        /// A multi-bar rest in any of the bar's staves.
+        const Position *myMultiBarRest;
+        /// The active players at the start of the bar.
+        const PlayerChange *myCurrentPlayers;
+        /// The repeated section that the bar belongs to.
+        const RepeatedSection *myRepeatedSection;
+    };
+
+    /// Where the notes from the current source bar are placed in the
+    /// destination system.
+    struct BarRange
+    {
+        int myDestPosition;
+        int myOffset;
+        int myLeft;
+        int myRight;
+    };
+
+    typedef std::function<int(Voice &, const Voice &, const BarRange &)>
+        ImportAction;
+
     /// Merge players and instruments.
     void mergePlayers();
 
-    int importNotes(
-        ScoreLocation &dest, State &srcState,
-        std::function<int(ScoreLocation &, ScoreLocation &)> action);
+    int importNotes(State &srcState, const ImportAction &action);
+
+    /// Returns the range of positions to copy from the source's current bar.
+    BarRange getBarRange(const State &state) const;
 
     /// Fetch the current pair of barlines from one of the source scores.
     /// If the next bar is the last bar of the source system, the start bar from
@@ -53,7 +94,7 @@ private:
     void mergeSystemSymbols();
 
     /// Check for a player change in the current bar.
-    const PlayerChange *findPlayerChange(const State &state);
+    const PlayerChange *findPlayerChange(const State &state) const;
 
     /// The state of one of the source scores being merged.
     struct State
@@ -64,11 +105,15 @@ private:
             EXPANDING_REPEAT
         };
 
-        State(Score &score, bool isBass);
+        State(const Score &score, bool isBass);
 
-        Caret caret;
+        const Score &score;
         RepeatIndexer repeatIndex;
-        ScoreLocation &loc;
+        /// Every bar in the score, in order.
+        std::vector<SourceBar> bars;
+        /// The index of each system's first bar.
+        std::vector<int> systemStarts;
+        int barIndex;
         bool isBass;
 
         bool inMultibarRest;
@@ -83,17 +128,23 @@ private:
         bool done;
         bool finishing;
 
+        const SourceBar &getBar() const;
+        const System &getSystem() const;
+
         bool outOfNotes() const;
         void advance();
         void finishIfPossible();
         void checkForMultibarRest();
         void checkForRepeatedSection();
         void compareRepeatedSection(State &other);
+        /// Returns the number of bars in the repeated section, including any
+        /// bars that are part of a multi-bar rest.
+        int getRepeatedSectionWidth(const RepeatedSection &section) const;
     };
 
     Score &myDestScore;
-    Caret myDestCaret;
-    ScoreLocation &myDestLoc;
+    /// The current position in the last system of the destination score.
+    int myDestPosition;
 
     Score &myGuitarScore;
     Score &myBassScore;
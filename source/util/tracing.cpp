@@ -0,0 +1,273 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "tracing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <ostream>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadStorage>
+#include <vector>
+
+namespace
+{
+/// The number of events that are kept for each thread. Older events are
+/// overwritten.
+const uint64_t BUFFER_SIZE = 1 << 15;
+
+const char SPAN_EVENT = 'X';
+const char COUNTER_EVENT = 'C';
+
+/// The fields are atomic so that the buffer can be exported while the owning
+/// thread continues to record events.
+struct Event
+{
+    std::atomic<const char *> myName;
+    std::atomic<char> myType;
+    /// The start time, in microseconds.
+    std::atomic<int64_t> myTimestamp;
+    /// The duration of a span, or the value of a counter.
+    std::atomic<int64_t> myValue;
+};
+
+struct EventData
+{
+    const char *myName;
+    char myType;
+    int64_t myTimestamp;
+    int64_t myValue;
+};
+
+/// A ring buffer of events for a single thread. Only the owning thread
+/// records events, so recording does not require any locking.
+class ThreadBuffer
+{
+public:
+    explicit ThreadBuffer(int threadId)
+        : myThreadId(threadId),
+          myEvents(new Event[BUFFER_SIZE]),
+          myCount(0),
+          myFirstEvent(0)
+    {
+    }
+
+    int getThreadId() const
+    {
+        return myThreadId;
+    }
+
+    void record(char type, const char *name, int64_t timestamp, int64_t value)
+    {
+        const uint64_t index = myCount.load(std::memory_order_relaxed);
+
+        Event &event = myEvents[index % BUFFER_SIZE];
+        event.myName.store(name, std::memory_order_relaxed);
+        event.myType.store(type, std::memory_order_relaxed);
+        event.myTimestamp.store(timestamp, std::memory_order_relaxed);
+        event.myValue.store(value, std::memory_order_relaxed);
+
+        myCount.store(index + 1, std::memory_order_release);
+    }
+
+    /// Copies the events that are currently in the buffer.
+    std::vector<EventData> getEvents() const
+    {
+        const uint64_t end = myCount.load(std::memory_order_acquire);
+        const uint64_t begin = firstAvailable(end);
+
+        std::vector<EventData> events;
+        events.reserve(end - begin);
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            const Event &event = myEvents[i % BUFFER_SIZE];
+            EventData data = { event.myName.load(std::memory_order_relaxed),
+                               event.myType.load(std::memory_order_relaxed),
+                               event.myTimestamp.load(
+                                   std::memory_order_relaxed),
+                               event.myValue.load(std::memory_order_relaxed) };
+            events.push_back(data);
+        }
+
+        // Discard any events that were overwritten while they were being
+        // copied. The slot for the next event may also be partially written.
+        const uint64_t newEnd = myCount.load(std::memory_order_acquire);
+        const uint64_t validBegin =
+            (newEnd + 1 > BUFFER_SIZE) ? newEnd + 1 - BUFFER_SIZE : 0;
+        if (validBegin > begin)
+        {
+            events.erase(events.begin(),
+                         events.begin() + std::min<uint64_t>(
+                                              validBegin - begin,
+                                              events.size()));
+        }
+
+        return events;
+    }
+
+    void clear()
+    {
+        myFirstEvent.store(myCount.load(std::memory_order_acquire),
+                           std::memory_order_relaxed);
+    }
+
+private:
+    uint64_t firstAvailable(uint64_t end) const
+    {
+        const uint64_t first = myFirstEvent.load(std::memory_order_relaxed);
+        const uint64_t oldest = (end > BUFFER_SIZE) ? end - BUFFER_SIZE : 0;
+        return std::max(first, oldest);
+    }
+
+    const int myThreadId;
+    std::unique_ptr<Event[]> myEvents;
+    /// The total number of events that have been recorded.
+    std::atomic<uint64_t> myCount;
+    /// Events before this index were discarded by clear().
+    std::atomic<uint64_t> myFirstEvent;
+};
+
+struct Registry
+{
+    Registry() : myIsEnabled(false)
+    {
+        myTimer.start();
+    }
+
+    std::atomic<bool> myIsEnabled;
+    QElapsedTimer myTimer;
+    /// The buffers are kept after their thread exits, so that e.g. the
+    /// playback thread's events can still be exported.
+    QMutex myMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> myBuffers;
+};
+}
+
+Q_GLOBAL_STATIC(Registry, theRegistry)
+
+static QThreadStorage<std::shared_ptr<ThreadBuffer>> theThreadBuffers;
+
+static int64_t currentTime()
+{
+    return theRegistry->myTimer.nsecsElapsed() / 1000;
+}
+
+static ThreadBuffer &getThreadBuffer()
+{
+    if (!theThreadBuffers.hasLocalData())
+    {
+        Registry &registry = *theRegistry;
+        QMutexLocker lock(&registry.myMutex);
+
+        auto buffer = std::make_shared<ThreadBuffer>(
+            static_cast<int>(registry.myBuffers.size()) + 1);
+        registry.myBuffers.push_back(buffer);
+        theThreadBuffers.setLocalData(buffer);
+    }
+
+    return *theThreadBuffers.localData();
+}
+
+/// Returns a copy of the list of buffers, so that they can be accessed
+/// without holding the lock.
+static std::vector<std::shared_ptr<ThreadBuffer>> getBuffers()
+{
+    Registry &registry = *theRegistry;
+    QMutexLocker lock(&registry.myMutex);
+    return registry.myBuffers;
+}
+
+static void writeString(std::ostream &output, const char *str)
+{
+    output << '"';
+    for (; *str; ++str)
+    {
+        if (*str == '"' || *str == '\\')
+            output << '\\';
+        output << *str;
+    }
+    output << '"';
+}
+
+bool Tracing::isEnabled()
+{
+    return theRegistry->myIsEnabled.load(std::memory_order_relaxed);
+}
+
+void Tracing::setEnabled(bool enabled)
+{
+    theRegistry->myIsEnabled.store(enabled);
+}
+
+void Tracing::counter(const char *name, int64_t value)
+{
+    if (isEnabled())
+        getThreadBuffer().record(COUNTER_EVENT, name, currentTime(), value);
+}
+
+Tracing::Span::Span(const char *name)
+    : myName(name), myStartTime(isEnabled() ? currentTime() : -1)
+{
+}
+
+Tracing::Span::~Span()
+{
+    if (myStartTime >= 0)
+    {
+        getThreadBuffer().record(SPAN_EVENT, myName, myStartTime,
+                                 currentTime() - myStartTime);
+    }
+}
+
+void Tracing::exportJson(std::ostream &output)
+{
+    output << "{\"traceEvents\":[";
+
+    bool first = true;
+    for (auto &buffer : getBuffers())
+    {
+        for (const EventData &event : buffer->getEvents())
+        {
+            if (!first)
+                output << ",";
+            first = false;
+
+            output << "\n{\"name\":";
+            writeString(output, event.myName);
+            output << ",\"ph\":\"" << event.myType << "\",\"ts\":"
+                   << event.myTimestamp << ",\"pid\":1,\"tid\":"
+                   << buffer->getThreadId();
+
+            if (event.myType == SPAN_EVENT)
+                output << ",\"dur\":" << event.myValue;
+            else
+                output << ",\"args\":{\"value\":" << event.myValue << "}";
+
+            output << "}";
+        }
+    }
+
+    output << "\n]}\n";
+}
+
+void Tracing::clear()
+{
+    for (auto &buffer : getBuffers())
+        buffer->clear();
+}
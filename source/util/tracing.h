@@ -0,0 +1,78 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef UTIL_TRACING_H
+#define UTIL_TRACING_H
+
+#include <boost/noncopyable.hpp>
+#include <cstdint>
+#include <iosfwd>
+
+/// Lightweight instrumentation for tracking down performance problems.
+/// Spans and counters are recorded into a fixed-size ring buffer for each
+/// thread, and can be exported in the Chrome trace event format (which can be
+/// viewed at chrome://tracing).
+///
+/// Recording is disabled until Tracing::setEnabled() is called, and the
+/// PTE_TRACE_* macros are removed entirely unless PTE_ENABLE_TRACING is
+/// defined (see the ENABLE_TRACING CMake option).
+namespace Tracing
+{
+/// Returns whether events are currently being recorded.
+bool isEnabled();
+/// Starts or stops recording events.
+void setEnabled(bool enabled);
+
+/// Records the current value of a counter (e.g. the number of MIDI events).
+/// The name must be a string literal.
+void counter(const char *name, int64_t value);
+
+/// Records the time spent in the enclosing scope.
+class Span : boost::noncopyable
+{
+public:
+    /// The name must be a string literal.
+    explicit Span(const char *name);
+    ~Span();
+
+private:
+    const char *myName;
+    /// The start time, or -1 if tracing was disabled.
+    int64_t myStartTime;
+};
+
+/// Writes the recorded events from every thread as a Chrome trace event
+/// JSON document.
+void exportJson(std::ostream &output);
+
+/// Discards all of the recorded events.
+void clear();
+}
+
+#ifdef PTE_ENABLE_TRACING
+#define PTE_TRACE_CONCAT_IMPL(a, b) a##b
+#define PTE_TRACE_CONCAT(a, b) PTE_TRACE_CONCAT_IMPL(a, b)
+/// Records the duration of the enclosing scope.
+#define PTE_TRACE_SCOPE(name) \
+    Tracing::Span PTE_TRACE_CONCAT(traceSpan, __LINE__)(name)
+/// Records the current value of a counter.
+#define PTE_TRACE_COUNTER(name, value) Tracing::counter(name, value)
+#else
+#define PTE_TRACE_SCOPE(name)
+#define PTE_TRACE_COUNTER(name, value)
+#endif
+
+#endif
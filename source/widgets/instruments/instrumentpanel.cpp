@@ -18,6 +18,7 @@
 #include "instrumentpanel.h"
 
 #include "instrumentpanelitem.h"
+#include <boost/range/algorithm/equal.hpp>
 #include <QVBoxLayout>
 #include <score/score.h>
 
@@ -34,7 +35,12 @@ InstrumentPanel::InstrumentPanel(QWidget *parent,
 
 void InstrumentPanel::reset(const Score &score)
 {
+    if (boost::equal(myInstruments, score.getInstruments()))
+        return;
+
     clear();
+    myInstruments.assign(score.getInstruments().begin(),
+                         score.getInstruments().end());
 
     for (int i = 0; i < score.getInstruments().size(); ++i)
     {
@@ -45,6 +51,8 @@ void InstrumentPanel::reset(const Score &score)
 
 void InstrumentPanel::clear()
 {
+    myInstruments.clear();
+
     while (QLayoutItem *item = myLayout->takeAt(0))
     {
         // We might be clearing the instrument panel in response to a signal
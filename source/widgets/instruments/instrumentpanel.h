@@ -19,6 +19,8 @@
 #define WIDGETS_INSTRUMENTPANEL_H
 
 #include <QWidget>
+#include <score/instrument.h>
+#include <vector>
 
 class InstrumentEditPubSub;
 class InstrumentRemovePubSub;
@@ -31,7 +33,8 @@ public:
     InstrumentPanel(QWidget *parent, const InstrumentEditPubSub &editPubSub,
                     const InstrumentRemovePubSub &removePubSub);
 
-    /// Clear and then populate the instrument panel.
+    /// Clear and then populate the instrument panel. Nothing is done if the
+    /// instruments are unchanged since the previous reset.
     void reset(const Score &score);
 
     /// Removes all items from the panel.
@@ -41,6 +44,8 @@ private:
     QVBoxLayout *myLayout;
     const InstrumentEditPubSub &myEditPubSub;
     const InstrumentRemovePubSub &myRemovePubSub;
+    /// The instruments that are currently displayed.
+    std::vector<Instrument> myInstruments;
 };
 
 #endif
@@ -18,6 +18,7 @@
 #include "mixer.h"
 
 #include "mixeritem.h"
+#include <boost/range/algorithm/equal.hpp>
 #include <QVBoxLayout>
 #include <score/score.h>
 
@@ -37,7 +38,11 @@ Mixer::Mixer(QWidget *parent, const TuningDictionary &dictionary,
 
 void Mixer::reset(const Score &score)
 {
+    if (boost::equal(myPlayers, score.getPlayers()))
+        return;
+
     clear();
+    myPlayers.assign(score.getPlayers().begin(), score.getPlayers().end());
 
     for (int i = 0; i < score.getPlayers().size(); ++i)
     {
@@ -47,8 +52,16 @@ void Mixer::reset(const Score &score)
     }
 }
 
+void Mixer::updatePlayer(int index, const Player &player)
+{
+    if (index >= 0 && index < static_cast<int>(myPlayers.size()))
+        myPlayers[index] = player;
+}
+
 void Mixer::clear()
 {
+    myPlayers.clear();
+
     while (QLayoutItem *item = myLayout->takeAt(0))
     {
         // We might be clearing the mixer in response to a signal from one of
@@ -19,6 +19,8 @@
 #define WIDGETS_MIXER_H
 
 #include <QWidget>
+#include <score/player.h>
+#include <vector>
 
 class PlayerEditPubSub;
 class PlayerRemovePubSub;
@@ -33,17 +35,25 @@ public:
           const PlayerEditPubSub &editPubSub,
           const PlayerRemovePubSub &removePubSub);
 
-    /// Clear and then populate the mixer.
+    /// Clear and then populate the mixer. Nothing is done if the players are
+    /// unchanged since the previous reset.
     void reset(const Score &score);
 
     /// Removes all items from the mixer.
     void clear();
 
+    /// Records a change that was made from the mixer's widgets without an
+    /// undo command, so that a later reset() compares against the player
+    /// that is actually displayed.
+    void updatePlayer(int index, const Player &player);
+
 private:
     QVBoxLayout *myLayout;
     const TuningDictionary &myDictionary;
     const PlayerEditPubSub &myEditPubSub;
     const PlayerRemovePubSub &myRemovePubSub;
+    /// The players that are currently displayed.
+    std::vector<Player> myPlayers;
 };
 
 #endif
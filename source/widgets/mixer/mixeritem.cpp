@@ -21,6 +21,7 @@
 #include <app/pubsub/playerpubsub.h>
 #include <boost/lexical_cast.hpp>
 #include <dialogs/tuningdialog.h>
+#include <score/generalmidi.h>
 #include <score/player.h>
 
 MixerItem::MixerItem(QWidget *parent, int playerIndex, const Player &player,
@@ -43,6 +44,14 @@ MixerItem::MixerItem(QWidget *parent, int playerIndex, const Player &player,
     ui->playerNameEdit->setText(ui->playerNameLabel->text());
     ui->playerVolume->setValue(player.getMaxVolume());
     ui->playerPan->setValue(player.getPan());
+
+    // The first option lets a port be chosen automatically.
+    ui->playerPort->addItem(tr("Auto"));
+    for (int i = 0; i < Midi::MAX_MIDI_PORTS; ++i)
+        ui->playerPort->addItem(tr("Port %1").arg(i + 1));
+    ui->playerPort->setCurrentIndex(
+        player.hasMidiPort() ? player.getMidiPort() + 1 : 0);
+
     ui->playerTuning->setText(QString::fromStdString(
         boost::lexical_cast<std::string>(player.getTuning())));
 
@@ -69,6 +78,11 @@ MixerItem::MixerItem(QWidget *parent, int playerIndex, const Player &player,
         onEdited(false);
     });
 
+    connect(ui->playerPort,
+            static_cast<void (QComboBox::*)(int)>(
+                &QComboBox::currentIndexChanged),
+            [=]() { onEdited(true); });
+
     connect(ui->playerTuning, &ClickableLabel::clicked, this,
             &MixerItem::editTuning);
 
@@ -117,6 +131,8 @@ void MixerItem::onEdited(bool undoable)
     player.setMaxVolume(ui->playerVolume->value());
     player.setPan(ui->playerPan->value());
     player.setTuning(myTuning);
+    if (ui->playerPort->currentIndex() > 0)
+        player.setMidiPort(ui->playerPort->currentIndex() - 1);
 
     myEditPubSub.publish(myPlayerIndex, player, undoable);
 }
@@ -113,7 +113,7 @@ void PlaybackWidget::onSettingChanged(const std::string &setting)
         updateMetronomeButton();
 }
 
-void PlaybackWidget::updateLocationLabel(const std::string &location)
+void PlaybackWidget::updateLocationLabel(const QString &location)
 {
-    ui->locationLabel->setText(QString::fromStdString(location));
+    ui->locationLabel->setText(location);
 }
@@ -45,7 +45,7 @@ public:
     void setPlaybackMode(bool isPlaying);
 
     /// Updates the text containing the caret's location.
-    void updateLocationLabel(const std::string &location);
+    void updateLocationLabel(const QString &location);
 
 signals:
     void playbackSpeedChanged(int speed);
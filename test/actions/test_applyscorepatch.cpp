@@ -0,0 +1,55 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <catch.hpp>
+
+#include <actions/applyscorepatch.h>
+#include <app/caret.h>
+#include <score/score.h>
+
+TEST_CASE("Actions/ApplyScorePatch", "")
+{
+    Score original, modified;
+    for (int i = 0; i < 3; ++i)
+    {
+        original.insertSystem(System());
+        modified.insertSystem(System());
+    }
+
+    modified.removeSystem(1);
+    modified.getSystems()[0].insertStaff(Staff(7));
+    modified.setLineSpacing(12);
+
+    Score score;
+    for (int i = 0; i < 3; ++i)
+        score.insertSystem(System());
+
+    Caret caret(score);
+    caret.moveToSystem(2, false);
+
+    ApplyScorePatch action(score, ScoreUtils::diff(original, modified), caret,
+                           "Apply Changes");
+
+    action.redo();
+    REQUIRE(score == modified);
+    REQUIRE(caret.getLocation().getSystemIndex() == 1);
+
+    action.undo();
+    REQUIRE(score == original);
+
+    action.redo();
+    REQUIRE(score == modified);
+}
@@ -0,0 +1,232 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <actions/bulkedit.h>
+#include <score/score.h>
+#include <score/scorelocation.h>
+
+/// Creates a score with a single player using standard tuning.
+static void createScore(Score &score, const std::vector<Note> &notes)
+{
+    Player player;
+    score.insertPlayer(player);
+    score.insertInstrument(Instrument());
+
+    System system;
+    PlayerChange change(0);
+    change.insertActivePlayer(0, ActivePlayer(0, 0));
+    system.insertPlayerChange(change);
+
+    Staff staff(6);
+    for (int i = 0; i < 4; ++i)
+    {
+        Position pos(i, Position::EighthNote);
+        for (const Note &note : notes)
+            pos.insertNote(note);
+        staff.getVoices()[0].insertPosition(pos);
+    }
+
+    system.insertStaff(staff);
+    score.insertSystem(system);
+    score.insertSystem(system);
+}
+
+static const Position &getPosition(const Score &score, int system, int index)
+{
+    return score.getSystems()[system].getStaves()[0].getVoices()[0]
+        .getPositions()[index];
+}
+
+TEST_CASE("Actions/BulkEdit/Transpose", "")
+{
+    Score score;
+    createScore(score, { Note(2, 3), Note(5, 1) });
+
+    BulkEdit action(score, BulkEdit::transpose(2), "Transpose");
+    REQUIRE(action.getChangeCount() == 8);
+    REQUIRE(action.getFirstSystem() == 0);
+    REQUIRE(action.getLastSystem() == 1);
+
+    action.redo();
+    const Position &pos = getPosition(score, 1, 3);
+    REQUIRE(pos.getNotes()[0] == Note(2, 5));
+    REQUIRE(pos.getNotes()[1] == Note(5, 3));
+
+    action.undo();
+    REQUIRE(pos.getNotes()[0] == Note(2, 3));
+    REQUIRE(pos.getNotes()[1] == Note(5, 1));
+}
+
+TEST_CASE("Actions/BulkEdit/TransposeOutOfRange", "")
+{
+    Score score;
+    createScore(score, { Note(1, 28), Note(5, 1) });
+
+    // The low note can't be lowered on any string, so it is left unchanged.
+    BulkEdit action(score, BulkEdit::transpose(-2), "Transpose");
+    action.redo();
+
+    const Position &pos = getPosition(score, 0, 0);
+    REQUIRE(pos.getNotes().size() == 2);
+    REQUIRE(pos.getNotes()[0] == Note(1, 26));
+    REQUIRE(pos.getNotes()[1] == Note(5, 1));
+
+    // The high note no longer fits on its string, so it moves to the top
+    // string.
+    BulkEdit action2(score, BulkEdit::transpose(6), "Transpose");
+    action2.redo();
+    REQUIRE(pos.getNotes()[0] == Note(0, 27));
+    REQUIRE(pos.getNotes()[1] == Note(5, 7));
+}
+
+TEST_CASE("Actions/BulkEdit/Retune", "")
+{
+    Score score;
+    createScore(score, { Note(2, 3), Note(5, 1) });
+
+    Tuning dropD;
+    dropD.setNote(5, dropD.getNote(5, false) - 2);
+
+    // Notes for other players are not modified.
+    BulkEdit ignored(score, BulkEdit::retune(1, dropD), "Retune");
+    REQUIRE(ignored.getChangeCount() == 0);
+
+    BulkEdit action(score, BulkEdit::retune(0, dropD), "Retune");
+    action.redo();
+
+    const Position &pos = getPosition(score, 0, 0);
+    REQUIRE(pos.getNotes()[0] == Note(2, 3));
+    REQUIRE(pos.getNotes()[1] == Note(5, 3));
+}
+
+TEST_CASE("Actions/BulkEdit/TrillsAndTappedHarmonics", "")
+{
+    Note trill(2, 3);
+    trill.setTrilledFret(5);
+    Note tappedHarmonic(4, 2);
+    tappedHarmonic.setTappedHarmonicFret(14);
+
+    Score score;
+    createScore(score, { trill, tappedHarmonic });
+
+    BulkEdit action(score, BulkEdit::transpose(2), "Transpose");
+    REQUIRE(action.getBlockedPositions().empty());
+    action.redo();
+
+    const Position &pos = getPosition(score, 0, 0);
+    REQUIRE(pos.getNotes()[0].getFretNumber() == 5);
+    REQUIRE(pos.getNotes()[0].getTrilledFret() == 7);
+    REQUIRE(pos.getNotes()[1].getFretNumber() == 4);
+    REQUIRE(pos.getNotes()[1].getTappedHarmonicFret() == 16);
+}
+
+TEST_CASE("Actions/BulkEdit/NaturalHarmonics", "")
+{
+    Note harmonic(2, 12);
+    harmonic.setProperty(Note::NaturalHarmonic);
+
+    Score score;
+    createScore(score, { harmonic, Note(5, 3) });
+
+    // A natural harmonic can't be transposed by changing its fret.
+    BulkEdit transpose(score, BulkEdit::transpose(2), "Transpose");
+    REQUIRE(transpose.getChangeCount() == 0);
+    REQUIRE(transpose.getBlockedPositions().size() == 8);
+    REQUIRE(transpose.getBlockedPositions()[5].mySystem == 1);
+    REQUIRE(transpose.getBlockedPositions()[5].myStaff == 0);
+    REQUIRE(transpose.getBlockedPositions()[5].myPosition == 1);
+
+    // The harmonic's string is not retuned, so the other notes can be
+    // refretted.
+    Tuning dropD;
+    dropD.setNote(5, dropD.getNote(5, false) - 2);
+
+    BulkEdit retune(score, BulkEdit::retune(0, dropD), "Retune");
+    REQUIRE(retune.getBlockedPositions().empty());
+    retune.redo();
+
+    const Position &pos = getPosition(score, 0, 0);
+    REQUIRE(pos.getNotes()[0].getFretNumber() == 12);
+    REQUIRE(pos.getNotes()[1] == Note(5, 5));
+}
+
+TEST_CASE("Actions/BulkEdit/ScaleDurations", "")
+{
+    Score score;
+    createScore(score, { Note(2, 3) });
+    score.getSystems()[0].getStaves()[0].getVoices()[0].getPositions()[0]
+        .setDurationType(Position::WholeNote);
+
+    BulkEdit action(score, BulkEdit::scaleDurations(2), "Double Durations");
+    action.redo();
+
+    // The whole note can't be lengthened.
+    REQUIRE(getPosition(score, 0, 0).getDurationType() == Position::WholeNote);
+    REQUIRE(getPosition(score, 0, 1).getDurationType() ==
+            Position::QuarterNote);
+
+    action.undo();
+    REQUIRE(getPosition(score, 0, 1).getDurationType() ==
+            Position::EighthNote);
+}
+
+TEST_CASE("Actions/BulkEdit/ClearProperties", "")
+{
+    Score score;
+    createScore(score, { Note(2, 3) });
+
+    Position &pos =
+        score.getSystems()[1].getStaves()[0].getVoices()[0].getPositions()[2];
+    pos.setProperty(Position::LetRing);
+    pos.getNotes()[0].setProperty(Note::Muted);
+
+    BulkEdit action(score,
+                    BulkEdit::clearProperties({ Position::LetRing },
+                                              { Note::Muted }),
+                    "Clear Properties");
+    REQUIRE(action.getChangeCount() == 1);
+    REQUIRE(action.getFirstSystem() == 1);
+
+    action.redo();
+    REQUIRE(!pos.hasProperty(Position::LetRing));
+    REQUIRE(!pos.getNotes()[0].hasProperty(Note::Muted));
+
+    action.undo();
+    REQUIRE(pos.hasProperty(Position::LetRing));
+    REQUIRE(pos.getNotes()[0].hasProperty(Note::Muted));
+}
+
+TEST_CASE("Actions/BulkEdit/Selection", "")
+{
+    Score score;
+    createScore(score, { Note(2, 3) });
+
+    ScoreLocation location(score, 1, 0, 2);
+    location.setSelectionStart(1);
+
+    BulkEdit action(location, BulkEdit::transpose(1), "Transpose");
+    REQUIRE(action.getChangeCount() == 2);
+
+    action.redo();
+    REQUIRE(getPosition(score, 0, 1).getNotes()[0] == Note(2, 3));
+    REQUIRE(getPosition(score, 1, 0).getNotes()[0] == Note(2, 3));
+    REQUIRE(getPosition(score, 1, 1).getNotes()[0] == Note(2, 4));
+    REQUIRE(getPosition(score, 1, 2).getNotes()[0] == Note(2, 4));
+    REQUIRE(getPosition(score, 1, 3).getNotes()[0] == Note(2, 3));
+}
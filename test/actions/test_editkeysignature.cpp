@@ -48,3 +48,26 @@ TEST_CASE("Actions/EditKeySignature", "")
         REQUIRE_FALSE(system.getBarlines()[2].getKeySignature() == newKey);
     }
 }
+
+TEST_CASE("Actions/EditKeySignature/AffectedSystems", "")
+{
+    Score score;
+    score.insertSystem(System());
+    score.insertSystem(System());
+    score.insertSystem(System());
+
+    // The third system starts with a different key, so it isn't modified.
+    const KeySignature otherKey(KeySignature::Major, 2, true);
+    score.getSystems()[2].getBarlines()[0].setKeySignature(otherKey);
+
+    const KeySignature newKey(KeySignature::Minor, 3, false);
+    ScoreLocation location(score, 0, 0, 0);
+    EditKeySignature action(location, newKey);
+
+    REQUIRE(action.getLastAffectedSystem() == 1);
+
+    action.redo();
+    REQUIRE(score.getSystems()[1].getBarlines()[0].getKeySignature() == newKey);
+    REQUIRE(score.getSystems()[2].getBarlines()[0].getKeySignature() ==
+            otherKey);
+}
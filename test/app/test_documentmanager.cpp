@@ -18,6 +18,7 @@
 #include <catch.hpp>
 
 #include <app/documentmanager.h>
+#include <score/score.h>
 
 TEST_CASE("App/DocumentManager", "")
 {
@@ -49,3 +50,19 @@ TEST_CASE("App/Document", "")
     REQUIRE(!document.hasFilename());
 }
 
+
+TEST_CASE("App/Document/Hibernate", "")
+{
+    DocumentManager manager;
+    Document &document = manager.addDefaultDocument();
+
+    Score expected;
+    ScoreUtils::copy(document.getScore(), expected);
+
+    document.hibernate();
+    REQUIRE(document.isHibernating());
+
+    // The score should be restored when it is accessed.
+    REQUIRE(document.getScore() == expected);
+    REQUIRE(!document.isHibernating());
+}
@@ -0,0 +1,86 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <app/playbackscorecache.h>
+#include <score/score.h>
+
+TEST_CASE("App/PlaybackScoreCache", "")
+{
+    Score score;
+    score.insertSystem(System());
+    score.insertSystem(System());
+    score.insertPlayer(Player());
+
+    PlaybackScoreCache cache;
+    std::shared_ptr<const Score> snapshot = cache.getSnapshot(score);
+    REQUIRE(*snapshot == score);
+    const Score *copy = snapshot.get();
+
+    SECTION("Modified systems are updated")
+    {
+        snapshot.reset();
+
+        score.getSystems()[1].insertBarline(Barline(5, Barline::SingleBar));
+        score.getPlayers()[0].setDescription("Test");
+        cache.markModified(1, 1);
+
+        snapshot = cache.getSnapshot(score);
+        REQUIRE(snapshot.get() == copy);
+        REQUIRE(*snapshot == score);
+    }
+
+    SECTION("Snapshots in use are not modified")
+    {
+        score.getSystems()[0].insertBarline(Barline(5, Barline::SingleBar));
+        cache.markModified(0, 0);
+
+        std::shared_ptr<const Score> newSnapshot = cache.getSnapshot(score);
+        REQUIRE(newSnapshot.get() != copy);
+        REQUIRE(*newSnapshot == score);
+        REQUIRE(snapshot->getSystems()[0].getBarlines().size() == 2);
+    }
+
+    SECTION("Snapshots are reused after every copy is released")
+    {
+        std::shared_ptr<const Score> otherCopy = snapshot;
+        snapshot.reset();
+
+        score.getSystems()[0].insertBarline(Barline(5, Barline::SingleBar));
+        cache.markModified(0, 0);
+
+        snapshot = cache.getSnapshot(score);
+        REQUIRE(snapshot.get() != copy);
+        REQUIRE(otherCopy->getSystems()[0].getBarlines().size() == 2);
+
+        otherCopy.reset();
+        snapshot.reset();
+        REQUIRE(cache.getSnapshot(score).get() == copy);
+    }
+
+    SECTION("Full copy when the number of systems changes")
+    {
+        snapshot.reset();
+
+        score.insertSystem(System());
+        cache.markModified(2, 2);
+
+        snapshot = cache.getSnapshot(score);
+        REQUIRE(*snapshot == score);
+    }
+}
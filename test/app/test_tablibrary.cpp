@@ -0,0 +1,62 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <catch.hpp>
+
+#include <app/tablibrary.h>
+#include <QCoreApplication>
+#include <QDir>
+#include <QTemporaryDir>
+
+TEST_CASE("App/TabLibrary", "")
+{
+    QTemporaryDir tempDir;
+    REQUIRE(tempDir.isValid());
+
+    const QString indexPath = tempDir.path() + "/library.idx";
+    const QString dataDir = QCoreApplication::applicationDirPath() + "/data";
+
+    TabLibrary library(indexPath);
+    REQUIRE(!library.load());
+    REQUIRE(library.scan(dataDir) > 0);
+
+    const QString guitars = QDir(dataDir).absoluteFilePath("guitars.ptb");
+    auto it = library.getEntries().find(guitars);
+    REQUIRE(it != library.getEntries().end());
+
+    const TabLibrary::Entry &entry = it->second;
+    REQUIRE(entry.myIsValid);
+    REQUIRE(entry.myTitle == "Some Title");
+    // Only the guitar score's players are included in the metadata.
+    REQUIRE(entry.myPlayerCount == 2);
+    REQUIRE(entry.myTunings.size() == 2);
+    REQUIRE(entry.myTunings[1].getStringCount() == 7);
+
+    // Unchanged files should not be read again.
+    REQUIRE(library.scan(dataDir) == 0);
+
+    REQUIRE_NOTHROW(library.save());
+
+    TabLibrary reloaded(indexPath);
+    REQUIRE(reloaded.load());
+    REQUIRE(reloaded.getEntries().size() == library.getEntries().size());
+    REQUIRE(reloaded.getEntries().at(guitars).myTunings[1].getNotes() ==
+            entry.myTunings[1].getNotes());
+    REQUIRE(reloaded.scan(dataDir) == 0);
+
+    REQUIRE(!reloaded.find("some title").empty());
+    REQUIRE(reloaded.find("No Such Song").empty());
+}
@@ -0,0 +1,49 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <audio/audiorenderer.h>
+#include <sstream>
+#include <string>
+
+TEST_CASE("Audio/AudioRenderer/WavHeader", "")
+{
+    const std::vector<float> samples = { 0.0f, 1.0f, -1.0f, 2.0f };
+
+    std::ostringstream output;
+    AudioRenderer::writeWav(output, samples);
+    const std::string data = output.str();
+
+    REQUIRE(data.size() == 44 + 8);
+    REQUIRE(data.substr(0, 4) == "RIFF");
+    REQUIRE(data.substr(8, 8) == "WAVEfmt ");
+    REQUIRE(data.substr(36, 4) == "data");
+
+    // The file length, number of channels and data size.
+    REQUIRE(static_cast<unsigned char>(data[4]) == 44);
+    REQUIRE(data[22] == 2);
+    REQUIRE(static_cast<unsigned char>(data[40]) == 8);
+
+    // Samples are clamped to the 16-bit range.
+    REQUIRE(static_cast<unsigned char>(data[46]) == 0xff);
+    REQUIRE(static_cast<unsigned char>(data[47]) == 0x7f);
+    REQUIRE(static_cast<unsigned char>(data[48]) == 0x01);
+    REQUIRE(static_cast<unsigned char>(data[49]) == 0x80);
+    REQUIRE(static_cast<unsigned char>(data[50]) == 0xff);
+    REQUIRE(static_cast<unsigned char>(data[51]) == 0x7f);
+}
@@ -0,0 +1,193 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <audio/barindex.h>
+#include <score/score.h>
+
+static void addQuarterNotes(Voice &voice, int start)
+{
+    for (int i = start; i < start + 4; ++i)
+        voice.insertPosition(Position(i, Position::QuarterNote));
+}
+
+/// Checks that the index matches a new index of the whole score.
+static void requireFullIndex(const BarIndex &index, const Score &score)
+{
+    BarIndex fullIndex(score);
+    REQUIRE(index.getBarCount() == fullIndex.getBarCount());
+    REQUIRE(index.getDuration() == fullIndex.getDuration());
+
+    for (int i = 0; i < fullIndex.getBarCount(); ++i)
+    {
+        REQUIRE(index.getBarLocation(i) == fullIndex.getBarLocation(i));
+        REQUIRE(index.getBarEndPosition(i) == fullIndex.getBarEndPosition(i));
+        REQUIRE(index.getStartTime(i) == fullIndex.getStartTime(i));
+    }
+
+    for (double time = 0; time < fullIndex.getDuration(); time += 500)
+        REQUIRE(index.findBarAtTime(time) == fullIndex.findBarAtTime(time));
+}
+
+TEST_CASE("Audio/BarIndex/Locations", "")
+{
+    Score score;
+    System system;
+    system.insertBarline(Barline(10, Barline::SingleBar));
+    score.insertSystem(system);
+    score.insertSystem(system);
+
+    BarIndex index(score);
+
+    REQUIRE(index.getBarCount() == 4);
+    REQUIRE(index.getBarLocation(0) == SystemLocation(0, 0));
+    REQUIRE(index.getBarLocation(1) == SystemLocation(0, 10));
+    REQUIRE(index.getBarLocation(2) == SystemLocation(1, 0));
+    REQUIRE(index.getBarLocation(3) == SystemLocation(1, 10));
+
+    REQUIRE(index.findBar(SystemLocation(0, 0)) == 0);
+    REQUIRE(index.findBar(SystemLocation(0, 9)) == 0);
+    REQUIRE(index.findBar(SystemLocation(0, 10)) == 1);
+    REQUIRE(index.findBar(SystemLocation(0, 29)) == 1);
+    REQUIRE(index.findBar(SystemLocation(1, 5)) == 2);
+    REQUIRE(index.findBar(SystemLocation(1, 15)) == 3);
+}
+
+TEST_CASE("Audio/BarIndex/Times", "")
+{
+    Score score;
+    System system;
+    system.getBarlines()[0].setBarType(Barline::RepeatStart);
+    system.insertBarline(Barline(10, Barline::RepeatEnd, 2));
+
+    Staff staff(6);
+    addQuarterNotes(staff.getVoices()[0], 1);
+    addQuarterNotes(staff.getVoices()[0], 11);
+    system.insertStaff(staff);
+    score.insertSystem(system);
+
+    BarIndex index(score);
+
+    // At the default tempo, each bar of 4/4 lasts for two seconds, and the
+    // first bar is repeated.
+    REQUIRE(index.getStartTime(0) == 0);
+    REQUIRE(index.getStartTime(1) == 4000);
+    REQUIRE(index.getDuration() == 6000);
+
+    REQUIRE(index.findBarAtTime(0) == 0);
+    REQUIRE(index.findBarAtTime(2500) == 0);
+    REQUIRE(index.findBarAtTime(4000) == 1);
+    REQUIRE(index.findBarAtTime(5999) == 1);
+}
+
+TEST_CASE("Audio/BarIndex/UpdateSystems", "")
+{
+    Score score;
+    System system;
+    system.insertBarline(Barline(10, Barline::SingleBar));
+    Staff staff(6);
+    addQuarterNotes(staff.getVoices()[0], 1);
+    system.insertStaff(staff);
+    score.insertSystem(system);
+    score.insertSystem(system);
+
+    BarIndex index(score);
+    REQUIRE(index.getBarCount() == 4);
+    REQUIRE(index.getStartTime(3) == 4000);
+
+    // Add a bar and a tempo change to the first system, which affects the
+    // bar numbers and start times of the second system.
+    System &firstSystem = score.getSystems()[0];
+    firstSystem.insertBarline(Barline(20, Barline::SingleBar));
+    TempoMarker tempo(5);
+    tempo.setBeatsPerMinute(240);
+    firstSystem.insertTempoMarker(tempo);
+    addQuarterNotes(firstSystem.getStaves()[0].getVoices()[0], 11);
+
+    index.updateSystems(score, 0, 0);
+    REQUIRE(index.getBarCount() == 5);
+    REQUIRE(index.getBarLocation(2) == SystemLocation(0, 20));
+    REQUIRE(index.getBarEndPosition(1) == 20);
+    REQUIRE(index.getBarLocation(3) == SystemLocation(1, 0));
+    REQUIRE(index.getStartTime(1) == 1000);
+    REQUIRE(index.getStartTime(3) == 2000);
+    REQUIRE(index.getDuration() == 3000);
+
+    // The result should match indexing the whole score.
+    requireFullIndex(index, score);
+
+    // Removing a system requires the whole score to be indexed.
+    score.removeSystem(1);
+    index.updateSystems(score, 1, 1);
+    REQUIRE(index.getBarCount() == 3);
+}
+
+TEST_CASE("Audio/BarIndex/UpdateSystemsWithoutNewBars", "")
+{
+    Score score;
+    System system;
+    system.insertBarline(Barline(10, Barline::SingleBar));
+    Staff staff(6);
+    addQuarterNotes(staff.getVoices()[0], 1);
+    addQuarterNotes(staff.getVoices()[0], 11);
+    system.insertStaff(staff);
+    for (int i = 0; i < 3; ++i)
+        score.insertSystem(system);
+
+    BarIndex index(score);
+
+    SECTION("Notes")
+    {
+        // Lengthen a bar in the middle system.
+        Voice &voice = score.getSystems()[1].getStaves()[0].getVoices()[0];
+        for (Position &pos : voice.getPositions())
+        {
+            if (pos.getPosition() < 10)
+                pos.setDurationType(Position::HalfNote);
+        }
+
+        index.updateSystems(score, 1, 1);
+        REQUIRE(index.getStartTime(3) == 8000);
+        requireFullIndex(index, score);
+    }
+
+    SECTION("Tempo")
+    {
+        // A tempo change also affects the following systems.
+        TempoMarker tempo(11);
+        tempo.setBeatsPerMinute(60);
+        score.getSystems()[1].insertTempoMarker(tempo);
+
+        index.updateSystems(score, 1, 1);
+        REQUIRE(index.getStartTime(4) == 10000);
+        REQUIRE(index.getDuration() == 18000);
+        requireFullIndex(index, score);
+    }
+
+    SECTION("Repeats")
+    {
+        System &middleSystem = score.getSystems()[1];
+        middleSystem.getBarlines()[1].setBarType(Barline::RepeatStart);
+        middleSystem.getBarlines()[2].setBarType(Barline::RepeatEnd);
+        middleSystem.getBarlines()[2].setRepeatCount(3);
+
+        index.updateSystems(score, 1, 1);
+        REQUIRE(index.getDuration() == 16000);
+        requireFullIndex(index, score);
+    }
+}
@@ -0,0 +1,85 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <audio/channelallocator.h>
+#include <score/generalmidi.h>
+#include <score/score.h>
+
+TEST_CASE("Audio/ChannelAllocator/SkipPercussion", "")
+{
+    Score score;
+    for (int i = 0; i < 11; ++i)
+        score.insertPlayer(Player());
+
+    ChannelAllocator channels(score);
+
+    REQUIRE(channels.getPortCount() == 1);
+    REQUIRE(channels.getChannel(0) == 0);
+    REQUIRE(channels.getChannel(8) == 8);
+    REQUIRE(channels.getChannel(9) == 10);
+    REQUIRE(channels.getChannel(10) == 11);
+}
+
+TEST_CASE("Audio/ChannelAllocator/MultiplePorts", "")
+{
+    Score score;
+    for (int i = 0; i < 20; ++i)
+        score.insertPlayer(Player());
+
+    ChannelAllocator channels(score);
+
+    // The 16th player uses the first channel of the second port.
+    REQUIRE(channels.getPortCount() == 2);
+    REQUIRE(channels.getChannel(14) == 15);
+    REQUIRE(channels.getChannel(15) == 16);
+    REQUIRE(channels.getChannel(19) == 20);
+}
+
+TEST_CASE("Audio/ChannelAllocator/PinnedPorts", "")
+{
+    Score score;
+    Player pinned;
+    pinned.setMidiPort(2);
+
+    score.insertPlayer(Player());
+    score.insertPlayer(pinned);
+    score.insertPlayer(Player());
+
+    ChannelAllocator channels(score);
+
+    REQUIRE(channels.getPortCount() == 3);
+    REQUIRE(channels.getChannel(0) == 0);
+    REQUIRE(channels.getChannel(1) == 2 * Midi::NUM_MIDI_CHANNELS_PER_PORT);
+    REQUIRE(channels.getChannel(2) == 1);
+}
+
+TEST_CASE("Audio/ChannelAllocator/SharedChannels", "")
+{
+    const int numChannels = Midi::MAX_MIDI_PORTS * 15;
+
+    Score score;
+    for (int i = 0; i < numChannels + 2; ++i)
+        score.insertPlayer(Player());
+
+    ChannelAllocator channels(score);
+
+    REQUIRE(channels.getPortCount() == Midi::MAX_MIDI_PORTS);
+    REQUIRE(channels.getChannel(numChannels) == channels.getChannel(0));
+    REQUIRE(channels.getChannel(numChannels + 1) == channels.getChannel(1));
+}
@@ -28,7 +28,8 @@ public:
     {
     }
 
-    void performEvent(MidiOutputDevice &) const override
+    void performEvent(MidiOutputDevice &,
+                      const PlaybackSettings &) const override
     {
     }
 };
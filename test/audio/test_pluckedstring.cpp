@@ -0,0 +1,83 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <audio/pluckedstring.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+static const int SAMPLE_RATE = 44100;
+
+static float getPeak(const std::vector<float> &samples, int start, int end)
+{
+    float peak = 0;
+    for (int i = start; i < end; ++i)
+        peak = std::max(peak, std::abs(samples[i]));
+    return peak;
+}
+
+TEST_CASE("Audio/PluckedString/Decay", "")
+{
+    PluckedString string(SAMPLE_RATE, 110, 1.0, 1);
+    std::vector<float> samples(SAMPLE_RATE, 0.0f);
+    string.render(samples.data(), SAMPLE_RATE);
+
+    REQUIRE(getPeak(samples, 0, 4410) > 0.1f);
+    REQUIRE(getPeak(samples, 39690, 44100) < getPeak(samples, 0, 4410));
+    REQUIRE(!string.isFinished());
+
+    // Once released, the note should quickly become silent.
+    string.release();
+    std::fill(samples.begin(), samples.end(), 0.0f);
+    string.render(samples.data(), SAMPLE_RATE);
+
+    REQUIRE(string.isFinished());
+    REQUIRE(getPeak(samples, 22050, 44100) == 0.0f);
+}
+
+TEST_CASE("Audio/PluckedString/Pitch", "")
+{
+    PluckedString string(SAMPLE_RATE, 441, 1.0, 1);
+    std::vector<float> samples(SAMPLE_RATE / 4, 0.0f);
+    // Render in uneven blocks, which should not affect the output.
+    for (size_t i = 0; i < samples.size(); i += 1000)
+    {
+        string.render(samples.data() + i,
+                      std::min<int>(1000, samples.size() - i));
+    }
+
+    // The period should be 100 samples, so find the lag with the strongest
+    // autocorrelation.
+    int bestLag = 0;
+    double bestCorrelation = 0;
+    for (int lag = 50; lag < 150; ++lag)
+    {
+        double correlation = 0;
+        for (int i = 4000; i < 8000; ++i)
+            correlation += samples[i] * samples[i + lag];
+
+        if (correlation > bestCorrelation)
+        {
+            bestCorrelation = correlation;
+            bestLag = lag;
+        }
+    }
+
+    REQUIRE(bestLag == 100);
+}
@@ -0,0 +1,78 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <audio/repeatcontroller.h>
+#include <score/score.h>
+
+static void makeScore(Score &score, int repeatCount)
+{
+    System system;
+    system.getBarlines()[0].setBarType(Barline::RepeatStart);
+    system.insertBarline(Barline(10, Barline::RepeatEnd, repeatCount));
+    score.insertSystem(system);
+}
+
+TEST_CASE("Audio/RepeatController/Repeats", "")
+{
+    Score score;
+    makeScore(score, 3);
+    RepeatController controller(score);
+    SystemLocation newLocation;
+
+    const SystemLocation prev(0, 5);
+    const SystemLocation end(0, 10);
+    REQUIRE(controller.checkForRepeat(prev, end, newLocation));
+    REQUIRE(newLocation == SystemLocation(0, 0));
+    REQUIRE(controller.checkForRepeat(prev, end, newLocation));
+    REQUIRE(!controller.checkForRepeat(prev, end, newLocation));
+}
+
+TEST_CASE("Audio/RepeatController/CopyState", "")
+{
+    Score score;
+    makeScore(score, 3);
+    RepeatController controller(score);
+    SystemLocation newLocation;
+
+    const SystemLocation prev(0, 5);
+    const SystemLocation end(0, 10);
+    REQUIRE(controller.checkForRepeat(prev, end, newLocation));
+
+    SECTION("Same repeat count")
+    {
+        Score newScore;
+        makeScore(newScore, 3);
+        RepeatController newController(newScore);
+        newController.copyState(controller);
+
+        // Only the remaining repeat should be performed.
+        REQUIRE(newController.checkForRepeat(prev, end, newLocation));
+        REQUIRE(!newController.checkForRepeat(prev, end, newLocation));
+    }
+
+    SECTION("Reduced repeat count")
+    {
+        Score newScore;
+        makeScore(newScore, 2);
+        RepeatController newController(newScore);
+        newController.copyState(controller);
+
+        REQUIRE(!newController.checkForRepeat(prev, end, newLocation));
+    }
+}
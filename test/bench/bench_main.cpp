@@ -0,0 +1,356 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../score/scoregenerator.h"
+
+#include <actions/addnote.h>
+#include <actions/addsystem.h>
+#include <actions/editnoteduration.h>
+#include <actions/removeposition.h>
+#include <algorithm>
+#include <audio/midievent.h>
+#include <audio/midiplayer.h>
+#include <boost/program_options.hpp>
+#include <formats/fileformatmanager.h>
+#include <formats/powertab/powertabexporter.h>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <painters/layoutinfo.h>
+#include <painters/systemrenderer.h>
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGraphicsItem>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <score/score.h>
+#include <score/scorelocation.h>
+#include <score/utils/scorediff.h>
+
+/// Runs each benchmark for a fixed number of iterations, and records the
+/// timings in a JSON document.
+class BenchmarkRunner
+{
+public:
+    explicit BenchmarkRunner(int iterations) : myIterations(iterations)
+    {
+    }
+
+    void run(const QString &name, const std::function<void()> &fn)
+    {
+        std::cerr << name.toStdString() << " ... " << std::flush;
+
+        std::vector<double> times;
+        for (int i = 0; i < myIterations; ++i)
+        {
+            QElapsedTimer timer;
+            timer.start();
+            fn();
+            times.push_back(timer.nsecsElapsed() / 1.0e6);
+        }
+
+        double total = 0;
+        for (double time : times)
+            total += time;
+
+        QJsonObject result;
+        result["name"] = name;
+        result["iterations"] = myIterations;
+        result["mean_ms"] = total / myIterations;
+        result["min_ms"] = *std::min_element(times.begin(), times.end());
+        result["max_ms"] = *std::max_element(times.begin(), times.end());
+        myResults.append(result);
+
+        std::cerr << total / myIterations << " ms" << std::endl;
+    }
+
+    const QJsonArray &getResults() const
+    {
+        return myResults;
+    }
+
+private:
+    const int myIterations;
+    QJsonArray myResults;
+};
+
+/// Times loading and saving in the native format, along with every importer
+/// for the files in the data directory.
+static void benchmarkFormats(BenchmarkRunner &runner, const Score &score,
+                             const QString &dataDir)
+{
+    FileFormatManager manager;
+    QTemporaryDir tempDir;
+    const std::string filename =
+        QDir(tempDir.path()).filePath("bench.pt2").toStdString();
+
+    runner.run("native/save", [&]() {
+        PowerTabExporter exporter;
+        exporter.save(filename, score);
+    });
+
+    const FileFormat nativeFormat = *manager.findFormat("pt2");
+    runner.run("native/load", [&]() {
+        Score loadedScore;
+        manager.importFile(loadedScore, filename, nativeFormat);
+    });
+
+    QDir dir(dataDir);
+    for (const QFileInfo &file : dir.entryInfoList(QDir::Files, QDir::Name))
+    {
+        boost::optional<FileFormat> format =
+            manager.findFormat(file.suffix().toStdString());
+        if (!format)
+            continue;
+
+        const std::string path = file.filePath().toStdString();
+        runner.run("import/" + file.fileName(), [&]() {
+            Score importedScore;
+            manager.importFile(importedScore, path, *format);
+        });
+    }
+}
+
+static void benchmarkRendering(BenchmarkRunner &runner, const Score &score)
+{
+    runner.run("layout", [&]() {
+        int systemIndex = 0;
+        for (const System &system : score.getSystems())
+        {
+            int staffIndex = 0;
+            for (const Staff &staff : system.getStaves())
+            {
+                LayoutInfo layout(score, system, systemIndex, staff,
+                                  staffIndex++);
+            }
+
+            ++systemIndex;
+        }
+    });
+
+    runner.run("render", [&]() {
+        SystemRenderer renderer(nullptr, score);
+        int systemIndex = 0;
+        for (const System &system : score.getSystems())
+            delete renderer(system, systemIndex++, Staff::GuitarView);
+    });
+}
+
+static void benchmarkPlayback(BenchmarkRunner &runner,
+                              const std::shared_ptr<const Score> &score)
+{
+    runner.run("midi/events", [&]() {
+        MidiPlayer player(score, 0, 0, 100);
+        MidiPlayer::EventList events;
+        MidiPlayer::ScheduledEventList performance;
+        player.generatePerformance(events, performance);
+    });
+}
+
+/// Applies and reverts some common edits in every system. The score is left
+/// unchanged afterwards.
+static void benchmarkActions(BenchmarkRunner &runner, Score &score)
+{
+    const int numSystems = score.getSystems().size();
+
+    runner.run("actions/add_note", [&]() {
+        for (int i = 0; i < numSystems; ++i)
+        {
+            // The generator never uses the top string in the first voice.
+            ScoreLocation location(score, i, 0, 0, 0, 5);
+            AddNote action(location, Note(5, 3), Position::EighthNote);
+            action.redo();
+            action.undo();
+        }
+    });
+
+    runner.run("actions/remove_position", [&]() {
+        for (int i = 0; i < numSystems; ++i)
+        {
+            RemovePosition action(ScoreLocation(score, i, 0, 0));
+            action.redo();
+            action.undo();
+        }
+    });
+
+    runner.run("actions/edit_note_duration", [&]() {
+        for (int i = 0; i < numSystems; ++i)
+        {
+            const System &system = score.getSystems()[i];
+            ScoreLocation location(score, i, 0,
+                                   system.getBarlines().back().getPosition());
+            location.setSelectionStart(0);
+
+            EditNoteDuration action(location, Position::SixteenthNote, false);
+            action.redo();
+            action.undo();
+        }
+    });
+
+    runner.run("actions/add_system", [&]() {
+        AddSystem action(score, 0);
+        action.redo();
+        action.undo();
+    });
+}
+
+/// Compares the score with copies that have edits scattered through it.
+static void benchmarkDiff(BenchmarkRunner &runner, const Score &score)
+{
+    const int numSystems = score.getSystems().size();
+
+    // Edit every tenth system in one copy, and the systems in between in the
+    // other copy.
+    Score ours, theirs;
+    ScoreUtils::copy(score, ours);
+    ScoreUtils::copy(score, theirs);
+    for (int i = 0; i < numSystems; i += 10)
+    {
+        RemovePosition(ScoreLocation(ours, i, 0, 0)).redo();
+        if (i + 5 < numSystems)
+            RemovePosition(ScoreLocation(theirs, i + 5, 0, 0)).redo();
+    }
+
+    ours.removeSystem(numSystems / 2);
+
+    runner.run("diff", [&]() { ScoreUtils::diff(score, ours); });
+    runner.run("merge", [&]() { ScoreUtils::merge(score, ours, theirs); });
+}
+
+int main(int argc, char *argv[])
+{
+    // The renderer needs a QApplication, but nothing is displayed.
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    ScoreGenerator::Options options;
+    int iterations = 5;
+    std::string dataDir =
+        (QCoreApplication::applicationDirPath() + "/data").toStdString();
+    std::string outputFile;
+    std::string label;
+
+    namespace po = boost::program_options;
+    po::options_description desc("Usage: pte_bench [options]\nTimes loading, "
+                                 "layout, rendering, playback, editing and "
+                                 "diffing of a generated score.\n\nOptions");
+    desc.add_options()
+        ("help,h", "Displays this help.")
+        ("systems", po::value<int>(&options.mySystemCount),
+         "The number of systems in the generated score.")
+        ("staves", po::value<int>(&options.myStaffCount),
+         "The number of staves in each system.")
+        ("voices", po::value<int>(&options.myVoiceCount),
+         "The number of voices (1 or 2) in each staff.")
+        ("seed", po::value<unsigned int>(&options.mySeed),
+         "The seed for generating the score.")
+        ("iterations", po::value<int>(&iterations),
+         "The number of times to run each benchmark.")
+        ("data", po::value<std::string>(&dataDir),
+         "A directory of files to benchmark each importer with.")
+        ("label", po::value<std::string>(&label),
+         "A label to identify the results (e.g. the commit).")
+        ("output", po::value<std::string>(&outputFile),
+         "Writes the results to the given JSON file instead of stdout.");
+
+    try
+    {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+    }
+    catch (po::error &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    BenchmarkRunner runner(iterations);
+    auto score = std::make_shared<Score>();
+
+    try
+    {
+        ScoreGenerator generator(options);
+        generator.generate(*score);
+
+        benchmarkFormats(runner, *score, QString::fromStdString(dataDir));
+        benchmarkRendering(runner, *score);
+        benchmarkPlayback(runner, score);
+        benchmarkActions(runner, *score);
+        benchmarkDiff(runner, *score);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int numPositions = 0;
+    int numNotes = 0;
+    for (const System &system : score->getSystems())
+    {
+        for (const Staff &staff : system.getStaves())
+        {
+            for (const Voice &voice : staff.getVoices())
+            {
+                numPositions += voice.getPositions().size();
+                for (const Position &pos : voice.getPositions())
+                    numNotes += pos.getNotes().size();
+            }
+        }
+    }
+
+    QJsonObject scoreInfo;
+    scoreInfo["seed"] = static_cast<int>(options.mySeed);
+    scoreInfo["systems"] = options.mySystemCount;
+    scoreInfo["staves"] = options.myStaffCount;
+    scoreInfo["voices"] = options.myVoiceCount;
+    scoreInfo["positions"] = numPositions;
+    scoreInfo["notes"] = numNotes;
+
+    QJsonObject root;
+    root["label"] = QString::fromStdString(label);
+    root["score"] = scoreInfo;
+    root["benchmarks"] = runner.getResults();
+    const QByteArray json = QJsonDocument(root).toJson();
+
+    if (outputFile.empty())
+        std::cout << json.constData();
+    else
+    {
+        QFile file(QString::fromStdString(outputFile));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size())
+        {
+            std::cerr << "Error: Could not write " << outputFile << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -49,6 +49,30 @@ TEST_CASE_METHOD(Gp4Fixture, "Formats/GuitarPro4Import/HeaderConversion")
     REQUIRE(song.getPerformanceNotes()  == "Some Comments");
 }
 
+TEST_CASE("Formats/GuitarPro4Import/Metadata",
+          "Only the header and tracks should be read.")
+{
+    const QString test_file =
+        QCoreApplication::applicationDirPath() + "/data/test1.gp4";
+
+    GuitarProImporter importer;
+    Score score;
+    importer.readMetadata(test_file.toStdString(), score);
+
+    const SongData &song = score.getScoreInfo().getSongData();
+    REQUIRE(song.getTitle() == "FileName");
+    REQUIRE(song.getArtist() == "Artist");
+
+    REQUIRE(score.getPlayers().size() == 2);
+    const Tuning &tuning = score.getPlayers()[0].getTuning();
+    REQUIRE(tuning.getStringCount() == 7);
+    REQUIRE(tuning.getCapo() == 1);
+
+    // The measures' contents are not imported.
+    REQUIRE(score.getSystems().size() == 1);
+    REQUIRE(score.getSystems()[0].getStaves().empty());
+}
+
 TEST_CASE_METHOD(Gp4Fixture, "Formats/GuitarPro4Import/TrackImport",
                  "The players/instruments should be imported correctly.")
 {
@@ -0,0 +1,73 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <formats/powertab/powertabexporter.h>
+#include <formats/powertab/powertabimporter.h>
+#include <QTemporaryDir>
+#include <score/score.h>
+
+TEST_CASE("Formats/PowerTab/Metadata", "")
+{
+    QTemporaryDir tempDir;
+    REQUIRE(tempDir.isValid());
+    const std::string path = (tempDir.path() + "/test.pt2").toStdString();
+
+    // Use characters that could be mistaken for the end of the score
+    // information.
+    Score score;
+    ScoreInfo info;
+    SongData song;
+    song.setTitle("A \"quoted\" {title} [1]");
+    song.setArtist("Back\\slash }");
+    info.setSongData(song);
+    score.setScoreInfo(info);
+
+    // The systems are skipped without being parsed, so brackets inside their
+    // strings must not end them early.
+    System system;
+    system.insertStaff(Staff(6));
+    system.getBarlines()[0].setRehearsalSign(
+        RehearsalSign("A", "Intro ]] \"}}"));
+    score.insertSystem(system);
+    Player player;
+    player.setDescription("Player ]} 1");
+    score.insertPlayer(player);
+    score.insertInstrument(Instrument());
+
+    PowerTabExporter exporter;
+    exporter.save(path, score);
+
+    PowerTabImporter importer;
+    Score metadata;
+    importer.readMetadata(path, metadata);
+
+    REQUIRE(metadata.getScoreInfo().getSongData().getTitle() ==
+            song.getTitle());
+    REQUIRE(metadata.getScoreInfo().getSongData().getArtist() ==
+            song.getArtist());
+
+    // The players are read, but the systems are skipped.
+    REQUIRE(metadata.getSystems().empty());
+    REQUIRE(metadata.getPlayers().size() == 1);
+    REQUIRE(metadata.getPlayers()[0].getDescription() ==
+            player.getDescription());
+    REQUIRE(metadata.getPlayers()[0].getTuning().getStringCount() ==
+            player.getTuning().getStringCount());
+    REQUIRE(metadata.getInstruments().size() == 1);
+}
@@ -17,10 +17,14 @@
 
 #include <catch.hpp>
 
+#include <chrono>
 #include <formats/powertab_old/powertaboldimporter.h>
 #include <formats/powertab_old/powertabdocument/powertabdocument.h>
+#include <iostream>
 #include <QCoreApplication>
+#include <QDir>
 #include <score/score.h>
+#include <score/utils/scoremerger.h>
 
 static void loadTest(PowerTabOldImporter &importer, const char *filename,
                      Score &score)
@@ -76,6 +80,23 @@ TEST_CASE("Formats/PowerTabOldImport/Guitars", "")
     REQUIRE(score.getInstruments()[0].getDescription() == "Electric Guitar (clean)");
 }
 
+TEST_CASE("Formats/PowerTabOldImport/Metadata", "")
+{
+    Score score;
+    PowerTabOldImporter importer;
+    const QString path =
+        QCoreApplication::applicationDirPath() + "/data/guitars.ptb";
+    importer.readMetadata(path.toStdString(), score);
+
+    REQUIRE(score.getScoreInfo().getSongData().getTitle() == "Some Title");
+    REQUIRE(score.getSystems().empty());
+
+    // Only the guitar score's players are read.
+    REQUIRE(score.getPlayers().size() == 2);
+    REQUIRE(score.getPlayers()[0].getDescription() == "First Player");
+    REQUIRE(score.getPlayers()[1].getTuning().getStringCount() == 7);
+}
+
 TEST_CASE("Formats/PowerTabOldImport/Barlines", "")
 {
     Score score;
@@ -355,3 +376,44 @@ TEST_CASE("Formats/PowerTabOldImport/Bends", "")
     REQUIRE(bend2.getStartPoint() == Bend::MidPoint);
     REQUIRE(bend2.getEndPoint() == Bend::MidPoint);
 }
+
+/// Reports the time spent parsing and converting each file, separately from
+/// the time spent merging the guitar and bass scores. This is hidden by
+/// default, and can be run with "pte_tests [benchmark]".
+TEST_CASE("Formats/PowerTabOldImport/MergeBenchmark", "[.][benchmark]")
+{
+    const int iterations = 100;
+    QDir dir(QCoreApplication::applicationDirPath() + "/data");
+
+    for (const QString &file : dir.entryList(QStringList("*.ptb"), QDir::Files))
+    {
+        typedef std::chrono::steady_clock Clock;
+        typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+        PowerTabOldImporter importer;
+        Milliseconds loadTime(0);
+        Milliseconds mergeTime(0);
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            Score score;
+            Score guitarScore;
+            Score bassScore;
+
+            // Measure the wall-clock time, rather than the processor time.
+            Clock::time_point start = Clock::now();
+            importer.loadUnmerged(dir.filePath(file).toStdString(), score,
+                                  guitarScore, bassScore);
+            Clock::time_point loaded = Clock::now();
+            loadTime += loaded - start;
+
+            ScoreMerger merger(score, guitarScore, bassScore);
+            merger.merge();
+            mergeTime += Clock::now() - loaded;
+        }
+
+        std::cout << file.toStdString() << ": load "
+                  << loadTime.count() / iterations << " ms, merge "
+                  << mergeTime.count() / iterations << " ms" << std::endl;
+    }
+}
@@ -0,0 +1,349 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scoregenerator.h"
+
+#include <algorithm>
+#include <score/score.h>
+#include <score/utils.h>
+#include <string>
+
+static const int BEATS_PER_BAR = 4;
+static const int MAX_FRET = 15;
+
+ScoreGenerator::Options::Options()
+    : mySeed(1),
+      mySystemCount(100),
+      myStaffCount(2),
+      myVoiceCount(2),
+      myBarsPerSystem(4),
+      myStringCount(6),
+      myHasVariedLayout(false),
+      myNoteDensity(0.9),
+      myChordDensity(0.25),
+      myTupletDensity(0.1),
+      myBendDensity(0.05),
+      myMultiBarRestDensity(0),
+      mySymbolDensity(0),
+      myPlayerChangeDensity(0),
+      myHasRepeats(true),
+      myHasRandomRepeats(false),
+      myHasPlayerChanges(true)
+{
+}
+
+ScoreGenerator::ScoreGenerator(const Options &options)
+    : myOptions(options), myEngine(options.mySeed), myIsInRepeat(false)
+{
+}
+
+void ScoreGenerator::generate(Score &score)
+{
+    myEngine.seed(myOptions.mySeed);
+    myIsInRepeat = false;
+
+    for (int i = 0; i < myOptions.myStaffCount; ++i)
+    {
+        Player player;
+        player.setDescription("Player " + std::to_string(i + 1));
+        score.insertPlayer(player);
+
+        Instrument instrument;
+        instrument.setDescription("Instrument " + std::to_string(i + 1));
+        score.insertInstrument(instrument);
+    }
+
+    for (int i = 0; i < myOptions.mySystemCount; ++i)
+    {
+        System system;
+        generateSystem(system, i);
+        score.insertSystem(system);
+    }
+
+    // Close a repeat that was left open.
+    if (myIsInRepeat)
+    {
+        Barline &endBar = score.getSystems().back().getBarlines().back();
+        endBar.setBarType(Barline::RepeatEnd);
+        endBar.setRepeatCount(2);
+    }
+}
+
+void ScoreGenerator::generateSystem(System &system, int systemIndex)
+{
+    int numBars = myOptions.myBarsPerSystem;
+    int numStaves = myOptions.myStaffCount;
+    if (myOptions.myHasVariedLayout)
+    {
+        numBars = 1 + random(numBars);
+        numStaves = 1 + random(numStaves);
+    }
+
+    // Choose the beats that are split into triplets. The staves use the same
+    // rhythm so that the barlines line up.
+    std::vector<BeatList> bars;
+    int start = 0;
+    for (int i = 0; i < numBars; ++i)
+    {
+        // With a varied layout, the barlines don't share a position with any
+        // notes.
+        if (i > 0 && myOptions.myHasVariedLayout)
+            ++start;
+
+        BeatList beats(1, start);
+        for (int j = 0; j < BEATS_PER_BAR; ++j)
+        {
+            const int length = chance(myOptions.myTupletDensity) ? 3 : 2;
+            beats.push_back(beats.back() + length);
+        }
+
+        start = beats.back();
+        bars.push_back(beats);
+    }
+
+    std::vector<bool> restBars;
+    for (int i = 0; i < numBars; ++i)
+        restBars.push_back(chance(myOptions.myMultiBarRestDensity));
+
+    for (int i = 0; i < numStaves; ++i)
+    {
+        Staff staff(myOptions.myStringCount);
+        generateStaff(staff, i, bars, restBars);
+        system.insertStaff(staff);
+    }
+
+    for (int i = 1; i < numBars; ++i)
+    {
+        system.insertBarline(
+            Barline(bars[i - 1].back(), Barline::SingleBar));
+    }
+
+    Barline &startBar = system.getBarlines().front();
+    Barline &endBar = system.getBarlines().back();
+    endBar.setPosition(bars.back().back());
+
+    if (systemIndex == 0)
+    {
+        TimeSignature time = startBar.getTimeSignature();
+        time.setVisible();
+        startBar.setTimeSignature(time);
+
+        system.insertTempoMarker(TempoMarker(0));
+    }
+
+    if (myOptions.myHasRepeats && systemIndex % 4 == 0)
+    {
+        startBar.setBarType(Barline::RepeatStart);
+        endBar.setBarType(Barline::RepeatEnd);
+        endBar.setRepeatCount(2);
+    }
+
+    if (systemIndex == 0 ||
+        (myOptions.myHasPlayerChanges && systemIndex % 8 == 0))
+    {
+        const int shift = myOptions.myHasPlayerChanges ? systemIndex / 8 : 0;
+
+        PlayerChange change(0);
+        for (int i = 0; i < numStaves; ++i)
+        {
+            const int player = (i + shift) % myOptions.myStaffCount;
+            change.insertActivePlayer(i, ActivePlayer(player, player));
+        }
+
+        system.insertPlayerChange(change);
+    }
+
+    for (int i = 0; i < numBars; ++i)
+    {
+        if (myOptions.myHasRandomRepeats)
+        {
+            Barline &leftBar = system.getBarlines()[i];
+            Barline &rightBar = system.getBarlines()[i + 1];
+
+            if (!myIsInRepeat && chance(1.0 / 7) &&
+                leftBar.getBarType() != Barline::RepeatEnd)
+            {
+                leftBar.setBarType(Barline::RepeatStart);
+                myIsInRepeat = true;
+            }
+            else if (myIsInRepeat && chance(0.25))
+            {
+                rightBar.setBarType(Barline::RepeatEnd);
+                rightBar.setRepeatCount(2 + random(2));
+                myIsInRepeat = false;
+            }
+            else if (i + 1 < numBars && chance(0.1))
+                rightBar.setBarType(Barline::DoubleBar);
+        }
+
+        if (restBars[i])
+            continue;
+
+        addSymbols(system, bars[i]);
+
+        const int position = system.getBarlines()[i].getPosition();
+        if (chance(myOptions.myPlayerChangeDensity) &&
+            !ScoreUtils::findByPosition(system.getPlayerChanges(), position))
+        {
+            PlayerChange change(position);
+            for (int j = 0; j < numStaves; ++j)
+            {
+                change.insertActivePlayer(
+                    j, ActivePlayer(random(myOptions.myStaffCount),
+                                    random(myOptions.myStaffCount)));
+            }
+
+            system.insertPlayerChange(change);
+        }
+    }
+}
+
+void ScoreGenerator::generateStaff(Staff &staff, int staffIndex,
+                                   const std::vector<BeatList> &bars,
+                                   const std::vector<bool> &restBars)
+{
+    // Fill the first voice with eighth notes or eighth note triplets.
+    Voice &voice = staff.getVoices()[0];
+    for (size_t i = 0; i < bars.size(); ++i)
+    {
+        const BeatList &beats = bars[i];
+
+        // A multi-bar rest is only written in the first staff, and the other
+        // staves are left empty.
+        if (restBars[i])
+        {
+            if (staffIndex == 0)
+            {
+                Position rest(beats.front(), Position::WholeNote);
+                rest.setRest();
+                rest.setMultiBarRest(2 + random(3));
+                voice.insertPosition(rest);
+            }
+
+            continue;
+        }
+
+        for (size_t j = 0; j + 1 < beats.size(); ++j)
+        {
+            const int length = beats[j + 1] - beats[j];
+            if (length == 3)
+            {
+                voice.insertIrregularGrouping(
+                    IrregularGrouping(beats[j], 3, 3, 2));
+            }
+
+            for (int position = beats[j]; position < beats[j + 1]; ++position)
+            {
+                Position pos(position, Position::EighthNote);
+                if (chance(myOptions.myNoteDensity))
+                    addNotes(pos);
+                else
+                    pos.setRest();
+
+                voice.insertPosition(pos);
+            }
+        }
+    }
+
+    // The second voice has quarter notes on the beat, on the lower strings.
+    if (myOptions.myVoiceCount > 1)
+    {
+        Voice &voice2 = staff.getVoices()[1];
+        for (size_t i = 0; i < bars.size(); ++i)
+        {
+            if (restBars[i])
+                continue;
+
+            const BeatList &beats = bars[i];
+            for (size_t j = 0; j + 1 < beats.size(); ++j)
+            {
+                if (!chance(myOptions.myNoteDensity))
+                    continue;
+
+                Position pos(beats[j], Position::QuarterNote);
+                pos.insertNote(
+                    Note(myOptions.myStringCount - 1 - random(2), random(5)));
+                voice2.insertPosition(pos);
+            }
+        }
+    }
+}
+
+void ScoreGenerator::addSymbols(System &system, const BeatList &beats)
+{
+    if (chance(myOptions.mySymbolDensity))
+    {
+        Staff &staff = system.getStaves()[random(
+            static_cast<int>(system.getStaves().size()))];
+        const int position = randomPosition(beats);
+
+        if (!ScoreUtils::findByPosition(staff.getDynamics(), position))
+            staff.insertDynamic(Dynamic(position, Dynamic::mf));
+    }
+
+    if (chance(myOptions.mySymbolDensity))
+    {
+        const int position = randomPosition(beats);
+        if (!ScoreUtils::findByPosition(system.getTempoMarkers(), position))
+            system.insertTempoMarker(TempoMarker(position));
+    }
+
+    if (chance(myOptions.mySymbolDensity))
+        system.insertChord(ChordText(randomPosition(beats), ChordName()));
+
+    if (chance(myOptions.mySymbolDensity))
+    {
+        AlternateEnding ending(randomPosition(beats));
+        ending.addNumber(1);
+        system.insertAlternateEnding(ending);
+    }
+}
+
+void ScoreGenerator::addNotes(Position &pos)
+{
+    const int string = random(myOptions.myStringCount - 2);
+
+    Note note(string, random(MAX_FRET + 1));
+    if (chance(myOptions.myBendDensity))
+        note.setBend(Bend(Bend::NormalBend, 4));
+    pos.insertNote(note);
+
+    if (chance(myOptions.myChordDensity))
+        pos.insertNote(Note(string + 1, random(MAX_FRET + 1)));
+}
+
+int ScoreGenerator::randomPosition(const BeatList &beats)
+{
+    return beats.front() + random(beats.back() - beats.front());
+}
+
+int ScoreGenerator::random(int n)
+{
+    // Avoid the standard distributions, whose output is implementation
+    // defined and would produce different scores on each platform.
+    return static_cast<int>(myEngine() % n);
+}
+
+bool ScoreGenerator::chance(double probability)
+{
+    // Disabled features don't use up any random numbers, so that they don't
+    // change the rest of the score.
+    if (probability <= 0)
+        return false;
+
+    return myEngine() < probability * myEngine.max();
+}
@@ -0,0 +1,112 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEST_SCORE_SCOREGENERATOR_H
+#define TEST_SCORE_SCOREGENERATOR_H
+
+#include <random>
+#include <vector>
+
+class Position;
+class Score;
+class Staff;
+class System;
+
+/// Generates scores of any size for the benchmarks and tests. The output only
+/// depends on the options (including the seed), so the same score is produced
+/// on every platform and for every run.
+class ScoreGenerator
+{
+public:
+    struct Options
+    {
+        Options();
+
+        unsigned int mySeed;
+        int mySystemCount;
+        int myStaffCount;
+        /// The number of voices (1 or 2) in each staff.
+        int myVoiceCount;
+        int myBarsPerSystem;
+        /// The number of strings in each staff (at least 3).
+        int myStringCount;
+        /// Whether each system has a random number of staves and bars, up to
+        /// myStaffCount and myBarsPerSystem.
+        bool myHasVariedLayout;
+
+        /// The probability that a position contains notes rather than a rest.
+        double myNoteDensity;
+        /// The probability that a position contains a second note.
+        double myChordDensity;
+        /// The probability that a beat is split into a triplet.
+        double myTupletDensity;
+        /// The probability that a note is bent.
+        double myBendDensity;
+        /// The probability that a bar is a multi-bar rest.
+        double myMultiBarRestDensity;
+        /// The probability that a bar has a dynamic, and separately a tempo
+        /// marker, a chord name or an alternate ending.
+        double mySymbolDensity;
+        /// The probability that a bar starts with a player change, which
+        /// assigns random players to the staves.
+        double myPlayerChangeDensity;
+
+        /// Whether every fourth system is enclosed by repeat bars.
+        bool myHasRepeats;
+        /// Whether repeats (which can span several systems) and double bars
+        /// are placed at random bars. This should not be combined with
+        /// myHasRepeats.
+        bool myHasRandomRepeats;
+        /// Whether the players are rotated between the staves every eighth
+        /// system.
+        bool myHasPlayerChanges;
+    };
+
+    explicit ScoreGenerator(const Options &options = Options());
+
+    /// Fills an empty score with random players, instruments and systems.
+    void generate(Score &score);
+
+private:
+    /// The start position of each beat in a bar, followed by the end of the
+    /// bar.
+    typedef std::vector<int> BeatList;
+
+    void generateSystem(System &system, int systemIndex);
+    void generateStaff(Staff &staff, int staffIndex,
+                       const std::vector<BeatList> &bars,
+                       const std::vector<bool> &restBars);
+    /// Adds dynamics, tempo markers, etc to the bar.
+    void addSymbols(System &system, const BeatList &beats);
+    /// Adds one or two random notes to the position.
+    void addNotes(Position &pos);
+
+    /// Returns a random position in the bar.
+    int randomPosition(const BeatList &beats);
+    /// Returns a random integer between 0 and n - 1.
+    int random(int n);
+    /// Returns true with the given probability.
+    bool chance(double probability);
+
+    const Options myOptions;
+    std::mt19937 myEngine;
+    /// Whether a repeat was started and not yet ended (if
+    /// myHasRandomRepeats is enabled).
+    bool myIsInRepeat;
+};
+
+#endif
@@ -0,0 +1,70 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <score/score.h>
+#include <score/utils/memoryusage.h>
+#include <sstream>
+
+TEST_CASE("Score/MemoryUsage/Count", "")
+{
+    Score score;
+    System system;
+    Staff staff(6);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        Position pos(i);
+        pos.insertNote(Note(0, i));
+        pos.insertNote(Note(1, i));
+        staff.getVoices()[0].insertPosition(pos);
+    }
+
+    system.insertStaff(staff);
+    score.insertSystem(system);
+    score.insertSystem(system);
+
+    const ScoreUtils::MemoryUsage usage = ScoreUtils::getMemoryUsage(score);
+    REQUIRE(usage.myEntries.at("systems").myCount == 2);
+    REQUIRE(usage.myEntries.at("staves").myCount == 2);
+    REQUIRE(usage.myEntries.at("positions").myCount == 10);
+    REQUIRE(usage.myEntries.at("notes").myCount == 20);
+    REQUIRE(usage.myEntries.at("notes").myBytes >= 20 * sizeof(Note));
+    REQUIRE(usage.getTotalBytes() > usage.getTotalSlackBytes());
+
+    std::ostringstream output;
+    ScoreUtils::printMemoryUsage(output, usage);
+    REQUIRE(output.str().find("positions") != std::string::npos);
+}
+
+TEST_CASE("Score/MemoryUsage/Compact", "")
+{
+    Score score;
+    for (int i = 0; i < 10; ++i)
+        score.insertSystem(System());
+
+    const ScoreUtils::MemoryUsage before = ScoreUtils::getMemoryUsage(score);
+
+    ScoreUtils::compact(score);
+    const ScoreUtils::MemoryUsage after = ScoreUtils::getMemoryUsage(score);
+
+    REQUIRE(after.getTotalSlackBytes() == 0);
+    REQUIRE(after.getTotalBytes() ==
+            before.getTotalBytes() - before.getTotalSlackBytes());
+    REQUIRE(after.myEntries.at("systems").myCount == 10);
+}
@@ -0,0 +1,107 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <catch.hpp>
+
+#include <score/score.h>
+#include <score/utils/phraseindex.h>
+
+static void addNotes(Voice &voice, int start, const std::vector<int> &frets,
+                     Position::DurationType duration = Position::QuarterNote)
+{
+    for (size_t i = 0; i < frets.size(); ++i)
+    {
+        Position pos(start + static_cast<int>(i), duration);
+        pos.insertNote(Note(0, frets[i]));
+        voice.insertPosition(pos);
+    }
+}
+
+/// The same phrase appears at the start of the first system, transposed up a
+/// tone across the two systems, and with a different rhythm in the second
+/// system.
+static void createScore(Score &score)
+{
+    System system1;
+    Staff staff1(6);
+    addNotes(staff1.getVoices()[0], 0, { 0, 2, 4, 5 });
+    Position rest(4, Position::QuarterNote);
+    rest.setRest();
+    staff1.getVoices()[0].insertPosition(rest);
+    addNotes(staff1.getVoices()[0], 5, { 2, 4 });
+    system1.insertStaff(staff1);
+    score.insertSystem(system1);
+
+    System system2;
+    Staff staff2(6);
+    addNotes(staff2.getVoices()[0], 0, { 6, 7 });
+    addNotes(staff2.getVoices()[0], 2, { 3, 5, 7, 8 }, Position::EighthNote);
+    system2.insertStaff(staff2);
+    score.insertSystem(system2);
+}
+
+TEST_CASE("Score/PhraseIndex/Find", "")
+{
+    Score score;
+    createScore(score);
+    PhraseIndex index(score);
+
+    auto phrase = PhraseIndex::getPhrase(score, 0, 0, 0, 0, 4);
+    REQUIRE(phrase.size() == 4);
+
+    auto matches = index.find(phrase, true);
+    REQUIRE(matches.size() == 2);
+    REQUIRE(matches[0] == PhraseIndex::Match(0, 0, 0, 0));
+    REQUIRE(matches[1] == PhraseIndex::Match(0, 0, 0, 5));
+
+    matches = index.find(phrase, false);
+    REQUIRE(matches.size() == 3);
+    REQUIRE(matches[2] == PhraseIndex::Match(1, 0, 0, 2));
+
+    // Short phrases are not indexed, but should still be found.
+    phrase = PhraseIndex::getPhrase(score, 0, 0, 0, 2, 3);
+    REQUIRE(phrase.size() == 2);
+    matches = index.find(phrase, true);
+    REQUIRE(matches.size() == 2);
+    REQUIRE(matches[0] == PhraseIndex::Match(0, 0, 0, 2));
+    REQUIRE(matches[1] == PhraseIndex::Match(1, 0, 0, 0));
+
+    // Rests must line up.
+    phrase = PhraseIndex::getPhrase(score, 0, 0, 0, 3, 5);
+    REQUIRE(phrase.size() == 3);
+    REQUIRE(phrase[1].isRest());
+    REQUIRE(index.find(phrase, true).size() == 1);
+}
+
+TEST_CASE("Score/PhraseIndex/Update", "")
+{
+    Score score;
+    createScore(score);
+    PhraseIndex index(score);
+
+    auto phrase = PhraseIndex::getPhrase(score, 0, 0, 0, 0, 3);
+
+    Voice &voice = score.getSystems()[1].getStaves()[0].getVoices()[0];
+    voice.getPositions()[0].getNotes()[0].setFretNumber(5);
+    index.updateSystems(score, 1, 1);
+
+    REQUIRE(index.find(phrase, false).size() == 2);
+
+    score.removeSystem(1);
+    index.updateSystems(score, 0, 0);
+
+    REQUIRE(index.find(phrase, false).size() == 1);
+}
@@ -19,6 +19,7 @@
 
 #include <score/generalmidi.h>
 #include <score/player.h>
+#include <sstream>
 #include "test_serialization.h"
 
 TEST_CASE("Score/Player/Serialization", "")
@@ -37,6 +38,41 @@ TEST_CASE("Score/Player/Serialization", "")
     player.setDescription("My Description");
     player.setMaxVolume(42);
     player.setPan(123);
+    player.setMidiPort(2);
 
     Serialization::test("player", player);
 }
+
+TEST_CASE("Score/Player/MidiPort", "")
+{
+    Player player;
+    REQUIRE(!player.hasMidiPort());
+
+    player.setMidiPort(3);
+    REQUIRE(player.hasMidiPort());
+    REQUIRE(player.getMidiPort() == 3);
+
+    REQUIRE_THROWS(player.setMidiPort(Midi::MAX_MIDI_PORTS));
+
+    player.clearMidiPort();
+    REQUIRE(!player.hasMidiPort());
+}
+
+TEST_CASE("Score/Player/InvalidMidiPort", "")
+{
+    Player player;
+    player.setMidiPort(2);
+
+    std::ostringstream output;
+    ScoreUtils::save(output, "player", player);
+
+    // Change the port to one that doesn't exist.
+    std::string data = output.str();
+    const size_t pos = data.find('2', data.find("midi_port"));
+    REQUIRE(pos != std::string::npos);
+    data.replace(pos, 1, std::to_string(Midi::MAX_MIDI_PORTS));
+
+    Player copy;
+    std::istringstream input(data);
+    REQUIRE_THROWS(ScoreUtils::load(input, "player", copy));
+}
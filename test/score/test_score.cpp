@@ -57,3 +57,20 @@ TEST_CASE("Score/Score/Instruments", "")
     score.removeInstrument(0);
     REQUIRE(score.getInstruments().size() == 0);
 }
+
+TEST_CASE("Score/Score/Copy", "")
+{
+    Score score;
+    score.insertSystem(System());
+    score.insertPlayer(Player());
+    score.insertInstrument(Instrument());
+    score.setLineSpacing(12);
+
+    Score copy;
+    ScoreUtils::copy(score, copy);
+    REQUIRE(copy == score);
+
+    // The copy should not share any data with the original score.
+    copy.removeSystem(0);
+    REQUIRE(score.getSystems().size() == 1);
+}
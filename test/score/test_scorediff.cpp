@@ -0,0 +1,200 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <catch.hpp>
+
+#include <score/score.h>
+#include <score/utils/scorediff.h>
+#include <sstream>
+
+static System makeSystem(int fret)
+{
+    System system;
+    Staff staff(6);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        Position pos(i);
+        pos.insertNote(Note(0, fret + i));
+        staff.getVoices()[0].insertPosition(pos);
+    }
+
+    system.insertStaff(staff);
+    system.insertStaff(staff);
+    return system;
+}
+
+static void makeScore(Score &score, int systemCount)
+{
+    score.insertPlayer(Player());
+    score.insertInstrument(Instrument());
+
+    for (int i = 0; i < systemCount; ++i)
+        score.insertSystem(makeSystem(i));
+}
+
+/// Changes the fret number of the first note in a staff.
+static void editNote(Score &score, int system, int staff, int fret)
+{
+    Position &pos = score.getSystems()[system]
+                        .getStaves()[staff]
+                        .getVoices()[0]
+                        .getPositions()[0];
+    pos.getNotes()[0].setFretNumber(fret);
+}
+
+TEST_CASE("Score/ScoreDiff/Identical", "")
+{
+    Score original, modified;
+    makeScore(original, 10);
+    makeScore(modified, 10);
+
+    const ScoreUtils::ScorePatch patch = ScoreUtils::diff(original, modified);
+    REQUIRE(patch.isEmpty());
+}
+
+TEST_CASE("Score/ScoreDiff/Diff", "")
+{
+    Score original, modified;
+    makeScore(original, 10);
+    makeScore(modified, 10);
+
+    editNote(modified, 2, 0, 20);
+    modified.removeSystem(5);
+    modified.insertSystem(makeSystem(15), 7);
+    modified.setLineSpacing(12);
+
+    const ScoreUtils::ScorePatch patch = ScoreUtils::diff(original, modified);
+    REQUIRE(patch.myLineSpacing);
+    REQUIRE(!patch.myPlayers);
+    REQUIRE(patch.myHunks.size() == 3);
+
+    REQUIRE(patch.myHunks[0].myIndex == 2);
+    REQUIRE(patch.myHunks[0].myRemovedCount == 1);
+    REQUIRE(patch.myHunks[0].mySystems.size() == 1);
+
+    REQUIRE(patch.myHunks[1].myIndex == 5);
+    REQUIRE(patch.myHunks[1].myRemovedCount == 1);
+    REQUIRE(patch.myHunks[1].mySystems.empty());
+
+    REQUIRE(patch.myHunks[2].myIndex == 8);
+    REQUIRE(patch.myHunks[2].myRemovedCount == 0);
+    REQUIRE(patch.myHunks[2].mySystems.size() == 1);
+
+    std::ostringstream output;
+    ScoreUtils::printPatch(output, original, patch);
+    REQUIRE(output.str() == "Line spacing changed\n"
+                            "System 3, bar 1: 1 position(s) added, 1 removed\n"
+                            "System 6 removed\n"
+                            "1 system(s) added before system 9\n");
+}
+
+TEST_CASE("Score/ScoreDiff/ApplyPatch", "")
+{
+    Score original, modified;
+    makeScore(original, 10);
+    makeScore(modified, 10);
+
+    editNote(modified, 0, 1, 20);
+    modified.removeSystem(3);
+    modified.removeSystem(3);
+    modified.insertSystem(makeSystem(15));
+    modified.getPlayers()[0].setDescription("Guitar");
+
+    const ScoreUtils::ScorePatch patch = ScoreUtils::diff(original, modified);
+
+    Score score;
+    makeScore(score, 10);
+    const ScoreUtils::ScorePatch inverse = ScoreUtils::applyPatch(score, patch);
+    REQUIRE(score == modified);
+
+    ScoreUtils::applyPatch(score, inverse);
+    REQUIRE(score == original);
+}
+
+TEST_CASE("Score/ScoreDiff/Merge", "")
+{
+    Score base, ours, theirs;
+    makeScore(base, 12);
+    makeScore(ours, 12);
+    makeScore(theirs, 12);
+
+    // Changes to different systems.
+    editNote(ours, 1, 0, 20);
+    ours.removeSystem(10);
+    ours.insertSystem(makeSystem(30), 0);
+    editNote(theirs, 7, 0, 21);
+    theirs.insertSystem(makeSystem(15), 8);
+
+    // Changes to different staves in the same system.
+    editNote(ours, 4, 0, 22);
+    editNote(theirs, 3, 1, 23);
+
+    // The same change on both sides.
+    editNote(ours, 6, 0, 24);
+    editNote(theirs, 5, 0, 24);
+
+    theirs.getPlayers()[0].setDescription("Guitar");
+
+    ScoreUtils::MergeResult result = ScoreUtils::merge(base, ours, theirs);
+    REQUIRE(result.myConflicts.empty());
+
+    ScoreUtils::applyPatch(ours, result.myPatch);
+
+    Score expected;
+    makeScore(expected, 12);
+    editNote(expected, 1, 0, 20);
+    editNote(expected, 3, 0, 22);
+    editNote(expected, 3, 1, 23);
+    editNote(expected, 5, 0, 24);
+    editNote(expected, 7, 0, 21);
+    expected.insertSystem(makeSystem(15), 8);
+    expected.removeSystem(11);
+    expected.insertSystem(makeSystem(30), 0);
+    expected.getPlayers()[0].setDescription("Guitar");
+
+    REQUIRE(ours == expected);
+}
+
+TEST_CASE("Score/ScoreDiff/MergeConflicts", "")
+{
+    Score base, ours, theirs;
+    makeScore(base, 10);
+    makeScore(ours, 10);
+    makeScore(theirs, 10);
+
+    editNote(ours, 2, 1, 20);
+    editNote(theirs, 2, 1, 21);
+    editNote(theirs, 2, 0, 22);
+
+    ours.removeSystem(6);
+    editNote(theirs, 6, 0, 23);
+
+    ours.setLineSpacing(12);
+    theirs.setLineSpacing(7);
+
+    ScoreUtils::MergeResult result = ScoreUtils::merge(base, ours, theirs);
+    REQUIRE(result.myConflicts.size() == 3);
+    REQUIRE(result.myConflicts[0].myDescription == "line spacing");
+    REQUIRE(result.myConflicts[0].mySystem == -1);
+    REQUIRE(result.myConflicts[1].myDescription == "staff 2");
+    REQUIRE(result.myConflicts[1].mySystem == 2);
+    REQUIRE(result.myConflicts[2].myDescription == "systems");
+    REQUIRE(result.myConflicts[2].mySystem == 6);
+
+    // Systems with a conflict are left unchanged.
+    REQUIRE(result.myPatch.myHunks.empty());
+}
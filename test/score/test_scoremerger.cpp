@@ -0,0 +1,108 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+  
+#include <catch.hpp>
+
+#include <random>
+#include <score/score.h>
+#include <score/utils/scoremerger.h>
+#include <stdexcept>
+#include "legacyscoremerger.h"
+#include "scoregenerator.h"
+
+/// Generates scores with a mix of the features that the merger handles
+/// (repeats, multi-bar rests, player changes, irregular groupings, etc).
+static void generateScores(unsigned int seed, Score &guitarScore,
+                           Score &bassScore)
+{
+    std::mt19937 engine(seed);
+
+    ScoreGenerator::Options options;
+    options.mySeed = seed;
+    options.mySystemCount = 1 + engine() % 8;
+    options.myBarsPerSystem = 5;
+    options.myHasVariedLayout = true;
+    options.myNoteDensity = 0.6;
+    options.myTupletDensity = 0.2;
+    options.myMultiBarRestDensity = 0.1;
+    options.mySymbolDensity = 0.2;
+    options.myPlayerChangeDensity = 0.15;
+    options.myHasRepeats = false;
+    options.myHasRandomRepeats = true;
+    options.myHasPlayerChanges = false;
+    ScoreGenerator(options).generate(guitarScore);
+
+    if (engine() % 4 != 0)
+    {
+        options.mySeed = engine();
+        options.mySystemCount = 1 + engine() % 8;
+        options.myStringCount = 4;
+        ScoreGenerator(options).generate(bassScore);
+    }
+    else
+    {
+        // An empty bass score, as in most files.
+        System system;
+        system.insertStaff(Staff(4));
+        bassScore.insertSystem(system);
+    }
+}
+
+/// Checks that the merger produces exactly the same score as the previous,
+/// Caret-based implementation.
+TEST_CASE("Score/ScoreMerger/MatchesLegacyMerger", "")
+{
+    for (unsigned int seed = 0; seed < 500; ++seed)
+    {
+        // The mergers can modify the source scores, so each one is given its
+        // own copy.
+        Score guitarScore, bassScore;
+        generateScores(seed, guitarScore, bassScore);
+
+        Score expected;
+        bool expectedThrow = false;
+        try
+        {
+            LegacyScoreMerger merger(expected, guitarScore, bassScore);
+            merger.merge();
+        }
+        catch (const std::exception &)
+        {
+            expectedThrow = true;
+        }
+
+        Score otherGuitarScore, otherBassScore;
+        generateScores(seed, otherGuitarScore, otherBassScore);
+
+        Score actual;
+        bool actualThrow = false;
+        try
+        {
+            ScoreMerger merger(actual, otherGuitarScore, otherBassScore);
+            merger.merge();
+        }
+        catch (const std::exception &)
+        {
+            actualThrow = true;
+        }
+
+        INFO("Seed: " << seed);
+        REQUIRE(actualThrow == expectedThrow);
+        if (!expectedThrow)
+            REQUIRE(actual == expected);
+    }
+}
@@ -0,0 +1,63 @@
+/*
+  * Copyright (C) 2014 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <sstream>
+#include <util/tracing.h>
+
+TEST_CASE("Util/Tracing/Disabled", "")
+{
+    Tracing::setEnabled(false);
+    Tracing::clear();
+
+    {
+        Tracing::Span span("Disabled span");
+    }
+    Tracing::counter("Disabled counter", 1);
+
+    std::ostringstream output;
+    Tracing::exportJson(output);
+    REQUIRE(output.str().find("Disabled") == std::string::npos);
+}
+
+TEST_CASE("Util/Tracing/Export", "")
+{
+    Tracing::setEnabled(true);
+    Tracing::clear();
+
+    {
+        Tracing::Span span("Test span");
+    }
+    Tracing::counter("Test counter", 42);
+    Tracing::setEnabled(false);
+
+    std::ostringstream output;
+    Tracing::exportJson(output);
+    const std::string json = output.str();
+
+    REQUIRE(json.find("\"traceEvents\"") != std::string::npos);
+    REQUIRE(json.find("\"name\":\"Test span\"") != std::string::npos);
+    REQUIRE(json.find("\"ph\":\"X\"") != std::string::npos);
+    REQUIRE(json.find("\"name\":\"Test counter\"") != std::string::npos);
+    REQUIRE(json.find("\"value\":42") != std::string::npos);
+
+    Tracing::clear();
+    output.str("");
+    Tracing::exportJson(output);
+    REQUIRE(output.str().find("Test span") == std::string::npos);
+}